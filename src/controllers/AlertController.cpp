@@ -2,6 +2,7 @@
 #include "models/AlertModel.h"
 #include "models/WeatherData.h"
 #include "services/NWSService.h"
+#include "services/RequestScheduler.h"
 #include "database/DatabaseManager.h"
 #include <QDebug>
 #include <QTimer>
@@ -174,7 +175,12 @@ void AlertController::checkAlerts() {
             continue;
         }
         
-        m_nwsService->fetchCurrent(alert->latitude(), alert->longitude());
+        const double latitude = alert->latitude();
+        const double longitude = alert->longitude();
+        NWSService* service = m_nwsService;
+        RequestScheduler::instance()->submit(service, RequestScheduler::Alerts, [service, latitude, longitude]() {
+            service->fetchCurrent(latitude, longitude);
+        });
         // Store alert for callback
         // Note: This is simplified - in a real implementation, we'd track which alert
         // each request belongs to
@@ -243,7 +249,13 @@ void AlertController::fetchNwsAlerts() {
         return;
     }
     
-    m_nwsService->fetchAlerts(m_monitorLatitude, m_monitorLongitude);
+    // Polling waits behind user fetches; the next poll supersedes an expired one
+    NWSService* service = m_nwsService;
+    const double latitude = m_monitorLatitude;
+    const double longitude = m_monitorLongitude;
+    RequestScheduler::instance()->submit(service, RequestScheduler::Alerts, [service, latitude, longitude]() {
+        service->fetchAlerts(latitude, longitude);
+    });
 }
 
 void AlertController::onNwsAlertsReady(QList<QJsonObject> alerts) {
@@ -1,11 +1,11 @@
 #include "controllers/WeatherController.h"
 #include "models/WeatherData.h"
 #include "models/ForecastModel.h"
+#include "models/ForecastSeries.h"
+#include "models/ForecastCodec.h"
 #include "database/DatabaseManager.h"
+#include "services/RequestScheduler.h"
 #include <QDebug>
-#include <QJsonObject>
-#include <QJsonDocument>
-#include <QJsonArray>
 #include <QDateTime>
 #include <QVariant>
 #include <QByteArray>
@@ -17,13 +17,43 @@
 #include <QProcessEnvironment>
 #include <cmath>
 
+namespace {
+// Cached forecasts are fresh for an hour and may be served stale while a
+// background refresh runs for up to a day
+constexpr int ForecastFreshSeconds = 3600;
+constexpr int ForecastMaxStaleSeconds = 24 * 3600;
+
+// Stored history from nearby locations feeds the nowcast motion estimate
+constexpr double NowcastNeighborhoodKm = 25.0;
+constexpr int NowcastHistoryHours = 3;
+constexpr int NowcastNeighborCount = 8;
+
+// Upstream admission: a spatio-temporal refresh (7 points per service) fits
+// in one burst, sustained traffic is held below the providers' limits
+RequestScheduler::RateLimit pirateRateLimit() {
+    RequestScheduler::RateLimit limit;
+    limit.requestsPerSecond = 1.0;
+    limit.burst = 10;
+    limit.interactiveReserve = 2;
+    return limit;
+}
+
+RequestScheduler::RateLimit nwsRateLimit() {
+    RequestScheduler::RateLimit limit;
+    limit.requestsPerSecond = 4.0;
+    limit.burst = 16;
+    limit.interactiveReserve = 2;
+    return limit;
+}
+} // namespace
+
 WeatherController::WeatherController(QObject *parent)
     : QObject(parent)
     , m_forecastModel(new ForecastModel(this))
     , m_current(nullptr)
     , m_nwsService(new NWSService(this))
     , m_pirateService(new PirateWeatherService(this))
-    , m_cache(new CacheManager(50, this))
+    , m_cache(new CacheManager(20000, this))
     , m_aggregator(new WeatherAggregator(this))
     , m_performanceMonitor(new PerformanceMonitor(this))
     , m_historicalManager(new HistoricalDataManager(this))
@@ -33,6 +63,7 @@ WeatherController::WeatherController(QObject *parent)
     , m_lastLon(0.0)
     , m_serviceProvider(NWS)
     , m_useAggregation(false)
+    , m_revalidating(false)
 {
     EnvLoader::loadFromFile();
 
@@ -44,9 +75,25 @@ WeatherController::WeatherController(QObject *parent)
         qWarning() << "PIRATE_WEATHER_API_KEY is not set. Pirate Weather requests will fail.";
     }
 
+    RequestScheduler* scheduler = RequestScheduler::instance();
+    scheduler->setRateLimit(m_pirateService->serviceName(), pirateRateLimit());
+    scheduler->setRateLimit(m_nwsService->serviceName(), nwsRateLimit());
+    
+    // Both services share one HTTP client; handshake now so the first fetch reuses the connection
+    m_nwsService->preconnect();
+    if (m_pirateService->hasApiKey()) {
+        m_pirateService->preconnect();
+    }
+
     // Initialize historical data manager
     m_historicalManager->initialize();
     
+    // Back the forecast cache with SQLite so restarts start warm
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (dbManager->isInitialized()) {
+        m_cache->setPersistentStore(dbManager);
+    }
+    
     // Setup aggregator with services
     // m_aggregator->addService(m_nwsService, 10); // Higher priority for NWS
     m_aggregator->addService(m_pirateService, 5);
@@ -157,19 +204,37 @@ void WeatherController::fetchForecast(double latitude, double longitude) {
     
     // Check cache first (cache key includes service provider)
     QString cacheKey = generateCacheKey(latitude, longitude);
-    QList<WeatherData*> cachedData = loadFromCache(cacheKey);
+    bool isStale = false;
+    QList<WeatherData*> cachedData = loadFromCache(cacheKey, isStale);
     
     if (!cachedData.isEmpty()) {
-        qDebug() << "Using cached forecast data";
+        qDebug() << "Using cached forecast data" << (isStale ? "(stale)" : "");
         m_performanceMonitor->recordForecastResponse(requestId, 0); // Cache hit is instant
         onForecastReady(cachedData);
+        
+        if (isStale) {
+            // Keep showing the stale forecast and refresh it in the background;
+            // forecastUpdated fires again when the fresh data lands
+            m_revalidating = true;
+            requestFromService(latitude, longitude);
+        }
         return;
     }
     
-    // Cache miss - fetch from selected service
+    m_revalidating = false;
+    requestFromService(latitude, longitude);
+}
+
+void WeatherController::requestFromService(double latitude, double longitude) {
+    // Fetch from selected service (cache miss or stale revalidation)
     QElapsedTimer timer;
     timer.start();
     
+    // A stale forecast is already on screen; its refresh yields to user fetches
+    const RequestScheduler::Priority priority = m_revalidating ? RequestScheduler::Prefetch
+                                                               : RequestScheduler::Interactive;
+    RequestScheduler* scheduler = RequestScheduler::instance();
+    
     switch (m_serviceProvider) {
         case NWS:
             // NWS disabled
@@ -177,9 +242,14 @@ void WeatherController::fetchForecast(double latitude, double longitude) {
             break;
         case PirateWeather:
             if (m_pirateService->isAvailable()) {
-                m_pirateService->cancelActiveRequests();
+                // A repeat fetch for the same location joins the outstanding
+                // reply; only a different location supersedes it
+                if (!m_pirateService->isForecastInFlight(latitude, longitude)) {
+                    m_pirateService->cancelActiveRequests();
+                    scheduler->cancel(m_pirateService);
+                }
                 qDebug() << "Cache miss - fetching from Pirate Weather API";
-                m_pirateService->fetchForecast(latitude, longitude);
+                scheduler->fetchForecast(m_pirateService, latitude, longitude, priority);
             } else {
                 setErrorMessage("Pirate Weather API key not available");
                 setLoading(false);
@@ -188,11 +258,11 @@ void WeatherController::fetchForecast(double latitude, double longitude) {
         case Aggregated:
             if (m_useAggregation) {
                 qDebug() << "Cache miss - fetching from aggregated services";
-                m_aggregator->fetchForecast(latitude, longitude);
+                m_aggregator->fetchForecast(latitude, longitude, priority);
             } else {
                 // Fallback to PirateWeather if aggregation disabled
                  if (m_pirateService->isAvailable()) {
-                    m_pirateService->fetchForecast(latitude, longitude);
+                    scheduler->fetchForecast(m_pirateService, latitude, longitude, priority);
                 } else {
                     setErrorMessage("Pirate Weather API key not available");
                     setLoading(false);
@@ -208,12 +278,14 @@ void WeatherController::refreshForecast() {
         QString cacheKey = generateCacheKey(m_lastLat, m_lastLon);
         m_cache->remove(cacheKey);
         
-        // Cancel any active requests to avoid processing stale responses
+        // Cancel any active or queued requests to avoid processing stale responses
         if (m_pirateService) {
             m_pirateService->cancelActiveRequests();
+            RequestScheduler::instance()->cancel(m_pirateService);
         }
         if (m_nwsService) {
             m_nwsService->cancelActiveRequests();
+            RequestScheduler::instance()->cancel(m_nwsService);
         }
         
         fetchForecast(m_lastLat, m_lastLon);
@@ -240,6 +312,10 @@ void WeatherController::onForecastReady(QList<WeatherData*> data) {
 
     qInfo() << "Received" << data.size() << "forecast periods";
     
+    if (!isFromCache) {
+        m_revalidating = false;
+    }
+    
     if (data.isEmpty()) {
         setErrorMessage("No forecast data available");
         setLoading(false);
@@ -256,13 +332,13 @@ void WeatherController::onForecastReady(QList<WeatherData*> data) {
     // Record service up
     m_performanceMonitor->recordServiceUp(serviceProvider());
     
-    // Store forecasts to historical storage
+    // Queue forecasts for historical storage (written on a background thread)
     if (m_historicalManager) {
         QString source = serviceProvider().toLower();
         if (m_useAggregation && m_serviceProvider == Aggregated) {
             source = "merged";
         }
-        m_historicalManager->storeForecasts(m_lastLat, m_lastLon, data, source);
+        m_historicalManager->enqueueForecasts(m_lastLat, m_lastLon, data, source);
     }
     
     // Set parent for all WeatherData objects to the model so it owns them
@@ -287,9 +363,11 @@ void WeatherController::onForecastReady(QList<WeatherData*> data) {
     m_current = data.first();
     emit currentChanged();
     
-    // Cache the data
-    QString cacheKey = generateCacheKey(m_lastLat, m_lastLon);
-    saveToCache(cacheKey, data);
+    // Cache the data (re-saving a cache hit would make stale data look fresh)
+    if (!isFromCache) {
+        QString cacheKey = generateCacheKey(m_lastLat, m_lastLon);
+        saveToCache(cacheKey, data);
+    }
     
     setLoading(false);
     emit forecastUpdated();
@@ -351,6 +429,14 @@ void WeatherController::onServiceError(QString error) {
         qDebug() << "Ignoring service error from inactive source:" << error;
         return;
     }
+    if (m_revalidating) {
+        // The stale forecast stays on screen; the next fetch retries
+        qWarning() << "Background refresh failed:" << error;
+        m_revalidating = false;
+        m_performanceMonitor->recordServiceDown(serviceProvider());
+        return;
+    }
+    
     qWarning() << "Service error:" << error;
     setErrorMessage(error);
     setLoading(false);
@@ -387,10 +473,18 @@ void WeatherController::fetchNowcast(double latitude, double longitude) {
         return;
     }
     
-    // Generate nowcast using current weather
-    QList<WeatherData*> historicalData; // Would be populated from recent forecasts
+    // Generate nowcast using current weather and recent neighborhood history
+    QList<WeatherData*> historicalData;
+    const QDateTime now = QDateTime::currentDateTime();
+    const QList<HistoricalDataManager::NearbySeries> neighbors = m_historicalManager->getNearbyData(
+        latitude, longitude, NowcastNeighborhoodKm,
+        now.addSecs(-NowcastHistoryHours * 3600), now, NowcastNeighborCount);
+    for (const HistoricalDataManager::NearbySeries& neighbor : neighbors) {
+        historicalData.append(neighbor.series.toWeatherDataList());
+    }
     QList<WeatherData*> nowcast = m_nowcastEngine->generateNowcast(
         latitude, longitude, m_current, historicalData);
+    qDeleteAll(historicalData);
     
     if (!nowcast.isEmpty()) {
         // Record precipitation predictions for performance monitoring
@@ -431,53 +525,26 @@ QString WeatherController::generateCacheKey(double lat, double lon) const {
     return CacheManager::generateKey(QString("forecast_%1").arg(service), lat, lon);
 }
 
-QList<WeatherData*> WeatherController::loadFromCache(const QString& key) {
-    QVariant cached = m_cache->get(key);
-    if (!cached.isValid()) {
-        return QList<WeatherData*>();
-    }
-    
-    QByteArray cacheData;
-    if (cached.userType() == QMetaType::fromType<QByteArray>().id()) {
-        cacheData = cached.toByteArray();
-    } else if (cached.userType() == QMetaType::fromType<QString>().id()) {
-        cacheData = cached.toString().toUtf8();
-    } else {
+QList<WeatherData*> WeatherController::loadFromCache(const QString& key, bool& isStale) {
+    QVariant cached = m_cache->getAllowStale(key, isStale);
+    if (!cached.isValid() || cached.userType() != QMetaType::fromType<QByteArray>().id()) {
         return QList<WeatherData*>();
     }
     
-    QJsonDocument doc = QJsonDocument::fromJson(cacheData);
-    if (doc.isNull() || !doc.isObject()) {
+    // Binary cache entry: header check only, fields are read in place
+    ForecastView view;
+    if (!view.open(cached.toByteArray())) {
+        qWarning() << "Discarding unreadable forecast cache entry" << key;
+        m_cache->remove(key);
         return QList<WeatherData*>();
     }
     
-    QJsonObject cacheObj = doc.object();
-    QJsonArray forecastArray = cacheObj["forecasts"].toArray();
-    QList<WeatherData*> forecasts;
-    
-    for (const QJsonValue& val : forecastArray) {
-        WeatherData* data = WeatherData::fromJson(val.toObject(), this);
-        if (data) {
-            forecasts.append(data);
-        }
-    }
-    
-    return forecasts;
+    return view.toSeries().toWeatherDataList(this);
 }
 
 void WeatherController::saveToCache(const QString& key, const QList<WeatherData*>& data) {
-    QJsonObject cacheObj;
-    QJsonArray forecastArray;
-    
-    for (WeatherData* forecast : data) {
-        forecastArray.append(forecast->toJson());
-    }
-    
-    cacheObj["forecasts"] = forecastArray;
-    cacheObj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-    
-    QJsonDocument doc(cacheObj);
-    m_cache->put(key, doc.toJson(), 3600); // 1 hour TTL
+    QByteArray encoded = ForecastCodec::encode(ForecastSeries::fromWeatherData(data));
+    m_cache->put(key, encoded, ForecastFreshSeconds, ForecastMaxStaleSeconds);
 }
 
 bool WeatherController::isValidCoordinate(double latitude, double longitude) const {
@@ -83,8 +83,9 @@ private slots:
 private:
     void setLoading(bool loading);
     void setErrorMessage(const QString& message);
+    void requestFromService(double latitude, double longitude);
     QString generateCacheKey(double lat, double lon) const;
-    QList<WeatherData*> loadFromCache(const QString& key);
+    QList<WeatherData*> loadFromCache(const QString& key, bool& isStale);
     void saveToCache(const QString& key, const QList<WeatherData*>& data);
     bool isValidCoordinate(double latitude, double longitude) const;
     bool shouldProcessServiceResponse(QObject* sender, bool& callerOwnsData) const;
@@ -105,6 +106,7 @@ private:
     double m_lastLon;
     ServiceProvider m_serviceProvider;
     bool m_useAggregation;
+    bool m_revalidating;    // Background refresh of a stale cached forecast
 };
 
 #endif // WEATHERCONTROLLER_H
@@ -0,0 +1,149 @@
+#include "database/ConnectionPool.h"
+#include "database/StatementCache.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QThread>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <atomic>
+#include <memory>
+
+namespace {
+// Wait for another connection's write lock instead of failing with SQLITE_BUSY
+constexpr int BusyTimeoutMs = 5000;
+
+// Connections may outlive their pool, so names are unique across pools
+std::atomic<quint64> nextConnectionId{0};
+} // namespace
+
+/**
+ * @brief One thread's connection
+ */
+struct ConnectionPool::Connection {
+    QString name;
+    std::unique_ptr<StatementCache> statements;
+    QMetaObject::Connection threadFinished;
+
+    ~Connection() {
+        QObject::disconnect(threadFinished);
+        statements.reset();     // Finalize statements before closing
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+/**
+ * @brief Every open connection, keyed by the thread that owns it
+ *
+ * Shared with the threads' finished handlers, which keep it alive after the
+ * pool is gone until the last owning thread has closed its connection.
+ * Whoever takes a connection out of the map under the mutex deletes it, so
+ * a connection is never closed twice.
+ */
+struct ConnectionPool::Registry {
+    mutable QMutex mutex;
+    QHash<QThread*, Connection*> connections;
+    DatabaseManager::TuningProfile profile;
+
+    Connection* find(QThread* thread) const {
+        QMutexLocker locker(&mutex);
+        return connections.value(thread);
+    }
+
+    void close(QThread* thread) {
+        Connection* connection = nullptr;
+        {
+            QMutexLocker locker(&mutex);
+            connection = connections.take(thread);
+        }
+        delete connection;
+    }
+};
+
+ConnectionPool::ConnectionPool(const QString& databasePath,
+                               const DatabaseManager::TuningProfile& profile,
+                               const QString& namePrefix)
+    : m_databasePath(databasePath)
+    , m_namePrefix(namePrefix)
+    , m_registry(new Registry)
+{
+    m_registry->profile = profile;
+}
+
+ConnectionPool::~ConnectionPool() {
+    m_registry->close(QThread::currentThread());
+
+    // Other threads may be mid-query; their finished handlers close them
+    const int remaining = openConnections();
+    if (remaining > 0) {
+        qWarning() << "Connection pool destroyed with" << remaining
+                   << "connection(s) open on running threads; they close when those threads finish";
+    }
+}
+
+QSqlDatabase ConnectionPool::connection() {
+    QThread* thread = QThread::currentThread();
+    if (Connection* existing = m_registry->find(thread)) {
+        return QSqlDatabase::database(existing->name, false);
+    }
+
+    // A second connection to an in-memory database would see a different database
+    if (m_databasePath.isEmpty() || m_databasePath == ":memory:") {
+        qWarning() << "Connection pool needs an on-disk database";
+        return QSqlDatabase();
+    }
+
+    DatabaseManager::TuningProfile profile;
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        profile = m_registry->profile;
+    }
+    const QString name = QString("%1_%2").arg(m_namePrefix).arg(nextConnectionId++);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(m_databasePath);
+        if (!db.open()) {
+            qWarning() << "Failed to open pooled connection:" << db.lastError().text();
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(name);
+            return QSqlDatabase();
+        }
+        DatabaseManager::applyTuning(db, profile);
+        QSqlQuery pragma(db);
+        pragma.exec(QString("PRAGMA busy_timeout = %1").arg(BusyTimeoutMs));
+    }
+
+    Connection* connection = new Connection;
+    connection->name = name;
+    connection->statements.reset(new StatementCache(QSqlDatabase::database(name, false)));
+
+    // Runs on the finishing thread; holds the registry so the connection is
+    // closed there even after the pool is gone
+    QSharedPointer<Registry> registry = m_registry;
+    connection->threadFinished = QObject::connect(thread, &QThread::finished, [registry, thread]() {
+        // Closing disconnects this handler, so keep the registry on the stack
+        QSharedPointer<Registry> alive = registry;
+        alive->close(thread);
+    });
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        m_registry->connections.insert(thread, connection);
+    }
+    return QSqlDatabase::database(name, false);
+}
+
+void ConnectionPool::release() {
+    m_registry->close(QThread::currentThread());
+}
+
+void ConnectionPool::setTuningProfile(const DatabaseManager::TuningProfile& profile) {
+    QMutexLocker locker(&m_registry->mutex);
+    m_registry->profile = profile;
+}
+
+int ConnectionPool::openConnections() const {
+    QMutexLocker locker(&m_registry->mutex);
+    return m_registry->connections.size();
+}
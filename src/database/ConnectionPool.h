@@ -0,0 +1,72 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QSharedPointer>
+#include <QString>
+#include "database/DatabaseManager.h"
+
+/**
+ * @brief Per-thread SQLite connections to one database file
+ *
+ * Qt connections may only be used by the thread that opened them. The pool
+ * opens one connection per calling thread on first use, applies the tuning
+ * profile and a busy timeout so concurrent writers wait for each other's
+ * locks, gives it a StatementCache, and closes it automatically when the
+ * thread finishes. A connection is only ever closed on its own thread: the
+ * destructor closes the destroying thread's connection, and connections of
+ * threads still running are closed when those threads finish (or release()),
+ * even if the pool is gone by then.
+ *
+ * All methods are thread-safe.
+ */
+class ConnectionPool
+{
+public:
+    /**
+     * @brief Constructor
+     * @param databasePath SQLite file; in-memory databases cannot be shared
+     * @param profile Pragmas applied to each new connection
+     * @param namePrefix Prefix of the Qt connection names
+     */
+    ConnectionPool(const QString& databasePath,
+                   const DatabaseManager::TuningProfile& profile = DatabaseManager::TuningProfile::performance(),
+                   const QString& namePrefix = "HyperlocalWeatherPool");
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief The calling thread's connection, opened on first use
+     * @return An invalid (closed) database if the connection cannot be opened
+     */
+    QSqlDatabase connection();
+
+    /**
+     * @brief Close the calling thread's connection before the thread ends
+     */
+    void release();
+
+    /**
+     * @brief Pragmas for connections opened from now on
+     */
+    void setTuningProfile(const DatabaseManager::TuningProfile& profile);
+
+    QString databasePath() const { return m_databasePath; }
+
+    /**
+     * @brief Connections currently open across all threads
+     */
+    int openConnections() const;
+
+private:
+    struct Registry;
+    struct Connection;
+
+    QString m_databasePath;
+    QString m_namePrefix;
+    QSharedPointer<Registry> m_registry;
+};
+
+#endif // CONNECTIONPOOL_H
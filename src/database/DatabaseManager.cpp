@@ -1,20 +1,298 @@
 #include "database/DatabaseManager.h"
+#include "database/ConnectionPool.h"
+#include "database/StatementCache.h"
 #include <QDebug>
 #include <QStandardPaths>
 #include <QDir>
 #include <QSqlError>
+#include <QSqlRecord>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QDateTime>
+#include <QTimeZone>
 #include <QCoreApplication>
+#include <QTimer>
+#include <QThread>
 
 DatabaseManager* DatabaseManager::s_instance = nullptr;
 
+namespace {
+// Validators not refreshed for this long no longer match anything upstream
+constexpr int HttpValidatorRetentionDays = 7;
+
+// NWS rarely redraws its grid; re-resolve a cell after this long anyway
+constexpr int NwsGridpointRetentionDays = 30;
+
+// forecast_cache.expires_at uses the same format as SQLite's datetime('now')
+const char* const CacheTimeFormat = "yyyy-MM-dd HH:mm:ss";
+
+QString toCacheTime(const QDateTime& dateTime) {
+    return dateTime.toUTC().toString(CacheTimeFormat);
+}
+
+QDateTime fromCacheTime(const QString& value) {
+    QDateTime dateTime = QDateTime::fromString(value, CacheTimeFormat);
+    dateTime.setTimeZone(QTimeZone::utc());
+    return dateTime;
+}
+
+// Bumped when a table layout changes incompatibly; stored in PRAGMA user_version
+constexpr int SchemaVersion = 3;
+
+// Daily partitions are historical_weather_YYYYMMDD; names sort chronologically
+const char* const HistoricalPartitionPrefix = "historical_weather_";
+const char* const HistoricalPartitionFormat = "yyyyMMdd";
+constexpr qint64 SecondsPerHour = 3600;
+constexpr qint64 SecondsPerDay = 24 * SecondsPerHour;
+
+const char* const HistoricalColumns =
+    "lat_udeg, lon_udeg, ts, source, temperature, feels_like, precip_probability, precip_intensity, "
+    "wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index, "
+    "weather_condition, weather_description, created_at";
+
+// Start of the UTC day a partition holds
+bool partitionStart(const QString& partition, qint64& startSecs) {
+    const QDate day = QDate::fromString(partition.mid(qstrlen(HistoricalPartitionPrefix)),
+                                        HistoricalPartitionFormat);
+    if (!day.isValid()) {
+        return false;
+    }
+    startSecs = QDateTime(day, QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+    return true;
+}
+
+// Per location, source and hour or UTC day: sample count plus min, max and
+// sum of each rollup metric
+bool createRollupTable(QSqlQuery& query, const QString& name) {
+    QStringList metricColumns;
+    for (const QString& metric : DatabaseManager::rollupMetrics()) {
+        metricColumns.append(QString("%1_min REAL, %1_max REAL, %1_sum REAL").arg(metric));
+    }
+    const QString createTable = QString(R"(
+        CREATE TABLE IF NOT EXISTS %1 (
+            lat_udeg INTEGER NOT NULL,
+            lon_udeg INTEGER NOT NULL,
+            ts INTEGER NOT NULL,
+            source TEXT NOT NULL,
+            sample_count INTEGER NOT NULL,
+            %2,
+            PRIMARY KEY (lat_udeg, lon_udeg, ts, source)
+        ) WITHOUT ROWID
+    )").arg(name, metricColumns.join(",\n            "));
+    
+    if (!query.exec(createTable)) {
+        qCritical() << "Failed to create" << name << "table:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// Historical row layout (schema v2): coordinates snapped to the 0.0001 degree
+// grid as integer micro-degrees and epoch-second timestamps, clustered on
+// (location, time) so lookups are index range scans
+bool createHistoricalTable(QSqlQuery& query, const QString& name) {
+    const QString createTable = QString(R"(
+        CREATE TABLE IF NOT EXISTS %1 (
+            lat_udeg INTEGER NOT NULL,
+            lon_udeg INTEGER NOT NULL,
+            ts INTEGER NOT NULL,
+            source TEXT NOT NULL,
+            temperature REAL,
+            feels_like REAL,
+            precip_probability REAL,
+            precip_intensity REAL,
+            wind_speed REAL,
+            wind_direction INTEGER,
+            humidity INTEGER,
+            pressure REAL,
+            cloud_cover INTEGER,
+            visibility INTEGER,
+            uv_index INTEGER,
+            weather_condition TEXT,
+            weather_description TEXT,
+            created_at INTEGER DEFAULT (strftime('%s', 'now')),
+            PRIMARY KEY (lat_udeg, lon_udeg, ts, source)
+        ) WITHOUT ROWID
+    )").arg(name);
+    
+    if (!query.exec(createTable)) {
+        qCritical() << "Failed to create" << name << "table:" << query.lastError().text();
+        return false;
+    }
+    return query.exec(QString("CREATE INDEX IF NOT EXISTS idx_%1_source_ts ON %1(source, ts)").arg(name));
+}
+
+// Redefines historical_weather as the UNION ALL of the current partitions so
+// ad hoc readers see one table; the query router reads partitions directly
+bool rebuildHistoricalView(QSqlDatabase db, QString& errorText) {
+    QStringList selects;
+    for (const QString& partition : DatabaseManager::historicalPartitions(db)) {
+        selects.append(QString("SELECT %1 FROM %2").arg(HistoricalColumns, partition));
+    }
+    if (selects.isEmpty()) {
+        QStringList nulls;
+        for (const QString& column : QString(HistoricalColumns).split(", ")) {
+            nulls.append("NULL AS " + column);
+        }
+        selects.append(QString("SELECT %1 WHERE 0").arg(nulls.join(", ")));
+    }
+    
+    QSqlQuery query(db);
+    if (!query.exec("DROP VIEW IF EXISTS historical_weather")
+        || !query.exec("CREATE VIEW historical_weather AS " + selects.join(" UNION ALL "))) {
+        errorText = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// Splits a single v2 historical_weather table into daily partitions
+bool partitionHistorical(QSqlDatabase db) {
+    QSqlQuery query(db);
+    if (!db.transaction()
+        || !query.exec("ALTER TABLE historical_weather RENAME TO historical_weather_unpartitioned")
+        || !query.exec("SELECT DISTINCT ts / 86400 FROM historical_weather_unpartitioned")) {
+        qCritical() << "Failed to stage historical_weather partitioning:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    
+    QList<qint64> days;
+    while (query.next()) {
+        days.append(query.value(0).toLongLong());
+    }
+    
+    QString errorText;
+    for (qint64 day : days) {
+        const QString partition = DatabaseManager::historicalPartition(day * SecondsPerDay);
+        if (!createHistoricalTable(query, partition)) {
+            db.rollback();
+            return false;
+        }
+        query.prepare(QString("INSERT OR REPLACE INTO %1 (%2) SELECT %2 FROM historical_weather_unpartitioned "
+                              "WHERE ts >= ? AND ts < ?").arg(partition, HistoricalColumns));
+        query.addBindValue(day * SecondsPerDay);
+        query.addBindValue((day + 1) * SecondsPerDay);
+        if (!query.exec()) {
+            errorText = query.lastError().text();
+            break;
+        }
+    }
+    
+    if (!errorText.isEmpty()
+        || !query.exec("DROP TABLE historical_weather_unpartitioned")
+        || !rebuildHistoricalView(db, errorText)
+        || !db.commit()) {
+        qCritical() << "Failed to partition historical_weather:"
+                    << (errorText.isEmpty() ? query.lastError().text() : errorText);
+        db.rollback();
+        return false;
+    }
+    
+    qInfo() << "Partitioned historical_weather into" << days.size() << "daily tables";
+    return true;
+}
+
+// Copies rows from the pre-v2 historical table (REAL coordinates, ISO-8601 text
+// timestamps in the writer's local time) into the current layout
+bool migrateLegacyHistorical(QSqlDatabase db) {
+    // Tables older than the feels_like column kept it only inside data_json
+    const QSqlRecord legacy = db.record("historical_weather_legacy");
+    const QString feelsLike = legacy.contains("feels_like") ? "feels_like" : "NULL";
+    const QString dataJson = legacy.contains("data_json") ? "data_json" : "NULL";
+    
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    const QString selectSql = QString(R"(
+        SELECT latitude, longitude, timestamp, source, temperature, %1, precip_probability,
+               precip_intensity, wind_speed, wind_direction, humidity, pressure, cloud_cover,
+               visibility, uv_index, weather_condition, weather_description, %2
+        FROM historical_weather_legacy
+    )").arg(feelsLike, dataJson);
+    if (!select.exec(selectSql)) {
+        qCritical() << "Failed to read legacy historical rows:" << select.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery insert(db);
+    insert.prepare(R"(
+        INSERT OR REPLACE INTO historical_weather
+        (lat_udeg, lon_udeg, ts, source, temperature, feels_like, precip_probability, precip_intensity,
+         wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index,
+         weather_condition, weather_description)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    int migrated = 0;
+    int skipped = 0;
+    while (select.next()) {
+        const QDateTime timestamp = QDateTime::fromString(select.value(2).toString(), Qt::ISODate);
+        if (!timestamp.isValid()) {
+            ++skipped;
+            continue;
+        }
+        
+        QVariant feels = select.value(5);
+        if (feels.isNull()) {
+            const QJsonDocument doc = QJsonDocument::fromJson(select.value(17).toString().toUtf8());
+            if (doc.isObject() && doc.object().contains("feelsLike")) {
+                feels = doc.object().value("feelsLike").toDouble();
+            }
+        }
+        
+        insert.bindValue(0, DatabaseManager::toMicroDegrees(select.value(0).toDouble()));
+        insert.bindValue(1, DatabaseManager::toMicroDegrees(select.value(1).toDouble()));
+        insert.bindValue(2, timestamp.toSecsSinceEpoch());
+        insert.bindValue(3, select.value(3));
+        insert.bindValue(4, select.value(4));
+        insert.bindValue(5, feels);
+        // Remaining columns line up one to one
+        for (int column = 6; column <= 16; ++column) {
+            insert.bindValue(column, select.value(column));
+        }
+        
+        if (!insert.exec()) {
+            qCritical() << "Failed to migrate historical row:" << insert.lastError().text();
+            return false;
+        }
+        ++migrated;
+    }
+    
+    qInfo() << "Migrated" << migrated << "historical rows to schema version" << SchemaVersion
+            << "(" << skipped << "unreadable rows skipped)";
+    return true;
+}
+} // namespace
+
+DatabaseManager::TuningProfile DatabaseManager::TuningProfile::sqliteDefaults() {
+    TuningProfile profile;
+    profile.journalMode = "DELETE";
+    profile.synchronous = "FULL";
+    profile.mmapSize = 0;
+    profile.cacheSizeKb = 2000;
+    profile.tempStoreMemory = false;
+    profile.maintenanceIntervalMs = 0;
+    return profile;
+}
+
+DatabaseManager::TuningProfile DatabaseManager::TuningProfile::performance() {
+    return TuningProfile();
+}
+
 DatabaseManager::DatabaseManager(QObject *parent)
     : QObject(parent)
+    , m_statements(nullptr)
+    , m_pool(nullptr)
     , m_initialized(false)
+    , m_tuningProfile(TuningProfile::performance())
+    , m_maintenanceTimer(new QTimer(this))
 {
+    connect(m_maintenanceTimer, &QTimer::timeout, this, &DatabaseManager::runMaintenance);
 }
 
 DatabaseManager::~DatabaseManager() {
+    delete m_pool;
+    delete m_statements;
     if (m_database.isOpen()) {
         m_database.close();
     }
@@ -51,17 +329,27 @@ bool DatabaseManager::initialize() {
         return false;
     }
     
+    // Journal mode and page cache settings take effect before any table work
+    applyTuning(m_database, m_tuningProfile);
+    
     // Create tables
-    if (!createTables()) {
+    if (!createTables(m_database)) {
         qCritical() << "Failed to create database tables";
         m_database.close();
         return false;
     }
     
+    // Other threads open their own connections to the same file
+    m_statements = new StatementCache(m_database);
+    m_pool = new ConnectionPool(dbPath, m_tuningProfile);
+    
     // Cleanup expired cache entries
     cleanupExpiredCache();
     
     m_initialized = true;
+    if (m_tuningProfile.maintenanceIntervalMs > 0) {
+        m_maintenanceTimer->start(m_tuningProfile.maintenanceIntervalMs);
+    }
     qInfo() << "Database initialized successfully:" << dbPath;
     return true;
 }
@@ -75,8 +363,287 @@ QString DatabaseManager::getDatabasePath() const {
     return dataDir.filePath("hyperlocal_weather.db");
 }
 
-bool DatabaseManager::createTables() {
-    QSqlQuery query(m_database);
+QSqlDatabase DatabaseManager::database() const {
+    if (!m_pool || QThread::currentThread() == thread()) {
+        return m_database;
+    }
+    return m_pool->connection();
+}
+
+bool DatabaseManager::execute(const QString& sql, const QVariantList& bindValues,
+                              QList<QVariantList>* rows, QString* errorText) const {
+    QSqlDatabase db = database();
+    if (!db.isOpen()) {
+        if (errorText) {
+            *errorText = "Database not open";
+        }
+        return false;
+    }
+    
+    PreparedQuery query(db, sql);
+    for (int i = 0; i < bindValues.size(); ++i) {
+        query->bindValue(i, bindValues.at(i));
+    }
+    if (!query->exec()) {
+        if (errorText) {
+            *errorText = query->lastError().text();
+        }
+        return false;
+    }
+    
+    if (rows) {
+        rows->clear();
+        const int columns = query->record().count();
+        while (query->next()) {
+            QVariantList row;
+            row.reserve(columns);
+            for (int column = 0; column < columns; ++column) {
+                row.append(query->value(column));
+            }
+            rows->append(row);
+        }
+    }
+    return true;
+}
+
+void DatabaseManager::setTuningProfile(const TuningProfile& profile) {
+    m_tuningProfile = profile;
+    if (!m_database.isOpen()) {
+        return;
+    }
+    
+    applyTuning(m_database, m_tuningProfile);
+    if (m_pool) {
+        m_pool->setTuningProfile(m_tuningProfile);
+    }
+    if (m_tuningProfile.maintenanceIntervalMs > 0) {
+        m_maintenanceTimer->start(m_tuningProfile.maintenanceIntervalMs);
+    } else {
+        m_maintenanceTimer->stop();
+    }
+}
+
+qint64 DatabaseManager::toMicroDegrees(double degrees) {
+    return qRound64(degrees * 10000.0) * 100;
+}
+
+double DatabaseManager::fromMicroDegrees(qint64 microDegrees) {
+    return microDegrees / 1000000.0;
+}
+
+QString DatabaseManager::historicalPartition(qint64 epochSeconds) {
+    return HistoricalPartitionPrefix
+        + QDateTime::fromSecsSinceEpoch(epochSeconds, QTimeZone::utc()).toString(HistoricalPartitionFormat);
+}
+
+QStringList DatabaseManager::historicalPartitions(QSqlDatabase db, qint64 fromSecs, qint64 toSecs) {
+    // Compare names rather than parse them; fixed-width dates sort chronologically
+    const QString first = fromSecs == std::numeric_limits<qint64>::min() ? QString() : historicalPartition(fromSecs);
+    const QString last = toSecs == std::numeric_limits<qint64>::max() ? QString() : historicalPartition(toSecs);
+    
+    QStringList partitions;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name FROM sqlite_master WHERE type = 'table' "
+                    "AND name GLOB 'historical_weather_[0-9]*' ORDER BY name")) {
+        qWarning() << "Failed to list historical partitions:" << query.lastError().text();
+        return partitions;
+    }
+    while (query.next()) {
+        const QString name = query.value(0).toString();
+        if ((first.isEmpty() || name >= first) && (last.isEmpty() || name <= last)) {
+            partitions.append(name);
+        }
+    }
+    return partitions;
+}
+
+bool DatabaseManager::ensureHistoricalPartition(QSqlDatabase db, const QString& partition, QString& errorText) {
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?");
+    query.addBindValue(partition);
+    if (!query.exec()) {
+        errorText = query.lastError().text();
+        return false;
+    }
+    if (query.next()) {
+        return true;
+    }
+    
+    if (!createHistoricalTable(query, partition)) {
+        errorText = query.lastError().text();
+        return false;
+    }
+    return rebuildHistoricalView(db, errorText);
+}
+
+QStringList DatabaseManager::historicalPartitionsBefore(QSqlDatabase db, qint64 cutoffSecs) {
+    QStringList expired;
+    for (const QString& partition : historicalPartitions(db)) {
+        qint64 startSecs = 0;
+        if (partitionStart(partition, startSecs) && startSecs + SecondsPerDay <= cutoffSecs) {
+            expired.append(partition);
+        }
+    }
+    return expired;
+}
+
+bool DatabaseManager::dropHistoricalPartitions(QSqlDatabase db, const QStringList& partitions) {
+    if (partitions.isEmpty()) {
+        return true;
+    }
+    
+    // Dropping a table frees its pages without rewriting any others
+    QSqlQuery query(db);
+    QString errorText;
+    bool ok = db.transaction();
+    for (const QString& partition : partitions) {
+        if (!ok) {
+            break;
+        }
+        ok = query.exec("DROP TABLE " + partition);
+        
+        // Forget the revisions of the dropped day too, so re-ingesting it writes every sample
+        qint64 startSecs = 0;
+        if (ok && partitionStart(partition, startSecs)) {
+            const QStringList deletes = {
+                "DELETE FROM forecast_revisions WHERE ts >= ? AND ts < ?",
+                "DELETE FROM forecast_issuances WHERE last_ts >= ? AND last_ts < ?"
+            };
+            for (const QString& sql : deletes) {
+                query.prepare(sql);
+                query.addBindValue(startSecs);
+                query.addBindValue(startSecs + SecondsPerDay);
+                ok = ok && query.exec();
+            }
+        }
+    }
+    if (ok) {
+        ok = rebuildHistoricalView(db, errorText) && db.commit();
+    }
+    if (!ok) {
+        qWarning() << "Failed to drop historical partitions:"
+                   << (errorText.isEmpty() ? query.lastError().text() : errorText);
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+int DatabaseManager::dropHistoricalPartitionsBefore(QSqlDatabase db, qint64 cutoffSecs) {
+    // Rollups are kept; they are what long trend queries read
+    const QStringList expired = historicalPartitionsBefore(db, cutoffSecs);
+    return dropHistoricalPartitions(db, expired) ? expired.size() : -1;
+}
+
+const QStringList& DatabaseManager::rollupMetrics() {
+    static const QStringList metrics = {
+        "temperature", "precip_probability", "precip_intensity", "wind_speed",
+        "humidity", "pressure", "cloud_cover"
+    };
+    return metrics;
+}
+
+bool DatabaseManager::refreshHistoricalRollups(QSqlDatabase db, const QString& partition,
+                                               qint64 fromSecs, qint64 toSecs, QString& errorText,
+                                               qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                               const QString& source) {
+    QStringList columns = {"lat_udeg", "lon_udeg", "ts", "source", "sample_count"};
+    QStringList hourly;
+    QStringList daily;
+    for (const QString& metric : rollupMetrics()) {
+        columns << metric + "_min" << metric + "_max" << metric + "_sum";
+        hourly.append(QString("MIN(%1), MAX(%1), SUM(%1)").arg(metric));
+        daily.append(QString("MIN(%1_min), MAX(%1_max), SUM(%1_sum)").arg(metric));
+    }
+    
+    // One series is a primary key prefix on both the partition and the rollups
+    const bool oneSeries = !source.isEmpty();
+    const QString seriesFilter = oneSeries ? " AND lat_udeg = ? AND lon_udeg = ? AND source = ?" : QString();
+    
+    auto bindRange = [&](QSqlQuery& query, qint64 from, qint64 to) {
+        query.addBindValue(from);
+        query.addBindValue(to);
+        if (oneSeries) {
+            query.addBindValue(latMicroDegrees);
+            query.addBindValue(lonMicroDegrees);
+            query.addBindValue(source);
+        }
+    };
+    
+    PreparedQuery hourlyQuery(db, QString(R"(
+        INSERT OR REPLACE INTO historical_rollup_hourly (%1)
+        SELECT lat_udeg, lon_udeg, ts / 3600 * 3600, source, COUNT(*), %2
+        FROM %3
+        WHERE ts >= ? AND ts < ?%4
+        GROUP BY lat_udeg, lon_udeg, ts / 3600, source
+    )").arg(columns.join(", "), hourly.join(", "), partition, seriesFilter));
+    bindRange(*hourlyQuery, fromSecs / SecondsPerHour * SecondsPerHour,
+              (toSecs / SecondsPerHour + 1) * SecondsPerHour);
+    if (!hourlyQuery->exec()) {
+        errorText = hourlyQuery->lastError().text();
+        return false;
+    }
+    
+    PreparedQuery dailyQuery(db, QString(R"(
+        INSERT OR REPLACE INTO historical_rollup_daily (%1)
+        SELECT lat_udeg, lon_udeg, ts / 86400 * 86400, source, SUM(sample_count), %2
+        FROM historical_rollup_hourly
+        WHERE ts >= ? AND ts < ?%3
+        GROUP BY lat_udeg, lon_udeg, ts / 86400, source
+    )").arg(columns.join(", "), daily.join(", "), seriesFilter));
+    bindRange(*dailyQuery, fromSecs / SecondsPerDay * SecondsPerDay,
+              (toSecs / SecondsPerDay + 1) * SecondsPerDay);
+    if (!dailyQuery->exec()) {
+        errorText = dailyQuery->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 DatabaseManager::locationId(qint64 latMicroDegrees, qint64 lonMicroDegrees) {
+    return static_cast<qint64>((static_cast<quint64>(latMicroDegrees) << 32)
+                               | (static_cast<quint64>(lonMicroDegrees) & 0xFFFFFFFFu));
+}
+
+bool DatabaseManager::applyTuning(QSqlDatabase db, const TuningProfile& profile) {
+    QSqlQuery query(db);
+    const QStringList pragmas = {
+        QString("PRAGMA journal_mode = %1").arg(profile.journalMode),
+        QString("PRAGMA synchronous = %1").arg(profile.synchronous),
+        QString("PRAGMA mmap_size = %1").arg(profile.mmapSize),
+        // Negative cache_size is in KiB rather than pages
+        QString("PRAGMA cache_size = %1").arg(-qAbs(profile.cacheSizeKb)),
+        QString("PRAGMA temp_store = %1").arg(profile.tempStoreMemory ? "MEMORY" : "DEFAULT")
+    };
+    
+    bool ok = true;
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Failed to apply" << pragma << ":" << query.lastError().text();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void DatabaseManager::runMaintenance() {
+    if (!m_database.isOpen()) {
+        return;
+    }
+    
+    QSqlQuery query(database());
+    if (m_tuningProfile.journalMode.compare("WAL", Qt::CaseInsensitive) == 0
+        && !query.exec("PRAGMA wal_checkpoint(PASSIVE)")) {
+        qWarning() << "WAL checkpoint failed:" << query.lastError().text();
+    }
+    if (!query.exec("PRAGMA optimize")) {
+        qWarning() << "PRAGMA optimize failed:" << query.lastError().text();
+    }
+}
+
+bool DatabaseManager::createTables(QSqlDatabase db) {
+    QSqlQuery query(db);
     
     // Locations table
     QString createLocations = R"(
@@ -132,8 +699,9 @@ bool DatabaseManager::createTables() {
     QString createCache = R"(
         CREATE TABLE IF NOT EXISTS forecast_cache (
             cache_key TEXT PRIMARY KEY,
-            data TEXT NOT NULL,
-            expires_at DATETIME NOT NULL
+            data BLOB NOT NULL,
+            expires_at DATETIME NOT NULL,
+            stale_at DATETIME
         )
     )";
     
@@ -142,15 +710,144 @@ bool DatabaseManager::createTables() {
         return false;
     }
     
-    // Historical weather table for time-series data
-    QString createHistoricalWeather = R"(
-        CREATE TABLE IF NOT EXISTS historical_weather (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            latitude REAL NOT NULL,
-            longitude REAL NOT NULL,
-            timestamp DATETIME NOT NULL,
+    // Validators and parsed payloads for conditional GETs, kept across restarts
+    if (!query.exec(R"(
+        CREATE TABLE IF NOT EXISTS http_validators (
+            cache_key TEXT PRIMARY KEY,
+            etag BLOB,
+            last_modified BLOB,
+            payload BLOB NOT NULL,
+            updated_at INTEGER DEFAULT (strftime('%s', 'now'))
+        )
+    )")) {
+        qCritical() << "Failed to create http_validators table:" << query.lastError().text();
+        return false;
+    }
+    
+    // NWS /points resolutions keyed by GridpointIndex cell
+    if (!query.exec(R"(
+        CREATE TABLE IF NOT EXISTS nws_gridpoints (
+            cell_row INTEGER NOT NULL,
+            cell_col INTEGER NOT NULL,
+            office TEXT NOT NULL,
+            grid_x INTEGER NOT NULL,
+            grid_y INTEGER NOT NULL,
+            resolved_at INTEGER NOT NULL,
+            PRIMARY KEY (cell_row, cell_col)
+        ) WITHOUT ROWID
+    )")) {
+        qCritical() << "Failed to create nws_gridpoints table:" << query.lastError().text();
+        return false;
+    }
+    
+    // Cache tables created before soft expiry was tracked lack stale_at
+    if (!db.record("forecast_cache").contains("stale_at")
+        && !query.exec("ALTER TABLE forecast_cache ADD COLUMN stale_at DATETIME")) {
+        qCritical() << "Failed to add stale_at to cache table:" << query.lastError().text();
+        return false;
+    }
+    
+    // Historical weather (schema v3): one v2-layout table per UTC day behind a
+    // historical_weather view, so retention drops whole tables. Older layouts
+    // are first brought to a single v2 table, then partitioned.
+    const bool hasLegacyHistorical = db.record("historical_weather").contains("timestamp");
+    if (hasLegacyHistorical
+        && (!db.transaction() || !query.exec("ALTER TABLE historical_weather RENAME TO historical_weather_legacy"))) {
+        qCritical() << "Failed to stage historical_weather migration:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    
+    if (hasLegacyHistorical) {
+        if (!createHistoricalTable(query, "historical_weather")
+            || !migrateLegacyHistorical(db)
+            || !query.exec("DROP TABLE historical_weather_legacy")
+            || !db.commit()) {
+            qCritical() << "Failed to migrate historical_weather:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    query.exec("SELECT type FROM sqlite_master WHERE name = 'historical_weather'");
+    const QString historicalType = query.next() ? query.value(0).toString() : QString();
+    if (historicalType == "table") {
+        if (!partitionHistorical(db)) {
+            return false;
+        }
+    } else if (historicalType.isEmpty()) {
+        QString errorText;
+        if (!rebuildHistoricalView(db, errorText)) {
+            qCritical() << "Failed to create historical_weather view:" << errorText;
+            return false;
+        }
+    }
+    
+    // Spatial index over the distinct historical locations, one point per
+    // location, for nearest-neighbor lookups. Falls back to an ordinary table
+    // with the same columns when SQLite was built without the R*Tree module.
+    if (!db.tables().contains("historical_locations")) {
+        if (!query.exec(R"(
+            CREATE VIRTUAL TABLE historical_locations
+            USING rtree_i32(id, min_lat, max_lat, min_lon, max_lon)
+        )")) {
+            qWarning() << "SQLite R*Tree module unavailable, using a B-tree location index:"
+                       << query.lastError().text();
+            if (!query.exec(R"(
+                CREATE TABLE historical_locations (
+                    id INTEGER PRIMARY KEY,
+                    min_lat INTEGER NOT NULL,
+                    max_lat INTEGER NOT NULL,
+                    min_lon INTEGER NOT NULL,
+                    max_lon INTEGER NOT NULL
+                )
+            )")) {
+                qCritical() << "Failed to create historical_locations table:" << query.lastError().text();
+                return false;
+            }
+            query.exec("CREATE INDEX IF NOT EXISTS idx_historical_locations_lat "
+                       "ON historical_locations(min_lat, min_lon)");
+        }
+        
+        // Index locations already present in historical_weather
+        if (!query.exec(R"(
+            INSERT OR REPLACE INTO historical_locations (id, min_lat, max_lat, min_lon, max_lon)
+            SELECT (lat_udeg << 32) | (lon_udeg & 4294967295), lat_udeg, lat_udeg, lon_udeg, lon_udeg
+            FROM (SELECT DISTINCT lat_udeg, lon_udeg FROM historical_weather)
+        )")) {
+            qWarning() << "Failed to index historical locations:" << query.lastError().text();
+        }
+    }
+    
+    // Hourly and daily rollups, maintained at ingest and kept past raw retention
+    const bool hasRollups = db.tables().contains("historical_rollup_hourly");
+    if (!createRollupTable(query, "historical_rollup_hourly")
+        || !createRollupTable(query, "historical_rollup_daily")) {
+        return false;
+    }
+    if (!hasRollups) {
+        // Summarize history stored before rollups existed
+        for (const QString& partition : historicalPartitions(db)) {
+            qint64 startSecs = 0;
+            QString errorText;
+            if (partitionStart(partition, startSecs)
+                && !refreshHistoricalRollups(db, partition, startSecs, startSecs + SecondsPerDay - 1, errorText)) {
+                qWarning() << "Failed to build rollups for" << partition << ":" << errorText;
+            }
+        }
+    }
+    
+    // Forecast revisions: per issuance, only the samples that changed beyond
+    // tolerance since the previous issuance of the same location and source
+    if (!query.exec(R"(
+        CREATE TABLE IF NOT EXISTS forecast_revisions (
+            lat_udeg INTEGER NOT NULL,
+            lon_udeg INTEGER NOT NULL,
             source TEXT NOT NULL,
+            ts INTEGER NOT NULL,
+            issued_at INTEGER NOT NULL,
             temperature REAL,
+            feels_like REAL,
             precip_probability REAL,
             precip_intensity REAL,
             wind_speed REAL,
@@ -162,14 +859,28 @@ bool DatabaseManager::createTables() {
             uv_index INTEGER,
             weather_condition TEXT,
             weather_description TEXT,
-            data_json TEXT,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            UNIQUE(latitude, longitude, timestamp, source)
-        )
-    )";
+            PRIMARY KEY (lat_udeg, lon_udeg, source, ts, issued_at)
+        ) WITHOUT ROWID
+    )")) {
+        qCritical() << "Failed to create forecast_revisions table:" << query.lastError().text();
+        return false;
+    }
     
-    if (!query.exec(createHistoricalWeather)) {
-        qCritical() << "Failed to create historical_weather table:" << query.lastError().text();
+    // One row per issuance with the horizon it covered
+    if (!query.exec(R"(
+        CREATE TABLE IF NOT EXISTS forecast_issuances (
+            lat_udeg INTEGER NOT NULL,
+            lon_udeg INTEGER NOT NULL,
+            source TEXT NOT NULL,
+            issued_at INTEGER NOT NULL,
+            first_ts INTEGER NOT NULL,
+            last_ts INTEGER NOT NULL,
+            sample_count INTEGER NOT NULL,
+            changed_count INTEGER NOT NULL,
+            PRIMARY KEY (lat_udeg, lon_udeg, source, issued_at)
+        ) WITHOUT ROWID
+    )")) {
+        qCritical() << "Failed to create forecast_issuances table:" << query.lastError().text();
         return false;
     }
     
@@ -177,46 +888,43 @@ bool DatabaseManager::createTables() {
     query.exec("CREATE INDEX IF NOT EXISTS idx_alerts_location ON alerts(location_id)");
     query.exec("CREATE INDEX IF NOT EXISTS idx_alerts_enabled ON alerts(enabled)");
     query.exec("CREATE INDEX IF NOT EXISTS idx_cache_expires ON forecast_cache(expires_at)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_historical_location_time ON historical_weather(latitude, longitude, timestamp)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_historical_source_time ON historical_weather(source, timestamp)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_historical_timestamp ON historical_weather(timestamp)");
+    
+    query.exec(QString("PRAGMA user_version = %1").arg(SchemaVersion));
     
     return true;
 }
 
 bool DatabaseManager::saveLocation(const QString& name, double latitude, double longitude, int& locationId) {
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO locations (name, latitude, longitude) VALUES (?, ?, ?)");
-    query.addBindValue(name);
-    query.addBindValue(latitude);
-    query.addBindValue(longitude);
+    PreparedQuery query(database(), "INSERT INTO locations (name, latitude, longitude) VALUES (?, ?, ?)");
+    query->addBindValue(name);
+    query->addBindValue(latitude);
+    query->addBindValue(longitude);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to save location:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to save location:" << query->lastError().text();
         return false;
     }
     
-    locationId = query.lastInsertId().toInt();
+    locationId = query->lastInsertId().toInt();
     return true;
 }
 
 bool DatabaseManager::getLocations(QList<QVariantMap>& locations) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT id, name, latitude, longitude, created_at FROM locations ORDER BY created_at DESC");
+    PreparedQuery query(database(), "SELECT id, name, latitude, longitude, created_at FROM locations ORDER BY created_at DESC");
     
-    if (!query.exec()) {
-        qWarning() << "Failed to get locations:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to get locations:" << query->lastError().text();
         return false;
     }
     
     locations.clear();
-    while (query.next()) {
+    while (query->next()) {
         QVariantMap location;
-        location["id"] = query.value(0).toInt();
-        location["name"] = query.value(1).toString();
-        location["latitude"] = query.value(2).toDouble();
-        location["longitude"] = query.value(3).toDouble();
-        location["created_at"] = query.value(4).toString();
+        location["id"] = query->value(0).toInt();
+        location["name"] = query->value(1).toString();
+        location["latitude"] = query->value(2).toDouble();
+        location["longitude"] = query->value(3).toDouble();
+        location["created_at"] = query->value(4).toString();
         locations.append(location);
     }
     
@@ -224,12 +932,11 @@ bool DatabaseManager::getLocations(QList<QVariantMap>& locations) {
 }
 
 bool DatabaseManager::deleteLocation(int locationId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM locations WHERE id = ?");
-    query.addBindValue(locationId);
+    PreparedQuery query(database(), "DELETE FROM locations WHERE id = ?");
+    query->addBindValue(locationId);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to delete location:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to delete location:" << query->lastError().text();
         return false;
     }
     
@@ -238,45 +945,43 @@ bool DatabaseManager::deleteLocation(int locationId) {
 
 bool DatabaseManager::saveAlert(int locationId, double latitude, double longitude,
                                 const QString& alertType, double threshold, int& alertId) {
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO alerts (location_id, latitude, longitude, alert_type, threshold) VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(locationId > 0 ? locationId : QVariant());
-    query.addBindValue(latitude);
-    query.addBindValue(longitude);
-    query.addBindValue(alertType);
-    query.addBindValue(threshold);
+    PreparedQuery query(database(), "INSERT INTO alerts (location_id, latitude, longitude, alert_type, threshold) VALUES (?, ?, ?, ?, ?)");
+    query->addBindValue(locationId > 0 ? locationId : QVariant());
+    query->addBindValue(latitude);
+    query->addBindValue(longitude);
+    query->addBindValue(alertType);
+    query->addBindValue(threshold);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to save alert:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to save alert:" << query->lastError().text();
         return false;
     }
     
-    alertId = query.lastInsertId().toInt();
+    alertId = query->lastInsertId().toInt();
     return true;
 }
 
 bool DatabaseManager::getAlerts(QList<QVariantMap>& alerts) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT id, location_id, latitude, longitude, alert_type, threshold, enabled, created_at, last_triggered FROM alerts ORDER BY created_at DESC");
+    PreparedQuery query(database(), "SELECT id, location_id, latitude, longitude, alert_type, threshold, enabled, created_at, last_triggered FROM alerts ORDER BY created_at DESC");
     
-    if (!query.exec()) {
-        qWarning() << "Failed to get alerts:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to get alerts:" << query->lastError().text();
         return false;
     }
     
     alerts.clear();
-    while (query.next()) {
+    while (query->next()) {
         QVariantMap alert;
-        alert["id"] = query.value(0).toInt();
-        alert["location_id"] = query.value(1).toInt();
-        alert["latitude"] = query.value(2).toDouble();
-        alert["longitude"] = query.value(3).toDouble();
-        alert["alert_type"] = query.value(4).toString();
-        alert["threshold"] = query.value(5).toDouble();
-        alert["enabled"] = query.value(6).toInt() == 1;
-        alert["created_at"] = query.value(7).toString();
-        if (!query.value(8).isNull()) {
-            alert["last_triggered"] = query.value(8).toString();
+        alert["id"] = query->value(0).toInt();
+        alert["location_id"] = query->value(1).toInt();
+        alert["latitude"] = query->value(2).toDouble();
+        alert["longitude"] = query->value(3).toDouble();
+        alert["alert_type"] = query->value(4).toString();
+        alert["threshold"] = query->value(5).toDouble();
+        alert["enabled"] = query->value(6).toInt() == 1;
+        alert["created_at"] = query->value(7).toString();
+        if (!query->value(8).isNull()) {
+            alert["last_triggered"] = query->value(8).toString();
         }
         alerts.append(alert);
     }
@@ -285,12 +990,11 @@ bool DatabaseManager::getAlerts(QList<QVariantMap>& alerts) {
 }
 
 bool DatabaseManager::deleteAlert(int alertId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM alerts WHERE id = ?");
-    query.addBindValue(alertId);
+    PreparedQuery query(database(), "DELETE FROM alerts WHERE id = ?");
+    query->addBindValue(alertId);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to delete alert:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to delete alert:" << query->lastError().text();
         return false;
     }
     
@@ -298,13 +1002,12 @@ bool DatabaseManager::deleteAlert(int alertId) {
 }
 
 bool DatabaseManager::updateAlertEnabled(int alertId, bool enabled) {
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE alerts SET enabled = ? WHERE id = ?");
-    query.addBindValue(enabled ? 1 : 0);
-    query.addBindValue(alertId);
+    PreparedQuery query(database(), "UPDATE alerts SET enabled = ? WHERE id = ?");
+    query->addBindValue(enabled ? 1 : 0);
+    query->addBindValue(alertId);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to update alert:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to update alert:" << query->lastError().text();
         return false;
     }
     
@@ -312,13 +1015,12 @@ bool DatabaseManager::updateAlertEnabled(int alertId, bool enabled) {
 }
 
 bool DatabaseManager::updateAlertLastTriggered(int alertId, const QDateTime& triggered) {
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE alerts SET last_triggered = ? WHERE id = ?");
-    query.addBindValue(triggered.toString(Qt::ISODate));
-    query.addBindValue(alertId);
+    PreparedQuery query(database(), "UPDATE alerts SET last_triggered = ? WHERE id = ?");
+    query->addBindValue(triggered.toString(Qt::ISODate));
+    query->addBindValue(alertId);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to update alert last triggered:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to update alert last triggered:" << query->lastError().text();
         return false;
     }
     
@@ -326,13 +1028,12 @@ bool DatabaseManager::updateAlertLastTriggered(int alertId, const QDateTime& tri
 }
 
 bool DatabaseManager::setPreference(const QString& key, const QString& value) {
-    QSqlQuery query(m_database);
-    query.prepare("INSERT OR REPLACE INTO user_preferences (key, value) VALUES (?, ?)");
-    query.addBindValue(key);
-    query.addBindValue(value);
+    PreparedQuery query(database(), "INSERT OR REPLACE INTO user_preferences (key, value) VALUES (?, ?)");
+    query->addBindValue(key);
+    query->addBindValue(value);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to set preference:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to set preference:" << query->lastError().text();
         return false;
     }
     
@@ -340,61 +1041,119 @@ bool DatabaseManager::setPreference(const QString& key, const QString& value) {
 }
 
 QString DatabaseManager::getPreference(const QString& key, const QString& defaultValue) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT value FROM user_preferences WHERE key = ?");
-    query.addBindValue(key);
+    PreparedQuery query(database(), "SELECT value FROM user_preferences WHERE key = ?");
+    query->addBindValue(key);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to get preference:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to get preference:" << query->lastError().text();
         return defaultValue;
     }
     
-    if (query.next()) {
-        return query.value(0).toString();
+    if (query->next()) {
+        return query->value(0).toString();
     }
     
     return defaultValue;
 }
 
-bool DatabaseManager::saveCacheEntry(const QString& key, const QString& data, const QDateTime& expiresAt) {
-    QSqlQuery query(m_database);
-    query.prepare("INSERT OR REPLACE INTO forecast_cache (cache_key, data, expires_at) VALUES (?, ?, ?)");
-    query.addBindValue(key);
-    query.addBindValue(data);
-    query.addBindValue(expiresAt.toString(Qt::ISODate));
+bool DatabaseManager::saveCacheEntry(const QString& key, const QByteArray& data, const QDateTime& expiresAt) {
+    PreparedQuery query(database(), "INSERT OR REPLACE INTO forecast_cache (cache_key, data, expires_at) VALUES (?, ?, ?)");
+    query->addBindValue(key);
+    query->addBindValue(data);
+    query->addBindValue(toCacheTime(expiresAt));
     
-    if (!query.exec()) {
-        qWarning() << "Failed to save cache entry:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to save cache entry:" << query->lastError().text();
         return false;
     }
     
     return true;
 }
 
-QString DatabaseManager::getCacheEntry(const QString& key) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT data FROM forecast_cache WHERE cache_key = ? AND expires_at > datetime('now')");
-    query.addBindValue(key);
+QByteArray DatabaseManager::getCacheEntry(const QString& key) {
+    PreparedQuery query(database(), "SELECT data FROM forecast_cache WHERE cache_key = ? AND expires_at > datetime('now')");
+    query->addBindValue(key);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to get cache entry:" << query.lastError().text();
-        return QString();
+    if (!query->exec()) {
+        qWarning() << "Failed to get cache entry:" << query->lastError().text();
+        return QByteArray();
     }
     
-    if (query.next()) {
-        return query.value(0).toString();
+    if (query->next()) {
+        return query->value(0).toByteArray();
+    }
+    
+    return QByteArray();
+}
+
+bool DatabaseManager::getCacheEntry(const QString& key, QByteArray& data, QDateTime& staleAt, QDateTime& expiresAt) {
+    PreparedQuery query(database(), "SELECT data, expires_at, stale_at FROM forecast_cache WHERE cache_key = ? AND expires_at > datetime('now')");
+    query->addBindValue(key);
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to get cache entry:" << query->lastError().text();
+        return false;
+    }
+    
+    if (!query->next()) {
+        return false;
     }
     
-    return QString();
+    data = query->value(0).toByteArray();
+    expiresAt = fromCacheTime(query->value(1).toString());
+    staleAt = query->value(2).isNull() ? expiresAt : fromCacheTime(query->value(2).toString());
+    return expiresAt.isValid();
+}
+
+bool DatabaseManager::applyCacheBatch(const QList<CacheRow>& writes, const QStringList& deletes) {
+    if (writes.isEmpty() && deletes.isEmpty()) {
+        return true;
+    }
+    
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        qWarning() << "Failed to begin cache batch:" << db.lastError().text();
+        return false;
+    }
+    
+    PreparedQuery insert(db, "INSERT OR REPLACE INTO forecast_cache (cache_key, data, expires_at, stale_at) VALUES (?, ?, ?, ?)");
+    for (const CacheRow& row : writes) {
+        insert->bindValue(0, row.key);
+        insert->bindValue(1, row.data);
+        insert->bindValue(2, toCacheTime(row.expiresAt));
+        insert->bindValue(3, toCacheTime(row.staleAt.isValid() ? row.staleAt : row.expiresAt));
+        if (!insert->exec()) {
+            qWarning() << "Failed to save cache entry:" << insert->lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    PreparedQuery remove(db, "DELETE FROM forecast_cache WHERE cache_key = ?");
+    for (const QString& key : deletes) {
+        remove->bindValue(0, key);
+        if (!remove->exec()) {
+            qWarning() << "Failed to delete cache entry:" << remove->lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    if (!db.commit()) {
+        qWarning() << "Failed to commit cache batch:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    
+    return true;
 }
 
 bool DatabaseManager::deleteCacheEntry(const QString& key) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM forecast_cache WHERE cache_key = ?");
-    query.addBindValue(key);
+    PreparedQuery query(database(), "DELETE FROM forecast_cache WHERE cache_key = ?");
+    query->addBindValue(key);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to delete cache entry:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to delete cache entry:" << query->lastError().text();
         return false;
     }
     
@@ -402,11 +1161,108 @@ bool DatabaseManager::deleteCacheEntry(const QString& key) {
 }
 
 void DatabaseManager::cleanupExpiredCache() {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM forecast_cache WHERE expires_at < datetime('now')");
+    PreparedQuery query(database(), "DELETE FROM forecast_cache WHERE expires_at < datetime('now')");
     
-    if (!query.exec()) {
-        qWarning() << "Failed to cleanup expired cache:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Failed to cleanup expired cache:" << query->lastError().text();
     }
+    
+    PreparedQuery validators(database(), "DELETE FROM http_validators WHERE updated_at < ?");
+    validators->addBindValue(QDateTime::currentSecsSinceEpoch() - HttpValidatorRetentionDays * 24 * 3600);
+    if (!validators->exec()) {
+        qWarning() << "Failed to cleanup HTTP validators:" << validators->lastError().text();
+    }
+    
+    PreparedQuery gridpoints(database(), "DELETE FROM nws_gridpoints WHERE resolved_at < ?");
+    gridpoints->addBindValue(QDateTime::currentSecsSinceEpoch() - NwsGridpointRetentionDays * 24 * 3600);
+    if (!gridpoints->exec()) {
+        qWarning() << "Failed to cleanup NWS gridpoints:" << gridpoints->lastError().text();
+    }
+}
+
+bool DatabaseManager::saveHttpValidator(const HttpValidator& validator) {
+    PreparedQuery query(database(), R"(
+        INSERT OR REPLACE INTO http_validators (cache_key, etag, last_modified, payload, updated_at)
+        VALUES (?, ?, ?, ?, ?)
+    )");
+    query->addBindValue(validator.key);
+    query->addBindValue(validator.etag);
+    query->addBindValue(validator.lastModified);
+    query->addBindValue(validator.payload);
+    query->addBindValue(QDateTime::currentSecsSinceEpoch());
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to save HTTP validator:" << query->lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::getHttpValidator(const QString& key, HttpValidator& validator) {
+    PreparedQuery query(database(), "SELECT etag, last_modified, payload FROM http_validators WHERE cache_key = ?");
+    query->addBindValue(key);
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to get HTTP validator:" << query->lastError().text();
+        return false;
+    }
+    
+    if (!query->next()) {
+        return false;
+    }
+    
+    validator.key = key;
+    validator.etag = query->value(0).toByteArray();
+    validator.lastModified = query->value(1).toByteArray();
+    validator.payload = query->value(2).toByteArray();
+    return true;
+}
+
+bool DatabaseManager::saveNwsGridpoint(const NwsGridpoint& gridpoint) {
+    PreparedQuery query(database(), R"(
+        INSERT OR REPLACE INTO nws_gridpoints (cell_row, cell_col, office, grid_x, grid_y, resolved_at)
+        VALUES (?, ?, ?, ?, ?, ?)
+    )");
+    query->addBindValue(gridpoint.cellRow);
+    query->addBindValue(gridpoint.cellCol);
+    query->addBindValue(gridpoint.office);
+    query->addBindValue(gridpoint.x);
+    query->addBindValue(gridpoint.y);
+    query->addBindValue(gridpoint.resolvedAt > 0 ? gridpoint.resolvedAt : QDateTime::currentSecsSinceEpoch());
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to save NWS gridpoint:" << query->lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::getNwsGridpoint(int cellRow, int cellCol, NwsGridpoint& gridpoint) {
+    PreparedQuery query(database(), R"(
+        SELECT office, grid_x, grid_y, resolved_at FROM nws_gridpoints
+        WHERE cell_row = ? AND cell_col = ? AND resolved_at >= ?
+    )");
+    query->addBindValue(cellRow);
+    query->addBindValue(cellCol);
+    query->addBindValue(QDateTime::currentSecsSinceEpoch() - NwsGridpointRetentionDays * 24 * 3600);
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to get NWS gridpoint:" << query->lastError().text();
+        return false;
+    }
+    
+    if (!query->next()) {
+        return false;
+    }
+    
+    gridpoint.cellRow = cellRow;
+    gridpoint.cellCol = cellCol;
+    gridpoint.office = query->value(0).toString();
+    gridpoint.x = query->value(1).toInt();
+    gridpoint.y = query->value(2).toInt();
+    gridpoint.resolvedAt = query->value(3).toLongLong();
+    return true;
 }
 
@@ -6,20 +6,85 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QStringList>
 #include <QVariantMap>
 #include <QList>
+#include <limits>
+#include "database/StatementCache.h"
+
+class QTimer;
+class ConnectionPool;
 
 /**
  * @brief SQLite database manager for persistent storage
  * 
  * Manages all database operations including locations, alerts,
  * preferences, and cache storage.
+ * 
+ * After initialize() the instance methods may be called from any thread:
+ * each thread works on its own pooled connection to the same file.
  */
 class DatabaseManager : public QObject
 {
     Q_OBJECT
     
 public:
+    /**
+     * @brief One row of the persistent forecast cache
+     */
+    struct CacheRow {
+        QString key;
+        QByteArray data;
+        QDateTime expiresAt;
+        QDateTime staleAt;      // Soft expiry; invalid means same as expiresAt
+    };
+    
+    /**
+     * @brief Conditional GET validators of one request and the parsed result they validate
+     */
+    struct HttpValidator {
+        QString key;
+        QByteArray etag;
+        QByteArray lastModified;    // Raw Last-Modified header value
+        QByteArray payload;         // Service-specific encoding of the parsed response
+    };
+    
+    /**
+     * @brief NWS gridpoint resolved for one GridpointIndex cell
+     */
+    struct NwsGridpoint {
+        int cellRow = 0;
+        int cellCol = 0;
+        QString office;
+        int x = -1;
+        int y = -1;
+        qint64 resolvedAt = 0;      // Unix seconds; 0 means now when saving
+    };
+    
+    /**
+     * @brief SQLite settings applied to a connection when it is opened
+     */
+    struct TuningProfile {
+        QString journalMode = "WAL";
+        QString synchronous = "NORMAL";
+        qint64 mmapSize = 256LL * 1024 * 1024;
+        int cacheSizeKb = 16 * 1024;
+        bool tempStoreMemory = true;
+        int maintenanceIntervalMs = 5 * 60 * 1000;  // wal_checkpoint + optimize; 0 disables
+        
+        /**
+         * @brief SQLite's own defaults (rollback journal, synchronous=FULL)
+         */
+        static TuningProfile sqliteDefaults();
+        
+        /**
+         * @brief WAL with relaxed fsync, memory-mapped reads and a larger page cache
+         */
+        static TuningProfile performance();
+    };
+    
     static DatabaseManager* instance();
     
     /**
@@ -49,14 +114,157 @@ public:
     bool setPreference(const QString& key, const QString& value);
     QString getPreference(const QString& key, const QString& defaultValue = QString());
     
-    // Cache (persistent cache across sessions)
-    bool saveCacheEntry(const QString& key, const QString& data, const QDateTime& expiresAt);
-    QString getCacheEntry(const QString& key);
+    // Cache (persistent cache across sessions, values are ForecastCodec blobs)
+    bool saveCacheEntry(const QString& key, const QByteArray& data, const QDateTime& expiresAt);
+    QByteArray getCacheEntry(const QString& key);
+    bool getCacheEntry(const QString& key, QByteArray& data, QDateTime& staleAt, QDateTime& expiresAt);
     bool deleteCacheEntry(const QString& key);
+    
+    /**
+     * @brief Write and delete cache rows in a single transaction
+     */
+    bool applyCacheBatch(const QList<CacheRow>& writes, const QStringList& deletes);
     void cleanupExpiredCache();
     
-    // Get database connection for use by other managers
-    QSqlDatabase database() const { return m_database; }
+    // HTTP revalidation (validators unused for HttpValidatorRetentionDays are dropped)
+    bool saveHttpValidator(const HttpValidator& validator);
+    bool getHttpValidator(const QString& key, HttpValidator& validator);
+    
+    // NWS gridpoint resolutions (entries older than NwsGridpointRetentionDays are ignored and dropped)
+    bool saveNwsGridpoint(const NwsGridpoint& gridpoint);
+    bool getNwsGridpoint(int cellRow, int cellCol, NwsGridpoint& gridpoint);
+    
+    /**
+     * @brief Connection for the calling thread
+     * 
+     * The thread that initialized the manager gets the main connection;
+     * other threads get their own pooled connection, closed automatically
+     * when the thread finishes.
+     */
+    QSqlDatabase database() const;
+    
+    /**
+     * @brief Per-thread connections used by other threads, or nullptr before initialize()
+     */
+    ConnectionPool* connectionPool() const { return m_pool; }
+    
+    /**
+     * @brief Run one statement on the calling thread's connection
+     * 
+     * Safe to call from any thread.
+     * @param sql Statement with positional placeholders
+     * @param bindValues Values for the placeholders
+     * @param rows Receives the result rows, one list of column values each (optional)
+     * @param errorText Receives the error on failure (optional)
+     * @return false if the statement failed
+     */
+    bool execute(const QString& sql, const QVariantList& bindValues = QVariantList(),
+                 QList<QVariantList>* rows = nullptr, QString* errorText = nullptr) const;
+    
+    /**
+     * @brief Prepared statement reuse across all connections
+     */
+    StatementCache::Stats statementCacheStats() const { return StatementCache::totals(); }
+    
+    /**
+     * @brief Set the tuning profile (applied immediately if already open)
+     */
+    void setTuningProfile(const TuningProfile& profile);
+    TuningProfile tuningProfile() const { return m_tuningProfile; }
+    
+    /**
+     * @brief Apply profile's pragmas to an open connection
+     */
+    static bool applyTuning(QSqlDatabase db, const TuningProfile& profile);
+    
+    /**
+     * @brief Create any missing tables and indexes on db
+     * 
+     * Migrates a historical_weather table in the pre-v2 layout (REAL
+     * coordinates, ISO-8601 text timestamps) or an unpartitioned v2 table
+     * into daily partitions in place.
+     */
+    static bool createTables(QSqlDatabase db);
+    
+    /**
+     * @brief Name of the daily historical partition (historical_weather_YYYYMMDD,
+     * UTC day) that holds epoch second epochSeconds
+     */
+    static QString historicalPartition(qint64 epochSeconds);
+    
+    /**
+     * @brief Existing historical partitions covering [fromSecs, toSecs], oldest first
+     */
+    static QStringList historicalPartitions(QSqlDatabase db,
+                                            qint64 fromSecs = std::numeric_limits<qint64>::min(),
+                                            qint64 toSecs = std::numeric_limits<qint64>::max());
+    
+    /**
+     * @brief Create a historical partition if missing and add it to the
+     * historical_weather view
+     * 
+     * Runs in the caller's transaction, if any.
+     */
+    static bool ensureHistoricalPartition(QSqlDatabase db, const QString& partition, QString& errorText);
+    
+    /**
+     * @brief Historical partitions whose whole day ends at or before cutoffSecs, oldest first
+     */
+    static QStringList historicalPartitionsBefore(QSqlDatabase db, qint64 cutoffSecs);
+    
+    /**
+     * @brief Drop the given historical partitions and rebuild the view in one transaction
+     * 
+     * Forecast revisions of the dropped days are deleted with them.
+     * @return false on error, in which case nothing is dropped
+     */
+    static bool dropHistoricalPartitions(QSqlDatabase db, const QStringList& partitions);
+    
+    /**
+     * @brief Drop every historical partition whose whole day ends at or before cutoffSecs
+     * @return Number of partitions dropped, or -1 on error
+     */
+    static int dropHistoricalPartitionsBefore(QSqlDatabase db, qint64 cutoffSecs);
+    
+    /**
+     * @brief Parameters summarized by the hourly and daily rollup tables
+     * 
+     * Each contributes <name>_min, <name>_max and <name>_sum columns, in
+     * this order, after the sample_count column.
+     */
+    static const QStringList& rollupMetrics();
+    
+    /**
+     * @brief Recompute historical_rollup_hourly and historical_rollup_daily
+     * from one partition's raw rows
+     * 
+     * Hours overlapping [fromSecs, toSecs] are rebuilt from raw rows, then
+     * their days from the hourly rollups, so re-ingesting a sample never
+     * counts it twice. Limited to one location and source unless source is
+     * empty.
+     */
+    static bool refreshHistoricalRollups(QSqlDatabase db, const QString& partition,
+                                         qint64 fromSecs, qint64 toSecs, QString& errorText,
+                                         qint64 latMicroDegrees = 0, qint64 lonMicroDegrees = 0,
+                                         const QString& source = QString());
+    
+    /**
+     * @brief historical_weather location key: the coordinate snapped to the
+     * 0.0001 degree (~11 m) grid, in integer micro-degrees
+     */
+    static qint64 toMicroDegrees(double degrees);
+    static double fromMicroDegrees(qint64 microDegrees);
+    
+    /**
+     * @brief historical_locations row id for a snapped location (latitude in
+     * the high 32 bits, longitude in the low 32 bits)
+     */
+    static qint64 locationId(qint64 latMicroDegrees, qint64 lonMicroDegrees);
+    
+    /**
+     * @brief Checkpoint the WAL and refresh query planner statistics
+     */
+    void runMaintenance();
     
 private:
     explicit DatabaseManager(QObject *parent = nullptr);
@@ -64,12 +272,15 @@ private:
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
     
-    bool createTables();
     QString getDatabasePath() const;
     
     static DatabaseManager* s_instance;
     QSqlDatabase m_database;
+    StatementCache* m_statements;   // Prepared statements of m_database
+    ConnectionPool* m_pool;
     bool m_initialized;
+    TuningProfile m_tuningProfile;
+    QTimer* m_maintenanceTimer;
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,160 @@
+#include "database/StatementCache.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace {
+// Connection name -> its cache
+QMutex registryMutex;
+QHash<QString, StatementCache*> registry;
+
+QAtomicInteger<qint64> totalHits;
+QAtomicInteger<qint64> totalMisses;
+QAtomicInteger<qint64> totalEvictions;
+QAtomicInteger<int> totalCached;
+} // namespace
+
+StatementCache::StatementCache(const QSqlDatabase& db, int capacity)
+    : m_database(db)
+    , m_connectionName(db.connectionName())
+    , m_capacity(qMax(1, capacity))
+    , m_useCounter(0)
+{
+    QMutexLocker locker(&registryMutex);
+    if (registry.contains(m_connectionName)) {
+        qWarning() << "Replacing statement cache for connection" << m_connectionName;
+    }
+    registry.insert(m_connectionName, this);
+}
+
+StatementCache::~StatementCache() {
+    {
+        QMutexLocker locker(&registryMutex);
+        if (registry.value(m_connectionName) == this) {
+            registry.remove(m_connectionName);
+        }
+    }
+    clear();
+    totalCached.fetchAndSubOrdered(m_cached.loadAcquire());
+}
+
+StatementCache* StatementCache::forConnection(const QSqlDatabase& db) {
+    QMutexLocker locker(&registryMutex);
+    return registry.value(db.connectionName(), nullptr);
+}
+
+void StatementCache::clear() {
+    // Statements handed out stay alive until their PreparedQuery releases them
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->inUse) {
+            ++it;
+            continue;
+        }
+        it = m_entries.erase(it);
+        m_cached.fetchAndSubOrdered(1);
+        totalCached.fetchAndSubOrdered(1);
+    }
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    Stats stats;
+    stats.hits = m_hits.loadAcquire();
+    stats.misses = m_misses.loadAcquire();
+    stats.evictions = m_evictions.loadAcquire();
+    stats.cached = m_cached.loadAcquire();
+    return stats;
+}
+
+StatementCache::Stats StatementCache::totals() {
+    Stats stats;
+    stats.hits = totalHits.loadAcquire();
+    stats.misses = totalMisses.loadAcquire();
+    stats.evictions = totalEvictions.loadAcquire();
+    stats.cached = totalCached.loadAcquire();
+    return stats;
+}
+
+QSqlQuery* StatementCache::acquire(const QString& sql) {
+    auto it = m_entries.find(sql);
+    if (it != m_entries.end()) {
+        if (it->inUse) {
+            return nullptr;     // Nested use of the same statement
+        }
+        it->inUse = true;
+        it->lastUse = ++m_useCounter;
+        m_active.insert(it->query.get(), sql);
+        m_hits.fetchAndAddOrdered(1);
+        totalHits.fetchAndAddOrdered(1);
+        return it->query.get();
+    }
+
+    std::unique_ptr<QSqlQuery> query(new QSqlQuery(m_database));
+    m_misses.fetchAndAddOrdered(1);
+    totalMisses.fetchAndAddOrdered(1);
+    if (!query->prepare(sql)) {
+        return nullptr;         // The caller prepares its own copy and sees the error
+    }
+
+    if (m_entries.size() >= m_capacity) {
+        evict();
+    }
+    Entry& entry = m_entries[sql];
+    entry.query = std::move(query);
+    entry.inUse = true;
+    entry.lastUse = ++m_useCounter;
+    m_active.insert(entry.query.get(), sql);
+    m_cached.fetchAndAddOrdered(1);
+    totalCached.fetchAndAddOrdered(1);
+    return entry.query.get();
+}
+
+void StatementCache::release(QSqlQuery* query) {
+    const QString sql = m_active.take(query);
+    auto it = m_entries.find(sql);
+    if (it == m_entries.end() || it->query.get() != query) {
+        return;
+    }
+
+    // Reset so the statement holds no read lock between uses
+    query->finish();
+    it->inUse = false;
+}
+
+void StatementCache::evict() {
+    auto oldest = m_entries.end();
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (!it->inUse && (oldest == m_entries.end() || it->lastUse < oldest->lastUse)) {
+            oldest = it;
+        }
+    }
+    if (oldest == m_entries.end()) {
+        return;                 // Everything is in use; grow past capacity for now
+    }
+
+    m_entries.erase(oldest);
+    m_cached.fetchAndSubOrdered(1);
+    totalCached.fetchAndSubOrdered(1);
+    m_evictions.fetchAndAddOrdered(1);
+    totalEvictions.fetchAndAddOrdered(1);
+}
+
+PreparedQuery::PreparedQuery(const QSqlDatabase& db, const QString& sql)
+    : m_cache(StatementCache::forConnection(db))
+    , m_query(nullptr)
+{
+    if (m_cache) {
+        m_query = m_cache->acquire(sql);
+    }
+    if (!m_query) {
+        m_cache = nullptr;
+        m_owned.reset(new QSqlQuery(db));
+        m_owned->prepare(sql);
+        m_query = m_owned.get();
+    }
+}
+
+PreparedQuery::~PreparedQuery() {
+    if (m_cache) {
+        m_cache->release(m_query);
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QString>
+#include <QAtomicInteger>
+#include <memory>
+
+/**
+ * @brief Prepared statements of one connection, keyed by SQL text
+ *
+ * The connection's owner creates the cache after opening the connection and
+ * destroys it before closing it; while it exists, PreparedQuery on that
+ * connection reuses statements instead of preparing them again. Least
+ * recently used statements are finalized once the cache is full.
+ *
+ * A cache belongs to its connection's thread; only stats() and totals()
+ * may be called from other threads.
+ */
+class StatementCache
+{
+public:
+    /**
+     * @brief Prepare hit and miss counters
+     */
+    struct Stats {
+        qint64 hits = 0;        // Statement reused
+        qint64 misses = 0;      // Statement prepared
+        qint64 evictions = 0;   // Finalized to make room
+        int cached = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param db Open connection whose statements are cached
+     * @param capacity Maximum number of cached statements
+     */
+    explicit StatementCache(const QSqlDatabase& db, int capacity = 64);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief The cache registered for a connection, or nullptr
+     */
+    static StatementCache* forConnection(const QSqlDatabase& db);
+
+    /**
+     * @brief Finalize every cached statement
+     */
+    void clear();
+
+    Stats stats() const;
+    int capacity() const { return m_capacity; }
+
+    /**
+     * @brief Counters summed over every cache in the process
+     */
+    static Stats totals();
+
+private:
+    friend class PreparedQuery;
+
+    struct Entry {
+        std::unique_ptr<QSqlQuery> query;
+        quint64 lastUse = 0;
+        bool inUse = false;
+    };
+
+    QSqlQuery* acquire(const QString& sql);
+    void release(QSqlQuery* query);
+    void evict();
+
+    QSqlDatabase m_database;
+    QString m_connectionName;
+    int m_capacity;
+    quint64 m_useCounter;
+    QHash<QString, Entry> m_entries;
+    QHash<QSqlQuery*, QString> m_active;    // Handed out, keyed back to their SQL
+
+    QAtomicInteger<qint64> m_hits;
+    QAtomicInteger<qint64> m_misses;
+    QAtomicInteger<qint64> m_evictions;
+    QAtomicInteger<int> m_cached;
+};
+
+/**
+ * @brief A prepared statement for one use, taken from the connection's cache
+ *
+ * Bind values, exec() and read results through the wrapped QSqlQuery as
+ * usual. On destruction a cached statement is reset and returned to the
+ * cache. Without a cache for the connection, or when the same SQL is already
+ * in use further up the stack, the statement is prepared just for this use.
+ */
+class PreparedQuery
+{
+public:
+    PreparedQuery(const QSqlDatabase& db, const QString& sql);
+    ~PreparedQuery();
+
+    PreparedQuery(const PreparedQuery&) = delete;
+    PreparedQuery& operator=(const PreparedQuery&) = delete;
+
+    QSqlQuery& operator*() { return *m_query; }
+    QSqlQuery* operator->() { return m_query; }
+
+private:
+    StatementCache* m_cache;
+    QSqlQuery* m_query;
+    std::unique_ptr<QSqlQuery> m_owned;
+};
+
+#endif // STATEMENTCACHE_H
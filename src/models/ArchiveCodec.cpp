@@ -0,0 +1,629 @@
+#include "models/ArchiveCodec.h"
+#include <QHash>
+#include <QtAlgorithms>
+#include <QVector>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const char Magic[4] = {'H', 'L', 'W', 'A'};
+
+// Header field offsets
+constexpr int HeaderVersion = 4;
+constexpr int HeaderSeriesCount = 8;
+constexpr int HeaderSampleCount = 12;
+constexpr int HeaderSize = 16;
+
+// Block header: qint64 latitude, qint64 longitude, qint32 source id,
+// quint32 sample count, quint32 payload bytes
+constexpr int BlockLatitude = 0;
+constexpr int BlockLongitude = 8;
+constexpr int BlockSource = 16;
+constexpr int BlockSampleCount = 20;
+constexpr int BlockPayloadSize = 24;
+constexpr int BlockHeaderSize = 28;
+
+// Double columns start with a 3-bit mode: 0-4 store value * 10^mode as an
+// exact integer, XorMode stores raw IEEE bits
+constexpr int ModeBits = 3;
+constexpr int MaxDecimalScale = 4;
+constexpr quint64 XorMode = 7;
+const double DecimalFactors[MaxDecimalScale + 1] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+
+// Scaled values stay well inside the range doubles hold exactly
+constexpr double MaxScaledMagnitude = 9.0e15;
+
+template <typename T>
+void append(QByteArray& out, T value) {
+    char buffer[sizeof(T)];
+    qToLittleEndian<T>(value, buffer);
+    out.append(buffer, sizeof(T));
+}
+
+template <typename T>
+T read(const char* src) {
+    return qFromLittleEndian<T>(src);
+}
+
+quint64 toBits(double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+quint64 zigzag(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unzigzag(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+/**
+ * @brief MSB-first bit packer
+ */
+class BitWriter
+{
+public:
+    void write(quint64 value, int bits) {
+        while (bits > 0) {
+            if (m_bitPos == 0) {
+                m_bytes.append('\0');
+            }
+            const int room = 8 - m_bitPos;
+            const int take = qMin(room, bits);
+            const quint64 chunk = (value >> (bits - take)) & ((1u << take) - 1);
+            m_bytes.data()[m_bytes.size() - 1] |= static_cast<char>(chunk << (room - take));
+            bits -= take;
+            m_bitPos = (m_bitPos + take) % 8;
+        }
+    }
+
+    const QByteArray& bytes() const { return m_bytes; }
+
+private:
+    QByteArray m_bytes;
+    int m_bitPos = 0;   // Bits used in the last byte
+};
+
+/**
+ * @brief Bounds-checked reader for BitWriter output
+ */
+class BitReader
+{
+public:
+    BitReader(const char* data, int size)
+        : m_data(reinterpret_cast<const quint8*>(data)), m_size(size) {}
+
+    bool read(int bits, quint64& value) {
+        value = 0;
+        while (bits > 0) {
+            if (m_byte >= m_size) {
+                return false;
+            }
+            const int room = 8 - m_bitPos;
+            const int take = qMin(room, bits);
+            const quint64 chunk = (m_data[m_byte] >> (room - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            bits -= take;
+            m_bitPos += take;
+            if (m_bitPos == 8) {
+                m_bitPos = 0;
+                ++m_byte;
+            }
+        }
+        return true;
+    }
+
+private:
+    const quint8* m_data;
+    int m_size;
+    int m_byte = 0;
+    int m_bitPos = 0;
+};
+
+// Prefix-coded zigzag integers: zero costs one bit, small magnitudes a few
+struct Bucket {
+    quint64 prefix;
+    int prefixBits;
+    int valueBits;
+};
+const Bucket Buckets[] = {
+    {0b10, 2, 7}, {0b110, 3, 9}, {0b1110, 4, 12}, {0b11110, 5, 32}, {0b11111, 5, 64}
+};
+constexpr int BucketCount = sizeof(Buckets) / sizeof(Buckets[0]);
+
+void writeInteger(BitWriter& out, qint64 value) {
+    const quint64 encoded = zigzag(value);
+    if (encoded == 0) {
+        out.write(0, 1);
+        return;
+    }
+    for (const Bucket& bucket : Buckets) {
+        if (bucket.valueBits == 64 || encoded < (quint64(1) << bucket.valueBits)) {
+            out.write(bucket.prefix, bucket.prefixBits);
+            out.write(encoded, bucket.valueBits);
+            return;
+        }
+    }
+}
+
+bool readInteger(BitReader& in, qint64& value) {
+    quint64 bit = 0;
+    if (!in.read(1, bit)) {
+        return false;
+    }
+    if (bit == 0) {
+        value = 0;
+        return true;
+    }
+
+    // The number of leading one bits selects the bucket
+    int ones = 1;
+    while (ones < BucketCount) {
+        if (!in.read(1, bit)) {
+            return false;
+        }
+        if (bit == 0) {
+            break;
+        }
+        ++ones;
+    }
+
+    quint64 encoded = 0;
+    if (!in.read(Buckets[ones - 1].valueBits, encoded)) {
+        return false;
+    }
+    value = unzigzag(encoded);
+    return true;
+}
+
+// Delta-of-delta: a regular cadence costs one bit per timestamp
+void writeTimestamps(BitWriter& out, const QVector<qint64>& timestamps) {
+    qint64 previous = 0;
+    qint64 previousDelta = 0;
+    for (int i = 0; i < timestamps.size(); ++i) {
+        if (i == 0) {
+            writeInteger(out, timestamps.at(i));
+        } else {
+            const qint64 delta = timestamps.at(i) - previous;
+            writeInteger(out, delta - previousDelta);
+            previousDelta = delta;
+        }
+        previous = timestamps.at(i);
+    }
+}
+
+bool readTimestamps(BitReader& in, int count, QVector<qint64>& timestamps) {
+    timestamps.resize(count);
+    qint64 previous = 0;
+    qint64 delta = 0;
+    for (int i = 0; i < count; ++i) {
+        qint64 value = 0;
+        if (!readInteger(in, value)) {
+            return false;
+        }
+        if (i == 0) {
+            previous = value;
+        } else {
+            delta += value;
+            previous += delta;
+        }
+        timestamps[i] = previous;
+    }
+    return true;
+}
+
+template <typename T>
+void writeIntegers(BitWriter& out, const QVector<T>& values) {
+    qint64 previous = 0;
+    for (T value : values) {
+        writeInteger(out, static_cast<qint64>(value) - previous);
+        previous = value;
+    }
+}
+
+bool readIntegers(BitReader& in, int count, QVector<qint32>& values) {
+    values.resize(count);
+    qint64 previous = 0;
+    for (int i = 0; i < count; ++i) {
+        qint64 delta = 0;
+        if (!readInteger(in, delta)) {
+            return false;
+        }
+        previous += delta;
+        values[i] = static_cast<qint32>(previous);
+    }
+    return true;
+}
+
+// Smallest decimal scale at which every value round-trips exactly
+quint64 decimalMode(const QVector<double>& values) {
+    for (int scale = 0; scale <= MaxDecimalScale; ++scale) {
+        const double factor = DecimalFactors[scale];
+        bool exact = true;
+        for (double value : values) {
+            const double scaled = value * factor;
+            if (!std::isfinite(scaled) || std::fabs(scaled) > MaxScaledMagnitude
+                || toBits(static_cast<double>(std::llround(scaled)) / factor) != toBits(value)) {
+                exact = false;
+                break;
+            }
+        }
+        if (exact) {
+            return static_cast<quint64>(scale);
+        }
+    }
+    return XorMode;
+}
+
+// Gorilla-style XOR against the previous value, reusing the previous
+// leading/trailing zero window when the new difference fits inside it
+void writeXorDoubles(BitWriter& out, const QVector<double>& values) {
+    quint64 previous = 0;
+    int windowLeading = -1;
+    int windowTrailing = 0;
+    for (int i = 0; i < values.size(); ++i) {
+        const quint64 bits = toBits(values.at(i));
+        if (i == 0) {
+            out.write(bits, 64);
+            previous = bits;
+            continue;
+        }
+
+        const quint64 difference = bits ^ previous;
+        previous = bits;
+        if (difference == 0) {
+            out.write(0, 1);
+            continue;
+        }
+
+        const int leading = qMin(31, static_cast<int>(qCountLeadingZeroBits(difference)));
+        const int trailing = static_cast<int>(qCountTrailingZeroBits(difference));
+        if (windowLeading >= 0 && leading >= windowLeading && trailing >= windowTrailing) {
+            out.write(0b10, 2);
+            out.write(difference >> windowTrailing, 64 - windowLeading - windowTrailing);
+        } else {
+            const int significant = 64 - leading - trailing;
+            out.write(0b11, 2);
+            out.write(static_cast<quint64>(leading), 5);
+            out.write(static_cast<quint64>(significant - 1), 6);
+            out.write(difference >> trailing, significant);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+}
+
+bool readXorDoubles(BitReader& in, int count, QVector<double>& values) {
+    quint64 previous = 0;
+    int windowLeading = -1;
+    int windowTrailing = 0;
+    for (int i = 0; i < count; ++i) {
+        if (i == 0) {
+            if (!in.read(64, previous)) {
+                return false;
+            }
+            values[i] = fromBits(previous);
+            continue;
+        }
+
+        quint64 control = 0;
+        if (!in.read(1, control)) {
+            return false;
+        }
+        if (control != 0) {
+            if (!in.read(1, control)) {
+                return false;
+            }
+            if (control != 0) {
+                quint64 leading = 0;
+                quint64 significant = 0;
+                if (!in.read(5, leading) || !in.read(6, significant)) {
+                    return false;
+                }
+                windowLeading = static_cast<int>(leading);
+                windowTrailing = 64 - windowLeading - static_cast<int>(significant + 1);
+                if (windowTrailing < 0) {
+                    return false;
+                }
+            } else if (windowLeading < 0) {
+                return false;
+            }
+
+            quint64 difference = 0;
+            if (!in.read(64 - windowLeading - windowTrailing, difference)) {
+                return false;
+            }
+            previous ^= difference << windowTrailing;
+        }
+        values[i] = fromBits(previous);
+    }
+    return true;
+}
+
+void writeDoubles(BitWriter& out, const QVector<double>& values) {
+    const quint64 mode = decimalMode(values);
+    out.write(mode, ModeBits);
+    if (mode == XorMode) {
+        writeXorDoubles(out, values);
+        return;
+    }
+
+    const double factor = DecimalFactors[mode];
+    qint64 previous = 0;
+    for (double value : values) {
+        const qint64 scaled = std::llround(value * factor);
+        writeInteger(out, scaled - previous);
+        previous = scaled;
+    }
+}
+
+bool readDoubles(BitReader& in, int count, QVector<double>& values) {
+    values.resize(count);
+    quint64 mode = 0;
+    if (!in.read(ModeBits, mode)) {
+        return false;
+    }
+    if (mode == XorMode) {
+        return readXorDoubles(in, count, values);
+    }
+    if (mode > static_cast<quint64>(MaxDecimalScale)) {
+        return false;
+    }
+
+    const double factor = DecimalFactors[mode];
+    qint64 scaled = 0;
+    for (int i = 0; i < count; ++i) {
+        qint64 delta = 0;
+        if (!readInteger(in, delta)) {
+            return false;
+        }
+        scaled += delta;
+        values[i] = static_cast<double>(scaled) / factor;
+    }
+    return true;
+}
+} // namespace
+
+QByteArray ArchiveCodec::encode(const QList<Series>& series) {
+    QStringList strings;
+    QHash<QString, qint32> stringIds;
+    auto intern = [&](const QString& value) {
+        auto it = stringIds.constFind(value);
+        if (it != stringIds.constEnd()) {
+            return it.value();
+        }
+        const qint32 id = static_cast<qint32>(strings.size());
+        strings.append(value);
+        stringIds.insert(value, id);
+        return id;
+    };
+
+    QByteArray blocks;
+    quint32 sampleCount = 0;
+    for (const Series& entry : series) {
+        const ForecastSeries& samples = entry.samples;
+        const int count = samples.size();
+
+        // Series-local string ids become dictionary ids
+        QVector<qint32> conditions(count);
+        QVector<qint32> descriptions(count);
+        for (int i = 0; i < count; ++i) {
+            const WeatherSample sample = samples.at(i);
+            conditions[i] = sample.conditionId == WeatherSample::NoString
+                ? WeatherSample::NoString : intern(samples.stringAt(sample.conditionId));
+            descriptions[i] = sample.descriptionId == WeatherSample::NoString
+                ? WeatherSample::NoString : intern(samples.stringAt(sample.descriptionId));
+        }
+
+        BitWriter payload;
+        writeTimestamps(payload, samples.timestamps());
+        writeDoubles(payload, samples.temperatures());
+        writeDoubles(payload, samples.feelsLikes());
+        writeDoubles(payload, samples.pressures());
+        writeDoubles(payload, samples.windSpeeds());
+        writeDoubles(payload, samples.precipProbabilities());
+        writeDoubles(payload, samples.precipIntensities());
+        writeIntegers(payload, samples.humidities());
+        writeIntegers(payload, samples.windDirections());
+        writeIntegers(payload, samples.cloudCovers());
+        writeIntegers(payload, samples.visibilities());
+        writeIntegers(payload, samples.uvIndices());
+        writeIntegers(payload, conditions);
+        writeIntegers(payload, descriptions);
+
+        append<qint64>(blocks, entry.latMicroDegrees);
+        append<qint64>(blocks, entry.lonMicroDegrees);
+        append<qint32>(blocks, intern(entry.source));
+        append<quint32>(blocks, static_cast<quint32>(count));
+        append<quint32>(blocks, static_cast<quint32>(payload.bytes().size()));
+        blocks.append(payload.bytes());
+        sampleCount += static_cast<quint32>(count);
+    }
+
+    QByteArray body;
+    append<quint32>(body, static_cast<quint32>(strings.size()));
+    for (const QString& value : strings) {
+        const QByteArray utf8 = value.toUtf8();
+        append<quint32>(body, static_cast<quint32>(utf8.size()));
+        body.append(utf8);
+    }
+    body.append(blocks);
+
+    QByteArray out;
+    out.append(Magic, sizeof(Magic));
+    append<quint16>(out, FormatVersion);
+    append<quint16>(out, 0);
+    append<quint32>(out, static_cast<quint32>(series.size()));
+    append<quint32>(out, sampleCount);
+    out.append(qCompress(body, 9));
+    return out;
+}
+
+bool ArchiveCodec::decode(const QByteArray& bytes, QList<Series>& series) {
+    series.clear();
+    ArchiveReader reader;
+    if (!reader.open(bytes)) {
+        return false;
+    }
+
+    while (reader.next()) {
+        Series entry;
+        entry.latMicroDegrees = reader.latMicroDegrees();
+        entry.lonMicroDegrees = reader.lonMicroDegrees();
+        entry.source = reader.source();
+        if (!reader.samples(entry.samples)) {
+            return false;
+        }
+        series.append(entry);
+    }
+    return series.size() == reader.seriesCount();
+}
+
+bool ArchiveReader::open(const QByteArray& bytes) {
+    *this = ArchiveReader();
+
+    if (bytes.size() < HeaderSize || std::memcmp(bytes.constData(), Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+
+    const char* base = bytes.constData();
+    if (read<quint16>(base + HeaderVersion) != ArchiveCodec::FormatVersion) {
+        return false;
+    }
+
+    QByteArray body = qUncompress(reinterpret_cast<const uchar*>(base + HeaderSize),
+                                  static_cast<int>(bytes.size() - HeaderSize));
+    if (body.size() < 4) {
+        return false;
+    }
+
+    // Each dictionary entry needs at least its length prefix
+    const quint32 stringCount = read<quint32>(body.constData());
+    if (stringCount > static_cast<quint32>(body.size() / 4)) {
+        return false;
+    }
+
+    int offset = 4;
+    QStringList strings;
+    strings.reserve(static_cast<int>(stringCount));
+    for (quint32 i = 0; i < stringCount; ++i) {
+        if (offset + 4 > body.size()) {
+            return false;
+        }
+        const quint32 length = read<quint32>(body.constData() + offset);
+        offset += 4;
+        if (length > static_cast<quint32>(body.size() - offset)) {
+            return false;
+        }
+        strings.append(QString::fromUtf8(body.constData() + offset, static_cast<int>(length)));
+        offset += static_cast<int>(length);
+    }
+
+    m_body = body;
+    m_strings = strings;
+    m_seriesCount = static_cast<int>(read<quint32>(base + HeaderSeriesCount));
+    m_sampleCount = static_cast<int>(read<quint32>(base + HeaderSampleCount));
+    m_nextBlock = offset;
+    m_valid = true;
+    return true;
+}
+
+bool ArchiveReader::next() {
+    if (!m_valid || m_nextBlock + BlockHeaderSize > m_body.size()) {
+        return false;
+    }
+
+    const char* header = m_body.constData() + m_nextBlock;
+    const quint32 count = read<quint32>(header + BlockSampleCount);
+    const quint32 payloadSize = read<quint32>(header + BlockPayloadSize);
+    const int payloadStart = m_nextBlock + BlockHeaderSize;
+    // Every sample takes at least one bit in each column
+    if (payloadSize > static_cast<quint32>(m_body.size() - payloadStart)
+        || count > payloadSize * 8) {
+        return false;
+    }
+
+    m_latMicroDegrees = read<qint64>(header + BlockLatitude);
+    m_lonMicroDegrees = read<qint64>(header + BlockLongitude);
+    m_sourceId = read<qint32>(header + BlockSource);
+    m_blockCount = static_cast<int>(count);
+    m_payloadStart = payloadStart;
+    m_payloadSize = static_cast<int>(payloadSize);
+    m_nextBlock = payloadStart + static_cast<int>(payloadSize);
+    return true;
+}
+
+QString ArchiveReader::source() const {
+    return m_strings.value(m_sourceId);
+}
+
+bool ArchiveReader::samples(ForecastSeries& series) const {
+    series.clear();
+    if (!m_valid) {
+        return false;
+    }
+
+    const int count = m_blockCount;
+    BitReader in(m_body.constData() + m_payloadStart, m_payloadSize);
+
+    QVector<qint64> timestamps;
+    QVector<double> doubles[6];
+    QVector<qint32> integers[7];
+    if (!readTimestamps(in, count, timestamps)) {
+        return false;
+    }
+    for (QVector<double>& column : doubles) {
+        if (!readDoubles(in, count, column)) {
+            return false;
+        }
+    }
+    for (QVector<qint32>& column : integers) {
+        if (!readIntegers(in, count, column)) {
+            return false;
+        }
+    }
+
+    // Intern only the dictionary entries this series uses
+    QVector<qint32> remap(m_strings.size(), WeatherSample::NoString - 1);
+    auto mapId = [&](qint32 id) {
+        if (id < 0 || id >= remap.size()) {
+            return WeatherSample::NoString;
+        }
+        if (remap.at(id) == WeatherSample::NoString - 1) {
+            remap[id] = series.internString(m_strings.at(id));
+        }
+        return remap.at(id);
+    };
+
+    series.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        WeatherSample sample;
+        sample.timestampMs = timestamps.at(i);
+        sample.latitude = m_latMicroDegrees / 1000000.0;
+        sample.longitude = m_lonMicroDegrees / 1000000.0;
+        sample.temperature = doubles[0].at(i);
+        sample.feelsLike = doubles[1].at(i);
+        sample.pressure = doubles[2].at(i);
+        sample.windSpeed = doubles[3].at(i);
+        sample.precipProbability = doubles[4].at(i);
+        sample.precipIntensity = doubles[5].at(i);
+        sample.humidity = integers[0].at(i);
+        sample.windDirection = integers[1].at(i);
+        sample.cloudCover = integers[2].at(i);
+        sample.visibility = integers[3].at(i);
+        sample.uvIndex = integers[4].at(i);
+        sample.conditionId = mapId(integers[5].at(i));
+        sample.descriptionId = mapId(integers[6].at(i));
+        series.append(sample);
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef ARCHIVECODEC_H
+#define ARCHIVECODEC_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "models/ForecastSeries.h"
+
+/**
+ * @brief Compressed columnar encoding of archived historical series
+ *
+ * Layout (integers little-endian):
+ *   Header   magic "HLWA", quint16 version, quint16 reserved,
+ *            quint32 series count, quint32 sample count
+ *   Body     qCompress()ed string dictionary, then one block per series
+ *
+ * A block holds the series' location, source and sample count, then a
+ * bit-packed payload storing one column after another: delta-of-delta
+ * timestamps, doubles as delta-coded scaled decimals when that is lossless
+ * and XOR-compressed otherwise, and delta-coded integers. Condition and
+ * description strings are ids into the dictionary.
+ */
+class ArchiveCodec
+{
+public:
+    static constexpr quint16 FormatVersion = 1;
+
+    /**
+     * @brief Samples of one location and source
+     */
+    struct Series {
+        qint64 latMicroDegrees = 0;
+        qint64 lonMicroDegrees = 0;
+        QString source;
+        ForecastSeries samples;     // Sorted by time
+    };
+
+    /**
+     * @brief Encode series into a self-contained buffer
+     */
+    static QByteArray encode(const QList<Series>& series);
+
+    /**
+     * @brief Decode every series of a buffer produced by encode()
+     * @return false if the buffer is malformed or of an unknown version
+     */
+    static bool decode(const QByteArray& bytes, QList<Series>& series);
+};
+
+/**
+ * @brief Sequential reader over an ArchiveCodec buffer
+ *
+ * Decompresses the body once, then walks the blocks in order. Block headers
+ * are read without touching the payload, so scanning for one location only
+ * decodes that location's samples.
+ */
+class ArchiveReader
+{
+public:
+    ArchiveReader() = default;
+
+    /**
+     * @brief Validate the header and decompress the body
+     * @return false if the buffer is malformed or of an unknown version
+     */
+    bool open(const QByteArray& bytes);
+
+    bool isValid() const { return m_valid; }
+    int seriesCount() const { return m_seriesCount; }
+    int sampleCount() const { return m_sampleCount; }
+
+    /**
+     * @brief Advance to the next series
+     * @return false at the end of the archive or on a malformed block
+     */
+    bool next();
+
+    // Current series
+    qint64 latMicroDegrees() const { return m_latMicroDegrees; }
+    qint64 lonMicroDegrees() const { return m_lonMicroDegrees; }
+    QString source() const;
+    int size() const { return m_blockCount; }
+
+    /**
+     * @brief Decode the current series
+     * @return false if its payload is malformed
+     */
+    bool samples(ForecastSeries& series) const;
+
+private:
+    QByteArray m_body;
+    QStringList m_strings;
+    int m_seriesCount = 0;
+    int m_sampleCount = 0;
+    int m_nextBlock = 0;        // Body offset of the next block header
+    int m_payloadStart = 0;
+    int m_payloadSize = 0;
+    qint64 m_latMicroDegrees = 0;
+    qint64 m_lonMicroDegrees = 0;
+    qint32 m_sourceId = -1;
+    int m_blockCount = 0;
+    bool m_valid = false;
+};
+
+#endif // ARCHIVECODEC_H
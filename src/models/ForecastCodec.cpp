@@ -0,0 +1,245 @@
+#include "models/ForecastCodec.h"
+#include <QtEndian>
+#include <QVector>
+#include <cstring>
+
+namespace {
+const char Magic[4] = {'H', 'L', 'W', 'F'};
+
+// Header field offsets
+constexpr int HeaderVersion = 4;
+constexpr int HeaderRecordSize = 6;
+constexpr int HeaderRecordCount = 8;
+constexpr int HeaderStringCount = 12;
+constexpr int HeaderSize = 16;
+
+// Record field offsets (8-byte fields first, record padded to 8 bytes)
+constexpr int FieldTimestamp = 0;
+constexpr int FieldLatitude = 8;
+constexpr int FieldLongitude = 16;
+constexpr int FieldTemperature = 24;
+constexpr int FieldFeelsLike = 32;
+constexpr int FieldPressure = 40;
+constexpr int FieldWindSpeed = 48;
+constexpr int FieldPrecipProbability = 56;
+constexpr int FieldPrecipIntensity = 64;
+constexpr int FieldHumidity = 72;
+constexpr int FieldWindDirection = 76;
+constexpr int FieldCloudCover = 80;
+constexpr int FieldVisibility = 84;
+constexpr int FieldUvIndex = 88;
+constexpr int FieldCondition = 92;
+constexpr int FieldDescription = 96;
+constexpr int RecordSize = 104;
+
+template <typename T>
+void write(char* dst, T value) {
+    qToLittleEndian<T>(value, dst);
+}
+
+template <typename T>
+T read(const char* src) {
+    return qFromLittleEndian<T>(src);
+}
+} // namespace
+
+QByteArray ForecastCodec::encode(const ForecastSeries& series) {
+    const int count = series.size();
+    const QStringList& strings = series.strings();
+
+    QVector<QByteArray> utf8;
+    utf8.reserve(strings.size());
+    qint64 stringBytes = 0;
+    for (const QString& value : strings) {
+        utf8.append(value.toUtf8());
+        stringBytes += utf8.last().size();
+    }
+
+    const qint64 offsetsStart = HeaderSize + static_cast<qint64>(count) * RecordSize;
+    const qint64 dataStart = offsetsStart + static_cast<qint64>(strings.size() + 1) * 4;
+    QByteArray out(static_cast<int>(dataStart + stringBytes), Qt::Uninitialized);
+    char* base = out.data();
+
+    std::memcpy(base, Magic, sizeof(Magic));
+    write<quint16>(base + HeaderVersion, FormatVersion);
+    write<quint16>(base + HeaderRecordSize, static_cast<quint16>(RecordSize));
+    write<quint32>(base + HeaderRecordCount, static_cast<quint32>(count));
+    write<quint32>(base + HeaderStringCount, static_cast<quint32>(strings.size()));
+
+    for (int i = 0; i < count; ++i) {
+        const WeatherSample sample = series.at(i);
+        char* rec = base + HeaderSize + static_cast<qint64>(i) * RecordSize;
+        write<qint64>(rec + FieldTimestamp, sample.timestampMs);
+        write<double>(rec + FieldLatitude, sample.latitude);
+        write<double>(rec + FieldLongitude, sample.longitude);
+        write<double>(rec + FieldTemperature, sample.temperature);
+        write<double>(rec + FieldFeelsLike, sample.feelsLike);
+        write<double>(rec + FieldPressure, sample.pressure);
+        write<double>(rec + FieldWindSpeed, sample.windSpeed);
+        write<double>(rec + FieldPrecipProbability, sample.precipProbability);
+        write<double>(rec + FieldPrecipIntensity, sample.precipIntensity);
+        write<qint32>(rec + FieldHumidity, sample.humidity);
+        write<qint32>(rec + FieldWindDirection, sample.windDirection);
+        write<qint32>(rec + FieldCloudCover, sample.cloudCover);
+        write<qint32>(rec + FieldVisibility, sample.visibility);
+        write<qint32>(rec + FieldUvIndex, sample.uvIndex);
+        write<qint32>(rec + FieldCondition, sample.conditionId);
+        write<qint32>(rec + FieldDescription, sample.descriptionId);
+        write<qint32>(rec + FieldDescription + 4, 0);
+    }
+
+    quint32 offset = 0;
+    char* offsets = base + offsetsStart;
+    char* data = base + dataStart;
+    for (int i = 0; i < utf8.size(); ++i) {
+        write<quint32>(offsets + i * 4, offset);
+        std::memcpy(data + offset, utf8.at(i).constData(), static_cast<size_t>(utf8.at(i).size()));
+        offset += static_cast<quint32>(utf8.at(i).size());
+    }
+    write<quint32>(offsets + utf8.size() * 4, offset);
+
+    return out;
+}
+
+bool ForecastCodec::decode(const QByteArray& bytes, ForecastSeries& series) {
+    ForecastView view;
+    if (!view.open(bytes)) {
+        return false;
+    }
+    series = view.toSeries();
+    return true;
+}
+
+bool ForecastView::open(const QByteArray& bytes) {
+    m_bytes = QByteArray();
+    m_count = 0;
+    m_recordSize = 0;
+    m_stringCount = 0;
+    m_offsetsStart = 0;
+    m_stringDataStart = 0;
+    m_valid = false;
+
+    if (bytes.size() < HeaderSize || std::memcmp(bytes.constData(), Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+
+    const char* base = bytes.constData();
+    if (read<quint16>(base + HeaderVersion) != ForecastCodec::FormatVersion) {
+        return false;
+    }
+
+    const quint16 recordSize = read<quint16>(base + HeaderRecordSize);
+    const quint32 count = read<quint32>(base + HeaderRecordCount);
+    const quint32 stringCount = read<quint32>(base + HeaderStringCount);
+    if (recordSize < RecordSize) {
+        return false;
+    }
+
+    const qint64 offsetsStart = HeaderSize + static_cast<qint64>(count) * recordSize;
+    const qint64 dataStart = offsetsStart + (static_cast<qint64>(stringCount) + 1) * 4;
+    if (dataStart > bytes.size()) {
+        return false;
+    }
+
+    // String offsets must be non-decreasing and stay inside the buffer
+    const qint64 dataSize = bytes.size() - dataStart;
+    quint32 previous = 0;
+    for (quint32 i = 0; i <= stringCount; ++i) {
+        const quint32 offset = read<quint32>(base + offsetsStart + static_cast<qint64>(i) * 4);
+        if (offset < previous || offset > dataSize) {
+            return false;
+        }
+        previous = offset;
+    }
+
+    m_bytes = bytes;
+    m_count = static_cast<int>(count);
+    m_recordSize = recordSize;
+    m_stringCount = static_cast<int>(stringCount);
+    m_offsetsStart = static_cast<int>(offsetsStart);
+    m_stringDataStart = static_cast<int>(dataStart);
+    m_valid = true;
+    return true;
+}
+
+const char* ForecastView::record(int index) const {
+    return m_bytes.constData() + HeaderSize + static_cast<qint64>(index) * m_recordSize;
+}
+
+qint64 ForecastView::timestampAt(int index) const {
+    return read<qint64>(record(index) + FieldTimestamp);
+}
+
+double ForecastView::temperatureAt(int index) const {
+    return read<double>(record(index) + FieldTemperature);
+}
+
+double ForecastView::precipProbabilityAt(int index) const {
+    return read<double>(record(index) + FieldPrecipProbability);
+}
+
+WeatherSample ForecastView::at(int index) const {
+    const char* rec = record(index);
+    WeatherSample sample;
+    sample.timestampMs = read<qint64>(rec + FieldTimestamp);
+    sample.latitude = read<double>(rec + FieldLatitude);
+    sample.longitude = read<double>(rec + FieldLongitude);
+    sample.temperature = read<double>(rec + FieldTemperature);
+    sample.feelsLike = read<double>(rec + FieldFeelsLike);
+    sample.pressure = read<double>(rec + FieldPressure);
+    sample.windSpeed = read<double>(rec + FieldWindSpeed);
+    sample.precipProbability = read<double>(rec + FieldPrecipProbability);
+    sample.precipIntensity = read<double>(rec + FieldPrecipIntensity);
+    sample.humidity = read<qint32>(rec + FieldHumidity);
+    sample.windDirection = read<qint32>(rec + FieldWindDirection);
+    sample.cloudCover = read<qint32>(rec + FieldCloudCover);
+    sample.visibility = read<qint32>(rec + FieldVisibility);
+    sample.uvIndex = read<qint32>(rec + FieldUvIndex);
+    sample.conditionId = read<qint32>(rec + FieldCondition);
+    sample.descriptionId = read<qint32>(rec + FieldDescription);
+    return sample;
+}
+
+QString ForecastView::stringAt(qint32 id) const {
+    if (id < 0 || id >= m_stringCount) {
+        return QString();
+    }
+    const char* offsets = m_bytes.constData() + m_offsetsStart;
+    const quint32 begin = read<quint32>(offsets + static_cast<qint64>(id) * 4);
+    const quint32 end = read<quint32>(offsets + (static_cast<qint64>(id) + 1) * 4);
+    return QString::fromUtf8(m_bytes.constData() + m_stringDataStart + begin,
+                             static_cast<int>(end - begin));
+}
+
+QString ForecastView::conditionAt(int index) const {
+    return stringAt(read<qint32>(record(index) + FieldCondition));
+}
+
+QString ForecastView::descriptionAt(int index) const {
+    return stringAt(read<qint32>(record(index) + FieldDescription));
+}
+
+ForecastSeries ForecastView::toSeries() const {
+    ForecastSeries series;
+    if (!m_valid) {
+        return series;
+    }
+
+    // Rebuild the string table; remap in case the buffer holds duplicates
+    QVector<qint32> remap(m_stringCount);
+    for (int i = 0; i < m_stringCount; ++i) {
+        remap[i] = series.internString(stringAt(i));
+    }
+    auto mapId = [&remap](qint32 id) {
+        return (id >= 0 && id < remap.size()) ? remap.at(id) : WeatherSample::NoString;
+    };
+
+    series.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        WeatherSample sample = at(i);
+        sample.conditionId = mapId(sample.conditionId);
+        sample.descriptionId = mapId(sample.descriptionId);
+        series.append(sample);
+    }
+    return series;
+}
@@ -0,0 +1,85 @@
+#ifndef FORECASTCODEC_H
+#define FORECASTCODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include "models/ForecastSeries.h"
+
+/**
+ * @brief Versioned binary encoding of a ForecastSeries
+ *
+ * Layout (integers and doubles little-endian):
+ *   Header   magic "HLWF", quint16 version, quint16 record size,
+ *            quint32 record count, quint32 string count
+ *   Records  record count x fixed-width sample records
+ *   Strings  (string count + 1) quint32 offsets, then the UTF-8 bytes
+ *
+ * Because records are fixed width, ForecastView can read any field of any
+ * sample directly from the buffer without parsing the rest of it.
+ */
+class ForecastCodec
+{
+public:
+    static constexpr quint16 FormatVersion = 1;
+
+    /**
+     * @brief Encode a series into a self-contained buffer
+     */
+    static QByteArray encode(const ForecastSeries& series);
+
+    /**
+     * @brief Decode a buffer produced by encode()
+     * @return false if the buffer is malformed or of an unknown version
+     */
+    static bool decode(const QByteArray& bytes, ForecastSeries& series);
+};
+
+/**
+ * @brief Zero-copy read view over a ForecastCodec buffer
+ *
+ * Holds an implicitly shared reference to the buffer and decodes fields on
+ * access, so opening a cached forecast costs a header check rather than a
+ * parse. String ids returned by at() refer to this view's string table.
+ */
+class ForecastView
+{
+public:
+    ForecastView() = default;
+
+    /**
+     * @brief Validate the header and attach to the buffer
+     * @return false if the buffer is malformed or of an unknown version
+     */
+    bool open(const QByteArray& bytes);
+
+    bool isValid() const { return m_valid; }
+    int size() const { return m_count; }
+
+    qint64 timestampAt(int index) const;
+    double temperatureAt(int index) const;
+    double precipProbabilityAt(int index) const;
+    WeatherSample at(int index) const;
+
+    int stringCount() const { return m_stringCount; }
+    QString stringAt(qint32 id) const;
+    QString conditionAt(int index) const;
+    QString descriptionAt(int index) const;
+
+    /**
+     * @brief Materialize the whole buffer as a ForecastSeries
+     */
+    ForecastSeries toSeries() const;
+
+private:
+    const char* record(int index) const;
+
+    QByteArray m_bytes;
+    int m_count = 0;
+    int m_recordSize = 0;
+    int m_stringCount = 0;
+    int m_offsetsStart = 0;
+    int m_stringDataStart = 0;
+    bool m_valid = false;
+};
+
+#endif // FORECASTCODEC_H
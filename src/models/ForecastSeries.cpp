@@ -0,0 +1,261 @@
+#include "models/ForecastSeries.h"
+#include "models/WeatherData.h"
+#include <QObject>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+template <typename T>
+void applyPermutation(QVector<T>& column, const QVector<int>& order) {
+    QVector<T> sorted;
+    sorted.reserve(column.size());
+    for (int index : order) {
+        sorted.append(column.at(index));
+    }
+    column = std::move(sorted);
+}
+} // namespace
+
+void ForecastSeries::reserve(int count) {
+    m_timestampMs.reserve(count);
+    m_latitude.reserve(count);
+    m_longitude.reserve(count);
+    m_temperature.reserve(count);
+    m_feelsLike.reserve(count);
+    m_humidity.reserve(count);
+    m_pressure.reserve(count);
+    m_windSpeed.reserve(count);
+    m_windDirection.reserve(count);
+    m_precipProbability.reserve(count);
+    m_precipIntensity.reserve(count);
+    m_cloudCover.reserve(count);
+    m_visibility.reserve(count);
+    m_uvIndex.reserve(count);
+    m_conditionId.reserve(count);
+    m_descriptionId.reserve(count);
+}
+
+void ForecastSeries::clear() {
+    m_timestampMs.clear();
+    m_latitude.clear();
+    m_longitude.clear();
+    m_temperature.clear();
+    m_feelsLike.clear();
+    m_humidity.clear();
+    m_pressure.clear();
+    m_windSpeed.clear();
+    m_windDirection.clear();
+    m_precipProbability.clear();
+    m_precipIntensity.clear();
+    m_cloudCover.clear();
+    m_visibility.clear();
+    m_uvIndex.clear();
+    m_conditionId.clear();
+    m_descriptionId.clear();
+    m_strings.clear();
+    m_stringIndex.clear();
+}
+
+ForecastSeries ForecastSeries::emptyCopy() const {
+    ForecastSeries copy;
+    copy.m_strings = m_strings;
+    copy.m_stringIndex = m_stringIndex;
+    return copy;
+}
+
+void ForecastSeries::append(const WeatherSample& sample) {
+    m_timestampMs.append(sample.timestampMs);
+    m_latitude.append(sample.latitude);
+    m_longitude.append(sample.longitude);
+    m_temperature.append(sample.temperature);
+    m_feelsLike.append(sample.feelsLike);
+    m_humidity.append(sample.humidity);
+    m_pressure.append(sample.pressure);
+    m_windSpeed.append(sample.windSpeed);
+    m_windDirection.append(sample.windDirection);
+    m_precipProbability.append(sample.precipProbability);
+    m_precipIntensity.append(sample.precipIntensity);
+    m_cloudCover.append(sample.cloudCover);
+    m_visibility.append(sample.visibility);
+    m_uvIndex.append(sample.uvIndex);
+    m_conditionId.append(sample.conditionId);
+    m_descriptionId.append(sample.descriptionId);
+}
+
+void ForecastSeries::append(const WeatherSample& sample, const ForecastSeries& strings) {
+    if (&strings == this) {
+        append(sample);
+        return;
+    }
+    WeatherSample remapped = sample;
+    remapped.conditionId = internString(strings.stringAt(sample.conditionId));
+    remapped.descriptionId = internString(strings.stringAt(sample.descriptionId));
+    append(remapped);
+}
+
+void ForecastSeries::append(const WeatherData* data) {
+    if (!data) {
+        return;
+    }
+
+    WeatherSample sample;
+    sample.timestampMs = toEpochMs(data->timestamp());
+    sample.latitude = data->latitude();
+    sample.longitude = data->longitude();
+    sample.temperature = data->temperature();
+    sample.feelsLike = data->feelsLike();
+    sample.humidity = data->humidity();
+    sample.pressure = data->pressure();
+    sample.windSpeed = data->windSpeed();
+    sample.windDirection = data->windDirection();
+    sample.precipProbability = data->precipProbability();
+    sample.precipIntensity = data->precipIntensity();
+    sample.cloudCover = data->cloudCover();
+    sample.visibility = data->visibility();
+    sample.uvIndex = data->uvIndex();
+    sample.conditionId = internString(data->weatherCondition());
+    sample.descriptionId = internString(data->weatherDescription());
+    append(sample);
+}
+
+WeatherSample ForecastSeries::at(int index) const {
+    WeatherSample sample;
+    sample.timestampMs = m_timestampMs.at(index);
+    sample.latitude = m_latitude.at(index);
+    sample.longitude = m_longitude.at(index);
+    sample.temperature = m_temperature.at(index);
+    sample.feelsLike = m_feelsLike.at(index);
+    sample.humidity = m_humidity.at(index);
+    sample.pressure = m_pressure.at(index);
+    sample.windSpeed = m_windSpeed.at(index);
+    sample.windDirection = m_windDirection.at(index);
+    sample.precipProbability = m_precipProbability.at(index);
+    sample.precipIntensity = m_precipIntensity.at(index);
+    sample.cloudCover = m_cloudCover.at(index);
+    sample.visibility = m_visibility.at(index);
+    sample.uvIndex = m_uvIndex.at(index);
+    sample.conditionId = m_conditionId.at(index);
+    sample.descriptionId = m_descriptionId.at(index);
+    return sample;
+}
+
+qint32 ForecastSeries::internString(const QString& value) {
+    if (value.isEmpty()) {
+        return WeatherSample::NoString;
+    }
+    auto it = m_stringIndex.constFind(value);
+    if (it != m_stringIndex.constEnd()) {
+        return it.value();
+    }
+    const qint32 id = static_cast<qint32>(m_strings.size());
+    m_strings.append(value);
+    m_stringIndex.insert(value, id);
+    return id;
+}
+
+QString ForecastSeries::stringAt(qint32 id) const {
+    if (id < 0 || id >= m_strings.size()) {
+        return QString();
+    }
+    return m_strings.at(id);
+}
+
+bool ForecastSeries::isSortedByTime() const {
+    return std::is_sorted(m_timestampMs.cbegin(), m_timestampMs.cend());
+}
+
+void ForecastSeries::sortByTime() {
+    if (isSortedByTime()) {
+        return;
+    }
+
+    QVector<int> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_timestampMs.at(a) < m_timestampMs.at(b);
+    });
+
+    applyPermutation(m_timestampMs, order);
+    applyPermutation(m_latitude, order);
+    applyPermutation(m_longitude, order);
+    applyPermutation(m_temperature, order);
+    applyPermutation(m_feelsLike, order);
+    applyPermutation(m_humidity, order);
+    applyPermutation(m_pressure, order);
+    applyPermutation(m_windSpeed, order);
+    applyPermutation(m_windDirection, order);
+    applyPermutation(m_precipProbability, order);
+    applyPermutation(m_precipIntensity, order);
+    applyPermutation(m_cloudCover, order);
+    applyPermutation(m_visibility, order);
+    applyPermutation(m_uvIndex, order);
+    applyPermutation(m_conditionId, order);
+    applyPermutation(m_descriptionId, order);
+}
+
+int ForecastSeries::lowerBound(qint64 timestampMs) const {
+    auto it = std::lower_bound(m_timestampMs.cbegin(), m_timestampMs.cend(), timestampMs);
+    return static_cast<int>(it - m_timestampMs.cbegin());
+}
+
+int ForecastSeries::indexOfTime(qint64 timestampMs) const {
+    const int index = lowerBound(timestampMs);
+    if (index < size() && m_timestampMs.at(index) == timestampMs) {
+        return index;
+    }
+    return -1;
+}
+
+ForecastSeries ForecastSeries::fromWeatherData(const QList<WeatherData*>& data) {
+    ForecastSeries series;
+    series.reserve(data.size());
+    for (const WeatherData* item : data) {
+        series.append(item);
+    }
+    return series;
+}
+
+WeatherData* ForecastSeries::toWeatherData(int index, QObject* parent) const {
+    if (index < 0 || index >= size()) {
+        return nullptr;
+    }
+
+    WeatherData* data = new WeatherData(parent);
+    data->setLatitude(m_latitude.at(index));
+    data->setLongitude(m_longitude.at(index));
+    data->setTimestamp(toDateTime(m_timestampMs.at(index)));
+    data->setTemperature(m_temperature.at(index));
+    data->setFeelsLike(m_feelsLike.at(index));
+    data->setHumidity(m_humidity.at(index));
+    data->setPressure(m_pressure.at(index));
+    data->setWindSpeed(m_windSpeed.at(index));
+    data->setWindDirection(m_windDirection.at(index));
+    data->setPrecipProbability(m_precipProbability.at(index));
+    data->setPrecipIntensity(m_precipIntensity.at(index));
+    data->setCloudCover(m_cloudCover.at(index));
+    data->setVisibility(m_visibility.at(index));
+    data->setUvIndex(m_uvIndex.at(index));
+    data->setWeatherCondition(conditionAt(index));
+    data->setWeatherDescription(descriptionAt(index));
+    return data;
+}
+
+QList<WeatherData*> ForecastSeries::toWeatherDataList(QObject* parent) const {
+    QList<WeatherData*> result;
+    result.reserve(size());
+    for (int i = 0; i < size(); ++i) {
+        result.append(toWeatherData(i, parent));
+    }
+    return result;
+}
+
+qint64 ForecastSeries::toEpochMs(const QDateTime& dateTime) {
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : WeatherSample::InvalidTime;
+}
+
+QDateTime ForecastSeries::toDateTime(qint64 timestampMs) {
+    if (timestampMs == WeatherSample::InvalidTime) {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(timestampMs);
+}
@@ -0,0 +1,139 @@
+#ifndef FORECASTSERIES_H
+#define FORECASTSERIES_H
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include "models/WeatherSample.h"
+
+class QObject;
+class WeatherData;
+
+/**
+ * @brief Columnar (struct-of-arrays) container of weather samples
+ *
+ * Stores each weather parameter in its own contiguous array so the
+ * interpolation, smoothing and aggregation engines can work on plain values
+ * without allocating QObjects. Condition and description strings are
+ * deduplicated in a per-series string table. WeatherData objects are only
+ * created at the QML boundary via toWeatherDataList().
+ */
+class ForecastSeries
+{
+public:
+    ForecastSeries() = default;
+
+    int size() const { return m_timestampMs.size(); }
+    bool isEmpty() const { return m_timestampMs.isEmpty(); }
+    void reserve(int count);
+    void clear();
+
+    /**
+     * @brief Create an empty series that shares this series' string table
+     *
+     * Samples taken from this series can be appended to the result without
+     * remapping their string ids.
+     */
+    ForecastSeries emptyCopy() const;
+
+    /**
+     * @brief Append a sample whose string ids refer to this series
+     */
+    void append(const WeatherSample& sample);
+
+    /**
+     * @brief Append a sample whose string ids refer to another series
+     * @param sample Sample to append
+     * @param strings Series owning the sample's string ids
+     */
+    void append(const WeatherSample& sample, const ForecastSeries& strings);
+
+    /**
+     * @brief Append a WeatherData object (ignored if null)
+     */
+    void append(const WeatherData* data);
+
+    /**
+     * @brief Read back a full sample (string ids refer to this series)
+     */
+    WeatherSample at(int index) const;
+
+    // Column access
+    const QVector<qint64>& timestamps() const { return m_timestampMs; }
+    const QVector<double>& latitudes() const { return m_latitude; }
+    const QVector<double>& longitudes() const { return m_longitude; }
+    const QVector<double>& temperatures() const { return m_temperature; }
+    const QVector<double>& feelsLikes() const { return m_feelsLike; }
+    const QVector<qint32>& humidities() const { return m_humidity; }
+    const QVector<double>& pressures() const { return m_pressure; }
+    const QVector<double>& windSpeeds() const { return m_windSpeed; }
+    const QVector<qint32>& windDirections() const { return m_windDirection; }
+    const QVector<double>& precipProbabilities() const { return m_precipProbability; }
+    const QVector<double>& precipIntensities() const { return m_precipIntensity; }
+    const QVector<qint32>& cloudCovers() const { return m_cloudCover; }
+    const QVector<qint32>& visibilities() const { return m_visibility; }
+    const QVector<qint32>& uvIndices() const { return m_uvIndex; }
+
+    qint64 timestampAt(int index) const { return m_timestampMs.at(index); }
+    QString conditionAt(int index) const { return stringAt(m_conditionId.at(index)); }
+    QString descriptionAt(int index) const { return stringAt(m_descriptionId.at(index)); }
+
+    // String table
+    qint32 internString(const QString& value);
+    QString stringAt(qint32 id) const;
+    const QStringList& strings() const { return m_strings; }
+
+    /**
+     * @brief Check whether timestamps are in non-decreasing order
+     */
+    bool isSortedByTime() const;
+
+    /**
+     * @brief Stable sort of all columns by timestamp
+     */
+    void sortByTime();
+
+    /**
+     * @brief Index of the first sample with timestamp >= timestampMs (series must be sorted)
+     */
+    int lowerBound(qint64 timestampMs) const;
+
+    /**
+     * @brief Index of the first sample with exactly this timestamp, or -1 (series must be sorted)
+     */
+    int indexOfTime(qint64 timestampMs) const;
+
+    // QML boundary conversion
+    static ForecastSeries fromWeatherData(const QList<WeatherData*>& data);
+    WeatherData* toWeatherData(int index, QObject* parent = nullptr) const;
+    QList<WeatherData*> toWeatherDataList(QObject* parent = nullptr) const;
+
+    static qint64 toEpochMs(const QDateTime& dateTime);
+    static QDateTime toDateTime(qint64 timestampMs);
+
+private:
+    QVector<qint64> m_timestampMs;
+    QVector<double> m_latitude;
+    QVector<double> m_longitude;
+    QVector<double> m_temperature;
+    QVector<double> m_feelsLike;
+    QVector<qint32> m_humidity;
+    QVector<double> m_pressure;
+    QVector<double> m_windSpeed;
+    QVector<qint32> m_windDirection;
+    QVector<double> m_precipProbability;
+    QVector<double> m_precipIntensity;
+    QVector<qint32> m_cloudCover;
+    QVector<qint32> m_visibility;
+    QVector<qint32> m_uvIndex;
+    QVector<qint32> m_conditionId;
+    QVector<qint32> m_descriptionId;
+
+    QStringList m_strings;
+    QHash<QString, qint32> m_stringIndex;
+};
+
+#endif // FORECASTSERIES_H
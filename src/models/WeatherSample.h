@@ -0,0 +1,43 @@
+#ifndef WEATHERSAMPLE_H
+#define WEATHERSAMPLE_H
+
+#include <QtGlobal>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Plain-value weather sample used by the processing pipeline
+ *
+ * Carries the same parameters as WeatherData without any QObject overhead,
+ * so samples can be copied by value and stored contiguously. Condition and
+ * description strings are referenced by index into the string table of the
+ * ForecastSeries that owns the sample.
+ */
+struct WeatherSample {
+    static constexpr qint64 InvalidTime = std::numeric_limits<qint64>::min();
+    static constexpr qint32 NoString = -1;
+
+    qint64 timestampMs = InvalidTime;   // Milliseconds since Unix epoch
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double temperature = 0.0;
+    double feelsLike = 0.0;
+    qint32 humidity = 0;
+    double pressure = 0.0;
+    double windSpeed = 0.0;
+    qint32 windDirection = 0;
+    double precipProbability = 0.0;
+    double precipIntensity = 0.0;
+    qint32 cloudCover = 0;
+    qint32 visibility = 0;
+    qint32 uvIndex = 0;
+    qint32 conditionId = NoString;      // Index into owning series' string table
+    qint32 descriptionId = NoString;    // Index into owning series' string table
+
+    bool hasValidTime() const { return timestampMs != InvalidTime; }
+};
+
+static_assert(std::is_trivially_copyable<WeatherSample>::value,
+              "WeatherSample must stay trivially copyable");
+
+#endif // WEATHERSAMPLE_H
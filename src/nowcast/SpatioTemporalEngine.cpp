@@ -2,6 +2,8 @@
 #include <QSet>
 #include <QMap>
 #include <QDebug>
+#include <QMetaMethod>
+#include <algorithm>
 
 SpatioTemporalEngine::SpatioTemporalEngine(QObject *parent)
     : QObject(parent)
@@ -39,26 +41,28 @@ QList<QPointF> SpatioTemporalEngine::generateGrid(double centerLat, double cente
     return gridPoints;
 }
 
-WeatherData* SpatioTemporalEngine::applySpatialSmoothing(const QList<WeatherData*>& gridForecasts,
-                                                         double centerLat, double centerLon)
+bool SpatioTemporalEngine::applySpatialSmoothing(const QVector<WeatherSample>& gridSamples,
+                                                 double centerLat, double centerLon,
+                                                 WeatherSample& output)
 {
-    if (gridForecasts.isEmpty()) {
-        return nullptr;
+    if (gridSamples.isEmpty()) {
+        return false;
     }
 
     QList<GridPoint> tempPoints;
     QList<GridPoint> precipPoints;
     QList<GridPoint> windPoints;
     QList<GridPoint> humidityPoints;
-
-    for (const WeatherData* sample : gridForecasts) {
-        if (!sample) {
-            continue;
-        }
-        tempPoints.append(GridPoint(sample->latitude(), sample->longitude(), sample->temperature(), true));
-        precipPoints.append(GridPoint(sample->latitude(), sample->longitude(), sample->precipIntensity(), true));
-        windPoints.append(GridPoint(sample->latitude(), sample->longitude(), sample->windSpeed(), true));
-        humidityPoints.append(GridPoint(sample->latitude(), sample->longitude(), sample->humidity(), true));
+    tempPoints.reserve(gridSamples.size());
+    precipPoints.reserve(gridSamples.size());
+    windPoints.reserve(gridSamples.size());
+    humidityPoints.reserve(gridSamples.size());
+
+    for (const WeatherSample& sample : gridSamples) {
+        tempPoints.append(GridPoint(sample.latitude, sample.longitude, sample.temperature, true));
+        precipPoints.append(GridPoint(sample.latitude, sample.longitude, sample.precipIntensity, true));
+        windPoints.append(GridPoint(sample.latitude, sample.longitude, sample.windSpeed, true));
+        humidityPoints.append(GridPoint(sample.latitude, sample.longitude, sample.humidity, true));
     }
 
     tempPoints = m_spatialInterpolator->handleMissingPoints(tempPoints, m_spatialConfig.missingPointsThreshold);
@@ -67,99 +71,101 @@ WeatherData* SpatioTemporalEngine::applySpatialSmoothing(const QList<WeatherData
     humidityPoints = m_spatialInterpolator->handleMissingPoints(humidityPoints, m_spatialConfig.missingPointsThreshold);
 
     if (tempPoints.isEmpty()) {
-        return nullptr;
+        return false;
     }
 
-    WeatherData* output = new WeatherData();
-    output->setLatitude(centerLat);
-    output->setLongitude(centerLon);
-    output->setTimestamp(gridForecasts.first()->timestamp());
+    // Non-smoothed parameters (timestamp, pressure, condition, ...) come from the first sample
+    output = gridSamples.first();
+    output.latitude = centerLat;
+    output.longitude = centerLon;
 
-    output->setTemperature(m_spatialInterpolator->interpolateWeighted(
-        centerLat, centerLon, tempPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower));
+    output.temperature = m_spatialInterpolator->interpolateWeighted(
+        centerLat, centerLon, tempPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower);
 
-    output->setPrecipIntensity(qMax(0.0, m_spatialInterpolator->interpolateWeighted(
-        centerLat, centerLon, precipPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower)));
+    output.precipIntensity = qMax(0.0, m_spatialInterpolator->interpolateWeighted(
+        centerLat, centerLon, precipPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower));
 
-    output->setWindSpeed(m_spatialInterpolator->interpolateWeighted(
-        centerLat, centerLon, windPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower));
+    output.windSpeed = m_spatialInterpolator->interpolateWeighted(
+        centerLat, centerLon, windPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower);
 
-    output->setHumidity(static_cast<int>(qRound(m_spatialInterpolator->interpolateWeighted(
-        centerLat, centerLon, humidityPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower))));
-
-    const WeatherData* reference = gridForecasts.first();
-    output->setFeelsLike(reference->feelsLike());
-    output->setPressure(reference->pressure());
-    output->setPrecipProbability(reference->precipProbability());
-    output->setWindDirection(reference->windDirection());
-    output->setCloudCover(reference->cloudCover());
-    output->setVisibility(reference->visibility());
-    output->setUvIndex(reference->uvIndex());
-    output->setWeatherCondition(reference->weatherCondition());
-    output->setWeatherDescription(reference->weatherDescription());
+    output.humidity = static_cast<qint32>(qRound(m_spatialInterpolator->interpolateWeighted(
+        centerLat, centerLon, humidityPoints, m_spatialConfig.strategy, m_spatialConfig.idwPower)));
 
     emit spatialSmoothingComplete();
-    return output;
+    return true;
 }
 
-QList<WeatherData*> SpatioTemporalEngine::applyTemporalInterpolation(const QList<WeatherData*>& apiForecasts)
+WeatherData* SpatioTemporalEngine::applySpatialSmoothing(const QList<WeatherData*>& gridForecasts,
+                                                         double centerLat, double centerLon)
 {
-    if (apiForecasts.isEmpty()) {
-        return {};
+    const ForecastSeries grid = ForecastSeries::fromWeatherData(gridForecasts);
+    QVector<WeatherSample> samples;
+    samples.reserve(grid.size());
+    for (int i = 0; i < grid.size(); ++i) {
+        samples.append(grid.at(i));
     }
 
-    QList<WeatherData*> filtered = apiForecasts;
-    const QDateTime nowRounded = QDateTime::currentDateTimeUtc().toUTC();
-    QList<WeatherData*> trimmed;
-    for (WeatherData* data : filtered) {
-        if (!data) {
-            continue;
-        }
-        trimmed.append(data);
+    WeatherSample smoothed;
+    if (!applySpatialSmoothing(samples, centerLat, centerLon, smoothed)) {
+        return nullptr;
     }
 
-    if (trimmed.isEmpty()) {
-        return {};
+    ForecastSeries output = grid.emptyCopy();
+    output.append(smoothed);
+    return output.toWeatherData(0);
+}
+
+ForecastSeries SpatioTemporalEngine::applyTemporalInterpolation(const ForecastSeries& apiForecasts)
+{
+    if (apiForecasts.isEmpty()) {
+        return ForecastSeries();
     }
 
-    QList<WeatherData*> interpolated = m_temporalInterpolator->interpolate(
-        trimmed,
+    ForecastSeries interpolated = m_temporalInterpolator->interpolate(
+        apiForecasts,
         qMax(1, m_temporalConfig.outputGranularityMinutes),
         m_temporalConfig.method);
 
     if (m_temporalConfig.smoothingWindowMinutes > 0) {
-        QList<WeatherData*> smoothed = m_temporalInterpolator->smooth(
+        interpolated = m_temporalInterpolator->smooth(
             interpolated,
             m_temporalConfig.smoothingWindowMinutes,
             TemporalInterpolator::SimpleMovingAverage);
-        qDeleteAll(interpolated);
-        interpolated = smoothed;
     }
 
     emit temporalInterpolationComplete();
     return interpolated;
 }
 
-QList<WeatherData*> SpatioTemporalEngine::combineAPIForecasts(const QMap<QString, QList<WeatherData*>>& apiForecasts)
+QList<WeatherData*> SpatioTemporalEngine::applyTemporalInterpolation(const QList<WeatherData*>& apiForecasts)
+{
+    return applyTemporalInterpolation(ForecastSeries::fromWeatherData(apiForecasts)).toWeatherDataList();
+}
+
+ForecastSeries SpatioTemporalEngine::combineAPIForecasts(const QMap<QString, ForecastSeries>& apiForecasts)
 {
     if (apiForecasts.isEmpty()) {
-        return {};
+        return ForecastSeries();
     }
 
-    QSet<QDateTime> timeline;
-    for (const QList<WeatherData*>& series : apiForecasts) {
-        for (WeatherData* sample : series) {
-            if (sample) {
-                timeline.insert(sample->timestamp());
-            }
-        }
+    // Sorted copies allow binary-search lookups per timestamp
+    QVector<ForecastSeries> sources;
+    QVector<double> weights;
+    QVector<qint64> timeline;
+    for (auto it = apiForecasts.constBegin(); it != apiForecasts.constEnd(); ++it) {
+        ForecastSeries series = it.value();
+        series.sortByTime();
+        timeline += series.timestamps();
+        sources.append(series);
+        weights.append(m_apiWeights.weights.value(it.key(), 1.0));
     }
 
-    QList<QDateTime> sortedTimes = timeline.values();
-    std::sort(sortedTimes.begin(), sortedTimes.end());
+    std::sort(timeline.begin(), timeline.end());
+    timeline.erase(std::unique(timeline.begin(), timeline.end()), timeline.end());
 
-    QList<WeatherData*> combined;
-    for (const QDateTime& ts : sortedTimes) {
+    ForecastSeries combined;
+    combined.reserve(timeline.size());
+    for (qint64 ts : timeline) {
         double totalWeight = 0.0;
         double sumTemp = 0.0;
         double sumPrecip = 0.0;
@@ -167,72 +173,69 @@ QList<WeatherData*> SpatioTemporalEngine::combineAPIForecasts(const QMap<QString
         double sumHumidity = 0.0;
         double sumPressure = 0.0;
 
-        WeatherData* reference = nullptr;
-
-        for (auto it = apiForecasts.constBegin(); it != apiForecasts.constEnd(); ++it) {
-            const QString apiName = it.key();
-            const QList<WeatherData*>& series = it.value();
+        int referenceSource = -1;
+        int referenceIndex = -1;
 
-            WeatherData* match = nullptr;
-            for (WeatherData* sample : series) {
-                if (sample && sample->timestamp() == ts) {
-                    match = sample;
-                    break;
-                }
-            }
-
-            if (!match) {
+        for (int s = 0; s < sources.size(); ++s) {
+            const ForecastSeries& series = sources.at(s);
+            const int match = series.indexOfTime(ts);
+            if (match < 0) {
                 continue;
             }
 
-            if (!reference) {
-                reference = match;
+            if (referenceSource < 0) {
+                referenceSource = s;
+                referenceIndex = match;
             }
 
-            const double weight = m_apiWeights.weights.value(apiName, 1.0);
+            const double weight = weights.at(s);
             totalWeight += weight;
-            sumTemp += match->temperature() * weight;
-            sumPrecip += match->precipIntensity() * weight;
-            sumWind += match->windSpeed() * weight;
-            sumHumidity += match->humidity() * weight;
-            sumPressure += match->pressure() * weight;
+            sumTemp += series.temperatures().at(match) * weight;
+            sumPrecip += series.precipIntensities().at(match) * weight;
+            sumWind += series.windSpeeds().at(match) * weight;
+            sumHumidity += series.humidities().at(match) * weight;
+            sumPressure += series.pressures().at(match) * weight;
         }
 
-        if (!reference || totalWeight <= 0.0) {
+        if (referenceSource < 0 || totalWeight <= 0.0) {
             continue;
         }
 
         const double norm = 1.0 / totalWeight;
-        WeatherData* blended = new WeatherData();
-        blended->setTimestamp(ts);
-        blended->setLatitude(reference->latitude());
-        blended->setLongitude(reference->longitude());
-        blended->setTemperature(sumTemp * norm);
-        blended->setPrecipIntensity(qMax(0.0, sumPrecip * norm));
-        blended->setWindSpeed(sumWind * norm);
-        blended->setHumidity(static_cast<int>(qRound(sumHumidity * norm)));
-        blended->setPressure(sumPressure * norm);
-        blended->setFeelsLike(reference->feelsLike());
-        blended->setPrecipProbability(reference->precipProbability());
-        blended->setWindDirection(reference->windDirection());
-        blended->setCloudCover(reference->cloudCover());
-        blended->setVisibility(reference->visibility());
-        blended->setUvIndex(reference->uvIndex());
-        blended->setWeatherCondition(reference->weatherCondition());
-        blended->setWeatherDescription(reference->weatherDescription());
-
-        combined.append(blended);
+        const ForecastSeries& reference = sources.at(referenceSource);
+        WeatherSample blended = reference.at(referenceIndex);
+        blended.timestampMs = ts;
+        blended.temperature = sumTemp * norm;
+        blended.precipIntensity = qMax(0.0, sumPrecip * norm);
+        blended.windSpeed = sumWind * norm;
+        blended.humidity = static_cast<qint32>(qRound(sumHumidity * norm));
+        blended.pressure = sumPressure * norm;
+
+        combined.append(blended, reference);
     }
 
     if (combined.isEmpty()) {
         emit error("Combined forecast is empty");
-    } else {
-        emit forecastReady(combined);
+    } else if (isSignalConnected(QMetaMethod::fromSignal(&SpatioTemporalEngine::forecastReady))) {
+        // Objects are only built for listeners, which take ownership
+        emit forecastReady(combined.toWeatherDataList());
     }
 
     return combined;
 }
 
+QList<WeatherData*> SpatioTemporalEngine::combineAPIForecasts(const QMap<QString, QList<WeatherData*>>& apiForecasts)
+{
+    QMap<QString, ForecastSeries> seriesMap;
+    for (auto it = apiForecasts.constBegin(); it != apiForecasts.constEnd(); ++it) {
+        seriesMap.insert(it.key(), ForecastSeries::fromWeatherData(it.value()));
+    }
+
+    // forecastReady is emitted by the series overload with its own objects
+    const ForecastSeries combined = combineAPIForecasts(seriesMap);
+    return combined.toWeatherDataList();
+}
+
 double SpatioTemporalEngine::kmToLatDegrees(double distanceKm)
 {
     return distanceKm / 111.0;
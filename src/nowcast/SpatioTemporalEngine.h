@@ -6,6 +6,7 @@
 #include <QDateTime>
 #include <QPointF>
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
 #include "nowcast/SpatialInterpolator.h"
 #include "nowcast/TemporalInterpolator.h"
 
@@ -20,6 +21,9 @@ class WeatherService;
  * 3. Spatially smoothing each API's forecast across the grid
  * 4. Temporally interpolating each API's forecast to common granularity
  * 5. Combining multiple APIs' forecasts into a single weighted result
+ * 
+ * All stages operate on WeatherSample/ForecastSeries values; the
+ * QList<WeatherData*> overloads are thin adapters for QObject callers.
  */
 class SpatioTemporalEngine : public QObject
 {
@@ -71,11 +75,16 @@ public:
     
     /**
      * @brief Apply spatial smoothing to forecast data at a single timestamp
-     * @param gridForecasts Forecasts from all grid points at one timestamp
+     * @param gridSamples Samples from all grid points at one timestamp
      * @param centerLat Center latitude for interpolation
      * @param centerLon Center longitude for interpolation
-     * @return Spatially smoothed value at center point
+     * @param output Spatially smoothed sample at center point; string ids are
+     *        taken from the first grid sample
+     * @return true if a smoothed sample was produced
      */
+    bool applySpatialSmoothing(const QVector<WeatherSample>& gridSamples,
+                               double centerLat, double centerLon,
+                               WeatherSample& output);
     WeatherData* applySpatialSmoothing(const QList<WeatherData*>& gridForecasts,
                                        double centerLat, double centerLon);
     
@@ -84,13 +93,17 @@ public:
      * @param apiForecasts Raw forecast data from one API
      * @return Interpolated forecast at configured granularity
      */
+    ForecastSeries applyTemporalInterpolation(const ForecastSeries& apiForecasts);
     QList<WeatherData*> applyTemporalInterpolation(const QList<WeatherData*>& apiForecasts);
     
     /**
      * @brief Combine forecasts from multiple APIs using weighted average
-     * @param apiForecasts Map of API name -> forecast list
+     * @param apiForecasts Map of API name -> forecast series
      * @return Combined forecast
+     *
+     * Emits forecastReady() with a separate object copy of a non-empty result.
      */
+    ForecastSeries combineAPIForecasts(const QMap<QString, ForecastSeries>& apiForecasts);
     QList<WeatherData*> combineAPIForecasts(const QMap<QString, QList<WeatherData*>>& apiForecasts);
     
 signals:
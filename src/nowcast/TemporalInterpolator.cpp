@@ -5,8 +5,7 @@
 #include <algorithm>
 
 // Forward declaration of helper function
-static void copyWeatherData(WeatherData* dest, const WeatherData* src);
-static QDateTime roundToNearestMinute(const QDateTime& dt);
+static qint64 roundToNearestMinute(qint64 timestampMs);
 
 TemporalInterpolator::TemporalInterpolator(QObject *parent)
     : QObject(parent)
@@ -18,119 +17,148 @@ TemporalInterpolator::TemporalInterpolator(QObject *parent)
 
 TemporalInterpolator::~TemporalInterpolator() = default;
 
-QList<WeatherData*> TemporalInterpolator::interpolate(const QList<WeatherData*>& sourceData,
-                                                        int outputGranularityMinutes,
-                                                        InterpolationMethod method)
+ForecastSeries TemporalInterpolator::interpolate(const ForecastSeries& sourceData,
+                                                 int outputGranularityMinutes,
+                                                 InterpolationMethod method)
 {
     if (sourceData.isEmpty()) {
-        return QList<WeatherData*>();
+        return ForecastSeries();
     }
-    
+
     if (sourceData.size() == 1) {
         // Can't interpolate with single point, return copy
-        WeatherData* copy = new WeatherData();
-        copy->setLatitude(sourceData.first()->latitude());
-        copy->setLongitude(sourceData.first()->longitude());
-        copy->setTimestamp(sourceData.first()->timestamp());
-        copy->setTemperature(sourceData.first()->temperature());
-        copy->setFeelsLike(sourceData.first()->feelsLike());
-        copy->setHumidity(sourceData.first()->humidity());
-        copy->setPressure(sourceData.first()->pressure());
-        copy->setWindSpeed(sourceData.first()->windSpeed());
-        copy->setWindDirection(sourceData.first()->windDirection());
-        copy->setPrecipProbability(sourceData.first()->precipProbability());
-        copy->setPrecipIntensity(sourceData.first()->precipIntensity());
-        copy->setCloudCover(sourceData.first()->cloudCover());
-        copy->setVisibility(sourceData.first()->visibility());
-        copy->setUvIndex(sourceData.first()->uvIndex());
-        copy->setWeatherCondition(sourceData.first()->weatherCondition());
-        copy->setWeatherDescription(sourceData.first()->weatherDescription());
-        return QList<WeatherData*>() << copy;
-    }
-    
-    QList<WeatherData*> sorted;
-    for (WeatherData* sample : sourceData) {
-        if (sample) {
-            sorted.append(sample);
-        }
-    }
-
-    if (sorted.isEmpty()) {
-        return QList<WeatherData*>();
+        return sourceData;
     }
 
-    std::sort(sorted.begin(), sorted.end(), [](const WeatherData* a, const WeatherData* b) {
-        return a->timestamp() < b->timestamp();
-    });
+    ForecastSeries sorted = sourceData;
+    sorted.sortByTime();
+    const QVector<qint64>& times = sorted.timestamps();
 
-    const int granularityMinutes = qMax(1, outputGranularityMinutes);
-    const QDateTime nowRounded = roundToNearestMinute(QDateTime::currentDateTimeUtc());
+    const qint64 granularityMs = static_cast<qint64>(qMax(1, outputGranularityMinutes)) * 60 * 1000;
+    const qint64 nowRounded = roundToNearestMinute(QDateTime::currentMSecsSinceEpoch());
 
-    QDateTime startTime = qMax(nowRounded, roundToNearestMinute(sorted.first()->timestamp()));
-    QDateTime nextForecast;
-    for (WeatherData* sample : sorted) {
-        QDateTime candidate = roundToNearestMinute(sample->timestamp());
+    const qint64 startTime = qMax(nowRounded, roundToNearestMinute(times.first()));
+    qint64 nextForecast = WeatherSample::InvalidTime;
+    for (qint64 sampleTime : times) {
+        const qint64 candidate = roundToNearestMinute(sampleTime);
         if (candidate > startTime) {
             nextForecast = candidate;
             break;
         }
     }
-    if (!nextForecast.isValid()) {
-        nextForecast = roundToNearestMinute(sorted.last()->timestamp());
+    if (nextForecast == WeatherSample::InvalidTime) {
+        nextForecast = roundToNearestMinute(times.last());
         if (nextForecast <= startTime) {
-            nextForecast = startTime.addSecs(granularityMinutes * 60);
+            nextForecast = startTime + granularityMs;
         }
     }
 
-    QDateTime endTime = qMax(startTime, nextForecast);
+    const qint64 endTime = qMax(startTime, nextForecast);
 
-    QList<WeatherData*> result;
-    QDateTime currentTime = startTime;
-    while (currentTime <= endTime) {
-        WeatherData* interpolated = nullptr;
-        
+    ForecastSeries result = sorted.emptyCopy();
+    result.reserve(static_cast<int>((endTime - startTime) / granularityMs) + 1);
+    for (qint64 currentTime = startTime; currentTime <= endTime; currentTime += granularityMs) {
         // Find bracketing points
-        const WeatherData* before = nullptr;
-        const WeatherData* after = nullptr;
-        
-        if (findBracketingPoints(sorted, currentTime, before, after)) {
-            if (before && after) {
-                // Interpolate between points
-                if (method == Linear) {
-                    interpolated = linearInterpolate(before, after, currentTime);
-                } else if (method == StepFunction) {
-                    // Use nearest neighbor
-                    qint64 distBefore = qAbs(before->timestamp().secsTo(currentTime));
-                    qint64 distAfter = qAbs(after->timestamp().secsTo(currentTime));
-                    
-                    interpolated = new WeatherData();
-                    if (distBefore < distAfter) {
-                        copyWeatherData(interpolated, before);
-                    } else {
-                        copyWeatherData(interpolated, after);
-                    }
-                    interpolated->setTimestamp(currentTime);
-                }
-            } else if (before) {
-                // Past last point, use last value
-                interpolated = new WeatherData();
-                copyWeatherData(interpolated, before);
-                interpolated->setTimestamp(currentTime);
-            } else if (after) {
-                // Before first point, use first value
-                interpolated = new WeatherData();
-                copyWeatherData(interpolated, after);
-                interpolated->setTimestamp(currentTime);
+        int before = -1;
+        int after = -1;
+        if (!findBracketingPoints(sorted, currentTime, before, after)) {
+            continue;
+        }
+
+        WeatherSample interpolated;
+        if (before >= 0 && after >= 0) {
+            // Interpolate between points
+            if (method == Linear) {
+                interpolated = linearInterpolate(sorted.at(before), sorted.at(after), currentTime);
+            } else if (method == StepFunction) {
+                // Use nearest neighbor
+                const qint64 distBefore = qAbs(currentTime - times.at(before));
+                const qint64 distAfter = qAbs(times.at(after) - currentTime);
+                interpolated = sorted.at(distBefore < distAfter ? before : after);
+                interpolated.timestampMs = currentTime;
+            } else {
+                continue;
             }
+        } else {
+            // Past last point or before first point, hold the nearest value
+            interpolated = sorted.at(before >= 0 ? before : after);
+            interpolated.timestampMs = currentTime;
         }
-        
-        if (interpolated) {
-            result.append(interpolated);
+
+        result.append(interpolated);
+    }
+
+    return result;
+}
+
+QList<WeatherData*> TemporalInterpolator::interpolate(const QList<WeatherData*>& sourceData,
+                                                        int outputGranularityMinutes,
+                                                        InterpolationMethod method)
+{
+    return interpolate(ForecastSeries::fromWeatherData(sourceData),
+                       outputGranularityMinutes, method).toWeatherDataList();
+}
+
+ForecastSeries TemporalInterpolator::smooth(const ForecastSeries& data,
+                                            int windowMinutes,
+                                            SmoothingMethod method)
+{
+    if (data.isEmpty() || method == None) {
+        return data;
+    }
+
+    const int count = data.size();
+    const int windowSize = qMax(1, windowMinutes);
+    const QVector<double>& temps = data.temperatures();
+    const QVector<double>& precips = data.precipIntensities();
+    const QVector<double>& winds = data.windSpeeds();
+
+    ForecastSeries result = data.emptyCopy();
+    result.reserve(count);
+
+    if (method == SimpleMovingAverage) {
+        // Prefix sums make each centered window O(1) regardless of its width
+        QVector<double> tempSums(count + 1, 0.0);
+        QVector<double> precipSums(count + 1, 0.0);
+        QVector<double> windSums(count + 1, 0.0);
+        for (int i = 0; i < count; ++i) {
+            tempSums[i + 1] = tempSums[i] + temps[i];
+            precipSums[i + 1] = precipSums[i] + precips[i];
+            windSums[i + 1] = windSums[i] + winds[i];
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int startIdx = qMax(0, i - windowSize / 2);
+            const int endIdx = qMin(count - 1, i + windowSize / 2);
+            const double windowCount = static_cast<double>(endIdx - startIdx + 1);
+
+            WeatherSample smoothed = data.at(i);
+            smoothed.temperature = (tempSums[endIdx + 1] - tempSums[startIdx]) / windowCount;
+            smoothed.precipIntensity = (precipSums[endIdx + 1] - precipSums[startIdx]) / windowCount;
+            smoothed.windSpeed = (windSums[endIdx + 1] - windSums[startIdx]) / windowCount;
+            result.append(smoothed);
+        }
+    } else if (method == ExponentialMovingAverage) {
+        // EMA with alpha = 2 / (windowSize + 1)
+        const double alpha = 2.0 / (windowSize + 1);
+        double prevTemp = 0.0;
+        double prevPrecip = 0.0;
+        double prevWind = 0.0;
+
+        for (int i = 0; i < count; ++i) {
+            WeatherSample smoothed = data.at(i);
+            if (i > 0) {
+                smoothed.temperature = alpha * temps[i] + (1 - alpha) * prevTemp;
+                smoothed.precipIntensity = alpha * precips[i] + (1 - alpha) * prevPrecip;
+                smoothed.windSpeed = alpha * winds[i] + (1 - alpha) * prevWind;
+            }
+            prevTemp = smoothed.temperature;
+            prevPrecip = smoothed.precipIntensity;
+            prevWind = smoothed.windSpeed;
+            result.append(smoothed);
         }
-        
-        currentTime = currentTime.addSecs(granularityMinutes * 60);
     }
-    
+
     return result;
 }
 
@@ -138,59 +166,43 @@ QList<WeatherData*> TemporalInterpolator::smooth(const QList<WeatherData*>& data
                                                    int windowMinutes,
                                                    SmoothingMethod method)
 {
-    if (data.isEmpty() || method == None) {
-        // Return copies
-        QList<WeatherData*> result;
-        for (const WeatherData* item : data) {
-            WeatherData* copy = new WeatherData();
-            copyWeatherData(copy, item);
-            result.append(copy);
-        }
-        return result;
+    return smooth(ForecastSeries::fromWeatherData(data), windowMinutes, method).toWeatherDataList();
+}
+
+ForecastSeries TemporalInterpolator::alignToGrid(const ForecastSeries& data,
+                                                 qint64 gridStartMs,
+                                                 int gridIntervalMinutes,
+                                                 int gridPointCount)
+{
+    if (data.isEmpty()) {
+        return ForecastSeries();
     }
-    
-    QList<WeatherData*> result;
-    int windowSize = qMax(1, windowMinutes);
-    
-    for (int i = 0; i < data.size(); ++i) {
-        WeatherData* smoothed = new WeatherData();
-        copyWeatherData(smoothed, data[i]); // Copy base data
-        
-        if (method == SimpleMovingAverage) {
-            // Calculate average of surrounding points
-            int startIdx = qMax(0, i - windowSize / 2);
-            int endIdx = qMin(data.size() - 1, i + windowSize / 2);
-            
-            double sumTemp = 0.0, sumPrecip = 0.0, sumWind = 0.0;
-            int count = 0;
-            
-            for (int j = startIdx; j <= endIdx; ++j) {
-                sumTemp += data[j]->temperature();
-                sumPrecip += data[j]->precipIntensity();
-                sumWind += data[j]->windSpeed();
-                count++;
-            }
-            
-            if (count > 0) {
-                smoothed->setTemperature(sumTemp / count);
-                smoothed->setPrecipIntensity(sumPrecip / count);
-                smoothed->setWindSpeed(sumWind / count);
-            }
-        } else if (method == ExponentialMovingAverage) {
-            // EMA with alpha = 2 / (windowSize + 1)
-            double alpha = 2.0 / (windowSize + 1);
-            
-            if (i > 0 && !result.isEmpty()) {
-                WeatherData* prev = result.last();
-                smoothed->setTemperature(alpha * data[i]->temperature() + (1 - alpha) * prev->temperature());
-                smoothed->setPrecipIntensity(alpha * data[i]->precipIntensity() + (1 - alpha) * prev->precipIntensity());
-                smoothed->setWindSpeed(alpha * data[i]->windSpeed() + (1 - alpha) * prev->windSpeed());
-            }
+
+    ForecastSeries sorted = data;
+    sorted.sortByTime();
+
+    const qint64 intervalMs = static_cast<qint64>(gridIntervalMinutes) * 60 * 1000;
+    ForecastSeries result = sorted.emptyCopy();
+    result.reserve(gridPointCount);
+    qint64 gridTime = gridStartMs;
+
+    for (int i = 0; i < gridPointCount; ++i, gridTime += intervalMs) {
+        int before = -1;
+        int after = -1;
+        if (!findBracketingPoints(sorted, gridTime, before, after)) {
+            continue;
+        }
+
+        WeatherSample aligned;
+        if (before >= 0 && after >= 0) {
+            aligned = linearInterpolate(sorted.at(before), sorted.at(after), gridTime);
+        } else {
+            aligned = sorted.at(before >= 0 ? before : after);
+            aligned.timestampMs = gridTime;
         }
-        
-        result.append(smoothed);
+        result.append(aligned);
     }
-    
+
     return result;
 }
 
@@ -199,163 +211,91 @@ QList<WeatherData*> TemporalInterpolator::alignToGrid(const QList<WeatherData*>&
                                                         int gridIntervalMinutes,
                                                         int gridPointCount)
 {
-    if (data.isEmpty()) {
-        return QList<WeatherData*>();
-    }
-    
-    QList<WeatherData*> result;
-    QDateTime gridTime = gridStartTime;
-    
-    for (int i = 0; i < gridPointCount; ++i) {
-        const WeatherData* before = nullptr;
-        const WeatherData* after = nullptr;
-        
-        if (findBracketingPoints(data, gridTime, before, after)) {
-            WeatherData* aligned = nullptr;
-            
-            if (before && after) {
-                aligned = linearInterpolate(before, after, gridTime);
-            } else if (before) {
-                aligned = new WeatherData();
-                copyWeatherData(aligned, before);
-                aligned->setTimestamp(gridTime);
-            } else if (after) {
-                aligned = new WeatherData();
-                copyWeatherData(aligned, after);
-                aligned->setTimestamp(gridTime);
-            }
-            
-            if (aligned) {
-                result.append(aligned);
-            }
-        }
-        
-        gridTime = gridTime.addSecs(gridIntervalMinutes * 60);
-    }
-    
-    return result;
+    return alignToGrid(ForecastSeries::fromWeatherData(data),
+                       ForecastSeries::toEpochMs(gridStartTime),
+                       gridIntervalMinutes, gridPointCount).toWeatherDataList();
 }
 
-WeatherData* TemporalInterpolator::linearInterpolate(const WeatherData* before,
-                                                       const WeatherData* after,
-                                                       const QDateTime& targetTime)
+WeatherSample TemporalInterpolator::linearInterpolate(const WeatherSample& before,
+                                                      const WeatherSample& after,
+                                                      qint64 targetMs) const
 {
-    if (!before || !after) {
-        return nullptr;
-    }
-    
-    WeatherData* result = new WeatherData();
-    result->setTimestamp(targetTime);
-    result->setLatitude(before->latitude());
-    result->setLongitude(before->longitude());
-    
-    qint64 timeBefore = before->timestamp().toSecsSinceEpoch();
-    qint64 timeAfter = after->timestamp().toSecsSinceEpoch();
-    qint64 timeTarget = targetTime.toSecsSinceEpoch();
-    
+    WeatherSample result;
+    result.timestampMs = targetMs;
+    result.latitude = before.latitude;
+    result.longitude = before.longitude;
+
+    const qint64 timeBefore = before.timestampMs;
+    const qint64 timeAfter = after.timestampMs;
+
     // Interpolate all numeric fields
-    result->setTemperature(interpolateValue(before->temperature(), after->temperature(),
-                                            timeBefore, timeAfter, timeTarget));
-    result->setFeelsLike(interpolateValue(before->feelsLike(), after->feelsLike(),
-                                          timeBefore, timeAfter, timeTarget));
-    result->setHumidity(static_cast<int>(interpolateValue(before->humidity(), after->humidity(),
-                                                          timeBefore, timeAfter, timeTarget)));
-    result->setPressure(interpolateValue(before->pressure(), after->pressure(),
-                                        timeBefore, timeAfter, timeTarget));
-    result->setWindSpeed(interpolateValue(before->windSpeed(), after->windSpeed(),
-                                         timeBefore, timeAfter, timeTarget));
-    result->setWindDirection(static_cast<int>(interpolateValue(before->windDirection(), after->windDirection(),
-                                                               timeBefore, timeAfter, timeTarget)));
-    result->setPrecipProbability(interpolateValue(before->precipProbability(), after->precipProbability(),
-                                                   timeBefore, timeAfter, timeTarget));
-    result->setPrecipIntensity(interpolateValue(before->precipIntensity(), after->precipIntensity(),
-                                               timeBefore, timeAfter, timeTarget));
-    result->setCloudCover(static_cast<int>(interpolateValue(before->cloudCover(), after->cloudCover(),
-                                                            timeBefore, timeAfter, timeTarget)));
-    result->setVisibility(static_cast<int>(interpolateValue(before->visibility(), after->visibility(),
-                                                            timeBefore, timeAfter, timeTarget)));
-    result->setUvIndex(static_cast<int>(interpolateValue(before->uvIndex(), after->uvIndex(),
-                                                         timeBefore, timeAfter, timeTarget)));
-    
+    result.temperature = interpolateValue(before.temperature, after.temperature,
+                                          timeBefore, timeAfter, targetMs);
+    result.feelsLike = interpolateValue(before.feelsLike, after.feelsLike,
+                                        timeBefore, timeAfter, targetMs);
+    result.humidity = static_cast<qint32>(interpolateValue(before.humidity, after.humidity,
+                                                           timeBefore, timeAfter, targetMs));
+    result.pressure = interpolateValue(before.pressure, after.pressure,
+                                       timeBefore, timeAfter, targetMs);
+    result.windSpeed = interpolateValue(before.windSpeed, after.windSpeed,
+                                        timeBefore, timeAfter, targetMs);
+    result.windDirection = static_cast<qint32>(interpolateValue(before.windDirection, after.windDirection,
+                                                                timeBefore, timeAfter, targetMs));
+    result.precipProbability = interpolateValue(before.precipProbability, after.precipProbability,
+                                                timeBefore, timeAfter, targetMs);
+    result.precipIntensity = interpolateValue(before.precipIntensity, after.precipIntensity,
+                                              timeBefore, timeAfter, targetMs);
+    result.cloudCover = static_cast<qint32>(interpolateValue(before.cloudCover, after.cloudCover,
+                                                             timeBefore, timeAfter, targetMs));
+    result.visibility = static_cast<qint32>(interpolateValue(before.visibility, after.visibility,
+                                                             timeBefore, timeAfter, targetMs));
+    result.uvIndex = static_cast<qint32>(interpolateValue(before.uvIndex, after.uvIndex,
+                                                          timeBefore, timeAfter, targetMs));
+
     // Use "before" value for categorical fields
-    result->setWeatherCondition(before->weatherCondition());
-    result->setWeatherDescription(before->weatherDescription());
-    
+    result.conditionId = before.conditionId;
+    result.descriptionId = before.descriptionId;
+
     return result;
 }
 
 double TemporalInterpolator::interpolateValue(double valueBefore, double valueAfter,
                                               qint64 timeBefore, qint64 timeAfter,
-                                              qint64 targetTime)
+                                              qint64 targetTime) const
 {
     if (timeBefore == timeAfter) {
         return valueBefore;
     }
-    
-    double fraction = static_cast<double>(targetTime - timeBefore) / 
+
+    double fraction = static_cast<double>(targetTime - timeBefore) /
                      static_cast<double>(timeAfter - timeBefore);
-    
+
     return valueBefore + fraction * (valueAfter - valueBefore);
 }
 
 
-bool TemporalInterpolator::findBracketingPoints(const QList<WeatherData*>& data,
-                                                const QDateTime& targetTime,
-                                                const WeatherData*& before,
-                                                const WeatherData*& after)
+bool TemporalInterpolator::findBracketingPoints(const ForecastSeries& data,
+                                                qint64 targetMs,
+                                                int& before,
+                                                int& after) const
 {
-    before = nullptr;
-    after = nullptr;
-    
-    for (int i = 0; i < data.size(); ++i) {
-        QDateTime dataTime = data[i]->timestamp();
-        
-        if (dataTime <= targetTime) {
-            before = data[i];
-        }
-        
-        if (dataTime >= targetTime && !after) {
-            after = data[i];
-            break;
-        }
+    // Binary search on the sorted timestamp column: "after" is the first
+    // sample at or past the target, "before" is that sample on an exact
+    // match or otherwise the one immediately preceding it.
+    const int index = data.lowerBound(targetMs);
+    after = index < data.size() ? index : -1;
+    if (after >= 0 && data.timestampAt(after) == targetMs) {
+        before = after;
+    } else {
+        before = index - 1;
     }
-    
-    return before != nullptr || after != nullptr;
-}
 
-// Helper function to copy WeatherData (QObject doesn't support assignment)
-void copyWeatherData(WeatherData* dest, const WeatherData* src) {
-    dest->setLatitude(src->latitude());
-    dest->setLongitude(src->longitude());
-    dest->setTimestamp(src->timestamp());
-    dest->setTemperature(src->temperature());
-    dest->setFeelsLike(src->feelsLike());
-    dest->setHumidity(src->humidity());
-    dest->setPressure(src->pressure());
-    dest->setWindSpeed(src->windSpeed());
-    dest->setWindDirection(src->windDirection());
-    dest->setPrecipProbability(src->precipProbability());
-    dest->setPrecipIntensity(src->precipIntensity());
-    dest->setCloudCover(src->cloudCover());
-    dest->setVisibility(src->visibility());
-    dest->setUvIndex(src->uvIndex());
-    dest->setWeatherCondition(src->weatherCondition());
-    dest->setWeatherDescription(src->weatherDescription());
+    return before >= 0 || after >= 0;
 }
 
-QDateTime roundToNearestMinute(const QDateTime& dt) {
-    QDateTime rounded = dt;
-    int msecs = rounded.time().msec();
-    if (msecs != 0) {
-        rounded = rounded.addMSecs(-msecs);
-    }
-    int secs = rounded.time().second();
-    if (secs >= 30) {
-        rounded = rounded.addSecs(60 - secs);
-    } else {
-        rounded = rounded.addSecs(-secs);
-    }
-    rounded.setTime(QTime(rounded.time().hour(), rounded.time().minute(), 0, 0));
-    return rounded;
+qint64 roundToNearestMinute(qint64 timestampMs) {
+    const qint64 secs = timestampMs / 1000;
+    const qint64 secOfMinute = secs % 60;
+    const qint64 minuteStart = secs - secOfMinute;
+    return (secOfMinute >= 30 ? minuteStart + 60 : minuteStart) * 1000;
 }
-
@@ -5,6 +5,7 @@
 #include <QList>
 #include <QDateTime>
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
 
 /**
  * @brief Handles temporal interpolation and smoothing of weather forecasts
@@ -12,6 +13,10 @@
  * Supports linear interpolation between forecast time steps and optional
  * moving average smoothing. Designed to work with variable time-step APIs
  * (e.g., hourly, 15-minute) and produce consistent output granularity.
+ * 
+ * The ForecastSeries overloads are the primary implementation; the
+ * QList<WeatherData*> overloads convert at the boundary for callers that
+ * still work with QObjects.
  */
 class TemporalInterpolator : public QObject
 {
@@ -40,6 +45,9 @@ public:
      * @param method Interpolation method to use
      * @return Interpolated forecast data at regular intervals
      */
+    ForecastSeries interpolate(const ForecastSeries& sourceData,
+                               int outputGranularityMinutes,
+                               InterpolationMethod method = Linear);
     QList<WeatherData*> interpolate(const QList<WeatherData*>& sourceData,
                                      int outputGranularityMinutes,
                                      InterpolationMethod method = Linear);
@@ -51,6 +59,9 @@ public:
      * @param method Smoothing method to use
      * @return Smoothed forecast data
      */
+    ForecastSeries smooth(const ForecastSeries& data,
+                          int windowMinutes,
+                          SmoothingMethod method = SimpleMovingAverage);
     QList<WeatherData*> smooth(const QList<WeatherData*>& data,
                                int windowMinutes,
                                SmoothingMethod method = SimpleMovingAverage);
@@ -58,11 +69,15 @@ public:
     /**
      * @brief Align forecast data to a common time grid
      * @param data Forecast data to align
-     * @param gridStartTime Start time of the grid
+     * @param gridStartTime Start time of the grid (epoch ms for the series overload)
      * @param gridIntervalMinutes Interval between grid points
      * @param gridPointCount Number of grid points
      * @return Data aligned to grid (interpolated if necessary)
      */
+    ForecastSeries alignToGrid(const ForecastSeries& data,
+                               qint64 gridStartMs,
+                               int gridIntervalMinutes,
+                               int gridPointCount);
     QList<WeatherData*> alignToGrid(const QList<WeatherData*>& data,
                                      const QDateTime& gridStartTime,
                                      int gridIntervalMinutes,
@@ -79,26 +94,30 @@ public:
     
 private:
     /**
-     * @brief Linear interpolation between two weather data points
+     * @brief Linear interpolation between two weather samples
      */
-    WeatherData* linearInterpolate(const WeatherData* before,
-                                    const WeatherData* after,
-                                    const QDateTime& targetTime);
+    WeatherSample linearInterpolate(const WeatherSample& before,
+                                    const WeatherSample& after,
+                                    qint64 targetMs) const;
     
     /**
      * @brief Interpolate a single numeric value
      */
     double interpolateValue(double valueBefore, double valueAfter,
                            qint64 timeBefore, qint64 timeAfter,
-                           qint64 targetTime);
+                           qint64 targetTime) const;
     
     /**
-     * @brief Find the two data points bracketing a target time
+     * @brief Find the indices of the two samples bracketing a target time
+     * @param data Time-sorted series
+     * @param targetMs Target time in epoch milliseconds
+     * @param before Set to the last index at or before the target, or -1
+     * @param after Set to the first index at or after the target, or -1
      */
-    bool findBracketingPoints(const QList<WeatherData*>& data,
-                             const QDateTime& targetTime,
-                             const WeatherData*& before,
-                             const WeatherData*& after);
+    bool findBracketingPoints(const ForecastSeries& data,
+                             qint64 targetMs,
+                             int& before,
+                             int& after) const;
     
     InterpolationMethod m_interpolationMethod;
     SmoothingMethod m_smoothingMethod;
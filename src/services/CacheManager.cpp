@@ -1,111 +1,288 @@
 #include "services/CacheManager.h"
+#include "database/DatabaseManager.h"
 #include <QDebug>
 #include <QMutexLocker>
-#include <QStringList>
-#include <QDateTime>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+// Queued writes that trigger an immediate flush instead of waiting for the timer
+constexpr int WriteBehindBatchSize = 64;
+} // namespace
+
+/**
+ * @brief One independently locked LRU partition of the cache
+ */
+struct CacheManager::Shard {
+    QHash<QString, CacheEntry*> index;
+    CacheEntry* head = nullptr;  // Least recently used
+    CacheEntry* tail = nullptr;  // Most recently used
+    int maxSize = 0;
+    mutable QMutex mutex;
+    
+    ~Shard() {
+        qDeleteAll(index);
+    }
+    
+    void evictLRU() {
+        if (!head) {
+            return;
+        }
+        
+        removeEntry(head);
+    }
+    
+    void updateAccessTime(CacheEntry* entry) {
+        // Move to tail of access order (most recently used)
+        if (entry == tail) {
+            return;
+        }
+        unlink(entry);
+        linkAtTail(entry);
+    }
+    
+    void removeEntry(CacheEntry* entry) {
+        unlink(entry);
+        index.remove(entry->key);
+        delete entry;
+    }
+    
+    void linkAtTail(CacheEntry* entry) {
+        entry->prev = tail;
+        entry->next = nullptr;
+        if (tail) {
+            tail->next = entry;
+        } else {
+            head = entry;
+        }
+        tail = entry;
+    }
+    
+    void unlink(CacheEntry* entry) {
+        if (entry->prev) {
+            entry->prev->next = entry->next;
+        } else {
+            head = entry->next;
+        }
+        if (entry->next) {
+            entry->next->prev = entry->prev;
+        } else {
+            tail = entry->prev;
+        }
+        entry->prev = nullptr;
+        entry->next = nullptr;
+    }
+    
+    void clear() {
+        qDeleteAll(index);
+        index.clear();
+        head = nullptr;
+        tail = nullptr;
+    }
+};
 
 CacheManager::CacheManager(int maxSize, QObject *parent)
+    : CacheManager(maxSize, 1, parent)
+{
+}
+
+CacheManager::CacheManager(int maxSize, int shardCount, QObject *parent)
     : QObject(parent)
     , m_maxSize(maxSize)
+    , m_database(nullptr)
+    , m_flushTimer(new QTimer(this))
 {
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &CacheManager::flush);
+    
+    const int count = qMax(1, shardCount);
+    const int perShard = qMax(1, (maxSize + count - 1) / count);
+    m_shards.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Shard* shard = new Shard;
+        shard->maxSize = perShard;
+        m_shards.append(shard);
+    }
 }
 
 CacheManager::~CacheManager() {
-    clear();
+    flush();
+    qDeleteAll(m_shards);
 }
 
 QVariant CacheManager::get(const QString& key) {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_cache.contains(key)) {
-        return QVariant();
+    bool isStale = false;
+    return lookup(key, false, isStale);
+}
+
+QVariant CacheManager::getAllowStale(const QString& key, bool& isStale) {
+    return lookup(key, true, isStale);
+}
+
+QVariant CacheManager::lookup(const QString& key, bool allowStale, bool& isStale) {
+    isStale = false;
+    {
+        Shard* shard = shardFor(key);
+        QMutexLocker locker(&shard->mutex);
+        
+        CacheEntry* entry = shard->index.value(key, nullptr);
+        if (entry) {
+            // Check if expired
+            if (!entry->isExpired()) {
+                // Stale entries stay cached for callers that accept them
+                isStale = entry->isStale();
+                if (isStale && !allowStale) {
+                    return QVariant();
+                }
+                // Update access order
+                shard->updateAccessTime(entry);
+                return entry->data;
+            }
+            shard->removeEntry(entry);
+        }
     }
     
-    CacheEntry& entry = m_cache[key];
+    return readThrough(key, allowStale, isStale);
+}
+
+void CacheManager::put(const QString& key, const QVariant& value, int ttlSeconds) {
+    put(key, value, ttlSeconds, ttlSeconds);
+}
+
+void CacheManager::put(const QString& key, const QVariant& value, int softTtlSeconds, int hardTtlSeconds) {
+    const int hardTtl = qMax(0, hardTtlSeconds);
+    const int softTtl = qBound(0, softTtlSeconds, hardTtl);
+    storeInMemory(key, value,
+                  QDeadlineTimer(static_cast<qint64>(softTtl) * 1000),
+                  QDeadlineTimer(static_cast<qint64>(hardTtl) * 1000));
     
-    // Check if expired
-    if (entry.isExpired()) {
-        m_cache.remove(key);
-        m_accessOrder.removeAll(key);
-        return QVariant();
+    if (m_database && value.userType() == QMetaType::fromType<QByteArray>().id()) {
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        PendingWrite write;
+        write.data = value.toByteArray();
+        write.staleAt = now.addSecs(softTtl);
+        write.expiresAt = now.addSecs(hardTtl);
+        queueWrite(key, write);
     }
-    
-    // Update access time
-    entry.lastAccessed = QDateTime::currentDateTime();
-    updateAccessTime(key);
-    
-    return entry.data;
 }
 
-void CacheManager::put(const QString& key, const QVariant& value, int ttlSeconds) {
-    QMutexLocker locker(&m_mutex);
+void CacheManager::storeInMemory(const QString& key, const QVariant& value,
+                                 const QDeadlineTimer& staleAt, const QDeadlineTimer& expiresAt) {
+    Shard* shard = shardFor(key);
+    QMutexLocker locker(&shard->mutex);
     
-    // Remove if already exists
-    if (m_cache.contains(key)) {
-        m_accessOrder.removeAll(key);
+    // Refresh in place if already exists
+    CacheEntry* existing = shard->index.value(key, nullptr);
+    if (existing) {
+        existing->data = value;
+        existing->staleAt = staleAt;
+        existing->expiresAt = expiresAt;
+        shard->updateAccessTime(existing);
+        return;
     }
     
     // Check if we need to evict
-    while (m_cache.size() >= m_maxSize && !m_cache.isEmpty()) {
-        evictLRU();
+    while (shard->index.size() >= shard->maxSize && !shard->index.isEmpty()) {
+        shard->evictLRU();
     }
     
     // Add new entry
-    QDateTime expiresAt = QDateTime::currentDateTime().addSecs(ttlSeconds);
-    m_cache[key] = CacheEntry(value, expiresAt);
-    m_accessOrder.append(key);
+    CacheEntry* entry = new CacheEntry(key, value, staleAt, expiresAt);
+    shard->index.insert(key, entry);
+    shard->linkAtTail(entry);
 }
 
 void CacheManager::remove(const QString& key) {
-    QMutexLocker locker(&m_mutex);
-    m_cache.remove(key);
-    m_accessOrder.removeAll(key);
+    {
+        Shard* shard = shardFor(key);
+        QMutexLocker locker(&shard->mutex);
+        CacheEntry* entry = shard->index.value(key, nullptr);
+        if (entry) {
+            shard->removeEntry(entry);
+        }
+    }
+    
+    if (m_database) {
+        PendingWrite removal;
+        removal.remove = true;
+        queueWrite(key, removal);
+    }
 }
 
 bool CacheManager::contains(const QString& key) {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_cache.contains(key)) {
-        return false;
-    }
-    
-    if (m_cache[key].isExpired()) {
-        m_cache.remove(key);
-        m_accessOrder.removeAll(key);
-        return false;
+    {
+        Shard* shard = shardFor(key);
+        QMutexLocker locker(&shard->mutex);
+        
+        CacheEntry* entry = shard->index.value(key, nullptr);
+        if (entry) {
+            if (!entry->isExpired()) {
+                return !entry->isStale();
+            }
+            shard->removeEntry(entry);
+        }
     }
     
-    return true;
+    bool isStale = false;
+    return readThrough(key, false, isStale).isValid();
 }
 
 void CacheManager::clear() {
-    QMutexLocker locker(&m_mutex);
-    m_cache.clear();
-    m_accessOrder.clear();
+    for (Shard* shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        shard->clear();
+    }
 }
 
 int CacheManager::size() const {
-    QMutexLocker locker(&m_mutex);
-    return m_cache.size();
+    int total = 0;
+    for (const Shard* shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        total += shard->index.size();
+    }
+    return total;
 }
 
 int CacheManager::maxSize() const {
     return m_maxSize;
 }
 
+int CacheManager::shardCount() const {
+    return m_shards.size();
+}
+
 void CacheManager::cleanupExpired() {
-    QMutexLocker locker(&m_mutex);
+    for (Shard* shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        
+        CacheEntry* entry = shard->head;
+        while (entry) {
+            CacheEntry* next = entry->next;
+            if (entry->isExpired()) {
+                shard->removeEntry(entry);
+            }
+            entry = next;
+        }
+    }
     
-    QStringList keysToRemove;
-    for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
-        if (it.value().isExpired()) {
-            keysToRemove.append(it.key());
+    if (!m_database) {
+        return;
+    }
+    
+    {
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        QMutexLocker locker(&m_pendingMutex);
+        for (auto it = m_pendingWrites.begin(); it != m_pendingWrites.end();) {
+            if (!it->remove && it->expiresAt <= now) {
+                it = m_pendingWrites.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
     
-    for (const QString& key : keysToRemove) {
-        m_cache.remove(key);
-        m_accessOrder.removeAll(key);
+    if (isOwnerThread()) {
+        m_database->cleanupExpiredCache();
     }
 }
 
@@ -117,18 +294,143 @@ QString CacheManager::generateKey(const QString& prefix, double lat, double lon,
     return key;
 }
 
-void CacheManager::evictLRU() {
-    if (m_accessOrder.isEmpty()) {
+CacheManager::Shard* CacheManager::shardFor(const QString& key) const {
+    if (m_shards.size() == 1) {
+        return m_shards.first();
+    }
+    return m_shards.at(static_cast<int>(qHash(key) % static_cast<size_t>(m_shards.size())));
+}
+
+void CacheManager::setPersistentStore(DatabaseManager* database, int flushIntervalMs) {
+    if (m_database && m_database != database) {
+        flush();
+    }
+    m_database = database;
+    m_flushTimer->setInterval(qMax(0, flushIntervalMs));
+}
+
+void CacheManager::flush() {
+    if (!m_database) {
+        return;
+    }
+    
+    // The database connection belongs to the owner thread
+    if (!isOwnerThread()) {
+        QMetaObject::invokeMethod(this, &CacheManager::flush, Qt::QueuedConnection);
         return;
     }
     
-    QString keyToRemove = m_accessOrder.takeFirst();
-    m_cache.remove(keyToRemove);
+    QHash<QString, PendingWrite> batch;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        batch.swap(m_pendingWrites);
+    }
+    m_flushTimer->stop();
+    
+    if (batch.isEmpty()) {
+        return;
+    }
+    
+    QList<DatabaseManager::CacheRow> writes;
+    QStringList deletes;
+    writes.reserve(batch.size());
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (auto it = batch.constBegin(); it != batch.constEnd(); ++it) {
+        if (it->remove) {
+            deletes.append(it.key());
+        } else if (it->expiresAt > now) {
+            writes.append({it.key(), it->data, it->expiresAt, it->staleAt});
+        }
+    }
+    
+    if (!m_database->applyCacheBatch(writes, deletes)) {
+        qWarning() << "Failed to persist" << batch.size() << "cache entries; retrying on the next flush";
+        {
+            // Entries queued since the swap are newer and win
+            QMutexLocker locker(&m_pendingMutex);
+            for (auto it = batch.constBegin(); it != batch.constEnd(); ++it) {
+                if (!m_pendingWrites.contains(it.key())) {
+                    m_pendingWrites.insert(it.key(), it.value());
+                }
+            }
+        }
+        m_flushTimer->start();
+    }
 }
 
-void CacheManager::updateAccessTime(const QString& key) {
-    // Move to end of access order (most recently used)
-    m_accessOrder.removeAll(key);
-    m_accessOrder.append(key);
+int CacheManager::pendingWriteCount() const {
+    QMutexLocker locker(&m_pendingMutex);
+    return m_pendingWrites.size();
 }
 
+QVariant CacheManager::readThrough(const QString& key, bool allowStale, bool& isStale) {
+    isStale = false;
+    if (!m_database) {
+        return QVariant();
+    }
+    
+    QByteArray data;
+    QDateTime staleAt;
+    QDateTime expiresAt;
+    bool found = false;
+    
+    // Queued writes are newer than anything in the database
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        auto it = m_pendingWrites.constFind(key);
+        if (it != m_pendingWrites.constEnd()) {
+            if (it->remove) {
+                return QVariant();
+            }
+            data = it->data;
+            staleAt = it->staleAt;
+            expiresAt = it->expiresAt;
+            found = true;
+        }
+    }
+    
+    if (!found) {
+        if (!isOwnerThread() || !m_database->getCacheEntry(key, data, staleAt, expiresAt)) {
+            return QVariant();
+        }
+    }
+    
+    // Carry the remaining TTLs over to the in-memory tier
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const qint64 remainingMs = now.msecsTo(expiresAt);
+    if (remainingMs <= 0) {
+        return QVariant();
+    }
+    const qint64 freshMs = qBound<qint64>(0, now.msecsTo(staleAt), remainingMs);
+    
+    QVariant value(data);
+    storeInMemory(key, value, QDeadlineTimer(freshMs), QDeadlineTimer(remainingMs));
+    
+    isStale = freshMs == 0;
+    if (isStale && !allowStale) {
+        return QVariant();
+    }
+    return value;
+}
+
+void CacheManager::queueWrite(const QString& key, const PendingWrite& write) {
+    bool flushNow = false;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_pendingWrites.insert(key, write);
+        flushNow = m_pendingWrites.size() >= WriteBehindBatchSize;
+    }
+    
+    // The timer and database live on the owner thread
+    QMetaObject::invokeMethod(this, [this, flushNow]() {
+        if (flushNow) {
+            flush();
+        } else if (!m_flushTimer->isActive()) {
+            m_flushTimer->start();
+        }
+    });
+}
+
+bool CacheManager::isOwnerThread() const {
+    return QThread::currentThread() == thread();
+}
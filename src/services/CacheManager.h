@@ -2,18 +2,40 @@
 #define CACHEMANAGER_H
 
 #include <QObject>
-#include <QMap>
-#include <QList>
 #include <QString>
+#include <QByteArray>
 #include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHash>
 #include <QMutex>
 #include <QVariant>
+#include <QVector>
+
+class DatabaseManager;
+class QTimer;
 
 /**
  * @brief LRU cache manager with TTL support
  * 
  * Thread-safe in-memory cache implementation using Least Recently Used (LRU)
  * eviction policy and Time-To-Live (TTL) expiration.
+ * 
+ * Entries are indexed by a hash map and threaded on an intrusive doubly-linked
+ * list in access order, so get, put and eviction are O(1) regardless of size.
+ * Expiry uses a monotonic clock and is unaffected by wall-clock changes.
+ * 
+ * In sharded mode the key space is split by hash across independent shards,
+ * each with its own index, LRU list, capacity and lock, so threads touching
+ * different keys rarely contend. Eviction is LRU within a shard.
+ * 
+ * With a persistent store attached the cache is two-tier: QByteArray values
+ * are written behind in batches to the SQLite forecast_cache table (L2) and
+ * read through into memory (L1) on a miss, so a restart starts warm. Both
+ * tiers honor the entry's TTL.
+ * 
+ * An entry may carry a soft TTL shorter than its hard TTL. Between the two it
+ * is stale: get() treats it as a miss, but getAllowStale() still returns it so
+ * callers can serve it immediately while they revalidate in the background.
  */
 class CacheManager : public QObject
 {
@@ -21,19 +43,28 @@ class CacheManager : public QObject
     
 public:
     /**
-     * @brief Cache entry structure
+     * @brief Cache entry structure (also a node of the LRU list)
      */
     struct CacheEntry {
+        QString key;
         QVariant data;
-        QDateTime expiresAt;
-        QDateTime lastAccessed;
+        QDeadlineTimer staleAt;       // Soft TTL
+        QDeadlineTimer expiresAt;     // Hard TTL
+        CacheEntry* prev = nullptr;   // Toward least recently used
+        CacheEntry* next = nullptr;   // Toward most recently used
+        
+        CacheEntry(const QString& k, const QVariant& d, const QDeadlineTimer& exp)
+            : key(k), data(d), staleAt(exp), expiresAt(exp) {}
         
-        CacheEntry() = default;
-        CacheEntry(const QVariant& d, const QDateTime& exp)
-            : data(d), expiresAt(exp), lastAccessed(QDateTime::currentDateTime()) {}
+        CacheEntry(const QString& k, const QVariant& d, const QDeadlineTimer& stale, const QDeadlineTimer& exp)
+            : key(k), data(d), staleAt(stale), expiresAt(exp) {}
+        
+        bool isStale() const {
+            return staleAt.hasExpired();
+        }
         
         bool isExpired() const {
-            return QDateTime::currentDateTime() > expiresAt;
+            return expiresAt.hasExpired();
         }
     };
     
@@ -42,16 +73,32 @@ public:
      * @param maxSize Maximum number of entries in cache
      * @param parent Parent QObject
      */
-    explicit CacheManager(int maxSize = 100, QObject *parent = nullptr);
+    explicit CacheManager(int maxSize = 10000, QObject *parent = nullptr);
+    
+    /**
+     * @brief Constructor for sharded mode
+     * @param maxSize Maximum number of entries across all shards
+     * @param shardCount Number of independently locked shards
+     * @param parent Parent QObject
+     */
+    CacheManager(int maxSize, int shardCount, QObject *parent = nullptr);
     ~CacheManager() override;
     
     /**
      * @brief Get value from cache
      * @param key Cache key
-     * @return Cached value or invalid QVariant if not found/expired
+     * @return Cached value or invalid QVariant if not found, stale or expired
      */
     QVariant get(const QString& key);
     
+    /**
+     * @brief Get value from cache, including entries past their soft TTL
+     * @param key Cache key
+     * @param isStale Set to true if the returned value is past its soft TTL
+     * @return Cached value or invalid QVariant if not found/expired
+     */
+    QVariant getAllowStale(const QString& key, bool& isStale);
+    
     /**
      * @brief Store value in cache
      * @param key Cache key
@@ -60,6 +107,15 @@ public:
      */
     void put(const QString& key, const QVariant& value, int ttlSeconds = 3600);
     
+    /**
+     * @brief Store value in cache with separate freshness and expiry
+     * @param key Cache key
+     * @param value Value to cache
+     * @param softTtlSeconds Time until the value becomes stale
+     * @param hardTtlSeconds Time until the value is discarded
+     */
+    void put(const QString& key, const QVariant& value, int softTtlSeconds, int hardTtlSeconds);
+    
     /**
      * @brief Remove entry from cache
      * @param key Cache key
@@ -67,14 +123,14 @@ public:
     void remove(const QString& key);
     
     /**
-     * @brief Check if key exists in cache and is not expired
+     * @brief Check if key exists in cache and is neither stale nor expired
      * @param key Cache key
      * @return true if key exists and is valid
      */
     bool contains(const QString& key);
     
     /**
-     * @brief Clear all cache entries
+     * @brief Clear all in-memory entries (the persistent tier is left intact)
      */
     void clear();
     
@@ -83,6 +139,7 @@ public:
      */
     int size() const;
     int maxSize() const;
+    int shardCount() const;
     
     /**
      * @brief Clean up expired entries
@@ -94,14 +151,53 @@ public:
      */
     static QString generateKey(const QString& prefix, double lat, double lon, const QString& suffix = "");
     
+    /**
+     * @brief Attach the persistent second tier
+     * 
+     * The database is only touched from the thread that owns this object;
+     * lookups from other threads see the in-memory tier and queued writes.
+     * Attach before sharing the cache across threads.
+     * @param database Initialized database manager, or nullptr to detach
+     * @param flushIntervalMs Delay before queued writes are flushed
+     */
+    void setPersistentStore(DatabaseManager* database, int flushIntervalMs = 1000);
+    bool hasPersistentStore() const { return m_database != nullptr; }
+    
+    /**
+     * @brief Write queued entries and removals to the persistent tier now
+     */
+    void flush();
+    int pendingWriteCount() const;
+    
 private:
-    void evictLRU();
-    void updateAccessTime(const QString& key);
+    struct Shard;
     
-    QMap<QString, CacheEntry> m_cache;
-    QList<QString> m_accessOrder;  // LRU tracking
-    mutable QMutex m_mutex;
+    /**
+     * @brief Write-behind record; remove marks a queued deletion
+     */
+    struct PendingWrite {
+        QByteArray data;
+        QDateTime staleAt;
+        QDateTime expiresAt;
+        bool remove = false;
+    };
+    
+    Shard* shardFor(const QString& key) const;
+    QVariant lookup(const QString& key, bool allowStale, bool& isStale);
+    void storeInMemory(const QString& key, const QVariant& value,
+                       const QDeadlineTimer& staleAt, const QDeadlineTimer& expiresAt);
+    QVariant readThrough(const QString& key, bool allowStale, bool& isStale);
+    void queueWrite(const QString& key, const PendingWrite& write);
+    bool isOwnerThread() const;
+    
+    QVector<Shard*> m_shards;
     int m_maxSize;
+    
+    // Persistent tier
+    DatabaseManager* m_database;
+    QTimer* m_flushTimer;
+    QHash<QString, PendingWrite> m_pendingWrites;
+    mutable QMutex m_pendingMutex;
 };
 
 #endif // CACHEMANAGER_H
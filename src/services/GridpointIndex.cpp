@@ -0,0 +1,64 @@
+#include "services/GridpointIndex.h"
+#include "database/DatabaseManager.h"
+#include <QtMath>
+
+namespace {
+constexpr double KmPerDegreeLatitude = 111.32;
+constexpr double CellDegrees = GridpointIndex::CellSizeKm / KmPerDegreeLatitude;
+} // namespace
+
+GridpointIndex::Cell GridpointIndex::cellOf(double latitude, double longitude) {
+    Cell cell;
+    cell.row = qFloor(latitude / CellDegrees);
+
+    // Width of the cell in degrees of longitude at the band's centre; near
+    // the poles the band is capped so columns stay finite
+    const double bandLatitude = (cell.row + 0.5) * CellDegrees;
+    const double cosine = qMax(0.01, qCos(qDegreesToRadians(bandLatitude)));
+    cell.col = qFloor(longitude * cosine / CellDegrees);
+    return cell;
+}
+
+bool GridpointIndex::lookup(double latitude, double longitude, Gridpoint& gridpoint) {
+    const Cell cell = cellOf(latitude, longitude);
+    auto it = m_cells.constFind(cell.key());
+    if (it != m_cells.constEnd()) {
+        ++m_hits;
+        gridpoint = *it;
+        return true;
+    }
+
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    DatabaseManager::NwsGridpoint stored;
+    if (!m_persistent || !dbManager->isInitialized() || !dbManager->getNwsGridpoint(cell.row, cell.col, stored)) {
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    gridpoint.office = stored.office;
+    gridpoint.x = stored.x;
+    gridpoint.y = stored.y;
+    m_cells.insert(cell.key(), gridpoint);
+    return true;
+}
+
+void GridpointIndex::insert(double latitude, double longitude, const Gridpoint& gridpoint) {
+    if (!gridpoint.isValid()) {
+        return;
+    }
+
+    const Cell cell = cellOf(latitude, longitude);
+    m_cells.insert(cell.key(), gridpoint);
+
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (m_persistent && dbManager->isInitialized()) {
+        DatabaseManager::NwsGridpoint stored;
+        stored.cellRow = cell.row;
+        stored.cellCol = cell.col;
+        stored.office = gridpoint.office;
+        stored.x = gridpoint.x;
+        stored.y = gridpoint.y;
+        dbManager->saveNwsGridpoint(stored);
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef GRIDPOINTINDEX_H
+#define GRIDPOINTINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Local point-to-gridpoint lookup for the NWS API
+ *
+ * NWS forecasts are issued per 2.5 km grid square, addressed by an office
+ * and an (x, y) index that only the /points endpoint can resolve. This
+ * index buckets coordinates into cells of the same size and remembers the
+ * resolution of each cell, so any later coordinate in a known cell skips
+ * the /points round trip.
+ *
+ * Resolutions are held in memory and written through to the nws_gridpoints
+ * table when the database is initialized; a cell missing from memory is
+ * read from the table, so a restart starts warm.
+ *
+ * The cells are not aligned with the NWS grid, so a point close to a cell
+ * edge may be answered with the neighbouring square. Neighbouring squares
+ * are 2.5 km apart, well within forecast resolution.
+ *
+ * Not thread-safe; use from the owning service's thread.
+ */
+class GridpointIndex
+{
+public:
+    static constexpr double CellSizeKm = 2.5;
+
+    /**
+     * @brief A square of roughly CellSizeKm on each side
+     */
+    struct Cell {
+        int row = 0;
+        int col = 0;
+
+        quint64 key() const { return (quint64(quint32(row)) << 32) | quint32(col); }
+        bool operator==(const Cell& other) const { return row == other.row && col == other.col; }
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief NWS grid square for a cell
+     */
+    struct Gridpoint {
+        QString office;
+        int x = -1;
+        int y = -1;
+
+        bool isValid() const { return !office.isEmpty() && x >= 0 && y >= 0; }
+    };
+
+    /**
+     * @param persistent Read and write the nws_gridpoints table (when the database is initialized)
+     */
+    explicit GridpointIndex(bool persistent = true) : m_persistent(persistent) {}
+
+    /**
+     * @brief Cell containing a coordinate
+     *
+     * Rows are bands of latitude; columns are narrowed by the band's
+     * latitude so cells stay roughly square.
+     */
+    static Cell cellOf(double latitude, double longitude);
+
+    /**
+     * @brief Gridpoint for the cell containing the coordinate
+     * @return false when the cell has not been resolved yet
+     */
+    bool lookup(double latitude, double longitude, Gridpoint& gridpoint);
+
+    /**
+     * @brief Record the resolution of a coordinate for its whole cell
+     */
+    void insert(double latitude, double longitude, const Gridpoint& gridpoint);
+
+    /**
+     * @brief Drop the in-memory entries (persisted ones are read back on demand)
+     */
+    void clear() { m_cells.clear(); }
+
+    int size() const { return m_cells.size(); }
+
+    /**
+     * @brief Lookups answered from memory or the database
+     */
+    qint64 hits() const { return m_hits; }
+    qint64 misses() const { return m_misses; }
+
+private:
+    QHash<quint64, Gridpoint> m_cells;
+    bool m_persistent;
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+};
+
+#endif // GRIDPOINTINDEX_H
@@ -1,20 +1,307 @@
 #include "services/HistoricalDataManager.h"
 #include "database/DatabaseManager.h"
+#include "database/StatementCache.h"
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
+#include "models/ArchiveCodec.h"
+#include "services/SqliteHistoricalStore.h"
+#include "services/MappedHistoricalStore.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
-#include <QJsonDocument>
 #include <QDateTime>
+#include <QVariantList>
+#include <QMap>
+#include <QSet>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QtMath>
+#include <algorithm>
+#include <tuple>
+
+namespace {
+constexpr double EarthRadiusKm = 6371.0;
+constexpr double KmPerDegreeLatitude = 111.32;
+
+// Archived partitions are <archive directory>/<partition name>.hlwa
+const char ArchiveDirectoryName[] = "historical_archive";
+const char ArchiveSuffix[] = ".hlwa";
+
+// Mapped backend segments live in <database directory>/historical_segments
+const char SegmentDirectoryName[] = "historical_segments";
+
+// Sample columns in the order sampleFromRow() reads them
+const char SampleColumns[] = R"(ts, temperature, feels_like, precip_probability, precip_intensity,
+               wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index,
+               weather_condition, weather_description)";
+
+// Read SampleColumns starting at column; strings are interned into strings
+WeatherSample sampleFromRow(const QSqlQuery& query, int column, ForecastSeries& strings) {
+    WeatherSample sample;
+    sample.timestampMs = query.value(column).toLongLong() * 1000;
+    sample.temperature = query.value(column + 1).toDouble();
+    sample.feelsLike = query.value(column + 2).toDouble();
+    sample.precipProbability = query.value(column + 3).toDouble();
+    sample.precipIntensity = query.value(column + 4).toDouble();
+    sample.windSpeed = query.value(column + 5).toDouble();
+    sample.windDirection = query.value(column + 6).toInt();
+    sample.humidity = query.value(column + 7).toInt();
+    sample.pressure = query.value(column + 8).toDouble();
+    sample.cloudCover = query.value(column + 9).toInt();
+    sample.visibility = query.value(column + 10).toInt();
+    sample.uvIndex = query.value(column + 11).toInt();
+    sample.conditionId = strings.internString(query.value(column + 12).toString());
+    sample.descriptionId = strings.internString(query.value(column + 13).toString());
+    return sample;
+}
+
+// Forward-only range scan of one series in one partition, oldest first; sink
+// is called with the query positioned on each row and returns false to stop
+template <typename Sink>
+bool scanPartitionRows(QSqlDatabase db, const QString& partition, qint64 latKey, qint64 lonKey,
+                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                       QString& errorText, Sink sink) {
+    // Equality on the snapped location plus a time range is a primary key range scan
+    QString sql = QString(R"(
+        SELECT %1
+        FROM %2
+        WHERE lat_udeg = ?
+          AND lon_udeg = ?
+          AND ts >= ?
+          AND ts <= ?
+    )").arg(SampleColumns, partition);
+    
+    if (!source.isEmpty()) {
+        sql += " AND source = ?";
+    }
+    
+    sql += " ORDER BY ts ASC";
+    
+    PreparedQuery query(db, sql);
+    query->setForwardOnly(true);
+    query->addBindValue(latKey);
+    query->addBindValue(lonKey);
+    query->addBindValue(fromSecs);
+    query->addBindValue(toSecs);
+    
+    if (!source.isEmpty()) {
+        query->addBindValue(source);
+    }
+    
+    if (!query->exec()) {
+        errorText = query->lastError().text();
+        return false;
+    }
+    
+    while (query->next()) {
+        if (!sink(*query)) {
+            break;
+        }
+    }
+    return true;
+}
+
+// Bind one list per SampleColumns value column (all but ts) for rows of series
+void bindSampleValues(QSqlQuery& query, const ForecastSeries& series, const QVector<int>& rows) {
+    QVariantList temperatures, feelsLikes, precipProbabilities, precipIntensities, windSpeeds,
+        windDirections, humidities, pressures, cloudCovers, visibilities, uvIndexes,
+        conditions, descriptions;
+    for (int i : rows) {
+        const WeatherSample sample = series.at(i);
+        temperatures << sample.temperature;
+        feelsLikes << sample.feelsLike;
+        precipProbabilities << sample.precipProbability;
+        precipIntensities << sample.precipIntensity;
+        windSpeeds << sample.windSpeed;
+        windDirections << sample.windDirection;
+        humidities << sample.humidity;
+        pressures << sample.pressure;
+        cloudCovers << sample.cloudCover;
+        visibilities << sample.visibility;
+        uvIndexes << sample.uvIndex;
+        conditions << series.stringAt(sample.conditionId);
+        descriptions << series.stringAt(sample.descriptionId);
+    }
+    
+    query.addBindValue(temperatures);
+    query.addBindValue(feelsLikes);
+    query.addBindValue(precipProbabilities);
+    query.addBindValue(precipIntensities);
+    query.addBindValue(windSpeeds);
+    query.addBindValue(windDirections);
+    query.addBindValue(humidities);
+    query.addBindValue(pressures);
+    query.addBindValue(cloudCovers);
+    query.addBindValue(visibilities);
+    query.addBindValue(uvIndexes);
+    query.addBindValue(conditions);
+    query.addBindValue(descriptions);
+}
+
+// Newest revision of each time in [fromSecs, toSecs] issued at or before
+// issuedAtSecs, appended to series in time order
+bool readRevisions(QSqlDatabase db, qint64 latKey, qint64 lonKey, const QString& source,
+                   qint64 fromSecs, qint64 toSecs, qint64 issuedAtSecs,
+                   ForecastSeries& series, QString& errorText) {
+    // The bare columns of an aggregate query come from the row holding MAX()
+    PreparedQuery query(db, QString(R"(
+        SELECT MAX(issued_at), %1
+        FROM forecast_revisions
+        WHERE lat_udeg = ?
+          AND lon_udeg = ?
+          AND source = ?
+          AND ts >= ?
+          AND ts <= ?
+          AND issued_at <= ?
+        GROUP BY ts
+        ORDER BY ts ASC
+    )").arg(SampleColumns));
+    query->setForwardOnly(true);
+    query->addBindValue(latKey);
+    query->addBindValue(lonKey);
+    query->addBindValue(source);
+    query->addBindValue(fromSecs);
+    query->addBindValue(toSecs);
+    query->addBindValue(issuedAtSecs);
+    
+    if (!query->exec()) {
+        errorText = query->lastError().text();
+        return false;
+    }
+    while (query->next()) {
+        WeatherSample sample = sampleFromRow(*query, 1, series);
+        sample.latitude = DatabaseManager::fromMicroDegrees(latKey);
+        sample.longitude = DatabaseManager::fromMicroDegrees(lonKey);
+        series.append(sample);
+    }
+    return true;
+}
+
+// Shared by every thread that ingests
+QMutex toleranceMutex;
+HistoricalDataManager::RevisionTolerance tolerance;
+
+// Fold newly archived series into an existing archive; new samples win on
+// equal timestamps
+QList<ArchiveCodec::Series> mergeArchives(const QList<ArchiveCodec::Series>& existing,
+                                          const QList<ArchiveCodec::Series>& added) {
+    using Key = std::tuple<qint64, qint64, QString>;
+    QMap<Key, ArchiveCodec::Series> merged;
+    for (const ArchiveCodec::Series& entry : existing) {
+        merged.insert(Key(entry.latMicroDegrees, entry.lonMicroDegrees, entry.source), entry);
+    }
+    for (const ArchiveCodec::Series& entry : added) {
+        const Key key(entry.latMicroDegrees, entry.lonMicroDegrees, entry.source);
+        auto it = merged.find(key);
+        if (it == merged.end()) {
+            merged.insert(key, entry);
+            continue;
+        }
+        
+        ForecastSeries combined = entry.samples;
+        const ForecastSeries& previous = it->samples;
+        for (int i = 0; i < previous.size(); ++i) {
+            if (entry.samples.indexOfTime(previous.timestampAt(i)) < 0) {
+                combined.append(previous.at(i), previous);
+            }
+        }
+        combined.sortByTime();
+        it->samples = combined;
+    }
+    return merged.values();
+}
+
+// Haversine great-circle distance
+double distanceKm(double lat1, double lon1, double lat2, double lon2) {
+    const double dLat = qDegreesToRadians(lat2 - lat1);
+    const double dLon = qDegreesToRadians(lon2 - lon1);
+    const double a = qSin(dLat / 2) * qSin(dLat / 2) +
+                     qCos(qDegreesToRadians(lat1)) * qCos(qDegreesToRadians(lat2)) *
+                     qSin(dLon / 2) * qSin(dLon / 2);
+    return EarthRadiusKm * 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
+}
+
+// Bucket fields in DatabaseManager::rollupMetrics() order
+using MetricField = HistoricalDataManager::MetricSummary HistoricalDataManager::AggregateBucket::*;
+const MetricField RollupFields[] = {
+    &HistoricalDataManager::AggregateBucket::temperature,
+    &HistoricalDataManager::AggregateBucket::precipProbability,
+    &HistoricalDataManager::AggregateBucket::precipIntensity,
+    &HistoricalDataManager::AggregateBucket::windSpeed,
+    &HistoricalDataManager::AggregateBucket::humidity,
+    &HistoricalDataManager::AggregateBucket::pressure,
+    &HistoricalDataManager::AggregateBucket::cloudCover
+};
+constexpr int RollupFieldCount = sizeof(RollupFields) / sizeof(RollupFields[0]);
+
+qint64 floorToStep(qint64 value, qint64 step) {
+    qint64 floored = value / step * step;
+    return floored > value ? floored - step : floored;
+}
+} // namespace
+
+void HistoricalDataManager::MetricSummary::merge(double minValue, double maxValue, double sumValue, int sampleCount) {
+    if (sampleCount <= 0) {
+        return;
+    }
+    min = count > 0 ? qMin(min, minValue) : minValue;
+    max = count > 0 ? qMax(max, maxValue) : maxValue;
+    sum += sumValue;
+    count += sampleCount;
+}
+
+bool HistoricalDataManager::RevisionTolerance::exceeded(const WeatherSample& previous,
+                                                        const ForecastSeries& previousStrings,
+                                                        const WeatherSample& current,
+                                                        const ForecastSeries& currentStrings) const {
+    const int turn = qAbs(current.windDirection - previous.windDirection) % 360;
+    return qAbs(current.temperature - previous.temperature) > temperature
+        || qAbs(current.feelsLike - previous.feelsLike) > feelsLike
+        || qAbs(current.precipProbability - previous.precipProbability) > precipProbability
+        || qAbs(current.precipIntensity - previous.precipIntensity) > precipIntensity
+        || qAbs(current.windSpeed - previous.windSpeed) > windSpeed
+        || qMin(turn, 360 - turn) > windDirection
+        || qAbs(current.humidity - previous.humidity) > humidity
+        || qAbs(current.pressure - previous.pressure) > pressure
+        || qAbs(current.cloudCover - previous.cloudCover) > cloudCover
+        || qAbs(current.visibility - previous.visibility) > visibility
+        || qAbs(current.uvIndex - previous.uvIndex) > uvIndex
+        || currentStrings.stringAt(current.conditionId) != previousStrings.stringAt(previous.conditionId)
+        || currentStrings.stringAt(current.descriptionId) != previousStrings.stringAt(previous.descriptionId);
+}
+
+HistoricalDataManager::RevisionTolerance HistoricalDataManager::revisionTolerance() {
+    QMutexLocker locker(&toleranceMutex);
+    return tolerance;
+}
+
+void HistoricalDataManager::setRevisionTolerance(const RevisionTolerance& value) {
+    QMutexLocker locker(&toleranceMutex);
+    tolerance = value;
+}
 
 HistoricalDataManager::HistoricalDataManager(QObject *parent)
     : QObject(parent)
     , m_retentionDays(7)
+    , m_archiveRetentionDays(180)
+    , m_backend(Backend::Sqlite)
+    , m_store(nullptr)
+    , m_writer(nullptr)
 {
 }
 
-HistoricalDataManager::~HistoricalDataManager() = default;
+HistoricalDataManager::~HistoricalDataManager() {
+    // Drain queued writes before the signal targets go away
+    if (m_writer) {
+        m_writer->stop();
+    }
+    delete m_store;
+}
 
 bool HistoricalDataManager::initialize() {
     if (!createTableIfNotExists()) {
@@ -31,12 +318,66 @@ bool HistoricalDataManager::initialize() {
         if (ok && days > 0) {
             m_retentionDays = days;
         }
+        
+        days = dbManager->getPreference("historical_archive_days", "180").toInt(&ok);
+        if (ok && days > 0) {
+            m_archiveRetentionDays = days;
+        }
+        
+        if (!m_store) {
+            const QString backend = dbManager->getPreference("historical_backend",
+                                                             m_backend == Backend::Mapped ? "mapped" : "sqlite");
+            m_backend = backend == "mapped" ? Backend::Mapped : Backend::Sqlite;
+            createStore(dbManager->database());
+        }
+        
+        // An in-memory database has no directory to archive next to
+        const QString databasePath = dbManager->database().databaseName();
+        if (m_archiveDirectory.isEmpty() && !databasePath.isEmpty() && databasePath != ":memory:") {
+            m_archiveDirectory = QFileInfo(databasePath).absoluteDir().filePath(ArchiveDirectoryName);
+        }
+        
+        // Dropping expired partitions is cheap enough to do on every start
+        cleanupOldData(m_retentionDays);
+    }
+    
+    // Ingest off the caller's thread on a dedicated connection to the same file
+    if (!m_writer && m_backend == Backend::Sqlite && dbManager && dbManager->isInitialized()) {
+        m_writer = new HistoricalWriter(dbManager->database().databaseName(), 8192, this);
+        m_writer->setTuningProfile(dbManager->tuningProfile());
+        connect(m_writer, &HistoricalWriter::batchCommitted, this, &HistoricalDataManager::dataStored);
+        connect(m_writer, &HistoricalWriter::error, this, &HistoricalDataManager::error);
+        if (!m_writer->start()) {
+            qWarning() << "Historical writer unavailable, storing synchronously";
+        }
     }
     
-    qInfo() << "HistoricalDataManager initialized with retention:" << m_retentionDays << "days";
+    qInfo() << "HistoricalDataManager initialized with retention:" << m_retentionDays << "days,"
+            << "backend:" << (m_store ? m_store->storeName() : QString("none"));
     return true;
 }
 
+void HistoricalDataManager::createStore(QSqlDatabase db) {
+    if (m_backend == Backend::Mapped) {
+        // Segments sit next to the database file, so an in-memory database has nowhere to put them
+        const QString databasePath = db.databaseName();
+        QString errorText = "no on-disk database";
+        if (!databasePath.isEmpty() && databasePath != ":memory:") {
+            MappedHistoricalStore* mapped = new MappedHistoricalStore(
+                QFileInfo(databasePath).absoluteDir().filePath(SegmentDirectoryName));
+            if (mapped->open(errorText)) {
+                m_store = mapped;
+                return;
+            }
+            delete mapped;
+        }
+        qWarning() << "Mapped historical store unavailable, using SQLite:" << errorText;
+        m_backend = Backend::Sqlite;
+    }
+    
+    m_store = new SqliteHistoricalStore(db);
+}
+
 bool HistoricalDataManager::createTableIfNotExists() {
     // Table is created by DatabaseManager, just verify it exists
     DatabaseManager* dbManager = DatabaseManager::instance();
@@ -51,9 +392,9 @@ bool HistoricalDataManager::createTableIfNotExists() {
         return false;
     }
     
-    // Check if table exists
+    // Check if the partition view exists
     QSqlQuery query(db);
-    query.prepare("SELECT name FROM sqlite_master WHERE type='table' AND name='historical_weather'");
+    query.prepare("SELECT name FROM sqlite_master WHERE type='view' AND name='historical_weather'");
     if (!query.exec()) {
         qWarning() << "Failed to check table existence:" << query.lastError().text();
         return false;
@@ -67,165 +408,646 @@ bool HistoricalDataManager::storeForecast(double latitude, double longitude, Wea
         return false;
     }
     
+    return writeForecasts(latitude, longitude, {data}, source) == 1;
+}
+
+bool HistoricalDataManager::storeForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source) {
+    if (forecasts.isEmpty()) {
+        return true;
+    }
+    
+    int successCount = writeForecasts(latitude, longitude, forecasts, source);
+    
+    if (successCount > 0) {
+        emit dataStored(successCount);
+    }
+    
+    return successCount == forecasts.size();
+}
+
+int HistoricalDataManager::writeForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source) {
     DatabaseManager* dbManager = DatabaseManager::instance();
     if (!dbManager || !dbManager->isInitialized()) {
         qWarning() << "DatabaseManager not initialized";
-        return false;
+        return 0;
     }
     
-    QSqlDatabase db = dbManager->database();
-    QSqlQuery query(db);
+    ForecastSeries series = ForecastSeries::fromWeatherData(forecasts);
+    if (series.isEmpty()) {
+        return 0;
+    }
     
-    // Round coordinates to reduce uniqueness issues (0.0001 degree ~ 11 meters)
-    double roundedLat = qRound(latitude * 10000.0) / 10000.0;
-    double roundedLon = qRound(longitude * 10000.0) / 10000.0;
+    if (!m_store) {
+        qWarning() << "HistoricalDataManager not initialized";
+        return 0;
+    }
     
-    query.prepare(R"(
-        INSERT OR REPLACE INTO historical_weather 
-        (latitude, longitude, timestamp, source, temperature, precip_probability, precip_intensity,
-         wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index,
-         weather_condition, weather_description, data_json)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
+    const qint64 latKey = DatabaseManager::toMicroDegrees(latitude);
+    const qint64 lonKey = DatabaseManager::toMicroDegrees(longitude);
     
-    query.addBindValue(roundedLat);
-    query.addBindValue(roundedLon);
-    query.addBindValue(data->timestamp().toString(Qt::ISODate));
-    query.addBindValue(source);
-    query.addBindValue(data->temperature());
-    query.addBindValue(data->precipProbability());
-    query.addBindValue(data->precipIntensity());
-    query.addBindValue(data->windSpeed());
-    query.addBindValue(data->windDirection());
-    query.addBindValue(data->humidity());
-    query.addBindValue(data->pressure());
-    query.addBindValue(data->cloudCover());
-    query.addBindValue(data->visibility());
-    query.addBindValue(data->uvIndex());
-    query.addBindValue(data->weatherCondition());
-    query.addBindValue(data->weatherDescription());
-    
-    // Store full JSON data
-    QJsonObject jsonData = data->toJson();
-    QJsonDocument doc(jsonData);
-    query.addBindValue(doc.toJson(QJsonDocument::Compact));
+    // The SQLite store indexes the location in its own transaction
+    QString errorText;
+    bool stored = m_store->insertSeries(latKey, lonKey, series, source, errorText);
+    if (stored && m_backend != Backend::Sqlite) {
+        stored = indexLocation(dbManager->database(), latKey, lonKey, errorText);
+    }
+    if (!stored) {
+        qWarning() << "Failed to store historical forecasts:" << errorText;
+        emit error(errorText);
+        return 0;
+    }
     
-    if (!query.exec()) {
-        qWarning() << "Failed to store historical forecast:" << query.lastError().text();
-        emit error(query.lastError().text());
-        return false;
+    return series.size();
+}
+
+bool HistoricalDataManager::enqueueForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source) {
+    if (!m_writer || !m_writer->isRunning()) {
+        return storeForecasts(latitude, longitude, forecasts, source);
     }
     
+    // Copy into plain values now; the WeatherData objects belong to the caller
+    if (!m_writer->enqueue(latitude, longitude, ForecastSeries::fromWeatherData(forecasts), source)) {
+        qWarning() << "Historical write queue full, dropped" << forecasts.size() << "forecasts";
+        return false;
+    }
     return true;
 }
 
-bool HistoricalDataManager::storeForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source) {
-    if (forecasts.isEmpty()) {
+bool HistoricalDataManager::insertSeries(QSqlDatabase db, double latitude, double longitude,
+                                         const ForecastSeries& series, const QString& source,
+                                         QString& errorText, qint64 issuedAtSecs,
+                                         int* changedSamples) {
+    // Snap coordinates to the 0.0001 degree (~11 meter) grid used as the row key
+    const qint64 latKey = DatabaseManager::toMicroDegrees(latitude);
+    const qint64 lonKey = DatabaseManager::toMicroDegrees(longitude);
+    const qint64 issuedAt = issuedAtSecs > 0 ? issuedAtSecs : QDateTime::currentSecsSinceEpoch();
+    if (changedSamples) {
+        *changedSamples = 0;
+    }
+    
+    QVector<int> valid;
+    qint64 firstSecs = std::numeric_limits<qint64>::max();
+    qint64 lastSecs = std::numeric_limits<qint64>::min();
+    for (int i = 0; i < series.size(); ++i) {
+        const qint64 timestampMs = series.timestampAt(i);
+        if (timestampMs != WeatherSample::InvalidTime) {
+            valid.append(i);
+            firstSecs = qMin(firstSecs, timestampMs / 1000);
+            lastSecs = qMax(lastSecs, timestampMs / 1000);
+        }
+    }
+    
+    if (valid.isEmpty()) {
         return true;
     }
     
-    int successCount = 0;
-    for (WeatherData* data : forecasts) {
-        if (storeForecast(latitude, longitude, data, source)) {
-            successCount++;
+    // The forecast as it stood before this issuance, one range scan
+    ForecastSeries previous;
+    if (!readRevisions(db, latKey, lonKey, source, firstSecs, lastSecs, issuedAt, previous, errorText)) {
+        return false;
+    }
+    
+    // Keep the samples that changed and route them to their daily partitions
+    const RevisionTolerance limits = revisionTolerance();
+    QVector<int> changed;
+    QMap<QString, QVector<int>> partitions;
+    for (int i : valid) {
+        const int before = previous.indexOfTime(series.timestampAt(i) / 1000 * 1000);
+        if (before >= 0 && !limits.exceeded(previous.at(before), previous, series.at(i), series)) {
+            continue;
         }
+        changed.append(i);
+        partitions[DatabaseManager::historicalPartition(series.timestampAt(i) / 1000)].append(i);
     }
     
-    if (successCount > 0) {
-        emit dataStored(successCount);
+    if (!changed.isEmpty()) {
+        QVariantList lats, lons, sources, timestamps, issuedAts;
+        for (int i : changed) {
+            lats << latKey;
+            lons << lonKey;
+            sources << source;
+            timestamps << series.timestampAt(i) / 1000;
+            issuedAts << issuedAt;
+        }
+        
+        PreparedQuery revisions(db, R"(
+            INSERT OR REPLACE INTO forecast_revisions
+            (lat_udeg, lon_udeg, source, ts, issued_at, temperature, feels_like, precip_probability,
+             precip_intensity, wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility,
+             uv_index, weather_condition, weather_description)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+        )");
+        revisions->addBindValue(lats);
+        revisions->addBindValue(lons);
+        revisions->addBindValue(sources);
+        revisions->addBindValue(timestamps);
+        revisions->addBindValue(issuedAts);
+        bindSampleValues(*revisions, series, changed);
+        if (!revisions->execBatch()) {
+            errorText = revisions->lastError().text();
+            return false;
+        }
     }
     
-    return successCount == forecasts.size();
+    // Batches issued in the same second merge into one issuance
+    PreparedQuery issuance(db, R"(
+        INSERT INTO forecast_issuances
+        (lat_udeg, lon_udeg, source, issued_at, first_ts, last_ts, sample_count, changed_count)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT (lat_udeg, lon_udeg, source, issued_at) DO UPDATE SET
+            first_ts = MIN(first_ts, excluded.first_ts),
+            last_ts = MAX(last_ts, excluded.last_ts),
+            sample_count = sample_count + excluded.sample_count,
+            changed_count = changed_count + excluded.changed_count
+    )");
+    issuance->addBindValue(latKey);
+    issuance->addBindValue(lonKey);
+    issuance->addBindValue(source);
+    issuance->addBindValue(issuedAt);
+    issuance->addBindValue(firstSecs);
+    issuance->addBindValue(lastSecs);
+    issuance->addBindValue(valid.size());
+    issuance->addBindValue(changed.size());
+    if (!issuance->exec()) {
+        errorText = issuance->lastError().text();
+        return false;
+    }
+    
+    if (changed.isEmpty()) {
+        return true;
+    }
+    
+    for (auto it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        if (!DatabaseManager::ensureHistoricalPartition(db, it.key(), errorText)
+            || !insertPartition(db, it.key(), latKey, lonKey, series, it.value(), source, errorText)) {
+            return false;
+        }
+    }
+    
+    if (changedSamples) {
+        *changedSamples = changed.size();
+    }
+    return indexLocation(db, latKey, lonKey, errorText);
+}
+
+bool HistoricalDataManager::readIssuance(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                                         const QString& source, qint64 issuedAtSecs,
+                                         ForecastSeries& series, QString& errorText,
+                                         qint64* resolvedIssuedAt) {
+    if (resolvedIssuedAt) {
+        *resolvedIssuedAt = 0;
+    }
+    
+    qint64 issuedAt = 0;
+    qint64 firstSecs = 0;
+    qint64 lastSecs = 0;
+    {
+        PreparedQuery issuance(db, R"(
+            SELECT issued_at, first_ts, last_ts
+            FROM forecast_issuances
+            WHERE lat_udeg = ? AND lon_udeg = ? AND source = ? AND issued_at <= ?
+            ORDER BY issued_at DESC
+            LIMIT 1
+        )");
+        issuance->addBindValue(latKey);
+        issuance->addBindValue(lonKey);
+        issuance->addBindValue(source);
+        issuance->addBindValue(issuedAtSecs);
+        if (!issuance->exec()) {
+            errorText = issuance->lastError().text();
+            return false;
+        }
+        if (!issuance->next()) {
+            return true;
+        }
+        issuedAt = issuance->value(0).toLongLong();
+        firstSecs = issuance->value(1).toLongLong();
+        lastSecs = issuance->value(2).toLongLong();
+    }
+    
+    if (resolvedIssuedAt) {
+        *resolvedIssuedAt = issuedAt;
+    }
+    return readRevisions(db, latKey, lonKey, source, firstSecs, lastSecs, issuedAt, series, errorText);
+}
+
+bool HistoricalDataManager::indexLocation(QSqlDatabase db, qint64 latKey, qint64 lonKey, QString& errorText) {
+    // Keep the spatial index in step; re-inserting a known location is harmless
+    PreparedQuery location(db, R"(
+        INSERT OR REPLACE INTO historical_locations (id, min_lat, max_lat, min_lon, max_lon)
+        VALUES (?, ?, ?, ?, ?)
+    )");
+    location->addBindValue(DatabaseManager::locationId(latKey, lonKey));
+    location->addBindValue(latKey);
+    location->addBindValue(latKey);
+    location->addBindValue(lonKey);
+    location->addBindValue(lonKey);
+    if (!location->exec()) {
+        errorText = location->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool HistoricalDataManager::insertPartition(QSqlDatabase db, const QString& partition,
+                                            qint64 latKey, qint64 lonKey,
+                                            const ForecastSeries& series, const QVector<int>& rows,
+                                            const QString& source, QString& errorText) {
+    // One bound list per column
+    QVariantList lats, lons, timestamps, sources;
+    for (int i : rows) {
+        lats << latKey;
+        lons << lonKey;
+        timestamps << series.timestampAt(i) / 1000;
+        sources << source;
+    }
+    
+    // Prepared once per partition and reused for every batch that lands in it
+    PreparedQuery query(db, QString(R"(
+        INSERT OR REPLACE INTO %1
+        (lat_udeg, lon_udeg, ts, source, temperature, feels_like, precip_probability, precip_intensity,
+         wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index,
+         weather_condition, weather_description)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )").arg(partition));
+    
+    query->addBindValue(lats);
+    query->addBindValue(lons);
+    query->addBindValue(timestamps);
+    query->addBindValue(sources);
+    bindSampleValues(*query, series, rows);
+    
+    if (!query->execBatch()) {
+        errorText = query->lastError().text();
+        return false;
+    }
+    
+    // Rebuild the hours and day this batch touched from the rows now stored
+    const auto range = std::minmax_element(timestamps.cbegin(), timestamps.cend(),
+        [](const QVariant& a, const QVariant& b) { return a.toLongLong() < b.toLongLong(); });
+    return DatabaseManager::refreshHistoricalRollups(db, partition, range.first->toLongLong(),
+                                                     range.second->toLongLong(), errorText,
+                                                     latKey, lonKey, source);
 }
 
 QList<WeatherData*> HistoricalDataManager::getHistoricalData(double latitude, double longitude,
                                                                const QDateTime& startTime,
                                                                const QDateTime& endTime,
                                                                const QString& source) {
-    QList<WeatherData*> results;
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (!dbManager || !dbManager->isInitialized()) {
+        qWarning() << "DatabaseManager not initialized";
+        return QList<WeatherData*>();
+    }
     
+    ForecastSeries series;
+    querySeries(dbManager->database(), DatabaseManager::toMicroDegrees(latitude),
+                DatabaseManager::toMicroDegrees(longitude), startTime, endTime, source, series);
+    return series.toWeatherDataList(this);
+}
+
+QList<WeatherData*> HistoricalDataManager::getIssuedForecast(double latitude, double longitude,
+                                                             const QDateTime& issuedAt,
+                                                             const QString& source) {
     DatabaseManager* dbManager = DatabaseManager::instance();
     if (!dbManager || !dbManager->isInitialized()) {
         qWarning() << "DatabaseManager not initialized";
-        return results;
+        return QList<WeatherData*>();
+    }
+    
+    ForecastSeries series;
+    QString errorText;
+    if (!readIssuance(dbManager->database(), DatabaseManager::toMicroDegrees(latitude),
+                      DatabaseManager::toMicroDegrees(longitude), source,
+                      issuedAt.toSecsSinceEpoch(), series, errorText)) {
+        qWarning() << "Failed to read forecast issuance:" << errorText;
+        emit error(errorText);
+        return QList<WeatherData*>();
+    }
+    return series.toWeatherDataList(this);
+}
+
+bool HistoricalDataManager::scanHistoricalData(double latitude, double longitude,
+                                               const QDateTime& startTime, const QDateTime& endTime,
+                                               const SeriesVisitor& visitor, const QString& source,
+                                               int batchSize) {
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (!dbManager || !dbManager->isInitialized() || !m_store) {
+        qWarning() << "HistoricalDataManager not initialized";
+        return false;
     }
     
     QSqlDatabase db = dbManager->database();
-    QSqlQuery query(db);
+    const qint64 latKey = DatabaseManager::toMicroDegrees(latitude);
+    const qint64 lonKey = DatabaseManager::toMicroDegrees(longitude);
+    const qint64 fromSecs = startTime.toSecsSinceEpoch();
+    const qint64 toSecs = endTime.toSecsSinceEpoch();
     
-    // Round coordinates to match stored values
-    double roundedLat = qRound(latitude * 10000.0) / 10000.0;
-    double roundedLon = qRound(longitude * 10000.0) / 10000.0;
+    SeriesBatcher batcher(batchSize, visitor);
+    QString errorText;
+    bool ok = true;
     
-    QString sql = R"(
-        SELECT latitude, longitude, timestamp, source, temperature, precip_probability, precip_intensity,
-               wind_speed, wind_direction, humidity, pressure, cloud_cover, visibility, uv_index,
-               weather_condition, weather_description, data_json
-        FROM historical_weather
-        WHERE ABS(latitude - ?) < 0.0001
-          AND ABS(longitude - ?) < 0.0001
-          AND timestamp >= ?
-          AND timestamp <= ?
-    )";
+    const QStringList archived = m_backend == Backend::Sqlite ? archivedPartitions(fromSecs, toSecs) : QStringList();
+    if (archived.isEmpty()) {
+        ok = m_store->scanSeries(latKey, lonKey, fromSecs, toSecs, source, batcher, errorText);
+    } else {
+        // Walk archived and live days together in time order; an archived day
+        // is decoded whole, merged with rows re-ingested since, then batched
+        const QStringList partitions = DatabaseManager::historicalPartitions(db, fromSecs, toSecs);
+        QStringList days = archived + partitions;
+        days.removeDuplicates();
+        days.sort();
+        for (const QString& day : days) {
+            if (!archived.contains(day)) {
+                ok = scanPartition(db, day, latKey, lonKey, fromSecs, toSecs, source, batcher, errorText);
+            } else {
+                const bool live = partitions.contains(day);
+                ForecastSeries daySeries;
+                if (!queryArchive(db, archivePath(day), live ? day : QString(),
+                                  latKey, lonKey, startTime, endTime, source, daySeries)) {
+                    return false;
+                }
+                ok = !live || readPartition(db, day, latKey, lonKey, fromSecs, toSecs, source, daySeries, errorText);
+                if (ok) {
+                    if (!daySeries.isSortedByTime()) {
+                        daySeries.sortByTime();
+                    }
+                    batcher.append(daySeries);
+                }
+            }
+            if (!ok || batcher.stopped()) {
+                break;
+            }
+        }
+    }
     
-    if (!source.isEmpty()) {
-        sql += " AND source = ?";
+    if (!ok) {
+        qWarning() << "Failed to retrieve historical data:" << errorText;
+        emit error(errorText);
+        return false;
+    }
+    batcher.flush();
+    return true;
+}
+
+bool HistoricalDataManager::querySeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                                        const QDateTime& startTime, const QDateTime& endTime,
+                                        const QString& source, ForecastSeries& series) {
+    if (!m_store) {
+        qWarning() << "HistoricalDataManager not initialized";
+        return false;
     }
     
-    sql += " ORDER BY timestamp ASC";
+    const qint64 fromSecs = startTime.toSecsSinceEpoch();
+    const qint64 toSecs = endTime.toSecsSinceEpoch();
     
-    query.prepare(sql);
-    query.addBindValue(roundedLat);
-    query.addBindValue(roundedLon);
-    query.addBindValue(startTime.toString(Qt::ISODate));
-    query.addBindValue(endTime.toString(Qt::ISODate));
+    // Archived days predate the live partitions, unless a day was written
+    // again after it was archived; those rows supersede the archived ones
+    if (m_backend == Backend::Sqlite) {
+        const QStringList archived = archivedPartitions(fromSecs, toSecs);
+        const QStringList partitions = archived.isEmpty()
+            ? QStringList() : DatabaseManager::historicalPartitions(db, fromSecs, toSecs);
+        for (const QString& day : archived) {
+            if (!queryArchive(db, archivePath(day), partitions.contains(day) ? day : QString(),
+                              latKey, lonKey, startTime, endTime, source, series)) {
+                return false;
+            }
+        }
+    }
     
-    if (!source.isEmpty()) {
-        query.addBindValue(source);
+    QString errorText;
+    if (!m_store->readSeries(latKey, lonKey, fromSecs, toSecs, source, series, errorText)) {
+        qWarning() << "Failed to retrieve historical data:" << errorText;
+        emit error(errorText);
+        return false;
     }
     
-    if (!query.exec()) {
-        qWarning() << "Failed to retrieve historical data:" << query.lastError().text();
-        emit error(query.lastError().text());
-        return results;
+    // Sources of one archived day, or a day re-ingested after archiving, interleave
+    if (!series.isSortedByTime()) {
+        series.sortByTime();
+    }
+    return true;
+}
+
+bool HistoricalDataManager::readSeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                                       ForecastSeries& series, QString& errorText) {
+    // Only the daily partitions overlapping the range are read, oldest first,
+    // so the concatenated rows stay in time order
+    const QStringList partitions = DatabaseManager::historicalPartitions(db, fromSecs, toSecs);
+    for (const QString& partition : partitions) {
+        if (!readPartition(db, partition, latKey, lonKey, fromSecs, toSecs, source, series, errorText)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HistoricalDataManager::readPartition(QSqlDatabase db, const QString& partition,
+                                          qint64 latKey, qint64 lonKey,
+                                          qint64 fromSecs, qint64 toSecs, const QString& source,
+                                          ForecastSeries& series, QString& errorText) {
+    return scanPartitionRows(db, partition, latKey, lonKey, fromSecs, toSecs, source, errorText,
+                             [&](const QSqlQuery& query) {
+        WeatherSample sample = sampleFromRow(query, 0, series);
+        sample.latitude = DatabaseManager::fromMicroDegrees(latKey);
+        sample.longitude = DatabaseManager::fromMicroDegrees(lonKey);
+        series.append(sample);
+        return true;
+    });
+}
+
+bool HistoricalDataManager::scanSeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                                       SeriesBatcher& batcher, QString& errorText) {
+    const QStringList partitions = DatabaseManager::historicalPartitions(db, fromSecs, toSecs);
+    for (const QString& partition : partitions) {
+        if (!scanPartition(db, partition, latKey, lonKey, fromSecs, toSecs, source, batcher, errorText)) {
+            return false;
+        }
+        if (batcher.stopped()) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool HistoricalDataManager::scanPartition(QSqlDatabase db, const QString& partition,
+                                          qint64 latKey, qint64 lonKey,
+                                          qint64 fromSecs, qint64 toSecs, const QString& source,
+                                          SeriesBatcher& batcher, QString& errorText) {
+    // Rows go straight from the cursor into the current batch
+    return scanPartitionRows(db, partition, latKey, lonKey, fromSecs, toSecs, source, errorText,
+                             [&](const QSqlQuery& query) {
+        WeatherSample sample = sampleFromRow(query, 0, batcher.pending());
+        sample.latitude = DatabaseManager::fromMicroDegrees(latKey);
+        sample.longitude = DatabaseManager::fromMicroDegrees(lonKey);
+        return batcher.append(sample);
+    });
+}
+
+bool HistoricalDataManager::queryArchive(QSqlDatabase db, const QString& archive, const QString& partition,
+                                         qint64 latKey, qint64 lonKey,
+                                         const QDateTime& startTime, const QDateTime& endTime,
+                                         const QString& source, ForecastSeries& series) {
+    QFile file(archive);
+    ArchiveReader reader;
+    if (!file.open(QIODevice::ReadOnly) || !reader.open(file.readAll())) {
+        qWarning() << "Failed to read historical archive:" << archive;
+        emit error(QString("Failed to read historical archive %1").arg(archive));
+        return false;
     }
     
-    while (query.next()) {
-        // Try to restore from JSON first (preserves all fields)
-        QString jsonStr = query.value(16).toString(); // data_json column
-        if (!jsonStr.isEmpty()) {
-            QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
-            if (!doc.isNull() && doc.isObject()) {
-                WeatherData* data = WeatherData::fromJson(doc.object(), this);
-                if (data) {
-                    results.append(data);
-                    continue;
-                }
+    // Same whole-second bounds as the partition queries
+    const qint64 startMs = startTime.toSecsSinceEpoch() * 1000;
+    const qint64 endMs = endTime.toSecsSinceEpoch() * 1000;
+    
+    // Block headers are compared without decoding the payloads
+    while (reader.next()) {
+        if (reader.latMicroDegrees() != latKey || reader.lonMicroDegrees() != lonKey
+            || (!source.isEmpty() && reader.source() != source)) {
+            continue;
+        }
+        
+        ForecastSeries block;
+        if (!reader.samples(block)) {
+            qWarning() << "Corrupt series in historical archive:" << archive;
+            emit error(QString("Corrupt series in historical archive %1").arg(archive));
+            return false;
+        }
+        
+        // Rows re-ingested into a partition since the day was archived supersede it
+        QSet<qint64> superseded;
+        if (!partition.isEmpty()) {
+            PreparedQuery query(db, QString("SELECT ts FROM %1 WHERE lat_udeg = ? AND lon_udeg = ? AND source = ?")
+                                    .arg(partition));
+            query->setForwardOnly(true);
+            query->addBindValue(latKey);
+            query->addBindValue(lonKey);
+            query->addBindValue(reader.source());
+            if (!query->exec()) {
+                qWarning() << "Failed to retrieve historical data:" << query->lastError().text();
+                emit error(query->lastError().text());
+                return false;
+            }
+            while (query->next()) {
+                superseded.insert(query->value(0).toLongLong() * 1000);
             }
         }
         
-        // Fallback: reconstruct from individual columns
-        WeatherData* fallbackData = new WeatherData(this);
-        fallbackData->setLatitude(query.value(0).toDouble());
-        fallbackData->setLongitude(query.value(1).toDouble());
-        fallbackData->setTimestamp(QDateTime::fromString(query.value(2).toString(), Qt::ISODate));
-        fallbackData->setTemperature(query.value(4).toDouble());
-        fallbackData->setPrecipProbability(query.value(5).toDouble());
-        fallbackData->setPrecipIntensity(query.value(6).toDouble());
-        fallbackData->setWindSpeed(query.value(7).toDouble());
-        fallbackData->setWindDirection(query.value(8).toInt());
-        fallbackData->setHumidity(query.value(9).toInt());
-        fallbackData->setPressure(query.value(10).toDouble());
-        fallbackData->setCloudCover(query.value(11).toInt());
-        fallbackData->setVisibility(query.value(12).toInt());
-        fallbackData->setUvIndex(query.value(13).toInt());
-        fallbackData->setWeatherCondition(query.value(14).toString());
-        fallbackData->setWeatherDescription(query.value(15).toString());
+        for (int i = block.lowerBound(startMs); i < block.size() && block.timestampAt(i) <= endMs; ++i) {
+            if (!superseded.contains(block.timestampAt(i))) {
+                series.append(block.at(i), block);
+            }
+        }
+    }
+    
+    return true;
+}
+
+QStringList HistoricalDataManager::archivedPartitions(qint64 fromSecs, qint64 toSecs) const {
+    QStringList partitions;
+    if (m_archiveDirectory.isEmpty()) {
+        return partitions;
+    }
+    
+    // Names compare in date order, like the partition tables
+    const QString first = DatabaseManager::historicalPartition(fromSecs);
+    const QString last = DatabaseManager::historicalPartition(toSecs);
+    const QStringList files = QDir(m_archiveDirectory).entryList(
+        {QString("historical_weather_*") + ArchiveSuffix}, QDir::Files, QDir::Name);
+    for (const QString& file : files) {
+        const QString partition = file.chopped(static_cast<int>(qstrlen(ArchiveSuffix)));
+        if (partition >= first && partition <= last) {
+            partitions.append(partition);
+        }
+    }
+    return partitions;
+}
+
+QString HistoricalDataManager::archivePath(const QString& partition) const {
+    return QDir(m_archiveDirectory).filePath(partition + ArchiveSuffix);
+}
+
+bool HistoricalDataManager::archivePartition(QSqlDatabase db, const QString& partition) {
+    if (!QDir().mkpath(m_archiveDirectory)) {
+        qWarning() << "Failed to create historical archive directory:" << m_archiveDirectory;
+        return false;
+    }
+    
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec(QString(R"(
+            SELECT lat_udeg, lon_udeg, source, %1
+            FROM %2
+            ORDER BY lat_udeg, lon_udeg, source, ts
+        )").arg(SampleColumns, partition))) {
+        qWarning() << "Failed to read historical partition" << partition << ":" << query.lastError().text();
+        return false;
+    }
+    
+    // One archive series per location and source
+    QList<ArchiveCodec::Series> archive;
+    while (query.next()) {
+        const qint64 latKey = query.value(0).toLongLong();
+        const qint64 lonKey = query.value(1).toLongLong();
+        const QString source = query.value(2).toString();
+        if (archive.isEmpty() || archive.last().latMicroDegrees != latKey
+            || archive.last().lonMicroDegrees != lonKey || archive.last().source != source) {
+            ArchiveCodec::Series entry;
+            entry.latMicroDegrees = latKey;
+            entry.lonMicroDegrees = lonKey;
+            entry.source = source;
+            archive.append(entry);
+        }
         
-        results.append(fallbackData);
+        ForecastSeries& samples = archive.last().samples;
+        WeatherSample sample = sampleFromRow(query, 3, samples);
+        sample.latitude = DatabaseManager::fromMicroDegrees(latKey);
+        sample.longitude = DatabaseManager::fromMicroDegrees(lonKey);
+        samples.append(sample);
+    }
+    if (archive.isEmpty()) {
+        return true;
     }
     
-    return results;
+    // The day may have been archived before and then written to again
+    const QString path = archivePath(partition);
+    if (QFile::exists(path)) {
+        QFile existing(path);
+        QList<ArchiveCodec::Series> previous;
+        if (!existing.open(QIODevice::ReadOnly) || !ArchiveCodec::decode(existing.readAll(), previous)) {
+            qWarning() << "Failed to read historical archive:" << path;
+            return false;
+        }
+        archive = mergeArchives(previous, archive);
+    }
+    
+    // Written to a temporary file and renamed, so a crash never leaves half an archive
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(ArchiveCodec::encode(archive)) < 0 || !file.commit()) {
+        qWarning() << "Failed to write historical archive" << path << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+int HistoricalDataManager::pruneArchives(qint64 cutoffSecs) {
+    if (m_archiveDirectory.isEmpty()) {
+        return 0;
+    }
+    
+    // Same rule as the partitions: the day containing the cutoff is kept
+    const QString cutoff = DatabaseManager::historicalPartition(cutoffSecs) + ArchiveSuffix;
+    QDir dir(m_archiveDirectory);
+    int removed = 0;
+    const QStringList files = dir.entryList({QString("historical_weather_*") + ArchiveSuffix}, QDir::Files, QDir::Name);
+    for (const QString& file : files) {
+        if (file < cutoff && dir.remove(file)) {
+            ++removed;
+        }
+    }
+    return removed;
 }
 
 QList<WeatherData*> HistoricalDataManager::getRecentData(double latitude, double longitude,
@@ -237,6 +1059,208 @@ QList<WeatherData*> HistoricalDataManager::getRecentData(double latitude, double
     return getHistoricalData(latitude, longitude, startTime, endTime, source);
 }
 
+QList<HistoricalDataManager::NearbySeries> HistoricalDataManager::getNearbyData(double latitude, double longitude,
+                                                                                 double radiusKm,
+                                                                                 const QDateTime& startTime,
+                                                                                 const QDateTime& endTime,
+                                                                                 int maxSeries,
+                                                                                 const QString& source) {
+    QList<NearbySeries> results;
+    if (maxSeries <= 0 || radiusKm < 0.0) {
+        return results;
+    }
+    
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (!dbManager || !dbManager->isInitialized()) {
+        qWarning() << "DatabaseManager not initialized";
+        return results;
+    }
+    
+    QSqlDatabase db = dbManager->database();
+    
+    // Bounding box of the search circle; a degree of longitude shrinks toward the poles
+    const double latSpan = radiusKm / KmPerDegreeLatitude;
+    const double cosLat = qCos(qDegreesToRadians(latitude));
+    const double lonSpan = cosLat > 1e-6 ? qMin(180.0, latSpan / cosLat) : 180.0;
+    
+    PreparedQuery query(db, R"(
+        SELECT min_lat, min_lon FROM historical_locations
+        WHERE max_lat >= ? AND min_lat <= ? AND max_lon >= ? AND min_lon <= ?
+    )");
+    query->setForwardOnly(true);
+    query->addBindValue(qFloor((latitude - latSpan) * 1000000.0));
+    query->addBindValue(qCeil((latitude + latSpan) * 1000000.0));
+    query->addBindValue(qFloor((longitude - lonSpan) * 1000000.0));
+    query->addBindValue(qCeil((longitude + lonSpan) * 1000000.0));
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to search historical locations:" << query->lastError().text();
+        emit error(query->lastError().text());
+        return results;
+    }
+    
+    // Trim the box to the circle, nearest first
+    struct Candidate {
+        qint64 latKey;
+        qint64 lonKey;
+        double distanceKm;
+    };
+    QList<Candidate> candidates;
+    while (query->next()) {
+        const qint64 latKey = query->value(0).toLongLong();
+        const qint64 lonKey = query->value(1).toLongLong();
+        const double distance = distanceKm(latitude, longitude,
+                                           DatabaseManager::fromMicroDegrees(latKey),
+                                           DatabaseManager::fromMicroDegrees(lonKey));
+        if (distance <= radiusKm) {
+            candidates.append({latKey, lonKey, distance});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.distanceKm < b.distanceKm;
+    });
+    
+    for (const Candidate& candidate : candidates) {
+        if (results.size() >= maxSeries) {
+            break;
+        }
+        
+        NearbySeries nearby;
+        nearby.latitude = DatabaseManager::fromMicroDegrees(candidate.latKey);
+        nearby.longitude = DatabaseManager::fromMicroDegrees(candidate.lonKey);
+        nearby.distanceKm = candidate.distanceKm;
+        if (!querySeries(db, candidate.latKey, candidate.lonKey, startTime, endTime, source, nearby.series)) {
+            break;
+        }
+        if (!nearby.series.isEmpty()) {
+            results.append(nearby);
+        }
+    }
+    
+    return results;
+}
+
+HistoricalDataManager::Resolution HistoricalDataManager::resolutionFor(qint64 stepSeconds) {
+    if (stepSeconds > 0 && stepSeconds % (24 * 3600) == 0) {
+        return Resolution::Daily;
+    }
+    if (stepSeconds > 0 && stepSeconds % 3600 == 0) {
+        return Resolution::Hourly;
+    }
+    return Resolution::Raw;
+}
+
+QList<HistoricalDataManager::AggregateBucket> HistoricalDataManager::getAggregates(double latitude, double longitude,
+                                                                                   const QDateTime& startTime,
+                                                                                   const QDateTime& endTime,
+                                                                                   qint64 stepSeconds,
+                                                                                   const QString& source,
+                                                                                   Resolution* resolution) {
+    Q_ASSERT(RollupFieldCount == DatabaseManager::rollupMetrics().size());
+    
+    // Rollups are maintained by the SQLite backend only
+    const Resolution chosen = m_backend == Backend::Sqlite ? resolutionFor(stepSeconds) : Resolution::Raw;
+    if (resolution) {
+        *resolution = chosen;
+    }
+    if (stepSeconds <= 0) {
+        return QList<AggregateBucket>();
+    }
+    
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (!dbManager || !dbManager->isInitialized()) {
+        qWarning() << "DatabaseManager not initialized";
+        return QList<AggregateBucket>();
+    }
+    
+    QSqlDatabase db = dbManager->database();
+    const qint64 latKey = DatabaseManager::toMicroDegrees(latitude);
+    const qint64 lonKey = DatabaseManager::toMicroDegrees(longitude);
+    
+    // Keyed by bucket start in epoch seconds
+    QMap<qint64, AggregateBucket> buckets;
+    auto bucketAt = [&](qint64 epochSeconds) -> AggregateBucket& {
+        const qint64 start = floorToStep(epochSeconds, stepSeconds);
+        auto it = buckets.find(start);
+        if (it == buckets.end()) {
+            it = buckets.insert(start, AggregateBucket());
+            it->start = QDateTime::fromSecsSinceEpoch(start, QTimeZone::utc());
+        }
+        return *it;
+    };
+    
+    if (chosen == Resolution::Raw) {
+        ForecastSeries series;
+        if (!querySeries(db, latKey, lonKey, startTime, endTime, source, series)) {
+            return QList<AggregateBucket>();
+        }
+        for (int i = 0; i < series.size(); ++i) {
+            AggregateBucket& bucket = bucketAt(series.timestampAt(i) / 1000);
+            const double values[] = {
+                series.temperatures().at(i), series.precipProbabilities().at(i),
+                series.precipIntensities().at(i), series.windSpeeds().at(i),
+                static_cast<double>(series.humidities().at(i)), series.pressures().at(i),
+                static_cast<double>(series.cloudCovers().at(i))
+            };
+            ++bucket.sampleCount;
+            for (int m = 0; m < RollupFieldCount; ++m) {
+                (bucket.*RollupFields[m]).merge(values[m], values[m], values[m], 1);
+            }
+        }
+        return buckets.values();
+    }
+    
+    const bool daily = chosen == Resolution::Daily;
+    const qint64 width = daily ? 24 * 3600 : 3600;
+    
+    QStringList metricColumns;
+    for (const QString& metric : DatabaseManager::rollupMetrics()) {
+        metricColumns << metric + "_min" << metric + "_max" << metric + "_sum";
+    }
+    
+    QString sql = QString(R"(
+        SELECT ts, sample_count, %1
+        FROM %2
+        WHERE lat_udeg = ?
+          AND lon_udeg = ?
+          AND ts >= ?
+          AND ts <= ?
+    )").arg(metricColumns.join(", "), daily ? "historical_rollup_daily" : "historical_rollup_hourly");
+    if (!source.isEmpty()) {
+        sql += " AND source = ?";
+    }
+    sql += " ORDER BY ts ASC";
+    
+    PreparedQuery query(db, sql);
+    query->setForwardOnly(true);
+    query->addBindValue(latKey);
+    query->addBindValue(lonKey);
+    query->addBindValue(floorToStep(startTime.toSecsSinceEpoch(), width));
+    query->addBindValue(endTime.toSecsSinceEpoch());
+    if (!source.isEmpty()) {
+        query->addBindValue(source);
+    }
+    
+    if (!query->exec()) {
+        qWarning() << "Failed to read historical rollups:" << query->lastError().text();
+        emit error(query->lastError().text());
+        return QList<AggregateBucket>();
+    }
+    
+    while (query->next()) {
+        AggregateBucket& bucket = bucketAt(query->value(0).toLongLong());
+        const int count = query->value(1).toInt();
+        bucket.sampleCount += count;
+        for (int m = 0; m < RollupFieldCount; ++m) {
+            const int column = 2 + m * 3;
+            (bucket.*RollupFields[m]).merge(query->value(column).toDouble(), query->value(column + 1).toDouble(),
+                                            query->value(column + 2).toDouble(), count);
+        }
+    }
+    
+    return buckets.values();
+}
+
 int HistoricalDataManager::cleanupOldData(int daysToKeep) {
     DatabaseManager* dbManager = DatabaseManager::instance();
     if (!dbManager || !dbManager->isInitialized()) {
@@ -249,20 +1273,63 @@ int HistoricalDataManager::cleanupOldData(int daysToKeep) {
     
     QDateTime cutoffTime = QDateTime::currentDateTime().addDays(-daysToKeep);
     
-    query.prepare("DELETE FROM historical_weather WHERE timestamp < ?");
-    query.addBindValue(cutoffTime.toString(Qt::ISODate));
+    // Segments have no archive tier; whole expired days are removed
+    if (m_backend != Backend::Sqlite) {
+        QString errorText;
+        const int droppedSegments = m_store ? m_store->dropBefore(cutoffTime.toSecsSinceEpoch(), errorText) : 0;
+        if (droppedSegments < 0) {
+            qWarning() << "Failed to drop expired historical segments:" << errorText;
+            emit error(errorText);
+            return 0;
+        }
+        emit cleanupComplete(droppedSegments);
+        qInfo() << "Dropped" << droppedSegments << "expired historical segments";
+        return droppedSegments;
+    }
     
-    if (!query.exec()) {
-        qWarning() << "Failed to cleanup old data:" << query.lastError().text();
-        emit error(query.lastError().text());
+    const qint64 archiveCutoffSecs = QDateTime::currentDateTime().addDays(-m_archiveRetentionDays).toSecsSinceEpoch();
+    const bool archiving = !m_archiveDirectory.isEmpty();
+    
+    QStringList expired = DatabaseManager::historicalPartitionsBefore(db, cutoffTime.toSecsSinceEpoch());
+    if (archiving) {
+        // Days already past the archive retention are dropped without archiving
+        const QString archiveCutoff = DatabaseManager::historicalPartition(archiveCutoffSecs);
+        QStringList archived;
+        for (const QString& partition : expired) {
+            if (partition < archiveCutoff || archivePartition(db, partition)) {
+                archived.append(partition);
+            } else {
+                qWarning() << "Keeping historical partition" << partition << "until it can be archived";
+            }
+        }
+        expired = archived;
+    }
+    
+    // Whole partitions only: no row deletes, so the write lock is held briefly
+    if (!DatabaseManager::dropHistoricalPartitions(db, expired)) {
+        emit error("Failed to drop expired historical partitions");
         return 0;
     }
+    const int droppedCount = expired.size();
+    const int prunedArchives = pruneArchives(archiveCutoffSecs);
+    
+    // Drop locations that no longer have any history from the spatial index.
+    // Archived locations stay indexed; getNearbyData() skips empty ones.
+    if (droppedCount > 0 && !archiving && !query.exec(R"(
+            DELETE FROM historical_locations
+            WHERE NOT EXISTS (
+                SELECT 1 FROM historical_weather
+                WHERE lat_udeg = historical_locations.min_lat AND lon_udeg = historical_locations.min_lon
+            )
+        )")) {
+        qWarning() << "Failed to prune historical locations:" << query.lastError().text();
+    }
     
-    int deletedCount = query.numRowsAffected();
-    emit cleanupComplete(deletedCount);
-    qInfo() << "Cleaned up" << deletedCount << "old historical weather records";
+    emit cleanupComplete(droppedCount);
+    qInfo() << "Dropped" << droppedCount << "expired historical weather partitions,"
+            << prunedArchives << "expired archives";
     
-    return deletedCount;
+    return droppedCount;
 }
 
 QString HistoricalDataManager::generateLocationKey(double latitude, double longitude, double precision) const {
@@ -5,19 +5,106 @@
 #include <QList>
 #include <QDateTime>
 #include <QString>
+#include <QSqlDatabase>
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
+#include "services/HistoricalWriter.h"
+#include "services/HistoricalStore.h"
 
 /**
  * @brief Manages historical weather data storage for time-series analysis
  * 
  * Stores weather forecasts and observations from multiple sources in SQLite
  * database to enable moving average calculations and historical analysis.
+ * Raw samples go through a HistoricalStore backend: the SQLite partitions by
+ * default, or memory-mapped segment files for read-heavy workloads.
  */
 class HistoricalDataManager : public QObject
 {
     Q_OBJECT
     
 public:
+    /**
+     * @brief Stored history of one location near a query point
+     */
+    struct NearbySeries {
+        double latitude = 0.0;      // Snapped location of the series
+        double longitude = 0.0;
+        double distanceKm = 0.0;    // From the query point
+        ForecastSeries series;      // Sorted by time
+    };
+    
+    /**
+     * @brief Backend holding raw samples
+     */
+    enum class Backend {
+        Sqlite,     // Daily historical_weather partitions, rollups and archive
+        Mapped      // MappedHistoricalStore segments next to the database
+    };
+    
+    /**
+     * @brief Storage an aggregate query reads
+     */
+    enum class Resolution {
+        Raw,        // Daily partitions of historical_weather
+        Hourly,     // historical_rollup_hourly
+        Daily       // historical_rollup_daily
+    };
+    
+    /**
+     * @brief Min, max and mean of one parameter over a bucket
+     */
+    struct MetricSummary {
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        int count = 0;
+        
+        double mean() const { return count > 0 ? sum / count : 0.0; }
+        void merge(double minValue, double maxValue, double sumValue, int sampleCount);
+    };
+    
+    /**
+     * @brief Aggregated history over one time bucket
+     */
+    struct AggregateBucket {
+        QDateTime start;            // UTC, aligned to the bucket width
+        int sampleCount = 0;
+        MetricSummary temperature;
+        MetricSummary precipProbability;
+        MetricSummary precipIntensity;
+        MetricSummary windSpeed;
+        MetricSummary humidity;
+        MetricSummary pressure;
+        MetricSummary cloudCover;
+    };
+    
+    /**
+     * @brief Largest change of each field that does not make a new revision
+     * 
+     * Wind direction is compared the short way round the compass; condition
+     * and description must match exactly.
+     */
+    struct RevisionTolerance {
+        double temperature = 0.1;
+        double feelsLike = 0.1;
+        double precipProbability = 0.01;
+        double precipIntensity = 0.001;
+        double windSpeed = 0.1;
+        int windDirection = 1;
+        int humidity = 0;
+        double pressure = 0.1;
+        int cloudCover = 0;
+        int visibility = 0;
+        int uvIndex = 0;
+        
+        /**
+         * @brief Whether current differs from previous by more than the tolerance
+         */
+        bool exceeded(const WeatherSample& previous, const ForecastSeries& previousStrings,
+                      const WeatherSample& current, const ForecastSeries& currentStrings) const;
+    };
+    
     explicit HistoricalDataManager(QObject *parent = nullptr);
     ~HistoricalDataManager() override;
     
@@ -47,6 +134,97 @@ public:
      */
     bool storeForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source);
     
+    /**
+     * @brief Queue forecasts for the background writer
+     * 
+     * Returns without touching the disk; falls back to storeForecasts() when
+     * the writer is not running.
+     * @return false if the write queue was full and the forecasts were dropped
+     */
+    bool enqueueForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source);
+    
+    /**
+     * @brief Background writer, or nullptr before initialize() or with the mapped backend
+     */
+    HistoricalWriter* writer() const { return m_writer; }
+    
+    /**
+     * @brief Backend in use
+     * 
+     * The historical_backend preference ("sqlite" or "mapped") overrides
+     * setBackend(). The mapped backend needs an on-disk database and falls
+     * back to SQLite without one. Rollups and the archive are maintained by
+     * the SQLite backend only.
+     */
+    Backend backend() const { return m_backend; }
+    
+    /**
+     * @brief Choose the backend (takes effect at initialize())
+     */
+    void setBackend(Backend backend) { m_backend = backend; }
+    
+    /**
+     * @brief Raw sample store, or nullptr before initialize()
+     */
+    HistoricalStore* store() const { return m_store; }
+    
+    /**
+     * @brief Bind and execute batched inserts of series on db
+     * 
+     * The series is recorded as one forecast issuance. Only samples that
+     * differ beyond revisionTolerance() from the newest earlier revision of
+     * the same time are written, to forecast_revisions and to their daily
+     * partitions (created on demand), so re-fetching an unchanged horizon
+     * writes nothing but the issuance row. Callable from any thread with a
+     * connection owned by that thread. The caller owns the surrounding
+     * transaction.
+     * @param issuedAtSecs Issuance time in epoch seconds (0 for now)
+     * @param changedSamples Receives the number of samples written (optional)
+     */
+    static bool insertSeries(QSqlDatabase db, double latitude, double longitude,
+                             const ForecastSeries& series, const QString& source,
+                             QString& errorText, qint64 issuedAtSecs = 0,
+                             int* changedSamples = nullptr);
+    
+    /**
+     * @brief Reconstruct a forecast as it was issued
+     * 
+     * Takes the latest issuance at or before issuedAtSecs and, for each time
+     * in its horizon, the newest revision issued no later than it.
+     * Samples are appended to series in time order; nothing is appended if
+     * nothing was issued by then.
+     * @param resolvedIssuedAt Receives the issuance used, or 0 (optional)
+     */
+    static bool readIssuance(QSqlDatabase db, qint64 latKey, qint64 lonKey, const QString& source,
+                             qint64 issuedAtSecs, ForecastSeries& series, QString& errorText,
+                             qint64* resolvedIssuedAt = nullptr);
+    
+    /**
+     * @brief Tolerance insertSeries() applies (shared by all threads)
+     */
+    static RevisionTolerance revisionTolerance();
+    static void setRevisionTolerance(const RevisionTolerance& tolerance);
+    
+    /**
+     * @brief Read one series from the daily partitions overlapping [fromSecs, toSecs]
+     * 
+     * Counterpart of insertSeries(); archived days are not included.
+     * Samples are appended to series in time order.
+     */
+    static bool readSeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                           qint64 fromSecs, qint64 toSecs, const QString& source,
+                           ForecastSeries& series, QString& errorText);
+    
+    /**
+     * @brief Stream one series from the daily partitions overlapping [fromSecs, toSecs]
+     * 
+     * Streaming counterpart of readSeries(): rows go from a forward-only
+     * cursor into batcher, in time order. The caller flushes batcher.
+     */
+    static bool scanSeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                           qint64 fromSecs, qint64 toSecs, const QString& source,
+                           SeriesBatcher& batcher, QString& errorText);
+    
     /**
      * @brief Retrieve historical data for a location and time range
      * @param latitude Location latitude
@@ -54,13 +232,49 @@ public:
      * @param startTime Start time (inclusive)
      * @param endTime End time (inclusive)
      * @param source Source filter (empty string for all sources)
-     * @return List of weather data points
+     * @return List of weather data points, parented to this manager; prefer
+     *         scanHistoricalData() for long ranges
      */
     QList<WeatherData*> getHistoricalData(double latitude, double longitude,
                                           const QDateTime& startTime,
                                           const QDateTime& endTime,
                                           const QString& source = QString());
     
+    /**
+     * @brief Stream historical data for a location and time range in batches
+     * 
+     * Rows are read with a forward-only cursor and handed to visitor in
+     * fixed-size columnar batches, oldest first, so memory stays bounded by
+     * batchSize however long the range is. Archived days are decoded one
+     * day at a time.
+     * @param latitude Location latitude
+     * @param longitude Location longitude
+     * @param startTime Start time (inclusive)
+     * @param endTime End time (inclusive)
+     * @param visitor Called with each batch; returns false to stop the scan
+     * @param source Source filter (empty string for all sources)
+     * @param batchSize Samples per batch (the last batch may be smaller)
+     * @return false on error; stopping early through the visitor is not an error
+     */
+    bool scanHistoricalData(double latitude, double longitude,
+                            const QDateTime& startTime, const QDateTime& endTime,
+                            const SeriesVisitor& visitor, const QString& source = QString(),
+                            int batchSize = 512);
+    
+    /**
+     * @brief Retrieve a forecast as it stood at a past issuance
+     * 
+     * Revisions are kept by the SQLite backend only, for as long as the
+     * daily partitions they belong to.
+     * @param latitude Location latitude
+     * @param longitude Location longitude
+     * @param issuedAt Latest issuance at or before this time is used
+     * @param source Source identifier
+     * @return Forecast samples of that issuance, parented to this manager
+     */
+    QList<WeatherData*> getIssuedForecast(double latitude, double longitude,
+                                          const QDateTime& issuedAt, const QString& source);
+    
     /**
      * @brief Get recent historical data for a location
      * @param latitude Location latitude
@@ -74,9 +288,62 @@ public:
                                       const QString& source = QString());
     
     /**
-     * @brief Clean up old data
+     * @brief Retrieve the stored series nearest to a point
+     * 
+     * Candidate locations come from the historical_locations spatial index,
+     * so only the rows of the returned locations are read.
+     * @param latitude Query latitude
+     * @param longitude Query longitude
+     * @param radiusKm Search radius in kilometers
+     * @param startTime Start time (inclusive)
+     * @param endTime End time (inclusive)
+     * @param maxSeries Maximum number of locations to return
+     * @param source Source filter (empty string for all sources)
+     * @return Up to maxSeries series ordered by distance; locations with no
+     *         samples in the time range are skipped
+     */
+    QList<NearbySeries> getNearbyData(double latitude, double longitude, double radiusKm,
+                                      const QDateTime& startTime, const QDateTime& endTime,
+                                      int maxSeries = 8, const QString& source = QString());
+    
+    /**
+     * @brief Coarsest storage whose buckets evenly divide stepSeconds
+     */
+    static Resolution resolutionFor(qint64 stepSeconds);
+    
+    /**
+     * @brief Aggregate history into fixed-width buckets
+     * 
+     * Reads the daily or hourly rollups when the step is a whole number of
+     * days or hours, so a multi-week daily trend reads one row per day.
+     * Other steps, and every step with the mapped backend, aggregate raw
+     * samples. With rollups the range is widened to
+     * whole rollup buckets.
+     * @param latitude Location latitude
+     * @param longitude Location longitude
+     * @param startTime Start time (inclusive)
+     * @param endTime End time (inclusive)
+     * @param stepSeconds Bucket width, aligned to the Unix epoch (UTC days)
+     * @param source Source filter (empty string for all sources)
+     * @param resolution Receives the storage that was read (optional)
+     * @return Non-empty buckets in time order
+     */
+    QList<AggregateBucket> getAggregates(double latitude, double longitude,
+                                         const QDateTime& startTime, const QDateTime& endTime,
+                                         qint64 stepSeconds, const QString& source = QString(),
+                                         Resolution* resolution = nullptr);
+    
+    /**
+     * @brief Clean up old data by dropping whole daily partitions
+     * 
+     * The partition containing the cutoff is kept, so up to one extra day
+     * of history survives. When an archive directory is set, each expired
+     * partition is first written to a compressed archive file, and archives
+     * older than archiveRetentionDays() are deleted. A partition whose
+     * archive cannot be written is kept. The mapped backend drops whole
+     * daily segments instead.
      * @param daysToKeep Number of days of data to keep
-     * @return Number of records deleted
+     * @return Number of daily partitions (or segments) dropped
      */
     int cleanupOldData(int daysToKeep = 7);
     
@@ -90,15 +357,57 @@ public:
      */
     void setRetentionDays(int days) { m_retentionDays = days; }
     
+    /**
+     * @brief Directory holding archived partitions (empty disables archiving)
+     * 
+     * Defaults to historical_archive next to the database file.
+     */
+    QString archiveDirectory() const { return m_archiveDirectory; }
+    void setArchiveDirectory(const QString& directory) { m_archiveDirectory = directory; }
+    
+    /**
+     * @brief Days of history kept in the archive before it is deleted
+     */
+    int archiveRetentionDays() const { return m_archiveRetentionDays; }
+    void setArchiveRetentionDays(int days) { m_archiveRetentionDays = days; }
+    
 signals:
     void dataStored(int count);
-    void cleanupComplete(int deletedCount);
+    void cleanupComplete(int droppedPartitions);
     void error(QString message);
     
 private:
     bool createTableIfNotExists();
+    int writeForecasts(double latitude, double longitude, const QList<WeatherData*>& forecasts, const QString& source);
+    bool querySeries(QSqlDatabase db, qint64 latKey, qint64 lonKey,
+                     const QDateTime& startTime, const QDateTime& endTime,
+                     const QString& source, ForecastSeries& series);
+    static bool readPartition(QSqlDatabase db, const QString& partition, qint64 latKey, qint64 lonKey,
+                              qint64 fromSecs, qint64 toSecs, const QString& source,
+                              ForecastSeries& series, QString& errorText);
+    static bool scanPartition(QSqlDatabase db, const QString& partition, qint64 latKey, qint64 lonKey,
+                              qint64 fromSecs, qint64 toSecs, const QString& source,
+                              SeriesBatcher& batcher, QString& errorText);
+    static bool indexLocation(QSqlDatabase db, qint64 latKey, qint64 lonKey, QString& errorText);
+    void createStore(QSqlDatabase db);
+    bool queryArchive(QSqlDatabase db, const QString& archive, const QString& partition,
+                      qint64 latKey, qint64 lonKey,
+                      const QDateTime& startTime, const QDateTime& endTime,
+                      const QString& source, ForecastSeries& series);
+    bool archivePartition(QSqlDatabase db, const QString& partition);
+    int pruneArchives(qint64 cutoffSecs);
+    QStringList archivedPartitions(qint64 fromSecs, qint64 toSecs) const;
+    QString archivePath(const QString& partition) const;
+    static bool insertPartition(QSqlDatabase db, const QString& partition, qint64 latKey, qint64 lonKey,
+                                const ForecastSeries& series, const QVector<int>& rows,
+                                const QString& source, QString& errorText);
     QString generateLocationKey(double latitude, double longitude, double precision = 0.0001) const;
     int m_retentionDays;
+    int m_archiveRetentionDays;
+    QString m_archiveDirectory;
+    Backend m_backend;
+    HistoricalStore* m_store;
+    HistoricalWriter* m_writer;
 };
 
 #endif // HISTORICALDATAMANAGER_H
@@ -0,0 +1,69 @@
+#include "services/HistoricalStore.h"
+
+namespace {
+constexpr qint64 SecondsPerDay = 24 * 3600;
+
+qint64 floorDiv(qint64 value, qint64 divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+} // namespace
+
+SeriesBatcher::SeriesBatcher(int batchSize, SeriesVisitor visitor)
+    : m_batchSize(qMax(1, batchSize))
+    , m_visitor(std::move(visitor))
+    , m_delivered(0)
+    , m_stopped(false)
+{
+    m_pending.reserve(m_batchSize);
+}
+
+bool SeriesBatcher::append(const WeatherSample& sample) {
+    if (m_stopped) {
+        return false;
+    }
+    m_pending.append(sample);
+    return m_pending.size() < m_batchSize || flush();
+}
+
+bool SeriesBatcher::append(const ForecastSeries& series) {
+    for (int i = 0; i < series.size() && !m_stopped; ++i) {
+        m_pending.append(series.at(i), series);
+        if (m_pending.size() >= m_batchSize) {
+            flush();
+        }
+    }
+    return !m_stopped;
+}
+
+bool SeriesBatcher::flush() {
+    if (m_stopped) {
+        return false;
+    }
+    if (m_pending.isEmpty()) {
+        return true;
+    }
+
+    m_delivered += m_pending.size();
+    m_stopped = !m_visitor(m_pending);
+
+    // Clearing drops the string table too, so it never outgrows one batch
+    m_pending.clear();
+    m_pending.reserve(m_batchSize);
+    return !m_stopped;
+}
+
+bool HistoricalStore::scanSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                 qint64 fromSecs, qint64 toSecs, const QString& source,
+                                 SeriesBatcher& batcher, QString& errorText) {
+    for (qint64 day = floorDiv(fromSecs, SecondsPerDay); day * SecondsPerDay <= toSecs; ++day) {
+        ForecastSeries series;
+        if (!readSeries(latMicroDegrees, lonMicroDegrees, qMax(fromSecs, day * SecondsPerDay),
+                        qMin(toSecs, (day + 1) * SecondsPerDay - 1), source, series, errorText)) {
+            return false;
+        }
+        if (!batcher.append(series)) {
+            break;
+        }
+    }
+    return true;
+}
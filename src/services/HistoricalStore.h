@@ -0,0 +1,113 @@
+#ifndef HISTORICALSTORE_H
+#define HISTORICALSTORE_H
+
+#include <QString>
+#include <functional>
+#include "models/ForecastSeries.h"
+
+/**
+ * @brief Receives one batch of a streamed scan
+ *
+ * The batch is only valid during the call; its string ids refer to the
+ * batch itself.
+ * @return false to stop the scan
+ */
+using SeriesVisitor = std::function<bool(const ForecastSeries& batch)>;
+
+/**
+ * @brief Collects streamed samples into fixed-size batches for a SeriesVisitor
+ *
+ * At most one batch is held at a time, so a scan of any length runs in
+ * memory bounded by the batch size.
+ */
+class SeriesBatcher
+{
+public:
+    SeriesBatcher(int batchSize, SeriesVisitor visitor);
+
+    /**
+     * @brief The batch being filled; intern strings here before append(sample)
+     */
+    ForecastSeries& pending() { return m_pending; }
+
+    /**
+     * @brief Add a sample whose string ids refer to pending()
+     * @return false once the visitor has stopped the scan
+     */
+    bool append(const WeatherSample& sample);
+
+    /**
+     * @brief Add every sample of a series, in order
+     * @return false once the visitor has stopped the scan
+     */
+    bool append(const ForecastSeries& series);
+
+    /**
+     * @brief Deliver the partly filled batch
+     * @return false once the visitor has stopped the scan
+     */
+    bool flush();
+
+    bool stopped() const { return m_stopped; }
+    int batchSize() const { return m_batchSize; }
+    qint64 samplesDelivered() const { return m_delivered; }
+
+private:
+    int m_batchSize;
+    SeriesVisitor m_visitor;
+    ForecastSeries m_pending;
+    qint64 m_delivered;
+    bool m_stopped;
+};
+
+/**
+ * @brief Storage backend for raw historical samples
+ *
+ * Series are keyed by snapped location (integer micro-degrees, see
+ * DatabaseManager::toMicroDegrees()) and source. Writing a timestamp that is
+ * already stored for the same series replaces the stored sample.
+ */
+class HistoricalStore
+{
+public:
+    virtual ~HistoricalStore() = default;
+
+    /**
+     * @brief Short backend name for logs and benchmarks
+     */
+    virtual QString storeName() const = 0;
+
+    /**
+     * @brief Store one batch of samples atomically
+     */
+    virtual bool insertSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                              const ForecastSeries& series, const QString& source,
+                              QString& errorText) = 0;
+
+    /**
+     * @brief Append the samples in [fromSecs, toSecs] to series in time order
+     * @param source Source filter (empty string for all sources)
+     */
+    virtual bool readSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                            qint64 fromSecs, qint64 toSecs, const QString& source,
+                            ForecastSeries& series, QString& errorText) = 0;
+
+    /**
+     * @brief Stream the samples in [fromSecs, toSecs] to batcher in time order
+     *
+     * The default reads one UTC day at a time through readSeries(). Stopping
+     * early through the visitor is not an error. The caller flushes batcher.
+     * @param source Source filter (empty string for all sources)
+     */
+    virtual bool scanSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                            qint64 fromSecs, qint64 toSecs, const QString& source,
+                            SeriesBatcher& batcher, QString& errorText);
+
+    /**
+     * @brief Drop every whole UTC day of samples that ends at or before cutoffSecs
+     * @return Number of storage units (partitions, segments) dropped, or -1 on error
+     */
+    virtual int dropBefore(qint64 cutoffSecs, QString& errorText) = 0;
+};
+
+#endif // HISTORICALSTORE_H
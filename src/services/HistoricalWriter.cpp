@@ -0,0 +1,192 @@
+#include "services/HistoricalWriter.h"
+#include "services/HistoricalDataManager.h"
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+// How long the writer lingers after waking so concurrent arrivals share a commit
+constexpr int GroupCommitWindowMs = 50;
+} // namespace
+
+HistoricalWriter::HistoricalWriter(const QString& databasePath, int capacitySamples, QObject *parent)
+    : QObject(parent)
+    , m_databasePath(databasePath)
+    , m_pool(databasePath, DatabaseManager::TuningProfile::performance(),
+             QString("historical_writer_%1").arg(reinterpret_cast<quintptr>(this), 0, 16))
+    , m_capacity(qMax(1, capacitySamples))
+    , m_thread(nullptr)
+    , m_stopping(false)
+    , m_writing(false)
+{
+}
+
+HistoricalWriter::~HistoricalWriter() {
+    stop();
+}
+
+bool HistoricalWriter::start() {
+    QMutexLocker locker(&m_mutex);
+    if (m_thread) {
+        return true;
+    }
+
+    // A second connection to an in-memory database would see a different database
+    if (m_databasePath.isEmpty() || m_databasePath == ":memory:") {
+        qWarning() << "Historical writer needs an on-disk database";
+        return false;
+    }
+
+    m_stopping = false;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("HistoricalWriter");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void HistoricalWriter::stop() {
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_thread) {
+            return;
+        }
+        m_stopping = true;
+        m_wake.wakeAll();
+        thread = m_thread;
+    }
+
+    // The writer drains the queue before it exits
+    thread->wait();
+    delete thread;
+
+    QMutexLocker locker(&m_mutex);
+    m_thread = nullptr;
+}
+
+bool HistoricalWriter::isRunning() const {
+    QMutexLocker locker(&m_mutex);
+    return m_thread && !m_stopping;
+}
+
+bool HistoricalWriter::enqueue(double latitude, double longitude, const ForecastSeries& series, const QString& source) {
+    if (series.isEmpty()) {
+        return true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_thread || m_stopping) {
+        return false;
+    }
+
+    if (m_stats.queuedSamples + series.size() > m_capacity) {
+        ++m_stats.droppedBatches;
+        m_stats.droppedSamples += series.size();
+        return false;
+    }
+
+    m_queue.enqueue({latitude, longitude, source, series, QDateTime::currentSecsSinceEpoch()});
+    m_stats.queuedSamples += series.size();
+    m_stats.highWaterMark = qMax(m_stats.highWaterMark, m_stats.queuedSamples);
+    ++m_stats.acceptedBatches;
+    m_wake.wakeOne();
+    return true;
+}
+
+bool HistoricalWriter::waitForIdle(int timeoutMs) {
+    QDeadlineTimer deadline(timeoutMs);
+    QMutexLocker locker(&m_mutex);
+    while (!m_queue.isEmpty() || m_writing) {
+        if (!m_drained.wait(&m_mutex, deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HistoricalWriter::Stats HistoricalWriter::stats() const {
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void HistoricalWriter::run() {
+    {
+        QSqlDatabase db = m_pool.connection();
+        if (!db.isOpen()) {
+            qWarning() << "Historical writer failed to open database";
+            emit error("Failed to open historical database");
+        }
+
+        QMutexLocker locker(&m_mutex);
+        while (true) {
+            while (m_queue.isEmpty() && !m_stopping) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_queue.isEmpty()) {
+                break; // Stopping with nothing left to write
+            }
+
+            // Let other producers join this commit unless the queue is filling up
+            QDeadlineTimer window(GroupCommitWindowMs);
+            while (!m_stopping && m_stats.queuedSamples < m_capacity / 2 && !window.hasExpired()) {
+                m_wake.wait(&m_mutex, window);
+            }
+
+            QQueue<Batch> group;
+            group.swap(m_queue);
+            const int sampleCount = m_stats.queuedSamples;
+            m_stats.queuedSamples = 0;
+            m_writing = true;
+            locker.unlock();
+
+            QElapsedTimer timer;
+            timer.start();
+
+            QString errorText;
+            int unchangedSamples = 0;
+            bool committed = db.isOpen() && db.transaction();
+            for (const Batch& batch : group) {
+                if (!committed) {
+                    break;
+                }
+                int changedSamples = 0;
+                committed = HistoricalDataManager::insertSeries(db, batch.latitude, batch.longitude,
+                                                                batch.series, batch.source, errorText,
+                                                                batch.issuedAtSecs, &changedSamples);
+                unchangedSamples += batch.series.size() - changedSamples;
+            }
+            if (committed) {
+                committed = db.commit();
+            }
+            if (!committed) {
+                if (errorText.isEmpty()) {
+                    errorText = db.lastError().text();
+                }
+                db.rollback();
+                qWarning() << "Historical writer failed to commit" << sampleCount << "samples:" << errorText;
+                emit error(errorText);
+            } else {
+                emit batchCommitted(sampleCount);
+            }
+
+            locker.relock();
+            m_writing = false;
+            m_stats.lastCommitMs = timer.elapsed();
+            if (committed) {
+                ++m_stats.commits;
+                m_stats.writtenSamples += sampleCount;
+                m_stats.unchangedSamples += unchangedSamples;
+            } else {
+                ++m_stats.failedCommits;
+                m_stats.droppedSamples += sampleCount;
+            }
+            m_drained.wakeAll();
+        }
+    }
+    // Close the connection now rather than when the thread object is destroyed
+    m_pool.release();
+}
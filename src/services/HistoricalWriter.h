@@ -0,0 +1,121 @@
+#ifndef HISTORICALWRITER_H
+#define HISTORICALWRITER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QString>
+#include "models/ForecastSeries.h"
+#include "database/DatabaseManager.h"
+#include "database/ConnectionPool.h"
+
+class QThread;
+
+/**
+ * @brief Asynchronous historical ingest on a dedicated writer thread
+ *
+ * Producers on any thread enqueue plain forecast series. The writer thread
+ * takes its own SQLite connection from a ConnectionPool; each time it wakes
+ * it drains everything queued and commits it in a single transaction (group
+ * commit), so callers never wait on disk I/O.
+ *
+ * The queue is bounded by sample count. When it is full, enqueue() rejects
+ * the batch instead of blocking; rejections and queue depth are reported
+ * through stats() as back-pressure metrics.
+ */
+class HistoricalWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Queue and commit counters
+     */
+    struct Stats {
+        int queuedSamples = 0;          // Waiting to be written right now
+        int highWaterMark = 0;          // Deepest the queue has been
+        qint64 acceptedBatches = 0;
+        qint64 droppedBatches = 0;      // Rejected because the queue was full
+        qint64 droppedSamples = 0;
+        qint64 writtenSamples = 0;
+        qint64 unchangedSamples = 0;    // Of those, matched the previous issuance and were skipped
+        qint64 commits = 0;             // Group commits performed
+        qint64 failedCommits = 0;
+        qint64 lastCommitMs = 0;        // Duration of the most recent commit
+    };
+
+    /**
+     * @brief Constructor
+     * @param databasePath SQLite file holding the historical_weather table
+     * @param capacitySamples Maximum number of queued samples
+     * @param parent Parent QObject
+     */
+    explicit HistoricalWriter(const QString& databasePath, int capacitySamples = 8192, QObject *parent = nullptr);
+    ~HistoricalWriter() override;
+
+    /**
+     * @brief Start the writer thread
+     * @return false if there is no on-disk database to connect to
+     */
+    bool start();
+
+    /**
+     * @brief Commit whatever is queued, then stop the writer thread
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief Queue a series for writing (callable from any thread)
+     * @return false if the queue is full or the writer is not running
+     */
+    bool enqueue(double latitude, double longitude, const ForecastSeries& series, const QString& source);
+
+    /**
+     * @brief Block until everything queued so far has been committed
+     * @return false if the timeout elapsed first
+     */
+    bool waitForIdle(int timeoutMs = 5000);
+
+    Stats stats() const;
+    int capacity() const { return m_capacity; }
+
+    /**
+     * @brief Pragmas for the writer's connection (set before start())
+     */
+    void setTuningProfile(const DatabaseManager::TuningProfile& profile) { m_pool.setTuningProfile(profile); }
+
+signals:
+    /**
+     * @brief Emitted from the writer thread after each group commit
+     */
+    void batchCommitted(int sampleCount);
+    void error(QString message);
+
+private:
+    struct Batch {
+        double latitude;
+        double longitude;
+        QString source;
+        ForecastSeries series;
+        qint64 issuedAtSecs;    // When the forecast was enqueued, not when it is written
+    };
+
+    void run();
+
+    QString m_databasePath;
+    ConnectionPool m_pool;
+    int m_capacity;
+    QThread* m_thread;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;      // Producers -> writer
+    QWaitCondition m_drained;   // Writer -> waitForIdle()
+    QQueue<Batch> m_queue;
+    bool m_stopping;
+    bool m_writing;             // A drained group is being committed
+    Stats m_stats;
+};
+
+#endif // HISTORICALWRITER_H
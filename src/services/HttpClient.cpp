@@ -0,0 +1,132 @@
+#include "services/HttpClient.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHttp2Configuration>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QDebug>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+#include <QHttp1Configuration>
+#endif
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
+
+namespace {
+// Forecast bodies are tens to hundreds of kilobytes; a larger window than
+// the 64 KiB default lets them arrive without flow-control round trips
+constexpr int Http2StreamWindowBytes = 1024 * 1024;
+} // namespace
+
+HttpClient* HttpClient::s_instance = nullptr;
+
+HttpClient* HttpClient::instance() {
+    if (!s_instance) {
+        s_instance = new HttpClient(Options(), QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+HttpClient::HttpClient(const Options& options, QObject *parent)
+    : QObject(parent)
+    , m_manager(new QNetworkAccessManager(this))
+    , m_options(options)
+{
+}
+
+HttpClient::~HttpClient() {
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+void HttpClient::setOptions(const Options& options) {
+    m_options = options;
+}
+
+QNetworkRequest HttpClient::request(const QUrl& url) const {
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, m_options.userAgent);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, m_options.http2);
+    if (m_options.http2) {
+        QHttp2Configuration http2;
+        http2.setServerPushEnabled(false);
+        http2.setStreamReceiveWindowSize(Http2StreamWindowBytes);
+        request.setHttp2Configuration(http2);
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    QHttp1Configuration http1;
+    http1.setNumberOfConnectionsPerHost(qBound(1, m_options.connectionsPerHost, 255));
+    request.setHttp1Configuration(http1);
+#endif
+    if (m_options.keepAliveSeconds > 0) {
+        request.setAttribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute,
+                             m_options.keepAliveSeconds);
+    }
+    if (m_options.transferTimeoutMs > 0) {
+        request.setTransferTimeout(m_options.transferTimeoutMs);
+    }
+    // Without an explicit Accept-Encoding, Qt offers the encodings it can
+    // decode and decompresses the body itself
+    if (!m_options.compression) {
+        request.setRawHeader("Accept-Encoding", "identity");
+    }
+    return request;
+}
+
+QNetworkReply* HttpClient::get(const QNetworkRequest& request) {
+    QNetworkReply* reply = m_manager->get(request);
+    if (!reply) {
+        return nullptr;
+    }
+
+    const QString host = request.url().host();
+    HostStats& stats = m_hostStats[host];
+    ++stats.requests;
+    ++stats.active;
+    stats.peakActive = qMax(stats.peakActive, stats.active);
+
+    // Only emitted when the request cannot use a cached connection
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, host]() {
+        ++m_hostStats[host].newConnections;
+    });
+    const qint64 startedMs = QDateTime::currentMSecsSinceEpoch();
+    connect(reply, &QNetworkReply::finished, this, [this, reply, host, startedMs]() {
+        onReplyFinished(reply, host, startedMs);
+    });
+    return reply;
+}
+
+void HttpClient::onReplyFinished(QNetworkReply* reply, const QString& host, qint64 startedMs) {
+    HostStats& stats = m_hostStats[host];
+    stats.active = qMax(0, stats.active - 1);
+    ++stats.finished;
+    stats.totalLatencyMs += QDateTime::currentMSecsSinceEpoch() - startedMs;
+    if (reply->error() != QNetworkReply::NoError) {
+        ++stats.failures;
+    }
+    if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+        ++stats.http2Replies;
+    }
+    // Services read the body afterwards; bytesAvailable() does not consume it
+    stats.bytesReceived += reply->bytesAvailable();
+}
+
+void HttpClient::preconnect(const QUrl& url) {
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+
+#if QT_CONFIG(ssl)
+    if (url.scheme() == "https") {
+        QSslConfiguration ssl = QSslConfiguration::defaultConfiguration();
+        if (m_options.http2) {
+            ssl.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                         QSslConfiguration::NextProtocolHttp1_1});
+        }
+        m_manager->connectToHostEncrypted(url.host(), url.port(443), ssl);
+        return;
+    }
+#endif
+    m_manager->connectToHost(url.host(), url.port(80));
+}
@@ -0,0 +1,114 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QUrl>
+#include <QNetworkRequest>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * @brief HTTP client shared by all weather services
+ *
+ * Wraps one QNetworkAccessManager so every service draws from the same
+ * connection cache: a TLS session opened by one request is reused by the
+ * next request to that host, and HTTP/2 multiplexes concurrent requests
+ * (such as a spatio-temporal grid fan-out) over a single connection.
+ * Idle connections are kept warm between refreshes, and preconnect()
+ * completes the handshake before the first request is made.
+ *
+ * Lives on the thread that created it, like the manager it wraps.
+ */
+class HttpClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Settings applied to every request
+     */
+    struct Options {
+        bool http2 = true;                  // Negotiate HTTP/2 via ALPN, fall back to HTTP/1.1
+        int connectionsPerHost = 6;         // Parallel HTTP/1.1 connections (Qt 6.5 and later)
+        int keepAliveSeconds = 300;         // Idle time before a cached connection is closed
+        bool compression = true;            // Accept compressed bodies, decoded transparently
+        int transferTimeoutMs = 30000;      // 0 disables
+        QString userAgent = "HyperlocalWeather/1.0";
+    };
+
+    /**
+     * @brief Counters for one host
+     */
+    struct HostStats {
+        qint64 requests = 0;
+        qint64 finished = 0;
+        qint64 failures = 0;
+        qint64 newConnections = 0;          // Requests that had to connect (and handshake) first
+        qint64 http2Replies = 0;
+        qint64 bytesReceived = 0;           // Decoded body bytes
+        qint64 totalLatencyMs = 0;          // Request to finished, summed
+        int active = 0;
+        int peakActive = 0;
+
+        qint64 reusedConnections() const { return qMax<qint64>(0, finished - newConnections); }
+        double meanLatencyMs() const { return finished > 0 ? double(totalLatencyMs) / finished : 0.0; }
+    };
+
+    /**
+     * @brief Client used by services that were not given one
+     */
+    static HttpClient* instance();
+
+    explicit HttpClient(const Options& options = Options(), QObject *parent = nullptr);
+    ~HttpClient() override;
+
+    Options options() const { return m_options; }
+
+    /**
+     * @brief Change the settings (applies to requests made afterwards)
+     */
+    void setOptions(const Options& options);
+
+    /**
+     * @brief Request for url with the configured protocol, timeout and headers
+     *
+     * Services add their own headers before passing it to get().
+     */
+    QNetworkRequest request(const QUrl& url) const;
+
+    /**
+     * @brief Send a GET and track it in the host's statistics
+     * @return The reply, owned by the caller
+     */
+    QNetworkReply* get(const QNetworkRequest& request);
+
+    /**
+     * @brief Open a connection to url's host ahead of the first request
+     *
+     * Completes the TCP and TLS handshakes (offering HTTP/2) so the first
+     * real request does not pay for them. Does nothing for an invalid URL.
+     */
+    void preconnect(const QUrl& url);
+
+    /**
+     * @brief Statistics per host name
+     */
+    QHash<QString, HostStats> hostStats() const { return m_hostStats; }
+    HostStats hostStats(const QString& host) const { return m_hostStats.value(host); }
+    void resetStats() { m_hostStats.clear(); }
+
+    QNetworkAccessManager* networkManager() const { return m_manager; }
+
+private:
+    void onReplyFinished(QNetworkReply* reply, const QString& host, qint64 startedMs);
+
+    static HttpClient* s_instance;
+    QNetworkAccessManager* m_manager;
+    Options m_options;
+    QHash<QString, HostStats> m_hostStats;
+};
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,476 @@
+#include "services/MappedHistoricalStore.h"
+#include "database/DatabaseManager.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief One sample as stored in a segment, read in place through the mapping
+ */
+struct MappedHistoricalStore::Record {
+    qint64 timestampMs;
+    double temperature;
+    double feelsLike;
+    double pressure;
+    double windSpeed;
+    double precipProbability;
+    double precipIntensity;
+    qint32 humidity;
+    qint32 windDirection;
+    qint32 cloudCover;
+    qint32 visibility;
+    qint32 uvIndex;
+    qint32 conditionId;         // Index into the store dictionary
+    qint32 descriptionId;
+    qint32 reserved;
+};
+
+namespace {
+const char SegmentMagic[4] = {'H', 'L', 'W', 'S'};
+const char SegmentSuffix[] = ".seg";
+const char StringsFileName[] = "strings.dat";
+const char DayFormat[] = "yyyyMMdd";
+constexpr int DayLength = 8;
+
+// Segment header: magic, quint16 version, quint16 record size,
+// quint32 byte order mark, quint32 reserved
+constexpr quint16 SegmentVersion = 1;
+constexpr quint32 ByteOrderMark = 0x01020304;
+constexpr int SegmentHeaderSize = 16;
+
+// Bounds open file handles; reads re-map on demand
+constexpr int MaxMappedSegments = 256;
+
+QString dayName(qint64 epochSeconds) {
+    return QDateTime::fromSecsSinceEpoch(epochSeconds, QTimeZone::utc()).toString(DayFormat);
+}
+
+QByteArray segmentHeader(quint16 recordSize) {
+    QByteArray header(SegmentHeaderSize, '\0');
+    char* base = header.data();
+    const quint32 byteOrder = ByteOrderMark;
+    std::memcpy(base, SegmentMagic, sizeof(SegmentMagic));
+    std::memcpy(base + 4, &SegmentVersion, sizeof(SegmentVersion));
+    std::memcpy(base + 6, &recordSize, sizeof(recordSize));
+    std::memcpy(base + 8, &byteOrder, sizeof(byteOrder));
+    return header;
+}
+} // namespace
+
+MappedHistoricalStore::MappedHistoricalStore(const QString& directory)
+    : m_directory(directory)
+{
+    static_assert(std::is_trivially_copyable<Record>::value,
+                  "Segment records are copied to and from the mapping as raw bytes");
+}
+
+MappedHistoricalStore::~MappedHistoricalStore() {
+    releaseSegments();
+}
+
+bool MappedHistoricalStore::open(QString& errorText) {
+    if (!QDir().mkpath(m_directory)) {
+        errorText = QString("Failed to create segment directory %1").arg(m_directory);
+        return false;
+    }
+
+    m_strings.clear();
+    m_stringIds.clear();
+
+    // Length-prefixed UTF-8 entries; ids are positions in the file
+    QFile file(QDir(m_directory).filePath(StringsFileName));
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadWrite)) {
+        errorText = file.errorString();
+        return false;
+    }
+
+    const QByteArray bytes = file.readAll();
+    int offset = 0;
+    while (offset + 4 <= bytes.size()) {
+        const quint32 length = qFromLittleEndian<quint32>(bytes.constData() + offset);
+        if (length > static_cast<quint32>(bytes.size() - offset - 4)) {
+            break;
+        }
+        const QString value = QString::fromUtf8(bytes.constData() + offset + 4, static_cast<int>(length));
+        m_stringIds.insert(value, static_cast<qint32>(m_strings.size()));
+        m_strings.append(value);
+        offset += 4 + static_cast<int>(length);
+    }
+
+    // Drop a partial entry left by an interrupted append so later entries line up
+    if (offset != bytes.size()) {
+        qWarning() << "Truncating damaged segment dictionary at" << offset << "bytes";
+        file.resize(offset);
+    }
+    return true;
+}
+
+qint32 MappedHistoricalStore::internString(const QString& value, QString& errorText) {
+    auto it = m_stringIds.constFind(value);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+
+    QFile file(QDir(m_directory).filePath(StringsFileName));
+    const QByteArray utf8 = value.toUtf8();
+    char length[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(utf8.size()), length);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)
+        || file.write(length, sizeof(length)) != sizeof(length)
+        || file.write(utf8) != utf8.size()) {
+        errorText = file.errorString();
+        return WeatherSample::NoString;
+    }
+
+    const qint32 id = static_cast<qint32>(m_strings.size());
+    m_strings.append(value);
+    m_stringIds.insert(value, id);
+    return id;
+}
+
+QString MappedHistoricalStore::locationDirectory(qint64 latMicroDegrees, qint64 lonMicroDegrees) const {
+    return QDir(m_directory).filePath(QString("%1_%2").arg(latMicroDegrees).arg(lonMicroDegrees));
+}
+
+const QStringList& MappedHistoricalStore::segmentNames(const QString& locationDirectory) {
+    auto it = m_segmentNames.find(locationDirectory);
+    if (it == m_segmentNames.end()) {
+        // Names start with the day, so name order is time order
+        it = m_segmentNames.insert(locationDirectory, QDir(locationDirectory).entryList(
+            {QString("*") + SegmentSuffix}, QDir::Files, QDir::Name));
+    }
+    return it.value();
+}
+
+const MappedHistoricalStore::Segment* MappedHistoricalStore::segment(const QString& path, QString& errorText) {
+    auto it = m_segments.constFind(path);
+    if (it != m_segments.constEnd()) {
+        return &it.value();
+    }
+    if (m_segments.size() >= MaxMappedSegments) {
+        releaseSegments();
+    }
+
+    QFile* file = new QFile(path);
+    Segment segment;
+    segment.file = file;
+    if (!file->open(QIODevice::ReadOnly)) {
+        errorText = file->errorString();
+        delete file;
+        return nullptr;
+    }
+
+    segment.size = file->size();
+    if (segment.size >= SegmentHeaderSize) {
+        segment.mapping = file->map(0, segment.size);
+    }
+
+    const uchar* base = segment.mapping;
+    quint16 version = 0;
+    quint16 recordSize = 0;
+    quint32 byteOrder = 0;
+    if (base) {
+        std::memcpy(&version, base + 4, sizeof(version));
+        std::memcpy(&recordSize, base + 6, sizeof(recordSize));
+        std::memcpy(&byteOrder, base + 8, sizeof(byteOrder));
+    }
+    if (!base || std::memcmp(base, SegmentMagic, sizeof(SegmentMagic)) != 0
+        || version != SegmentVersion || recordSize != sizeof(Record) || byteOrder != ByteOrderMark) {
+        errorText = QString("Invalid historical segment %1").arg(path);
+        delete file;
+        return nullptr;
+    }
+
+    // A partial trailing record from an interrupted append is ignored
+    segment.records = reinterpret_cast<const Record*>(base + SegmentHeaderSize);
+    segment.count = static_cast<int>((segment.size - SegmentHeaderSize) / static_cast<qint64>(sizeof(Record)));
+    return &m_segments.insert(path, segment).value();
+}
+
+void MappedHistoricalStore::releaseSegment(const QString& path) {
+    auto it = m_segments.find(path);
+    if (it != m_segments.end()) {
+        it->file->unmap(it->mapping);
+        delete it->file;
+        m_segments.erase(it);
+    }
+}
+
+void MappedHistoricalStore::releaseSegments() {
+    for (Segment& segment : m_segments) {
+        segment.file->unmap(segment.mapping);
+        delete segment.file;
+    }
+    m_segments.clear();
+}
+
+bool MappedHistoricalStore::insertSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                         const ForecastSeries& series, const QString& source,
+                                         QString& errorText) {
+    // Route samples to their daily segments
+    QMap<QString, QVector<int>> days;
+    for (int i = 0; i < series.size(); ++i) {
+        const qint64 timestampMs = series.timestampAt(i);
+        if (timestampMs != WeatherSample::InvalidTime) {
+            days[dayName(timestampMs / 1000)].append(i);
+        }
+    }
+    if (days.isEmpty()) {
+        return true;
+    }
+
+    const QString directory = locationDirectory(latMicroDegrees, lonMicroDegrees);
+    if (!QDir().mkpath(directory)) {
+        errorText = QString("Failed to create segment directory %1").arg(directory);
+        return false;
+    }
+    const QString suffix = "_" + QString::fromLatin1(source.toUtf8().toHex()) + SegmentSuffix;
+
+    for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+        QVector<Record> records;
+        records.reserve(it.value().size());
+        for (int i : it.value()) {
+            const WeatherSample sample = series.at(i);
+            Record record = {};
+            record.timestampMs = sample.timestampMs;
+            record.temperature = sample.temperature;
+            record.feelsLike = sample.feelsLike;
+            record.pressure = sample.pressure;
+            record.windSpeed = sample.windSpeed;
+            record.precipProbability = sample.precipProbability;
+            record.precipIntensity = sample.precipIntensity;
+            record.humidity = sample.humidity;
+            record.windDirection = sample.windDirection;
+            record.cloudCover = sample.cloudCover;
+            record.visibility = sample.visibility;
+            record.uvIndex = sample.uvIndex;
+            record.conditionId = WeatherSample::NoString;
+            record.descriptionId = WeatherSample::NoString;
+            if (sample.conditionId != WeatherSample::NoString) {
+                record.conditionId = internString(series.stringAt(sample.conditionId), errorText);
+                if (record.conditionId == WeatherSample::NoString) {
+                    return false;
+                }
+            }
+            if (sample.descriptionId != WeatherSample::NoString) {
+                record.descriptionId = internString(series.stringAt(sample.descriptionId), errorText);
+                if (record.descriptionId == WeatherSample::NoString) {
+                    return false;
+                }
+            }
+            records.append(record);
+        }
+
+        // Sorted and unique by time; the last sample of a timestamp wins
+        std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.timestampMs < b.timestampMs;
+        });
+        QVector<Record> unique;
+        unique.reserve(records.size());
+        for (const Record& record : records) {
+            if (!unique.isEmpty() && unique.last().timestampMs == record.timestampMs) {
+                unique.last() = record;
+            } else {
+                unique.append(record);
+            }
+        }
+
+        if (!writeSegment(QDir(directory).filePath(it.key() + suffix), unique, errorText)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MappedHistoricalStore::writeSegment(const QString& path, const QVector<Record>& records, QString& errorText) {
+    const char* bytes = reinterpret_cast<const char*>(records.constData());
+    qint64 byteCount = static_cast<qint64>(records.size()) * static_cast<qint64>(sizeof(Record));
+
+    QVector<Record> merged;
+    if (QFile::exists(path)) {
+        const Segment* existing = segment(path, errorText);
+        if (!existing) {
+            return false;
+        }
+
+        // Strictly newer samples on a whole-record boundary are a plain append
+        const bool aligned = (existing->size - SegmentHeaderSize) % static_cast<qint64>(sizeof(Record)) == 0;
+        if (aligned && (existing->count == 0
+                        || records.first().timestampMs > existing->records[existing->count - 1].timestampMs)) {
+            releaseSegment(path);
+            QFile file(path);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(bytes, byteCount) != byteCount) {
+                errorText = file.errorString();
+                return false;
+            }
+            return true;
+        }
+
+        // Overlap: merge in time order, new samples replacing stored ones
+        const Record* stored = existing->records;
+        const int storedCount = existing->count;
+        merged.reserve(storedCount + records.size());
+        int s = 0;
+        int r = 0;
+        while (s < storedCount || r < records.size()) {
+            if (r == records.size() || (s < storedCount && stored[s].timestampMs < records[r].timestampMs)) {
+                merged.append(stored[s++]);
+            } else {
+                if (s < storedCount && stored[s].timestampMs == records[r].timestampMs) {
+                    ++s;
+                }
+                merged.append(records[r++]);
+            }
+        }
+        bytes = reinterpret_cast<const char*>(merged.constData());
+        byteCount = static_cast<qint64>(merged.size()) * static_cast<qint64>(sizeof(Record));
+        releaseSegment(path);
+    } else {
+        // Same key as segmentNames(): the path was built from locationDirectory()
+        m_segmentNames.remove(QFileInfo(path).path());
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(segmentHeader(static_cast<quint16>(sizeof(Record)))) != SegmentHeaderSize
+        || file.write(bytes, byteCount) != byteCount
+        || !file.commit()) {
+        errorText = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool MappedHistoricalStore::readSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                                       ForecastSeries& series, QString& errorText) {
+    const QString directory = locationDirectory(latMicroDegrees, lonMicroDegrees);
+    const QString first = dayName(fromSecs);
+    const QString last = dayName(toSecs);
+    const QString suffix = source.isEmpty()
+        ? QString() : "_" + QString::fromLatin1(source.toUtf8().toHex()) + SegmentSuffix;
+    const qint64 fromMs = fromSecs * 1000;
+    const qint64 toMs = toSecs * 1000;
+    const double latitude = DatabaseManager::fromMicroDegrees(latMicroDegrees);
+    const double longitude = DatabaseManager::fromMicroDegrees(lonMicroDegrees);
+
+    // Several sources of one day interleave in time, so gather them apart and sort
+    ForecastSeries gathered;
+    ForecastSeries& out = source.isEmpty() ? gathered : series;
+
+    // Store dictionary ids to ids of the output series, filled on first use
+    QVector<qint32> remap(m_strings.size(), WeatherSample::NoString - 1);
+    auto mapId = [&](qint32 id) {
+        if (id < 0 || id >= remap.size()) {
+            return WeatherSample::NoString;
+        }
+        if (remap.at(id) == WeatherSample::NoString - 1) {
+            remap[id] = out.internString(m_strings.at(id));
+        }
+        return remap.at(id);
+    };
+
+    const QStringList names = segmentNames(directory);
+    for (const QString& name : names) {
+        const QString day = name.left(DayLength);
+        if (day < first) {
+            continue;
+        }
+        if (day > last) {
+            break;
+        }
+        if (!suffix.isEmpty() && name.mid(DayLength) != suffix) {
+            continue;
+        }
+
+        const Segment* mapped = segment(QDir(directory).filePath(name), errorText);
+        if (!mapped) {
+            return false;
+        }
+
+        // Records are sorted by time: the range is two binary searches
+        const Record* begin = mapped->records;
+        const Record* end = begin + mapped->count;
+        const Record* low = std::lower_bound(begin, end, fromMs, [](const Record& record, qint64 timestampMs) {
+            return record.timestampMs < timestampMs;
+        });
+        const Record* high = std::upper_bound(low, end, toMs, [](qint64 timestampMs, const Record& record) {
+            return timestampMs < record.timestampMs;
+        });
+
+        out.reserve(out.size() + static_cast<int>(high - low));
+        for (const Record* record = low; record < high; ++record) {
+            WeatherSample sample;
+            sample.timestampMs = record->timestampMs;
+            sample.latitude = latitude;
+            sample.longitude = longitude;
+            sample.temperature = record->temperature;
+            sample.feelsLike = record->feelsLike;
+            sample.pressure = record->pressure;
+            sample.windSpeed = record->windSpeed;
+            sample.precipProbability = record->precipProbability;
+            sample.precipIntensity = record->precipIntensity;
+            sample.humidity = record->humidity;
+            sample.windDirection = record->windDirection;
+            sample.cloudCover = record->cloudCover;
+            sample.visibility = record->visibility;
+            sample.uvIndex = record->uvIndex;
+            sample.conditionId = mapId(record->conditionId);
+            sample.descriptionId = mapId(record->descriptionId);
+            out.append(sample);
+        }
+    }
+
+    if (source.isEmpty()) {
+        if (!gathered.isSortedByTime()) {
+            gathered.sortByTime();
+        }
+        series.reserve(series.size() + gathered.size());
+        for (int i = 0; i < gathered.size(); ++i) {
+            series.append(gathered.at(i), gathered);
+        }
+    }
+    return true;
+}
+
+int MappedHistoricalStore::dropBefore(qint64 cutoffSecs, QString& errorText) {
+    // Same rule as the SQLite partitions: the day containing the cutoff is kept
+    const QString cutoff = dayName(cutoffSecs);
+    QDir root(m_directory);
+    int dropped = 0;
+
+    const QStringList locations = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& location : locations) {
+        QDir directory(root.filePath(location));
+        const QStringList names = directory.entryList({QString("*") + SegmentSuffix}, QDir::Files, QDir::Name);
+        for (const QString& name : names) {
+            if (name.left(DayLength) >= cutoff) {
+                break;
+            }
+            const QString path = directory.filePath(name);
+            releaseSegment(path);
+            if (!directory.remove(name)) {
+                errorText = QString("Failed to remove historical segment %1").arg(path);
+                m_segmentNames.clear();
+                return -1;
+            }
+            ++dropped;
+        }
+        root.rmdir(location);   // Only succeeds once the location is empty
+    }
+
+    m_segmentNames.clear();
+    return dropped;
+}
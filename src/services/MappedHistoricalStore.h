@@ -0,0 +1,81 @@
+#ifndef MAPPEDHISTORICALSTORE_H
+#define MAPPEDHISTORICALSTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "services/HistoricalStore.h"
+
+class QFile;
+
+/**
+ * @brief Historical samples in memory-mapped, fixed-width segment files
+ *
+ * Each location has a directory holding one segment per UTC day and source:
+ *
+ *   <directory>/<lat_udeg>_<lon_udeg>/<yyyyMMdd>_<hex source>.seg
+ *
+ * A segment is a small header followed by fixed-width records sorted by
+ * timestamp, so a range read is two binary searches over the mapping and a
+ * copy of the records in between; nothing is parsed. Batches newer than a
+ * segment's last record are appended; overlapping batches rewrite the
+ * segment with new samples replacing old ones. Condition and description
+ * strings are ids into a store-wide dictionary file.
+ *
+ * Segments use the host byte order and are rejected on a host that differs.
+ * Not thread-safe; use one instance per thread.
+ */
+class MappedHistoricalStore : public HistoricalStore
+{
+public:
+    explicit MappedHistoricalStore(const QString& directory);
+    ~MappedHistoricalStore() override;
+
+    /**
+     * @brief Create the directory if needed and load the string dictionary
+     */
+    bool open(QString& errorText);
+
+    QString directory() const { return m_directory; }
+
+    QString storeName() const override { return "mapped"; }
+
+    bool insertSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                      const ForecastSeries& series, const QString& source,
+                      QString& errorText) override;
+    bool readSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                    qint64 fromSecs, qint64 toSecs, const QString& source,
+                    ForecastSeries& series, QString& errorText) override;
+    int dropBefore(qint64 cutoffSecs, QString& errorText) override;
+
+private:
+    struct Record;
+
+    /**
+     * @brief An open, mapped segment file
+     */
+    struct Segment {
+        QFile* file = nullptr;
+        uchar* mapping = nullptr;
+        qint64 size = 0;                // File size when mapped
+        const Record* records = nullptr;
+        int count = 0;
+    };
+
+    QString locationDirectory(qint64 latMicroDegrees, qint64 lonMicroDegrees) const;
+    const QStringList& segmentNames(const QString& locationDirectory);
+    const Segment* segment(const QString& path, QString& errorText);
+    void releaseSegment(const QString& path);
+    void releaseSegments();
+    bool writeSegment(const QString& path, const QVector<Record>& records, QString& errorText);
+    qint32 internString(const QString& value, QString& errorText);
+
+    QString m_directory;
+    QHash<QString, Segment> m_segments;         // By file path
+    QHash<QString, QStringList> m_segmentNames; // Sorted file names by location directory
+    QStringList m_strings;
+    QHash<QString, qint32> m_stringIds;
+};
+
+#endif // MAPPEDHISTORICALSTORE_H
@@ -3,13 +3,112 @@
 #include <QDebug>
 #include <QtMath>
 #include <algorithm>
+#include <numeric>
 #include <QDateTime>
 
+namespace {
+// Window helpers over a column viewed through a sort permutation:
+// positions [start, end) of `order` select the samples in time order.
+
+template <typename T>
+double windowMean(const QVector<T>& column, const QVector<int>& order, int start, int end) {
+    double sum = 0.0;
+    int count = 0;
+    for (int pos = start; pos < end; ++pos) {
+        const double value = static_cast<double>(column.at(order.at(pos)));
+        if (qIsFinite(value)) {
+            sum += value;
+            count++;
+        }
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+double windowExponential(const QVector<double>& column, const QVector<int>& order,
+                         int start, int end, double alpha) {
+    if (start >= end) {
+        return 0.0;
+    }
+    if (alpha < 0.0 || alpha > 1.0) {
+        return column.at(order.at(end - 1));
+    }
+    
+    // EMA: EMA_today = alpha * value_today + (1 - alpha) * EMA_yesterday
+    double ema = column.at(order.at(start));
+    for (int pos = start + 1; pos < end; ++pos) {
+        const double value = column.at(order.at(pos));
+        if (qIsFinite(value)) {
+            ema = alpha * value + (1.0 - alpha) * ema;
+        }
+    }
+    return ema;
+}
+
+int windowWindDirection(const QVector<qint32>& directions, const QVector<double>& speeds,
+                        const QVector<int>& order, int start, int end) {
+    if (start >= end) {
+        return 0;
+    }
+    
+    // Vector average for wind direction
+    double windX = 0.0;
+    double windY = 0.0;
+    int count = 0;
+    for (int pos = start; pos < end; ++pos) {
+        const int index = order.at(pos);
+        if (speeds.at(index) > 0 && directions.at(index) >= 0) {
+            double radians = qDegreesToRadians(static_cast<double>(directions.at(index)));
+            windX += qCos(radians) * speeds.at(index);
+            windY += qSin(radians) * speeds.at(index);
+            count++;
+        }
+    }
+    
+    if (count == 0 || (qAbs(windX) < 0.001 && qAbs(windY) < 0.001)) {
+        return directions.at(order.at(end - 1));
+    }
+    
+    int avgDirection = static_cast<int>(qRadiansToDegrees(qAtan2(windY, windX)));
+    if (avgDirection < 0) {
+        avgDirection += 360;
+    }
+    return avgDirection;
+}
+
+// Replace sample's measured values with their averages over positions
+// [start, end) of data viewed through order
+void smoothSample(WeatherSample& sample, const ForecastSeries& data, const QVector<int>& order,
+                  int start, int end, bool exponential, double alpha) {
+    if (exponential) {
+        sample.temperature = windowExponential(data.temperatures(), order, start, end, alpha);
+        sample.feelsLike = windowExponential(data.feelsLikes(), order, start, end, alpha);
+        sample.pressure = windowExponential(data.pressures(), order, start, end, alpha);
+        sample.windSpeed = windowExponential(data.windSpeeds(), order, start, end, alpha);
+        sample.precipProbability = qMax(0.0, qMin(1.0, windowExponential(data.precipProbabilities(), order, start, end, alpha)));
+        sample.precipIntensity = qMax(0.0, windowExponential(data.precipIntensities(), order, start, end, alpha));
+    } else {
+        sample.temperature = windowMean(data.temperatures(), order, start, end);
+        sample.feelsLike = windowMean(data.feelsLikes(), order, start, end);
+        sample.pressure = windowMean(data.pressures(), order, start, end);
+        sample.windSpeed = windowMean(data.windSpeeds(), order, start, end);
+        sample.precipProbability = qMax(0.0, qMin(1.0, windowMean(data.precipProbabilities(), order, start, end)));
+        sample.precipIntensity = qMax(0.0, windowMean(data.precipIntensities(), order, start, end));
+    }
+    
+    sample.windDirection = windowWindDirection(data.windDirections(), data.windSpeeds(), order, start, end);
+    sample.humidity = static_cast<qint32>(qRound(windowMean(data.humidities(), order, start, end)));
+    sample.cloudCover = static_cast<qint32>(qRound(windowMean(data.cloudCovers(), order, start, end)));
+    sample.visibility = static_cast<qint32>(qRound(windowMean(data.visibilities(), order, start, end)));
+    sample.uvIndex = static_cast<qint32>(qRound(windowMean(data.uvIndices(), order, start, end)));
+}
+} // namespace
+
 MovingAverageFilter::MovingAverageFilter(QObject *parent)
     : QObject(parent)
     , m_type(Simple)
     , m_defaultWindowSize(10)
     , m_alpha(0.2)
+    , m_streamContext(0)
 {
     // Set default window sizes per parameter type
     m_parameterWindowSizes["temperature"] = 10;
@@ -231,116 +330,117 @@ WeatherData* MovingAverageFilter::getExponentialMovingAverage(double alpha) {
     return averaged;
 }
 
-QList<WeatherData*> MovingAverageFilter::smoothForecast(const QList<WeatherData*>& forecasts,
-                                                          const QList<WeatherData*>& historicalData) {
-    QList<WeatherData*> smoothed;
-    
+ForecastSeries MovingAverageFilter::smoothForecast(const ForecastSeries& forecasts,
+                                                   const ForecastSeries& historicalData) {
     if (forecasts.isEmpty()) {
-        return smoothed;
+        return ForecastSeries();
     }
     
-    // Add historical data to context (if provided)
-    QList<WeatherData*> allData;
-    allData.append(historicalData);
-    allData.append(forecasts);
+    // Add historical data to context (if provided), then the forecasts
+    ForecastSeries allData = historicalData;
+    const int historyCount = allData.size();
+    allData.reserve(historyCount + forecasts.size());
+    for (int i = 0; i < forecasts.size(); ++i) {
+        allData.append(forecasts.at(i), forecasts);
+    }
     
-    // Sort by timestamp
-    std::sort(allData.begin(), allData.end(),
-              [](WeatherData* a, WeatherData* b) {
-                  return a->timestamp() < b->timestamp();
-              });
+    // Sort by timestamp via an index permutation so each forecast's
+    // position in the merged timeline is known without searching
+    QVector<int> order(allData.size());
+    std::iota(order.begin(), order.end(), 0);
+    const QVector<qint64>& times = allData.timestamps();
+    std::stable_sort(order.begin(), order.end(), [&times](int a, int b) {
+        return times.at(a) < times.at(b);
+    });
+    QVector<int> positionOf(allData.size());
+    for (int pos = 0; pos < order.size(); ++pos) {
+        positionOf[order[pos]] = pos;
+    }
     
-    // Apply moving average to each forecast point
-    for (WeatherData* forecast : forecasts) {
-        if (!forecast) {
-            continue;
-        }
-        
-        // Find position in sorted list
-        int pos = allData.indexOf(forecast);
-        if (pos < 0) {
-            // Forecast not in list, use as-is
-            smoothed.append(forecast);
-            continue;
-        }
-        
+    ForecastSeries smoothed = forecasts.emptyCopy();
+    smoothed.reserve(forecasts.size());
+    const int windowSize = m_defaultWindowSize;
+    
+    for (int f = 0; f < forecasts.size(); ++f) {
         // Get window of data around this point
-        int windowSize = m_defaultWindowSize;
-        int startPos = qMax(0, pos - windowSize / 2);
-        int endPos = qMin(allData.size(), pos + windowSize / 2 + 1);
-        QList<WeatherData*> windowData = allData.mid(startPos, endPos - startPos);
-        
-        if (windowData.isEmpty()) {
-            smoothed.append(forecast);
-            continue;
-        }
-        
-        // Calculate moving average for this window
-        QList<double> temps, feelsLike, pressures, windSpeeds, precipProbs, precipIntensities;
-        QList<int> windDirections, humidities, cloudCovers, visibilities, uvIndices;
-        
-        for (WeatherData* data : windowData) {
-            temps.append(data->temperature());
-            feelsLike.append(data->feelsLike());
-            pressures.append(data->pressure());
-            windSpeeds.append(data->windSpeed());
-            precipProbs.append(data->precipProbability());
-            precipIntensities.append(data->precipIntensity());
-            windDirections.append(data->windDirection());
-            humidities.append(data->humidity());
-            cloudCovers.append(data->cloudCover());
-            visibilities.append(data->visibility());
-            uvIndices.append(data->uvIndex());
-        }
-        
-        // Create smoothed data point
-        WeatherData* smoothedData = new WeatherData();
-        smoothedData->setLatitude(forecast->latitude());
-        smoothedData->setLongitude(forecast->longitude());
-        smoothedData->setTimestamp(forecast->timestamp());
-        
-        if (m_type == Exponential) {
-            // Use exponential moving average
-            smoothedData->setTemperature(calculateExponentialAverage(temps, m_alpha));
-            smoothedData->setFeelsLike(calculateExponentialAverage(feelsLike, m_alpha));
-            smoothedData->setPressure(calculateExponentialAverage(pressures, m_alpha));
-            smoothedData->setWindSpeed(calculateExponentialAverage(windSpeeds, m_alpha));
-            smoothedData->setPrecipProbability(qMax(0.0, qMin(1.0, calculateExponentialAverage(precipProbs, m_alpha))));
-            smoothedData->setPrecipIntensity(qMax(0.0, calculateExponentialAverage(precipIntensities, m_alpha)));
-        } else {
-            // Use simple moving average
-            smoothedData->setTemperature(calculateSimpleAverage(temps, windowData.size()));
-            smoothedData->setFeelsLike(calculateSimpleAverage(feelsLike, windowData.size()));
-            smoothedData->setPressure(calculateSimpleAverage(pressures, windowData.size()));
-            smoothedData->setWindSpeed(calculateSimpleAverage(windSpeeds, windowData.size()));
-            smoothedData->setPrecipProbability(qMax(0.0, qMin(1.0, calculateSimpleAverage(precipProbs, windowData.size()))));
-            smoothedData->setPrecipIntensity(qMax(0.0, calculateSimpleAverage(precipIntensities, windowData.size())));
-        }
-        
-        smoothedData->setWindDirection(windDirectionAverage(windDirections, windSpeeds, windowData.size()));
-        smoothedData->setHumidity(static_cast<int>(qRound(calculateSimpleAverage(
-            QList<double>(humidities.begin(), humidities.end()), windowData.size()))));
-        smoothedData->setCloudCover(static_cast<int>(qRound(calculateSimpleAverage(
-            QList<double>(cloudCovers.begin(), cloudCovers.end()), windowData.size()))));
-        smoothedData->setVisibility(static_cast<int>(qRound(calculateSimpleAverage(
-            QList<double>(visibilities.begin(), visibilities.end()), windowData.size()))));
-        smoothedData->setUvIndex(static_cast<int>(qRound(calculateSimpleAverage(
-            QList<double>(uvIndices.begin(), uvIndices.end()), windowData.size()))));
-        
-        smoothedData->setWeatherCondition(forecast->weatherCondition());
-        smoothedData->setWeatherDescription(forecast->weatherDescription());
+        const int pos = positionOf[historyCount + f];
+        const int startPos = qMax(0, pos - windowSize / 2);
+        const int endPos = qMin(allData.size(), pos + windowSize / 2 + 1);
         
-        smoothed.append(smoothedData);
+        // Location, timestamp and condition come from the forecast itself
+        WeatherSample sample = forecasts.at(f);
+        smoothSample(sample, allData, order, startPos, endPos, m_type == Exponential, m_alpha);
+        smoothed.append(sample);
     }
     
     return smoothed;
 }
 
+ForecastSeries MovingAverageFilter::smoothStream(const ForecastSeries& batch) {
+    for (int i = 0; i < batch.size(); ++i) {
+        m_streamBuffer.append(batch.at(i), batch);
+    }
+    return drainStream(false);
+}
+
+ForecastSeries MovingAverageFilter::finishStream() {
+    ForecastSeries smoothed = drainStream(true);
+    resetStream();
+    return smoothed;
+}
+
+void MovingAverageFilter::resetStream() {
+    m_streamBuffer.clear();
+    m_streamContext = 0;
+}
+
+ForecastSeries MovingAverageFilter::drainStream(bool final) {
+    // The buffer holds up to half a window of already smoothed samples as
+    // left context, then the samples still waiting for their right context
+    const int half = m_defaultWindowSize / 2;
+    const int size = m_streamBuffer.size();
+    const int ready = final ? size : qMax(m_streamContext, size - half);
+    
+    ForecastSeries smoothed = m_streamBuffer.emptyCopy();
+    if (ready <= m_streamContext) {
+        return smoothed;
+    }
+    
+    QVector<int> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    smoothed.reserve(ready - m_streamContext);
+    for (int pos = m_streamContext; pos < ready; ++pos) {
+        WeatherSample sample = m_streamBuffer.at(pos);
+        smoothSample(sample, m_streamBuffer, order, qMax(0, pos - half), qMin(size, pos + half + 1),
+                     m_type == Exponential, m_alpha);
+        smoothed.append(sample);
+    }
+    
+    // Keep the left context of the samples still pending; the fresh buffer
+    // drops strings no longer referenced
+    const int keepFrom = qMax(0, ready - half);
+    ForecastSeries remaining;
+    remaining.reserve(size - keepFrom + half);
+    for (int pos = keepFrom; pos < size; ++pos) {
+        remaining.append(m_streamBuffer.at(pos), m_streamBuffer);
+    }
+    m_streamBuffer = remaining;
+    m_streamContext = ready - keepFrom;
+    return smoothed;
+}
+
+QList<WeatherData*> MovingAverageFilter::smoothForecast(const QList<WeatherData*>& forecasts,
+                                                          const QList<WeatherData*>& historicalData) {
+    return smoothForecast(ForecastSeries::fromWeatherData(forecasts),
+                          ForecastSeries::fromWeatherData(historicalData)).toWeatherDataList();
+}
+
 void MovingAverageFilter::clear() {
     for (WeatherData* data : m_dataPoints) {
         delete data;
     }
     m_dataPoints.clear();
+    resetStream();
 }
 
 double MovingAverageFilter::calculateSimpleAverage(const QList<double>& values, int windowSize) const {
@@ -5,6 +5,7 @@
 #include <QList>
 #include <QDateTime>
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
 
 /**
  * @brief Temporal moving average filter for weather data smoothing
@@ -71,6 +72,15 @@ public:
      */
     WeatherData* getExponentialMovingAverage(double alpha = -1.0);
     
+    /**
+     * @brief Apply moving average to a forecast series
+     * @param forecasts Forecast samples to smooth
+     * @param historicalData Historical samples to use for smoothing (optional)
+     * @return Smoothed forecast samples, one per input forecast
+     */
+    ForecastSeries smoothForecast(const ForecastSeries& forecasts,
+                                  const ForecastSeries& historicalData = ForecastSeries());
+    
     /**
      * @brief Apply moving average to a list of forecasts
      * @param forecasts List of weather data points to smooth
@@ -80,6 +90,29 @@ public:
     QList<WeatherData*> smoothForecast(const QList<WeatherData*>& forecasts,
                                        const QList<WeatherData*>& historicalData = QList<WeatherData*>());
     
+    /**
+     * @brief Smooth a time-ordered stream one batch at a time
+     * 
+     * Feed the batches of HistoricalDataManager::scanHistoricalData() in
+     * order; memory stays bounded by one batch plus a window. A sample's
+     * window reaches windowSize / 2 samples ahead, so each call returns the
+     * samples whose window is complete and holds back the rest. The
+     * concatenated output equals smoothForecast() over the whole stream.
+     * @param batch Next samples of the stream, in time order
+     * @return Smoothed samples now complete (possibly none)
+     */
+    ForecastSeries smoothStream(const ForecastSeries& batch);
+    
+    /**
+     * @brief Smooth the samples still held back and end the stream
+     */
+    ForecastSeries finishStream();
+    
+    /**
+     * @brief Discard a partly consumed stream
+     */
+    void resetStream();
+    
     /**
      * @brief Clear all stored data points
      */
@@ -97,12 +130,15 @@ private:
     double calculateSimpleAverage(const QList<double>& values, int windowSize) const;
     double calculateExponentialAverage(const QList<double>& values, double alpha) const;
     int windDirectionAverage(const QList<int>& directions, const QList<double>& speeds, int windowSize) const;
+    ForecastSeries drainStream(bool final);
     
     QList<WeatherData*> m_dataPoints;
     MovingAverageType m_type;
     int m_defaultWindowSize;
     double m_alpha;
     QMap<QString, int> m_parameterWindowSizes;
+    ForecastSeries m_streamBuffer;      // Left context, then samples awaiting right context
+    int m_streamContext;                // Leading samples of m_streamBuffer already returned
 };
 
 #endif // MOVINGAVERAGEFILTER_H
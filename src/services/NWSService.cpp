@@ -1,5 +1,8 @@
 #include "services/NWSService.h"
 #include "models/WeatherData.h"
+#include "services/HttpClient.h"
+#include "models/ForecastSeries.h"
+#include "models/ForecastCodec.h"
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QJsonDocument>
@@ -14,10 +17,7 @@ const QString NWSService::BASE_URL = "https://api.weather.gov";
 
 NWSService::NWSService(QObject *parent)
     : WeatherService(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
 {
-{
-}
 }
 
 NWSService::~NWSService() {
@@ -39,6 +39,7 @@ void NWSService::cancelActiveRequests() {
         reply->deleteLater();
     }
     m_activeReplies.clear();
+    clearInFlight();
 }
 
 void NWSService::unregisterReply(QNetworkReply* reply) {
@@ -49,22 +50,19 @@ void NWSService::unregisterReply(QNetworkReply* reply) {
         reply->disconnect(this);
         m_activeReplies.remove(reply);
     }
+    releaseInFlight(reply);
 }
 
 void NWSService::fetchForecast(double latitude, double longitude) {
-    QString cacheKey = QString("%1_%2").arg(latitude, 0, 'f', 4).arg(longitude, 0, 'f', 4);
-    
-    // First, get gridpoint if we don't have it
-    if (!m_gridpointCache.contains(cacheKey)) {
+    // Resolve the gridpoint first unless its cell is already known
+    GridpointIndex::Gridpoint gridpoint;
+    if (!m_gridpoints.lookup(latitude, longitude, gridpoint)) {
         fetchGridpoint(latitude, longitude);
-        // Store lat/lon for later use
-        m_gridpointCache[cacheKey].office = ""; // Placeholder
         return;
     }
     
-    Gridpoint gridpoint = m_gridpointCache[cacheKey];
-    if (!gridpoint.isValid()) {
-        fetchGridpoint(latitude, longitude);
+    const QString flightKey = inFlightKey("forecast", latitude, longitude);
+    if (joinInFlight(flightKey)) {
         return;
     }
     
@@ -72,22 +70,29 @@ void NWSService::fetchForecast(double latitude, double longitude) {
     QString forecastUrl = QString("%1/gridpoints/%2/%3,%4/forecast")
         .arg(BASE_URL, gridpoint.office, QString::number(gridpoint.x), QString::number(gridpoint.y));
     
-    QNetworkRequest request{QUrl(forecastUrl)};
-    request.setHeader(QNetworkRequest::UserAgentHeader, "HyperlocalWeather/1.0");
+    QNetworkRequest request = httpClient()->request(QUrl(forecastUrl));
     request.setRawHeader("Accept", "application/json");
     
-    // Use conditional GET if we have last modified time
-    QString lastModifiedKey = QString("forecast_%1").arg(cacheKey);
-    if (m_lastModifiedCache.contains(lastModifiedKey)) {
-        QDateTime lastModified = m_lastModifiedCache[lastModifiedKey];
-        request.setRawHeader("If-Modified-Since", lastModified.toUTC().toString(Qt::RFC2822Date).toUtf8());
-    }
+    // Revalidate the forecast parsed last time; an unchanged one comes back as a bodiless 304
+    applyValidators(request, forecastUrl);
     
-    QNetworkReply* reply = m_networkManager->get(request);
+    QNetworkReply* reply = httpClient()->get(request);
     m_activeReplies.insert(reply);
+    trackInFlight(flightKey, reply);
     connect(reply, &QNetworkReply::finished, this, &NWSService::onForecastReplyFinished);
     reply->setProperty("latitude", latitude);
     reply->setProperty("longitude", longitude);
+    reply->setProperty("validatorKey", forecastUrl);
+}
+
+QString NWSService::upstreamCell(double latitude, double longitude) {
+    // The resolved grid square when known, else the index cell it will resolve for
+    GridpointIndex::Gridpoint gridpoint;
+    if (m_gridpoints.lookup(latitude, longitude, gridpoint)) {
+        return QString("%1/%2,%3").arg(gridpoint.office).arg(gridpoint.x).arg(gridpoint.y);
+    }
+    const GridpointIndex::Cell cell = GridpointIndex::cellOf(latitude, longitude);
+    return QString("cell/%1,%2").arg(cell.row).arg(cell.col);
 }
 
 void NWSService::fetchCurrent(double latitude, double longitude) {
@@ -96,30 +101,40 @@ void NWSService::fetchCurrent(double latitude, double longitude) {
 }
 
 void NWSService::fetchGridpoint(double latitude, double longitude) {
+    const QString flightKey = inFlightKey("points", latitude, longitude);
+    if (joinInFlight(flightKey)) {
+        return;
+    }
+    
     QString pointsUrl = QString("%1/points/%2,%3")
         .arg(BASE_URL, QString::number(latitude, 'f', 4), QString::number(longitude, 'f', 4));
     
-    QNetworkRequest request{QUrl(pointsUrl)};
-    request.setHeader(QNetworkRequest::UserAgentHeader, "HyperlocalWeather/1.0");
+    QNetworkRequest request = httpClient()->request(QUrl(pointsUrl));
     request.setRawHeader("Accept", "application/json");
     
-    QNetworkReply* reply = m_networkManager->get(request);
+    QNetworkReply* reply = httpClient()->get(request);
     m_activeReplies.insert(reply);
+    trackInFlight(flightKey, reply);
     connect(reply, &QNetworkReply::finished, this, &NWSService::onPointsReplyFinished);
     reply->setProperty("latitude", latitude);
     reply->setProperty("longitude", longitude);
 }
 
 void NWSService::fetchAlerts(double latitude, double longitude) {
+    const QString flightKey = inFlightKey("alerts", latitude, longitude);
+    if (joinInFlight(flightKey)) {
+        return;
+    }
+    
     QString alertsUrl = QString("%1/alerts/active?point=%2,%3")
         .arg(BASE_URL, QString::number(latitude, 'f', 4), QString::number(longitude, 'f', 4));
     
-    QNetworkRequest request{QUrl(alertsUrl)};
-    request.setHeader(QNetworkRequest::UserAgentHeader, "HyperlocalWeather/1.0");
+    QNetworkRequest request = httpClient()->request(QUrl(alertsUrl));
     request.setRawHeader("Accept", "application/json");
     
-    QNetworkReply* reply = m_networkManager->get(request);
+    QNetworkReply* reply = httpClient()->get(request);
     m_activeReplies.insert(reply);
+    trackInFlight(flightKey, reply);
     connect(reply, &QNetworkReply::finished, this, &NWSService::onAlertsReplyFinished);
 }
 
@@ -142,10 +157,11 @@ void NWSService::onPointsReplyFinished() {
     }
     
     QByteArray data = reply->readAll();
-    parsePointsResponse(data, lat, lon);
     
     // Now fetch forecast with the gridpoint
-    fetchForecast(lat, lon);
+    if (parsePointsResponse(data, lat, lon)) {
+        fetchForecast(lat, lon);
+    }
     
     reply->deleteLater();
 }
@@ -159,38 +175,41 @@ void NWSService::onForecastReplyFinished() {
     unregisterReply(reply);
     
     if (reply->error() != QNetworkReply::NoError) {
-        if (reply->error() == QNetworkReply::ContentNotFoundError) {
-            // 304 Not Modified - use cached data
-            qDebug() << "Forecast not modified, using cache";
-        } else {
-            qWarning() << "Forecast request error:" << reply->errorString();
-            emit error(reply->errorString());
-        }
+        qWarning() << "Forecast request error:" << reply->errorString();
+        emit error(reply->errorString());
         reply->deleteLater();
         return;
     }
     
-    // Check for 304 Not Modified
+    const QString validatorKey = reply->property("validatorKey").toString();
+    
+    // 304 Not Modified: replay the forecast parsed from the last full response
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     if (statusCode == 304) {
-        qDebug() << "Forecast not modified (304)";
+        ForecastSeries series;
+        const QByteArray payload = revalidated(validatorKey, reply);
+        if (payload.isEmpty() || !ForecastCodec::decode(payload, series)) {
+            emit error("Forecast not modified but no stored copy to replay");
+        } else {
+            qDebug() << "Forecast not modified (304), replaying" << series.size() << "periods";
+            // The gridpoint may have been resolved for a different coordinate
+            QList<WeatherData*> forecasts = series.toWeatherDataList();
+            for (WeatherData* forecast : forecasts) {
+                forecast->setLatitude(reply->property("latitude").toDouble());
+                forecast->setLongitude(reply->property("longitude").toDouble());
+            }
+            emit forecastReady(forecasts);
+        }
         reply->deleteLater();
         return;
     }
     
-    // Update Last-Modified cache
-    QVariant lastModified = reply->header(QNetworkRequest::LastModifiedHeader);
-    if (lastModified.isValid()) {
-        QString cacheKey = QString("%1_%2").arg(
-            reply->property("latitude").toDouble(), 0, 'f', 4)
-            .arg(reply->property("longitude").toDouble(), 0, 'f', 4);
-        m_lastModifiedCache[QString("forecast_%1").arg(cacheKey)] = lastModified.toDateTime();
-    }
-    
     double lat = reply->property("latitude").toDouble();
     double lon = reply->property("longitude").toDouble();
     QByteArray data = reply->readAll();
-    parseForecastResponse(data, lat, lon);
+    QByteArray payload;
+    parseForecastResponse(data, lat, lon, &payload);
+    storeValidators(validatorKey, reply, payload);
     
     reply->deleteLater();
 }
@@ -248,11 +267,11 @@ void NWSService::onNetworkError(QNetworkReply::NetworkError networkError) {
     }
 }
 
-void NWSService::parsePointsResponse(const QByteArray& data, double lat, double lon) {
+bool NWSService::parsePointsResponse(const QByteArray& data, double lat, double lon) {
     QJsonDocument doc = QJsonDocument::fromJson(data);
     if (doc.isNull() || !doc.isObject()) {
         emit error("Invalid points response");
-        return;
+        return false;
     }
     
     QJsonObject obj = doc.object();
@@ -261,7 +280,7 @@ void NWSService::parsePointsResponse(const QByteArray& data, double lat, double
     QString forecastUrl = props["forecast"].toString();
     if (forecastUrl.isEmpty()) {
         emit error("No forecast URL in response");
-        return;
+        return false;
     }
     
     // Extract office, x, y from forecast URL
@@ -269,40 +288,43 @@ void NWSService::parsePointsResponse(const QByteArray& data, double lat, double
     QStringList parts = forecastUrl.split('/');
     if (parts.size() < 6) {
         emit error("Invalid forecast URL format");
-        return;
+        return false;
     }
     
     QString office = parts[parts.size() - 3];
     QStringList grid = parts[parts.size() - 2].split(',');
     if (grid.size() != 2) {
         emit error("Invalid gridpoint format");
-        return;
+        return false;
     }
     
     bool ok;
     int x = grid[0].toInt(&ok);
     if (!ok) {
         emit error("Invalid gridpoint X coordinate");
-        return;
+        return false;
     }
     int y = grid[1].toInt(&ok);
     if (!ok) {
         emit error("Invalid gridpoint Y coordinate");
-        return;
+        return false;
     }
     
-    QString cacheKey = QString("%1_%2").arg(lat, 0, 'f', 4).arg(lon, 0, 'f', 4);
-    Gridpoint gridpoint;
+    GridpointIndex::Gridpoint gridpoint;
     gridpoint.office = office;
     gridpoint.x = x;
     gridpoint.y = y;
-    gridpoint.lastModified = QDateTime::currentDateTime();
-    m_gridpointCache[cacheKey] = gridpoint;
+    if (!gridpoint.isValid()) {
+        emit error("Invalid gridpoint");
+        return false;
+    }
+    m_gridpoints.insert(lat, lon, gridpoint);
     
     emit gridpointReady(office, x, y);
+    return true;
 }
 
-void NWSService::parseForecastResponse(const QByteArray& data, double lat, double lon) {
+void NWSService::parseForecastResponse(const QByteArray& data, double lat, double lon, QByteArray* payload) {
     QJsonDocument doc = QJsonDocument::fromJson(data);
     if (doc.isNull() || !doc.isObject()) {
         emit error("Invalid forecast response");
@@ -321,6 +343,11 @@ void NWSService::parseForecastResponse(const QByteArray& data, double lat, doubl
         forecast->setLongitude(lon);
     }
     
+    // Encode before emitting; receivers take ownership of the objects
+    if (payload && !forecasts.isEmpty()) {
+        *payload = ForecastCodec::encode(ForecastSeries::fromWeatherData(forecasts));
+    }
+    
     emit forecastReady(forecasts);
 }
 
@@ -2,7 +2,7 @@
 #define NWSSERVICE_H
 
 #include "services/WeatherService.h"
-#include <QNetworkAccessManager>
+#include "services/GridpointIndex.h"
 #include <QNetworkReply>
 #include <QDateTime>
 
@@ -10,10 +10,10 @@
  * @brief National Weather Service API integration
  * 
  * Implements weather data fetching from the NWS API:
- * - Points to gridpoint conversion
+ * - Points to gridpoint conversion, remembered per 2.5 km cell across restarts
  * - Forecast and hourly forecast retrieval
  * - Active alerts retrieval
- * - Conditional GET support for caching
+ * - Conditional GET: a 304 replays the stored parsed forecast
  */
 class NWSService : public WeatherService
 {
@@ -26,6 +26,8 @@ public:
     void fetchForecast(double latitude, double longitude) override;
     void fetchCurrent(double latitude, double longitude) override;
     QString serviceName() const override { return "NWS"; }
+    QUrl endpoint() const override { return QUrl(BASE_URL); }
+    QString upstreamCell(double latitude, double longitude) override;
     
     /**
      * @brief Fetch active alerts for a location
@@ -37,6 +39,11 @@ public:
      */
     void fetchGridpoint(double latitude, double longitude);
     
+    /**
+     * @brief Gridpoints resolved so far, for lookups without a /points request
+     */
+    GridpointIndex& gridpointIndex() { return m_gridpoints; }
+    
     void cancelActiveRequests() override;
     
 signals:
@@ -51,27 +58,14 @@ private slots:
     void onNetworkError(QNetworkReply::NetworkError networkError);
     
 private:
-    struct Gridpoint {
-        QString office;
-        int x;
-        int y;
-        QDateTime lastModified;
-        
-        bool isValid() const {
-            return !office.isEmpty() && x >= 0 && y >= 0;
-        }
-    };
-    
-    void parsePointsResponse(const QByteArray& data, double lat, double lon);
-    void parseForecastResponse(const QByteArray& data, double lat, double lon);
+    bool parsePointsResponse(const QByteArray& data, double lat, double lon);
+    void parseForecastResponse(const QByteArray& data, double lat, double lon, QByteArray* payload = nullptr);
     void parseHourlyForecastResponse(const QByteArray& data, double lat, double lon);
     void parseAlertsResponse(const QByteArray& data);
     QList<WeatherData*> parsePeriods(const QJsonArray& periods, double lat, double lon);
     WeatherData* parsePeriod(const QJsonObject& period, double lat, double lon);
     
-    QNetworkAccessManager* m_networkManager;
-    QMap<QString, Gridpoint> m_gridpointCache;
-    QMap<QString, QDateTime> m_lastModifiedCache;
+    GridpointIndex m_gridpoints;
     QSet<QNetworkReply*> m_activeReplies;
     
     void unregisterReply(QNetworkReply* reply);
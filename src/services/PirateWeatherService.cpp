@@ -1,5 +1,8 @@
 #include "services/PirateWeatherService.h"
 #include "models/WeatherData.h"
+#include "services/HttpClient.h"
+#include "models/ForecastSeries.h"
+#include "models/ForecastCodec.h"
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QJsonDocument>
@@ -12,12 +15,32 @@
 #include <QVariant>
 #include <QJsonParseError>
 #include <QtGlobal>
+#include <QDataStream>
+
+namespace {
+// Parsed response kept for revalidation: hourly, current and minutely
+// ForecastCodec buffers (minutely is empty when nobody asked for it)
+constexpr quint8 PayloadVersion = 1;
+
+QByteArray packPayload(const QByteArray& hourly, const QByteArray& current, const QByteArray& minutely) {
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << PayloadVersion << hourly << current << minutely;
+    return payload;
+}
+
+bool unpackPayload(const QByteArray& payload, QByteArray& hourly, QByteArray& current, QByteArray& minutely) {
+    QDataStream stream(payload);
+    quint8 version = 0;
+    stream >> version >> hourly >> current >> minutely;
+    return stream.status() == QDataStream::Ok && version == PayloadVersion;
+}
+} // namespace
 
 const QString PirateWeatherService::BASE_URL = "https://api.pirateweather.net/forecast";
 
 PirateWeatherService::PirateWeatherService(QObject *parent)
     : WeatherService(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
 {
     // Try to get API key from environment
     // Try to get API key from environment, fallback to hardcoded key for testing
@@ -42,19 +65,32 @@ void PirateWeatherService::fetchForecast(double latitude, double longitude) {
         return;
     }
     
+    // Coalesce with an identical request that is still outstanding
+    const QString flightKey = inFlightKey("forecast", latitude, longitude);
+    if (joinInFlight(flightKey)) {
+        return;
+    }
+    
     QString url = QString("%1/%2/%3,%4")
         .arg(BASE_URL, m_apiKey, QString::number(latitude, 'f', 4), QString::number(longitude, 'f', 4));
         
     qDebug() << "PirateWeather requesting URL:" << url;
     
-    QNetworkRequest request{QUrl(url)};
-    request.setHeader(QNetworkRequest::UserAgentHeader, "HyperlocalWeather/1.0");
+    QNetworkRequest request = httpClient()->request(QUrl(url));
     request.setRawHeader("Accept", "application/json");
-    request.setTransferTimeout(30000); // 30 second timeout
+    
+    // Revalidate the last parsed response, unless minutely data is now
+    // wanted and the stored copy was parsed without it
+    const QString key = validatorKey(latitude, longitude);
+    QByteArray hourly, current, minutely;
+    if (!wantsMinuteForecast()
+        || (unpackPayload(validatedPayload(key), hourly, current, minutely) && !minutely.isEmpty())) {
+        applyValidators(request, key);
+    }
     
     // abortActiveRequests(); // REMOVED: Do not abort concurrent requests for grid processing
     
-    QNetworkReply* reply = m_networkManager->get(request);
+    QNetworkReply* reply = httpClient()->get(request);
     if (!reply) {
         emit error("Failed to start Pirate Weather request");
         return;
@@ -62,6 +98,7 @@ void PirateWeatherService::fetchForecast(double latitude, double longitude) {
     
     reply->setParent(this);
     m_activeReplies.insert(reply);
+    trackInFlight(flightKey, reply);
     
     connect(reply, &QNetworkReply::finished,
             this, &PirateWeatherService::onForecastReplyFinished);
@@ -69,6 +106,7 @@ void PirateWeatherService::fetchForecast(double latitude, double longitude) {
             this, &PirateWeatherService::onNetworkError);
     reply->setProperty("latitude", latitude);
     reply->setProperty("longitude", longitude);
+    reply->setProperty("validatorKey", key);
 }
 
 void PirateWeatherService::fetchCurrent(double latitude, double longitude) {
@@ -97,15 +135,25 @@ void PirateWeatherService::onForecastReplyFinished() {
     
     double lat = reply->property("latitude").toDouble();
     double lon = reply->property("longitude").toDouble();
-    
-    QByteArray data = reply->readAll();
+    const QString key = reply->property("validatorKey").toString();
     
     // Check receivers in main thread
-    const bool hasMinuteReceivers = receivers(SIGNAL(minuteForecastReady(QList<WeatherData*>))) > 0;
+    const bool minuteReceivers = wantsMinuteForecast();
+    
+    // 304 Not Modified: replay the stored result without parsing anything
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        replayForecast(revalidated(key, reply), lat, lon, minuteReceivers);
+        reply->deleteLater();
+        return;
+    }
+    
+    QByteArray data = reply->readAll();
     
     // Parse on main thread to avoid threading issues with QObjects
     // JSON parsing is fast enough to do synchronously
-    parseForecastResponse(data, lat, lon, hasMinuteReceivers);
+    QByteArray payload;
+    parseForecastResponse(data, lat, lon, minuteReceivers, &payload);
+    storeValidators(key, reply, payload);
     
     reply->deleteLater();
 }
@@ -120,7 +168,44 @@ void PirateWeatherService::onNetworkError(QNetworkReply::NetworkError networkErr
     }
 }
 
-void PirateWeatherService::parseForecastResponse(const QByteArray& data, double lat, double lon, bool hasMinuteReceivers) {
+bool PirateWeatherService::wantsMinuteForecast() const {
+    return receivers(SIGNAL(minuteForecastReady(QList<WeatherData*>))) > 0;
+}
+
+QString PirateWeatherService::validatorKey(double lat, double lon) {
+    // The request URL minus the API key
+    return QString("%1/%2,%3").arg(BASE_URL, QString::number(lat, 'f', 4), QString::number(lon, 'f', 4));
+}
+
+void PirateWeatherService::replayForecast(const QByteArray& payload, double lat, double lon, bool hasMinuteReceivers) {
+    QByteArray hourly, current, minutely;
+    ForecastSeries forecasts;
+    if (!unpackPayload(payload, hourly, current, minutely) || !ForecastCodec::decode(hourly, forecasts)) {
+        emit error("Forecast not modified but no stored copy to replay");
+        return;
+    }
+    qDebug() << "PirateWeather forecast not modified (304), replaying" << forecasts.size() << "hours";
+    
+    // Same signals, in the same order, as parseForecastResponse()
+    ForecastSeries series;
+    if (hasMinuteReceivers && ForecastCodec::decode(minutely, series)) {
+        emit minuteForecastReady(series.toWeatherDataList());
+    }
+    series.clear();
+    if (ForecastCodec::decode(current, series) && !series.isEmpty()) {
+        emit currentReady(series.toWeatherData(0));
+    }
+    
+    QList<WeatherData*> data = forecasts.toWeatherDataList();
+    for (WeatherData* forecast : data) {
+        forecast->setLatitude(lat);
+        forecast->setLongitude(lon);
+    }
+    emit forecastReady(data);
+}
+
+void PirateWeatherService::parseForecastResponse(const QByteArray& data, double lat, double lon, bool hasMinuteReceivers,
+                                                 QByteArray* payload) {
     QJsonParseError parseError;
     QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
     if (doc.isNull() || !doc.isObject()) {
@@ -135,6 +220,8 @@ void PirateWeatherService::parseForecastResponse(const QByteArray& data, double
     QJsonObject obj = doc.object();
     
     QList<WeatherData*> forecasts;
+    QByteArray currentBuffer;
+    QByteArray minutelyBuffer;
     
     // Parse hourly forecast
     if (obj.contains("hourly") && obj["hourly"].isObject()) {
@@ -150,6 +237,9 @@ void PirateWeatherService::parseForecastResponse(const QByteArray& data, double
         QJsonObject minutely = obj["minutely"].toObject();
         if (minutely.contains("data") && minutely["data"].isArray()) {
             QList<WeatherData*> minutelyData = parseMinutelyData(minutely["data"].toArray(), lat, lon);
+            if (payload) {
+                minutelyBuffer = ForecastCodec::encode(ForecastSeries::fromWeatherData(minutelyData));
+            }
             emit minuteForecastReady(minutelyData);
         }
     }
@@ -158,11 +248,18 @@ void PirateWeatherService::parseForecastResponse(const QByteArray& data, double
     if (obj.contains("currently") && obj["currently"].isObject()) {
         WeatherData* current = parseDataPoint(obj["currently"].toObject(), lat, lon);
         if (current) {
+            if (payload) {
+                currentBuffer = ForecastCodec::encode(ForecastSeries::fromWeatherData({current}));
+            }
             emit currentReady(current);
         }
     }
     
     if (!forecasts.isEmpty()) {
+        if (payload) {
+            *payload = packPayload(ForecastCodec::encode(ForecastSeries::fromWeatherData(forecasts)),
+                                   currentBuffer, minutelyBuffer);
+        }
         emit forecastReady(forecasts);
     } else {
         // No forecast data available - emit error so controller can reset loading state
@@ -289,6 +386,7 @@ void PirateWeatherService::abortActiveRequests() {
         reply->deleteLater();
     }
     m_activeReplies.clear();
+    clearInFlight();
 }
 
 void PirateWeatherService::unregisterReply(QNetworkReply* reply) {
@@ -299,5 +397,6 @@ void PirateWeatherService::unregisterReply(QNetworkReply* reply) {
         reply->disconnect(this);
         m_activeReplies.remove(reply);
     }
+    releaseInFlight(reply);
 }
 
@@ -2,7 +2,6 @@
 #define PIRATEWEATHERSERVICE_H
 
 #include "services/WeatherService.h"
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QString>
 #include <QSet>
@@ -13,7 +12,8 @@
  * 
  * Implements weather data fetching from the Pirate Weather API
  * (Dark Sky API replacement). Provides minute-by-minute precipitation
- * forecasts for nowcasting.
+ * forecasts for nowcasting. Requests are revalidated with conditional
+ * GETs; a 304 replays the forecast parsed from the last full response.
  */
 class PirateWeatherService : public WeatherService
 {
@@ -26,6 +26,7 @@ public:
     void fetchForecast(double latitude, double longitude) override;
     void fetchCurrent(double latitude, double longitude) override;
     QString serviceName() const override { return "PirateWeather"; }
+    QUrl endpoint() const override { return QUrl(BASE_URL); }
     
     /**
      * @brief Set API key
@@ -59,14 +60,17 @@ private slots:
     void onNetworkError(QNetworkReply::NetworkError networkError);
     
 private:
-    void parseForecastResponse(const QByteArray& data, double lat, double lon, bool hasMinuteReceivers);
+    void parseForecastResponse(const QByteArray& data, double lat, double lon, bool hasMinuteReceivers,
+                               QByteArray* payload = nullptr);
+    void replayForecast(const QByteArray& payload, double lat, double lon, bool hasMinuteReceivers);
+    bool wantsMinuteForecast() const;
+    static QString validatorKey(double lat, double lon);
     QList<WeatherData*> parseHourlyData(const QJsonArray& hourly, double lat, double lon);
     QList<WeatherData*> parseMinutelyData(const QJsonArray& minutely, double lat, double lon);
     WeatherData* parseDataPoint(const QJsonObject& point, double lat, double lon);
     void abortActiveRequests();
     void unregisterReply(QNetworkReply* reply);
     
-    QNetworkAccessManager* m_networkManager;
     QString m_apiKey;
     QSet<QNetworkReply*> m_activeReplies;
     
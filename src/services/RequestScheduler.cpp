@@ -0,0 +1,289 @@
+#include "services/RequestScheduler.h"
+#include "services/WeatherService.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <QDebug>
+#include <QtMath>
+#include <QPair>
+#include <limits>
+
+RequestScheduler* RequestScheduler::s_instance = nullptr;
+
+RequestScheduler* RequestScheduler::instance() {
+    if (!s_instance) {
+        s_instance = new RequestScheduler(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+RequestScheduler::RequestScheduler(QObject *parent)
+    : QObject(parent)
+    , m_wakeup(new QTimer(this))
+{
+    m_defaultDeadlineMs[Interactive] = 15000;
+    m_defaultDeadlineMs[Alerts] = 60000;
+    m_defaultDeadlineMs[Prefetch] = 120000;
+
+    m_clock.start();
+    m_wakeup->setSingleShot(true);
+    connect(m_wakeup, &QTimer::timeout, this, &RequestScheduler::dispatchAll);
+}
+
+RequestScheduler::~RequestScheduler() {
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+void RequestScheduler::setRateLimit(const QString& provider, const RateLimit& limit) {
+    Provider& state = m_providers[provider];
+    state.limited = true;
+    state.limit = limit;
+    state.limit.burst = qMax(1, limit.burst);
+    state.limit.interactiveReserve = qBound(0, limit.interactiveReserve, state.limit.burst - 1);
+    state.tokens = state.limit.burst;
+    state.refilledMs = m_clock.elapsed();
+    dispatch(provider);
+}
+
+void RequestScheduler::clearRateLimit(const QString& provider) {
+    auto it = m_providers.find(provider);
+    if (it == m_providers.end()) {
+        return;
+    }
+    it->limited = false;
+    dispatch(provider);
+}
+
+void RequestScheduler::setDefaultDeadline(Priority priority, int deadlineMs) {
+    if (priority >= 0 && priority < PriorityCount) {
+        m_defaultDeadlineMs[priority] = qMax(0, deadlineMs);
+    }
+}
+
+void RequestScheduler::submit(WeatherService* service, Priority priority, std::function<void()> work,
+                              std::function<void()> expired, int deadlineMs) {
+    if (!service || !work || priority < 0 || priority >= PriorityCount) {
+        return;
+    }
+
+    const QString name = service->serviceName();
+    const qint64 nowMs = m_clock.elapsed();
+    Job job;
+    job.service = service;
+    job.work = std::move(work);
+    job.expired = std::move(expired);
+    job.submittedMs = nowMs;
+    job.deadlineMs = nowMs + (deadlineMs < 0 ? m_defaultDeadlineMs[priority] : deadlineMs);
+
+    m_providers[name].queues[priority].enqueue(job);
+    ProviderStats& stats = m_stats[name];
+    ++stats.submitted;
+    ++stats.queued;
+
+    // Work submitted from inside a dispatched fetch is picked up by the running
+    // pass, or right after it when it is for another provider
+    if (!m_dispatching) {
+        dispatch(name);
+    } else if (name != m_dispatchingProvider && !m_deferred.contains(name)) {
+        m_deferred.append(name);
+    }
+}
+
+void RequestScheduler::fetchForecast(WeatherService* service, double latitude, double longitude,
+                                     Priority priority, int deadlineMs) {
+    QPointer<WeatherService> target(service);
+    submit(service, priority,
+        [target, latitude, longitude]() {
+            if (target) {
+                target->fetchForecast(latitude, longitude);
+            }
+        },
+        [target]() {
+            if (target) {
+                emit target->error("Request expired before the rate limit allowed it");
+            }
+        },
+        deadlineMs);
+}
+
+void RequestScheduler::cancel(WeatherService* service) {
+    for (auto it = m_providers.begin(); it != m_providers.end(); ++it) {
+        int removed = 0;
+        for (QQueue<Job>& queue : it->queues) {
+            removed += queue.removeIf([service](const Job& job) {
+                return job.service.isNull() || job.service == service;
+            });
+        }
+        if (removed > 0) {
+            ProviderStats& stats = m_stats[it.key()];
+            stats.cancelled += removed;
+            stats.queued -= removed;
+        }
+    }
+    scheduleWakeup();
+}
+
+int RequestScheduler::queuedCount(const QString& provider) const {
+    auto it = m_providers.constFind(provider);
+    if (it == m_providers.constEnd()) {
+        return 0;
+    }
+    int count = 0;
+    for (const QQueue<Job>& queue : it->queues) {
+        count += queue.size();
+    }
+    return count;
+}
+
+void RequestScheduler::resetStats() {
+    for (auto it = m_stats.begin(); it != m_stats.end(); ++it) {
+        const int queued = it->queued;
+        *it = ProviderStats();
+        it->queued = queued;
+    }
+}
+
+void RequestScheduler::refill(Provider& provider, qint64 nowMs) const {
+    const double elapsedSeconds = (nowMs - provider.refilledMs) / 1000.0;
+    provider.tokens = qMin<double>(provider.limit.burst,
+                                   provider.tokens + elapsedSeconds * provider.limit.requestsPerSecond);
+    provider.refilledMs = nowMs;
+}
+
+bool RequestScheduler::admits(const Provider& provider, Priority priority) const {
+    if (!provider.limited) {
+        return true;
+    }
+    const int reserve = priority == Interactive ? 0 : provider.limit.interactiveReserve;
+    return provider.tokens >= 1.0 + reserve;
+}
+
+void RequestScheduler::dropExpired(const QString& name, qint64 nowMs) {
+    QList<QPair<Priority, Job>> expired;
+    Provider& provider = m_providers[name];
+    ProviderStats& stats = m_stats[name];
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        provider.queues[priority].removeIf([&](const Job& job) {
+            if (job.service.isNull()) {
+                ++stats.cancelled;
+                --stats.queued;
+                return true;
+            }
+            if (job.deadlineMs <= nowMs) {
+                expired.append(qMakePair(Priority(priority), job));
+                ++stats.expired[priority];
+                --stats.queued;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    // Callbacks run last; they may submit or cancel work
+    for (const auto& entry : expired) {
+        qWarning() << "RequestScheduler dropped an expired" << entry.first << "request for" << name
+                   << "after" << nowMs - entry.second.submittedMs << "ms";
+        emit requestExpired(name, entry.first);
+        if (entry.second.expired) {
+            entry.second.expired();
+        }
+    }
+}
+
+void RequestScheduler::dispatch(const QString& name) {
+    if (m_dispatching) {
+        return;
+    }
+    m_dispatching = true;
+    m_dispatchingProvider = name;
+
+    // Queues are re-read after every job: a dispatched fetch may submit or
+    // cancel work (a synchronous reply finishing an aggregation, say)
+    for (;;) {
+        const qint64 nowMs = m_clock.elapsed();
+        dropExpired(name, nowMs);
+
+        Provider& provider = m_providers[name];
+        if (provider.limited) {
+            refill(provider, nowMs);
+        }
+
+        int next = -1;
+        for (int priority = 0; priority < PriorityCount; ++priority) {
+            if (!provider.queues[priority].isEmpty()) {
+                next = priority;
+                break;
+            }
+        }
+        // A lower class never overtakes a waiting higher one
+        if (next < 0 || !admits(provider, Priority(next))) {
+            break;
+        }
+
+        Job job = provider.queues[next].dequeue();
+        if (provider.limited) {
+            provider.tokens -= 1.0;
+        }
+        ProviderStats& stats = m_stats[name];
+        const qint64 waitMs = nowMs - job.submittedMs;
+        --stats.queued;
+        ++stats.dispatched[next];
+        stats.totalWaitMs[next] += waitMs;
+        stats.maxWaitMs[next] = qMax(stats.maxWaitMs[next], waitMs);
+        job.work();
+    }
+
+    m_dispatching = false;
+    m_dispatchingProvider.clear();
+    while (!m_deferred.isEmpty()) {
+        dispatch(m_deferred.takeFirst());
+    }
+    scheduleWakeup();
+}
+
+void RequestScheduler::dispatchAll() {
+    const QStringList names = m_providers.keys();
+    for (const QString& name : names) {
+        dispatch(name);
+    }
+}
+
+void RequestScheduler::scheduleWakeup() {
+    // Wake for the earliest of: a token for the head of a queue, or a deadline
+    const qint64 nowMs = m_clock.elapsed();
+    qint64 wakeMs = -1;
+    for (auto it = m_providers.cbegin(); it != m_providers.cend(); ++it) {
+        const Provider& provider = it.value();
+        for (int priority = 0; priority < PriorityCount; ++priority) {
+            const QQueue<Job>& queue = provider.queues[priority];
+            if (queue.isEmpty()) {
+                continue;
+            }
+            qint64 dueMs = nowMs;
+            if (provider.limited && provider.limit.requestsPerSecond > 0.0) {
+                const int reserve = priority == Interactive ? 0 : provider.limit.interactiveReserve;
+                const double missing = 1.0 + reserve - provider.tokens;
+                const double elapsedSeconds = (nowMs - provider.refilledMs) / 1000.0;
+                const double stillMissing = missing - elapsedSeconds * provider.limit.requestsPerSecond;
+                if (stillMissing > 0.0) {
+                    dueMs = nowMs + qCeil(stillMissing / provider.limit.requestsPerSecond * 1000.0);
+                }
+            } else if (provider.limited) {
+                dueMs = -1;     // No refill; only deadlines can wake us
+            }
+            for (const Job& job : queue) {
+                dueMs = dueMs < 0 ? job.deadlineMs : qMin(dueMs, job.deadlineMs);
+            }
+            if (dueMs >= 0) {
+                wakeMs = wakeMs < 0 ? dueMs : qMin(wakeMs, dueMs);
+            }
+        }
+    }
+
+    if (wakeMs < 0) {
+        m_wakeup->stop();
+        return;
+    }
+    m_wakeup->start(int(qBound<qint64>(0, wakeMs - nowMs, std::numeric_limits<int>::max())));
+}
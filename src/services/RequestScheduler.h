@@ -0,0 +1,166 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <functional>
+
+class QTimer;
+class WeatherService;
+
+/**
+ * @brief Admission control between callers and the weather services
+ *
+ * Every upstream fetch is submitted with a priority class and a deadline
+ * and queued per provider (WeatherService::serviceName()). Each provider
+ * has a token bucket: a fetch is dispatched when a token is available,
+ * otherwise it waits in its class queue. Queues drain strictly by class,
+ * interactive before alerts before prefetch.
+ *
+ * Background classes may not take the last RateLimit::interactiveReserve
+ * tokens, so a user fetch arriving after a burst of background work is
+ * still dispatched at once. A fetch whose deadline passes while queued is
+ * dropped and its expiry callback run instead.
+ *
+ * Providers without a configured limit dispatch immediately. Lives on the
+ * thread that created it, like the services it calls.
+ */
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Interactive,    // The user is waiting for the result
+        Alerts,         // Alert polling and threshold checks
+        Prefetch,       // Background refreshes and revalidation
+        PriorityCount
+    };
+    Q_ENUM(Priority)
+
+    /**
+     * @brief Token bucket of one provider
+     */
+    struct RateLimit {
+        double requestsPerSecond = 1.0;     // Refill rate
+        int burst = 5;                      // Bucket capacity
+        int interactiveReserve = 1;         // Tokens only interactive fetches may take
+    };
+
+    /**
+     * @brief Counters for one provider
+     */
+    struct ProviderStats {
+        qint64 submitted = 0;
+        qint64 dispatched[PriorityCount] = {};
+        qint64 expired[PriorityCount] = {};
+        qint64 cancelled = 0;
+        qint64 totalWaitMs[PriorityCount] = {};     // Submit to dispatch, summed
+        qint64 maxWaitMs[PriorityCount] = {};
+        int queued = 0;
+
+        double meanWaitMs(Priority priority) const {
+            return dispatched[priority] > 0 ? double(totalWaitMs[priority]) / dispatched[priority] : 0.0;
+        }
+    };
+
+    /**
+     * @brief Scheduler used by the controllers and the aggregator
+     */
+    static RequestScheduler* instance();
+
+    explicit RequestScheduler(QObject *parent = nullptr);
+    ~RequestScheduler() override;
+
+    /**
+     * @brief Limit a provider (applies to fetches dispatched afterwards)
+     *
+     * The bucket starts full.
+     */
+    void setRateLimit(const QString& provider, const RateLimit& limit);
+    void clearRateLimit(const QString& provider);
+
+    /**
+     * @brief Time a queued fetch of each class may wait before it is dropped
+     */
+    void setDefaultDeadline(Priority priority, int deadlineMs);
+    int defaultDeadline(Priority priority) const { return m_defaultDeadlineMs[priority]; }
+
+    /**
+     * @brief Queue work against a service's provider
+     * @param work Issues the fetch; run at most once
+     * @param expired Run instead of work if the deadline passes first
+     * @param deadlineMs Negative uses the class default
+     *
+     * Dispatched before returning when a token is available. Work for a
+     * service that is destroyed while queued is discarded.
+     */
+    void submit(WeatherService* service, Priority priority, std::function<void()> work,
+                std::function<void()> expired = nullptr, int deadlineMs = -1);
+
+    /**
+     * @brief Queue service->fetchForecast(latitude, longitude)
+     *
+     * On expiry the service emits error() so its callers stop waiting.
+     */
+    void fetchForecast(WeatherService* service, double latitude, double longitude,
+                       Priority priority = Interactive, int deadlineMs = -1);
+
+    /**
+     * @brief Drop every queued fetch for a service without running either callback
+     */
+    void cancel(WeatherService* service);
+
+    int queuedCount(const QString& provider) const;
+
+    QHash<QString, ProviderStats> stats() const { return m_stats; }
+    ProviderStats stats(const QString& provider) const { return m_stats.value(provider); }
+    void resetStats();
+
+signals:
+    /**
+     * @brief Emitted when a queued fetch expires
+     */
+    void requestExpired(QString provider, RequestScheduler::Priority priority);
+
+private:
+    struct Job {
+        QPointer<WeatherService> service;
+        std::function<void()> work;
+        std::function<void()> expired;
+        qint64 submittedMs = 0;
+        qint64 deadlineMs = 0;
+    };
+
+    struct Provider {
+        bool limited = false;
+        RateLimit limit;
+        double tokens = 0.0;
+        qint64 refilledMs = 0;
+        QQueue<Job> queues[PriorityCount];
+    };
+
+    void refill(Provider& provider, qint64 nowMs) const;
+    bool admits(const Provider& provider, Priority priority) const;
+    void dispatch(const QString& name);
+    void dispatchAll();
+    void dropExpired(const QString& name, qint64 nowMs);
+    void scheduleWakeup();
+
+    static RequestScheduler* s_instance;
+    QHash<QString, Provider> m_providers;
+    QHash<QString, ProviderStats> m_stats;
+    int m_defaultDeadlineMs[PriorityCount];
+    QElapsedTimer m_clock;
+    QTimer* m_wakeup;
+    bool m_dispatching = false;
+    QString m_dispatchingProvider;
+    QStringList m_deferred;     // Providers given work during another provider's pass
+};
+
+#endif // REQUESTSCHEDULER_H
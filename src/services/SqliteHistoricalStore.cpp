@@ -0,0 +1,52 @@
+#include "services/SqliteHistoricalStore.h"
+#include "services/HistoricalDataManager.h"
+#include "database/DatabaseManager.h"
+#include <QSqlError>
+
+SqliteHistoricalStore::SqliteHistoricalStore(QSqlDatabase db)
+    : m_db(db)
+{
+}
+
+bool SqliteHistoricalStore::insertSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                         const ForecastSeries& series, const QString& source,
+                                         QString& errorText) {
+    if (!m_db.transaction()) {
+        errorText = m_db.lastError().text();
+        return false;
+    }
+
+    if (!HistoricalDataManager::insertSeries(m_db, DatabaseManager::fromMicroDegrees(latMicroDegrees),
+                                             DatabaseManager::fromMicroDegrees(lonMicroDegrees),
+                                             series, source, errorText)
+        || !m_db.commit()) {
+        if (errorText.isEmpty()) {
+            errorText = m_db.lastError().text();
+        }
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteHistoricalStore::readSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                                       ForecastSeries& series, QString& errorText) {
+    return HistoricalDataManager::readSeries(m_db, latMicroDegrees, lonMicroDegrees,
+                                             fromSecs, toSecs, source, series, errorText);
+}
+
+bool SqliteHistoricalStore::scanSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                                       qint64 fromSecs, qint64 toSecs, const QString& source,
+                                       SeriesBatcher& batcher, QString& errorText) {
+    return HistoricalDataManager::scanSeries(m_db, latMicroDegrees, lonMicroDegrees,
+                                             fromSecs, toSecs, source, batcher, errorText);
+}
+
+int SqliteHistoricalStore::dropBefore(qint64 cutoffSecs, QString& errorText) {
+    const int dropped = DatabaseManager::dropHistoricalPartitionsBefore(m_db, cutoffSecs);
+    if (dropped < 0) {
+        errorText = "Failed to drop expired historical partitions";
+    }
+    return dropped;
+}
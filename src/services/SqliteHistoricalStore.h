@@ -0,0 +1,39 @@
+#ifndef SQLITEHISTORICALSTORE_H
+#define SQLITEHISTORICALSTORE_H
+
+#include <QSqlDatabase>
+#include "services/HistoricalStore.h"
+
+/**
+ * @brief Historical samples in the daily historical_weather_YYYYMMDD partitions
+ *
+ * Also maintains the spatial index and the hourly and daily rollups as
+ * part of each insert.
+ */
+class SqliteHistoricalStore : public HistoricalStore
+{
+public:
+    /**
+     * @brief Constructor
+     * @param db Open connection; only used from the thread that owns it
+     */
+    explicit SqliteHistoricalStore(QSqlDatabase db);
+
+    QString storeName() const override { return "sqlite"; }
+
+    bool insertSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                      const ForecastSeries& series, const QString& source,
+                      QString& errorText) override;
+    bool readSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                    qint64 fromSecs, qint64 toSecs, const QString& source,
+                    ForecastSeries& series, QString& errorText) override;
+    bool scanSeries(qint64 latMicroDegrees, qint64 lonMicroDegrees,
+                    qint64 fromSecs, qint64 toSecs, const QString& source,
+                    SeriesBatcher& batcher, QString& errorText) override;
+    int dropBefore(qint64 cutoffSecs, QString& errorText) override;
+
+private:
+    QSqlDatabase m_db;
+};
+
+#endif // SQLITEHISTORICALSTORE_H
@@ -4,7 +4,6 @@
 #include <algorithm>
 #include <QtMath>
 #include <QMap>
-#include <QSet>
 #include <QVector>
 #include <QProcessEnvironment>
 
@@ -20,6 +19,7 @@ WeatherAggregator::WeatherAggregator(QObject *parent)
     , m_successfulRequests(0)
     , m_failedRequests(0)
     , m_startTime(QDateTime::currentDateTime())
+    , m_currentPriority(RequestScheduler::Interactive)
     , m_spatioTemporalEngine(new SpatioTemporalEngine(this))
     , m_spatioTemporalEnabled(true)
     , m_spatioTemporalActive(false)
@@ -157,7 +157,7 @@ void WeatherAggregator::setMovingAverageAlpha(double alpha) {
     }
 }
 
-void WeatherAggregator::fetchForecast(double latitude, double longitude) {
+void WeatherAggregator::fetchForecast(double latitude, double longitude, RequestScheduler::Priority priority) {
     m_requestTimer.start();
     m_totalRequests++;
     
@@ -165,6 +165,10 @@ void WeatherAggregator::fetchForecast(double latitude, double longitude) {
     m_currentRequestKey = cacheKey;
     m_currentLat = latitude;
     m_currentLon = longitude;
+    m_currentPriority = priority;
+    
+    // Fetches still queued for an earlier request would be filed under this one
+    cancelQueuedFetches();
     
     const bool useSpatio = shouldUseSpatioTemporal();
     int timeoutMs = useSpatio ? m_spatioTimeoutMs : m_defaultTimeoutMs;
@@ -201,13 +205,14 @@ void WeatherAggregator::fetchForecast(double latitude, double longitude) {
         case PrimaryOnly:
         case Fallback:
             // Try first available service
-            availableServices.first()->fetchForecast(latitude, longitude);
+            RequestScheduler::instance()->fetchForecast(availableServices.first(), latitude, longitude, priority,
+                                                        timeoutMs);
             break;
         case WeightedAverage:
         case BestAvailable:
             // Try all available services
             for (WeatherService* service : availableServices) {
-                service->fetchForecast(latitude, longitude);
+                RequestScheduler::instance()->fetchForecast(service, latitude, longitude, priority, timeoutMs);
             }
             break;
     }
@@ -272,6 +277,10 @@ void WeatherAggregator::onServiceForecastReady(QList<WeatherData*> data) {
     updateServiceAvailability(service, true, responseTime);
     m_successfulRequests++;
     
+    // Take a value copy up front: the service's objects stay with the
+    // controller, which may discard them as soon as this slot returns
+    ForecastSeries series = ForecastSeries::fromWeatherData(data);
+    
     // Handle based on strategy
     if (m_strategy == WeightedAverage || m_strategy == BestAvailable) {
         // Collect forecasts from multiple sources
@@ -280,7 +289,7 @@ void WeatherAggregator::onServiceForecastReady(QList<WeatherData*> data) {
         
         // Add this service's forecasts to pending list with service info
         ForecastWithService forecastEntry;
-        forecastEntry.forecasts = data;
+        forecastEntry.forecasts = series;
         forecastEntry.service = service;
         forecastEntry.responseTime = responseTime;
         m_pendingForecasts[cacheKey].append(forecastEntry);
@@ -292,7 +301,7 @@ void WeatherAggregator::onServiceForecastReady(QList<WeatherData*> data) {
         
         if (receivedServices.size() >= expectedServices.size()) {
             // All services have responded, merge the forecasts
-            QList<WeatherData*> mergedForecasts;
+            ForecastSeries mergedForecasts;
             
             if (m_strategy == WeightedAverage) {
                 mergedForecasts = mergeForecasts(m_pendingForecasts[cacheKey]);
@@ -336,14 +345,14 @@ void WeatherAggregator::onServiceForecastReady(QList<WeatherData*> data) {
             m_pendingRequests.remove(cacheKey);
             
             m_timeoutTimer->stop();
-            emit forecastReady(mergedForecasts);
+            emit forecastReady(mergedForecasts.toWeatherDataList());
             emit metricsUpdated(getMetrics());
         }
         // Otherwise, wait for more services to respond
     } else {
         // PrimaryOnly or Fallback: emit immediately
         m_timeoutTimer->stop();
-        emit forecastReady(data);
+        emit forecastReady(series.toWeatherDataList());
         emit metricsUpdated(getMetrics());
     }
 }
@@ -470,11 +479,19 @@ void WeatherAggregator::onTimeout() {
         resetSpatioTemporalState();
         return;
     }
+    cancelQueuedFetches();
     m_failedRequests++;
     emit error("Request timeout");
     emit metricsUpdated(getMetrics());
 }
 
+void WeatherAggregator::cancelQueuedFetches() {
+    RequestScheduler* scheduler = RequestScheduler::instance();
+    for (const ServiceEntry& entry : m_services) {
+        scheduler->cancel(entry.service);
+    }
+}
+
 void WeatherAggregator::updateServiceAvailability(WeatherService* service, bool success, qint64 responseTime) {
     for (ServiceEntry& entry : m_services) {
         if (entry.service == service) {
@@ -574,27 +591,23 @@ double WeatherAggregator::calculateWeight(WeatherService* service, qint64 respon
     return qMax(0.1, totalWeight);
 }
 
-QDateTime WeatherAggregator::binTimestamp(const QDateTime& timestamp, int binMinutes) const {
-    if (!timestamp.isValid()) {
-        return timestamp;
+qint64 WeatherAggregator::binTimestamp(qint64 timestampMs, int binMinutes) const {
+    if (timestampMs == WeatherSample::InvalidTime || binMinutes <= 0) {
+        return timestampMs;
     }
     
-    QDateTime binned = timestamp;
-    
     // Round down to nearest bin
-    int minutes = binned.time().minute();
-    int roundedMinutes = (minutes / binMinutes) * binMinutes;
-    
-    QTime roundedTime = binned.time();
-    roundedTime.setHMS(roundedTime.hour(), roundedMinutes, 0, 0);
-    binned.setTime(roundedTime);
-    
-    return binned;
+    const qint64 binMs = static_cast<qint64>(binMinutes) * 60 * 1000;
+    qint64 offset = timestampMs % binMs;
+    if (offset < 0) {
+        offset += binMs;
+    }
+    return timestampMs - offset;
 }
 
-QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithService>& forecastsWithServices) {
+ForecastSeries WeatherAggregator::mergeForecasts(const QList<ForecastWithService>& forecastsWithServices) {
     if (forecastsWithServices.isEmpty()) {
-        return QList<WeatherData*>();
+        return ForecastSeries();
     }
     
     // If only one source, return it directly
@@ -602,30 +615,35 @@ QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithSe
         return forecastsWithServices.first().forecasts;
     }
     
+    // A sample in a time bin: which source, which row, and the source weight
+    struct BinEntry {
+        int source;
+        int index;
+        double weight;
+    };
+    
     // Group forecasts by timestamp (bin to 30-minute intervals)
-    QMap<QDateTime, QList<QPair<WeatherData*, double>>> timeBins; // timestamp -> list of (data, weight)
+    QMap<qint64, QVector<BinEntry>> timeBins;
     
     // Collect all forecasts with their weights
-    for (const ForecastWithService& forecastEntry : forecastsWithServices) {
-        const QList<WeatherData*>& sourceForecasts = forecastEntry.forecasts;
-        WeatherService* service = forecastEntry.service;
-        qint64 responseTime = forecastEntry.responseTime;
+    for (int source = 0; source < forecastsWithServices.size(); ++source) {
+        const ForecastWithService& forecastEntry = forecastsWithServices.at(source);
+        const ForecastSeries& sourceForecasts = forecastEntry.forecasts;
         
         if (sourceForecasts.isEmpty()) {
             continue;
         }
         
         // Calculate weight for this service
-        double weight = calculateWeight(service, responseTime);
+        double weight = calculateWeight(forecastEntry.service, forecastEntry.responseTime);
         
         // Add each forecast to appropriate time bin
-        for (WeatherData* data : sourceForecasts) {
-            if (!data || !data->timestamp().isValid()) {
+        const QVector<qint64>& times = sourceForecasts.timestamps();
+        for (int i = 0; i < times.size(); ++i) {
+            if (times.at(i) == WeatherSample::InvalidTime) {
                 continue;
             }
-            
-            QDateTime binnedTime = binTimestamp(data->timestamp(), 30);
-            timeBins[binnedTime].append(qMakePair(data, weight));
+            timeBins[binTimestamp(times.at(i), 30)].append({source, i, weight});
         }
     }
     
@@ -634,38 +652,38 @@ QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithSe
         return forecastsWithServices.first().forecasts;
     }
     
-    // Merge forecasts for each time bin
-    QList<WeatherData*> mergedForecasts;
-    QList<QDateTime> sortedTimes = timeBins.keys();
-    std::sort(sortedTimes.begin(), sortedTimes.end());
+    // Merge forecasts for each time bin (QMap keeps bins in time order)
+    ForecastSeries mergedForecasts;
+    mergedForecasts.reserve(timeBins.size());
     
-    for (const QDateTime& binTime : sortedTimes) {
-        const QList<QPair<WeatherData*, double>>& binData = timeBins[binTime];
+    for (auto binIt = timeBins.cbegin(); binIt != timeBins.cend(); ++binIt) {
+        const qint64 binTime = binIt.key();
+        const QVector<BinEntry>& binData = binIt.value();
         
         if (binData.isEmpty()) {
             continue;
         }
         
+        const ForecastSeries& firstSeries = forecastsWithServices.at(binData.first().source).forecasts;
+        const WeatherSample firstData = firstSeries.at(binData.first().index);
+        
         // Calculate total weight
         double totalWeight = 0.0;
-        for (const QPair<WeatherData*, double>& pair : binData) {
-            totalWeight += pair.second;
+        for (const BinEntry& entry : binData) {
+            totalWeight += entry.weight;
         }
         
         if (totalWeight <= 0.0) {
             // Use first data point if no valid weights
-            mergedForecasts.append(binData.first().first);
+            mergedForecasts.append(firstData, firstSeries);
             continue;
         }
         
-        // Create merged WeatherData
-        WeatherData* merged = new WeatherData();
-        
-        // Use first data point's location and timestamp as base
-        WeatherData* firstData = binData.first().first;
-        merged->setLatitude(firstData->latitude());
-        merged->setLongitude(firstData->longitude());
-        merged->setTimestamp(binTime);
+        // Use first data point's location as base, bin start as timestamp
+        WeatherSample merged;
+        merged.latitude = firstData.latitude;
+        merged.longitude = firstData.longitude;
+        merged.timestampMs = binTime;
         
         // Weighted averages for numeric parameters
         double weightedTemp = 0.0;
@@ -692,59 +710,59 @@ QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithSe
         QString mostWeightedDescription;
         double maxConditionWeight = 0.0;
         
-        for (const QPair<WeatherData*, double>& pair : binData) {
-            WeatherData* data = pair.first;
-            double weight = pair.second;
-            double normalizedWeight = weight / totalWeight;
+        for (const BinEntry& entry : binData) {
+            const ForecastSeries& series = forecastsWithServices.at(entry.source).forecasts;
+            const WeatherSample data = series.at(entry.index);
+            double normalizedWeight = entry.weight / totalWeight;
             
             // Temperature
-            if (data->temperature() != 0.0 || qAbs(data->temperature()) > 0.01) {
-                weightedTemp += data->temperature() * normalizedWeight;
+            if (data.temperature != 0.0 || qAbs(data.temperature) > 0.01) {
+                weightedTemp += data.temperature * normalizedWeight;
             }
             
             // Feels like
-            if (data->feelsLike() != 0.0 || qAbs(data->feelsLike()) > 0.01) {
-                weightedFeelsLike += data->feelsLike() * normalizedWeight;
+            if (data.feelsLike != 0.0 || qAbs(data.feelsLike) > 0.01) {
+                weightedFeelsLike += data.feelsLike * normalizedWeight;
             }
             
             // Pressure
-            if (data->pressure() > 0.0) {
-                weightedPressure += data->pressure() * normalizedWeight;
+            if (data.pressure > 0.0) {
+                weightedPressure += data.pressure * normalizedWeight;
             }
             
             // Wind speed
-            weightedWindSpeed += data->windSpeed() * normalizedWeight;
+            weightedWindSpeed += data.windSpeed * normalizedWeight;
             
             // Wind direction (vector average)
-            if (data->windDirection() >= 0 && data->windSpeed() > 0) {
-                double radians = qDegreesToRadians(static_cast<double>(data->windDirection()));
-                windX += qCos(radians) * data->windSpeed() * normalizedWeight;
-                windY += qSin(radians) * data->windSpeed() * normalizedWeight;
+            if (data.windDirection >= 0 && data.windSpeed > 0) {
+                double radians = qDegreesToRadians(static_cast<double>(data.windDirection));
+                windX += qCos(radians) * data.windSpeed * normalizedWeight;
+                windY += qSin(radians) * data.windSpeed * normalizedWeight;
                 windWeight += normalizedWeight;
             }
             
             // Precipitation
-            weightedPrecipProb += data->precipProbability() * normalizedWeight;
-            weightedPrecipIntensity += data->precipIntensity() * normalizedWeight;
+            weightedPrecipProb += data.precipProbability * normalizedWeight;
+            weightedPrecipIntensity += data.precipIntensity * normalizedWeight;
             
             // Humidity
-            if (data->humidity() > 0) {
-                weightedHumidity += static_cast<double>(data->humidity()) * normalizedWeight;
+            if (data.humidity > 0) {
+                weightedHumidity += static_cast<double>(data.humidity) * normalizedWeight;
             }
             
             // Cloud cover
-            weightedCloudCover += static_cast<double>(data->cloudCover()) * normalizedWeight;
+            weightedCloudCover += static_cast<double>(data.cloudCover) * normalizedWeight;
             
             // Visibility
-            if (data->visibility() > 0) {
-                weightedVisibility += static_cast<double>(data->visibility()) * normalizedWeight;
+            if (data.visibility > 0) {
+                weightedVisibility += static_cast<double>(data.visibility) * normalizedWeight;
             }
             
             // UV Index
-            weightedUvIndex += static_cast<double>(data->uvIndex()) * normalizedWeight;
+            weightedUvIndex += static_cast<double>(data.uvIndex) * normalizedWeight;
             
             // Weather condition (weighted selection)
-            QString condition = data->weatherCondition();
+            QString condition = series.stringAt(data.conditionId);
             if (!condition.isEmpty()) {
                 conditionWeights[condition] += normalizedWeight;
                 if (conditionWeights[condition] > maxConditionWeight) {
@@ -753,17 +771,17 @@ QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithSe
                 }
             }
             
-            QString description = data->weatherDescription();
+            QString description = series.stringAt(data.descriptionId);
             if (!description.isEmpty() && normalizedWeight > 0.5) {
                 mostWeightedDescription = description; // Use from highest weight source
             }
         }
         
         // Set merged values
-        merged->setTemperature(weightedTemp);
-        merged->setFeelsLike(weightedFeelsLike > 0.0 ? weightedFeelsLike : weightedTemp);
-        merged->setPressure(weightedPressure);
-        merged->setWindSpeed(weightedWindSpeed);
+        merged.temperature = weightedTemp;
+        merged.feelsLike = weightedFeelsLike > 0.0 ? weightedFeelsLike : weightedTemp;
+        merged.pressure = weightedPressure;
+        merged.windSpeed = weightedWindSpeed;
         
         // Calculate wind direction from vector average
         if (windWeight > 0 && (qAbs(windX) > 0.001 || qAbs(windY) > 0.001)) {
@@ -772,21 +790,21 @@ QList<WeatherData*> WeatherAggregator::mergeForecasts(const QList<ForecastWithSe
             if (avgDirection < 0) {
                 avgDirection += 360;
             }
-            merged->setWindDirection(avgDirection);
-        } else if (!binData.isEmpty()) {
-            merged->setWindDirection(binData.first().first->windDirection());
+            merged.windDirection = avgDirection;
+        } else {
+            merged.windDirection = firstData.windDirection;
         }
         
-        merged->setPrecipProbability(qMax(0.0, qMin(1.0, weightedPrecipProb)));
-        merged->setPrecipIntensity(qMax(0.0, weightedPrecipIntensity));
-        merged->setHumidity(static_cast<int>(qRound(weightedHumidity)));
-        merged->setCloudCover(static_cast<int>(qRound(weightedCloudCover)));
-        merged->setVisibility(static_cast<int>(qRound(weightedVisibility)));
-        merged->setUvIndex(static_cast<int>(qRound(weightedUvIndex)));
-        merged->setWeatherCondition(mostWeightedCondition.isEmpty() ? 
-                                    (binData.first().first->weatherCondition()) : mostWeightedCondition);
-        merged->setWeatherDescription(mostWeightedDescription.isEmpty() ?
-                                     (binData.first().first->weatherDescription()) : mostWeightedDescription);
+        merged.precipProbability = qMax(0.0, qMin(1.0, weightedPrecipProb));
+        merged.precipIntensity = qMax(0.0, weightedPrecipIntensity);
+        merged.humidity = static_cast<qint32>(qRound(weightedHumidity));
+        merged.cloudCover = static_cast<qint32>(qRound(weightedCloudCover));
+        merged.visibility = static_cast<qint32>(qRound(weightedVisibility));
+        merged.uvIndex = static_cast<qint32>(qRound(weightedUvIndex));
+        merged.conditionId = mergedForecasts.internString(mostWeightedCondition.isEmpty() ?
+                                                          firstSeries.stringAt(firstData.conditionId) : mostWeightedCondition);
+        merged.descriptionId = mergedForecasts.internString(mostWeightedDescription.isEmpty() ?
+                                                            firstSeries.stringAt(firstData.descriptionId) : mostWeightedDescription);
         
         mergedForecasts.append(merged);
     }
@@ -985,15 +1003,35 @@ void WeatherAggregator::startSpatioTemporalRequest(double latitude, double longi
         SpatioServiceContext ctx;
         ctx.service = service;
         ctx.apiName = service->serviceName();
-        for (const QPointF& point : m_spatioGrid) {
+        
+        // Fetch each upstream cell once; the other points in it share the result
+        QHash<QString, int> fetchedCells;
+        for (int i = 0; i < m_spatioGrid.size(); ++i) {
             SpatioGridPointState state;
-            state.coordinate = point;
+            state.coordinate = m_spatioGrid[i];
             ctx.gridStates.append(state);
+            
+            const QString cell = service->upstreamCell(state.coordinate.x(), state.coordinate.y());
+            auto it = cell.isEmpty() ? fetchedCells.end() : fetchedCells.find(cell);
+            if (it != fetchedCells.end()) {
+                ctx.sharedPoints[it.value()].append(i);
+                continue;
+            }
+            if (!cell.isEmpty()) {
+                fetchedCells.insert(cell, i);
+            }
+            ctx.sharedPoints.insert(i, {i});
+        }
+        if (ctx.sharedPoints.size() < m_spatioGrid.size()) {
+            qDebug() << "Spatio-temporal grid for" << ctx.apiName << "needs"
+                     << ctx.sharedPoints.size() << "of" << m_spatioGrid.size() << "fetches";
         }
+        const QList<int> fetchIndices = ctx.sharedPoints.keys();
         m_spatioContexts.insert(service, ctx);
 
-        for (const QPointF& point : m_spatioGrid) {
-            service->fetchForecast(point.x(), point.y());
+        for (int index : fetchIndices) {
+            RequestScheduler::instance()->fetchForecast(service, m_spatioGrid[index].x(), m_spatioGrid[index].y(),
+                                                        m_currentPriority, m_spatioTimeoutMs);
         }
     }
 }
@@ -1030,9 +1068,15 @@ void WeatherAggregator::handleSpatioTemporalForecast(WeatherService* service, QL
         return;
     }
 
-    qDeleteAll(ctx.gridStates[gridIndex].forecasts);
-    ctx.gridStates[gridIndex].forecasts = data;
-    ctx.gridStates[gridIndex].completed = true;
+    // Spatio-temporal responses are owned by the aggregator; keep values only
+    ForecastSeries series = ForecastSeries::fromWeatherData(data);
+    qDeleteAll(data);
+    series.sortByTime();
+    const QVector<int> sharing = ctx.sharedPoints.value(gridIndex, {gridIndex});
+    for (int index : sharing) {
+        ctx.gridStates[index].forecasts = series;
+        ctx.gridStates[index].completed = true;
+    }
 
     bool serviceComplete = std::all_of(ctx.gridStates.begin(), ctx.gridStates.end(),
         [](const SpatioGridPointState& state) { return state.completed; });
@@ -1052,39 +1096,30 @@ void WeatherAggregator::processSpatioTemporalService(WeatherService* service) {
         return;
     }
 
-    QSet<QDateTime> timestamps;
+    QVector<qint64> sortedTimes;
     for (const SpatioGridPointState& state : ctx.gridStates) {
-        for (WeatherData* entry : state.forecasts) {
-            if (entry) {
-                timestamps.insert(entry->timestamp());
-            }
-        }
+        sortedTimes += state.forecasts.timestamps();
     }
-
-    QList<QDateTime> sortedTimes = timestamps.values();
     std::sort(sortedTimes.begin(), sortedTimes.end());
+    sortedTimes.erase(std::unique(sortedTimes.begin(), sortedTimes.end()), sortedTimes.end());
 
-    QList<WeatherData*> spatialTimeline;
-    for (const QDateTime& ts : sortedTimes) {
-        QList<WeatherData*> samples = buildSpatialSamples(ctx.gridStates, ts);
+    ForecastSeries spatialTimeline;
+    spatialTimeline.reserve(sortedTimes.size());
+    for (qint64 ts : sortedTimes) {
+        const ForecastSeries* stringSource = nullptr;
+        QVector<WeatherSample> samples = buildSpatialSamples(ctx.gridStates, ts, stringSource);
         if (samples.isEmpty()) {
             continue;
         }
-        WeatherData* smoothed = m_spatioTemporalEngine->applySpatialSmoothing(samples, m_currentLat, m_currentLon);
-        if (smoothed) {
-            spatialTimeline.append(smoothed);
+        WeatherSample smoothed;
+        if (m_spatioTemporalEngine->applySpatialSmoothing(samples, m_currentLat, m_currentLon, smoothed)) {
+            spatialTimeline.append(smoothed, *stringSource);
         }
     }
 
     ctx.spatialTimeline = spatialTimeline;
     ctx.temporalTimeline = m_spatioTemporalEngine->applyTemporalInterpolation(ctx.spatialTimeline);
     ctx.hasTemporalResult = true;
-
-    for (SpatioGridPointState& state : ctx.gridStates) {
-        qDeleteAll(state.forecasts);
-        state.forecasts.clear();
-        state.completed = false;
-    }
     ctx.gridStates.clear();
 
     finalizeSpatioTemporalResult();
@@ -1112,7 +1147,7 @@ void WeatherAggregator::finalizeSpatioTemporalResult() {
         }
     }
 
-    QMap<QString, QList<WeatherData*>> apiForecasts;
+    QMap<QString, ForecastSeries> apiForecasts;
     for (auto it = m_spatioContexts.begin(); it != m_spatioContexts.end(); ++it) {
         const SpatioServiceContext& ctx = it.value();
         if (ctx.hasTemporalResult && !ctx.temporalTimeline.isEmpty()) {
@@ -1126,7 +1161,7 @@ void WeatherAggregator::finalizeSpatioTemporalResult() {
         return;
     }
 
-    QList<WeatherData*> combined = m_spatioTemporalEngine->combineAPIForecasts(apiForecasts);
+    ForecastSeries combined = m_spatioTemporalEngine->combineAPIForecasts(apiForecasts);
     if (combined.isEmpty()) {
         emit error("Failed to combine API forecasts");
         resetSpatioTemporalState();
@@ -1135,30 +1170,24 @@ void WeatherAggregator::finalizeSpatioTemporalResult() {
 
     m_timeoutTimer->stop();
     m_successfulRequests++;
-    emit forecastReady(combined);
+    emit forecastReady(combined.toWeatherDataList());
     emit metricsUpdated(getMetrics());
 
     resetSpatioTemporalState();
     m_spatioTemporalActive = false;
 }
 
-void WeatherAggregator::resetSpatioTemporalState(bool deleteTimelines) {
+void WeatherAggregator::resetSpatioTemporalState() {
     for (auto it = m_spatioContexts.begin(); it != m_spatioContexts.end(); ++it) {
         // Cancel any pending network requests for this service to prevent
         // responses from matching against a future (different) grid.
         it.key()->cancelActiveRequests();
+        RequestScheduler::instance()->cancel(it.key());
         
-        for (SpatioGridPointState& state : it.value().gridStates) {
-            qDeleteAll(state.forecasts);
-            state.forecasts.clear();
-        }
-        if (deleteTimelines) {
-            qDeleteAll(it.value().spatialTimeline);
-            qDeleteAll(it.value().temporalTimeline);
-        }
         it.value().spatialTimeline.clear();
         it.value().temporalTimeline.clear();
         it.value().gridStates.clear();
+        it.value().sharedPoints.clear();
         it.value().hasTemporalResult = false;
         it.value().hasError = false;
     }
@@ -1175,25 +1204,45 @@ void WeatherAggregator::cancelSpatioTemporalRequests() {
 }
 
 int WeatherAggregator::matchGridIndex(const QList<QPointF>& grid, double lat, double lon) const {
+    // Grid points can be closer together than the tolerance; take the nearest
+    int best = -1;
+    double bestDistance = 0.0;
     for (int i = 0; i < grid.size(); ++i) {
-        if (qAbs(grid[i].x() - lat) <= m_gridMatchTolerance &&
-            qAbs(grid[i].y() - lon) <= m_gridMatchTolerance) {
-            return i;
+        const double dLat = qAbs(grid[i].x() - lat);
+        const double dLon = qAbs(grid[i].y() - lon);
+        if (dLat > m_gridMatchTolerance || dLon > m_gridMatchTolerance) {
+            continue;
+        }
+        const double distance = dLat * dLat + dLon * dLon;
+        if (best < 0 || distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
         }
     }
-    return -1;
+    return best;
 }
 
-QList<WeatherData*> WeatherAggregator::buildSpatialSamples(const QVector<SpatioGridPointState>& states,
-                                                           const QDateTime& timestamp) const {
-    QList<WeatherData*> samples;
+QVector<WeatherSample> WeatherAggregator::buildSpatialSamples(const QVector<SpatioGridPointState>& states,
+                                                              qint64 timestampMs,
+                                                              const ForecastSeries*& stringSource) const {
+    // String ids of the returned samples refer to their own grid point's
+    // series; stringSource is set to the series owning the first sample.
+    QVector<WeatherSample> samples;
+    samples.reserve(states.size());
+    stringSource = nullptr;
     for (const SpatioGridPointState& state : states) {
-        for (WeatherData* entry : state.forecasts) {
-            if (entry && entry->timestamp() == timestamp) {
-                samples.append(entry);
-                break;
-            }
+        const int index = state.forecasts.indexOfTime(timestampMs);
+        if (index < 0) {
+            continue;
+        }
+        if (!stringSource) {
+            stringSource = &state.forecasts;
         }
+        // A forecast shared across one upstream cell is placed at each grid point
+        WeatherSample sample = state.forecasts.at(index);
+        sample.latitude = state.coordinate.x();
+        sample.longitude = state.coordinate.y();
+        samples.append(sample);
     }
     return samples;
 }
@@ -9,7 +9,9 @@
 #include <QMap>
 #include "services/WeatherService.h"
 #include "services/MovingAverageFilter.h"
+#include "services/RequestScheduler.h"
 #include "models/WeatherData.h"
+#include "models/ForecastSeries.h"
 #include "nowcast/SpatioTemporalEngine.h"
 #include <QPointF>
 #include <QVector>
@@ -71,8 +73,12 @@ public:
     
     /**
      * @brief Fetch forecast using aggregation strategy
+     * 
+     * Upstream fetches, including the spatio-temporal fan-out, are queued
+     * on RequestScheduler::instance() at the given priority.
      */
-    void fetchForecast(double latitude, double longitude);
+    void fetchForecast(double latitude, double longitude,
+                       RequestScheduler::Priority priority = RequestScheduler::Interactive);
     
     /**
      * @brief Get performance metrics
@@ -115,21 +121,21 @@ private:
     struct ForecastWithService;
     
     void updateServiceAvailability(WeatherService* service, bool success, qint64 responseTime);
-    QList<WeatherData*> mergeForecasts(const QList<ForecastWithService>& forecastsWithServices);
+    ForecastSeries mergeForecasts(const QList<ForecastWithService>& forecastsWithServices);
     WeatherData* mergeCurrentWeather(const QList<WeatherData*>& currentData);
     double calculateConfidence(WeatherService* service) const;
     double calculateWeight(WeatherService* service, qint64 responseTime) const;
-    QDateTime binTimestamp(const QDateTime& timestamp, int binMinutes = 30) const;
+    qint64 binTimestamp(qint64 timestampMs, int binMinutes = 30) const;
     
     struct ForecastWithService {
-        QList<WeatherData*> forecasts;
+        ForecastSeries forecasts;
         WeatherService* service;
         qint64 responseTime;
     };
 
     struct SpatioGridPointState {
         QPointF coordinate;
-        QList<WeatherData*> forecasts;
+        ForecastSeries forecasts;   // Sorted by time
         bool completed = false;
     };
 
@@ -137,8 +143,9 @@ private:
         WeatherService* service = nullptr;
         QString apiName;
         QVector<SpatioGridPointState> gridStates;
-        QList<WeatherData*> spatialTimeline;
-        QList<WeatherData*> temporalTimeline;
+        QHash<int, QVector<int>> sharedPoints;  // Fetched grid index -> indices in the same upstream cell
+        ForecastSeries spatialTimeline;
+        ForecastSeries temporalTimeline;
         bool hasTemporalResult = false;
         bool hasError = false;
     };
@@ -149,11 +156,13 @@ private:
     void handleSpatioTemporalForecast(WeatherService* service, QList<WeatherData*> data);
     void processSpatioTemporalService(WeatherService* service);
     void finalizeSpatioTemporalResult();
-    void resetSpatioTemporalState(bool deleteTimelines = true);
+    void resetSpatioTemporalState();
     int matchGridIndex(const QList<QPointF>& grid, double lat, double lon) const;
-    QList<WeatherData*> buildSpatialSamples(const QVector<SpatioGridPointState>& states,
-                                            const QDateTime& timestamp) const;
+    QVector<WeatherSample> buildSpatialSamples(const QVector<SpatioGridPointState>& states,
+                                               qint64 timestampMs,
+                                               const ForecastSeries*& stringSource) const;
     void markServiceGridError(WeatherService* service, const QString& errorMessage);
+    void cancelQueuedFetches();
     
     QList<ServiceEntry> m_services;
     AggregationStrategy m_strategy;
@@ -181,6 +190,7 @@ private:
     QString m_currentRequestKey;
     double m_currentLat;
     double m_currentLon;
+    RequestScheduler::Priority m_currentPriority;
 
     // Spatio-temporal pipeline
     SpatioTemporalEngine* m_spatioTemporalEngine;
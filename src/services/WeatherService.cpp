@@ -1,7 +1,135 @@
 #include "services/WeatherService.h"
+#include "services/CacheManager.h"
+#include "services/HttpClient.h"
+#include <QDebug>
+#include <QNetworkReply>
+#include <QNetworkRequest>
 
 WeatherService::WeatherService(QObject *parent)
     : QObject(parent)
+    , m_httpClient(HttpClient::instance())
 {
 }
 
+void WeatherService::setHttpClient(HttpClient* client) {
+    m_httpClient = client ? client : HttpClient::instance();
+}
+
+void WeatherService::preconnect() {
+    m_httpClient->preconnect(endpoint());
+}
+
+
+QString WeatherService::inFlightKey(const QString& kind, double latitude, double longitude) {
+    return CacheManager::generateKey(kind, latitude, longitude);
+}
+
+bool WeatherService::joinInFlight(const QString& key) {
+    QNetworkReply* reply = m_inFlight.value(key, nullptr);
+    if (!reply) {
+        return false;
+    }
+    
+    // Results are broadcast through our signals, so every waiter sees the
+    // one reply's outcome
+    ++m_coalescedRequests;
+    qDebug() << serviceName() << "joined in-flight request" << key;
+    return true;
+}
+
+bool WeatherService::isForecastInFlight(double latitude, double longitude) const {
+    return m_inFlight.contains(inFlightKey("forecast", latitude, longitude));
+}
+
+void WeatherService::trackInFlight(const QString& key, QNetworkReply* reply) {
+    if (!reply) {
+        return;
+    }
+    m_inFlight.insert(key, reply);
+    m_inFlightKeys.insert(reply, key);
+}
+
+void WeatherService::releaseInFlight(QNetworkReply* reply) {
+    auto it = m_inFlightKeys.find(reply);
+    if (it == m_inFlightKeys.end()) {
+        return;
+    }
+    if (m_inFlight.value(it.value(), nullptr) == reply) {
+        m_inFlight.remove(it.value());
+    }
+    m_inFlightKeys.erase(it);
+}
+
+void WeatherService::clearInFlight() {
+    m_inFlight.clear();
+    m_inFlightKeys.clear();
+}
+
+bool WeatherService::applyValidators(QNetworkRequest& request, const QString& key) {
+    if (validatedPayload(key).isEmpty()) {
+        return false;
+    }
+    
+    const DatabaseManager::HttpValidator& validator = m_validators[key];
+    if (!validator.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", validator.etag);
+    }
+    if (!validator.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", validator.lastModified);
+    }
+    return true;
+}
+
+QByteArray WeatherService::validatedPayload(const QString& key) {
+    auto it = m_validators.constFind(key);
+    if (it != m_validators.constEnd()) {
+        return it->payload;
+    }
+    
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    DatabaseManager::HttpValidator validator;
+    if (!dbManager->isInitialized() || !dbManager->getHttpValidator(key, validator)) {
+        return QByteArray();
+    }
+    m_validators.insert(key, validator);
+    return validator.payload;
+}
+
+void WeatherService::storeValidators(const QString& key, QNetworkReply* reply, const QByteArray& payload) {
+    DatabaseManager::HttpValidator validator;
+    validator.key = key;
+    validator.etag = reply->rawHeader("ETag");
+    validator.lastModified = reply->rawHeader("Last-Modified");
+    validator.payload = payload;
+    if (key.isEmpty() || payload.isEmpty() || (validator.etag.isEmpty() && validator.lastModified.isEmpty())) {
+        return;
+    }
+    
+    m_validators.insert(key, validator);
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (dbManager->isInitialized()) {
+        dbManager->saveHttpValidator(validator);
+    }
+}
+
+QByteArray WeatherService::revalidated(const QString& key, QNetworkReply* reply) {
+    const QByteArray payload = validatedPayload(key);
+    if (payload.isEmpty()) {
+        return payload;
+    }
+    
+    ++m_notModified;
+    // A 304 may carry updated validators; either way the stored copy is current again
+    DatabaseManager::HttpValidator& validator = m_validators[key];
+    if (reply->hasRawHeader("ETag")) {
+        validator.etag = reply->rawHeader("ETag");
+    }
+    if (reply->hasRawHeader("Last-Modified")) {
+        validator.lastModified = reply->rawHeader("Last-Modified");
+    }
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    if (dbManager->isInitialized()) {
+        dbManager->saveHttpValidator(validator);
+    }
+    return payload;
+}
@@ -3,7 +3,14 @@
 
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <QUrl>
 #include "models/WeatherData.h"
+#include "database/DatabaseManager.h"
+
+class QNetworkReply;
+class QNetworkRequest;
+class HttpClient;
 
 /**
  * @brief Abstract base class for weather data services
@@ -51,6 +58,49 @@ public:
      */
     virtual void cancelActiveRequests() {}
     
+    /**
+     * @brief Number of fetches that attached to an in-flight request
+     * instead of issuing their own
+     */
+    int coalescedRequestCount() const { return m_coalescedRequests; }
+    
+    /**
+     * @brief Check whether a forecast fetch for the rounded coordinate is outstanding
+     * 
+     * A fetchForecast() for it now would join that request.
+     */
+    bool isForecastInFlight(double latitude, double longitude) const;
+    
+    /**
+     * @brief Number of 304 replies answered from the stored parsed result
+     */
+    int notModifiedCount() const { return m_notModified; }
+    
+    /**
+     * @brief HTTP client requests go through (HttpClient::instance() by default)
+     */
+    HttpClient* httpClient() const { return m_httpClient; }
+    void setHttpClient(HttpClient* client);
+    
+    /**
+     * @brief Root URL of the service's API
+     */
+    virtual QUrl endpoint() const { return QUrl(); }
+    
+    /**
+     * @brief Open a connection to endpoint() before the first fetch
+     */
+    void preconnect();
+    
+    /**
+     * @brief Identifier of the upstream forecast cell a coordinate falls in
+     * 
+     * Coordinates with the same non-empty key receive the same forecast, so
+     * a fan-out only needs to fetch one of them. Empty (the default) means
+     * every coordinate is fetched on its own.
+     */
+    virtual QString upstreamCell(double latitude, double longitude) { Q_UNUSED(latitude); Q_UNUSED(longitude); return QString(); }
+    
 signals:
     /**
      * @brief Emitted when forecast data is ready
@@ -68,7 +118,71 @@ signals:
     void error(QString message);
     
 protected:
+    /**
+     * @brief Single-flight key for a request kind at a rounded coordinate
+     *
+     * Uses CacheManager::generateKey so requests that would share a cache
+     * entry also share one network round trip.
+     */
+    static QString inFlightKey(const QString& kind, double latitude, double longitude);
+    
+    /**
+     * @brief Attach to the in-flight request for key, if there is one
+     * @return true if the caller should wait on the existing reply
+     */
+    bool joinInFlight(const QString& key);
+    
+    /**
+     * @brief Record reply as the single in-flight request for key
+     */
+    void trackInFlight(const QString& key, QNetworkReply* reply);
+    
+    /**
+     * @brief Forget reply once it has finished, failed or been aborted
+     */
+    void releaseInFlight(QNetworkReply* reply);
+    
+    /**
+     * @brief Forget every in-flight request
+     */
+    void clearInFlight();
+    
+    /**
+     * @brief Make request conditional on the validators stored for key
+     * 
+     * Validators are kept in memory and, once the database is initialized,
+     * in its http_validators table, so revalidation survives restarts.
+     * @return false if nothing is stored for key
+     */
+    bool applyValidators(QNetworkRequest& request, const QString& key);
+    
+    /**
+     * @brief Parsed result stored with the validators for key, or empty
+     */
+    QByteArray validatedPayload(const QString& key);
+    
+    /**
+     * @brief Remember reply's ETag and Last-Modified with the result parsed from it
+     * 
+     * Does nothing if the reply carries neither header.
+     */
+    void storeValidators(const QString& key, QNetworkReply* reply, const QByteArray& payload);
+    
+    /**
+     * @brief Handle a 304 reply: refresh the stored validators and return the payload
+     * @return Stored payload, or empty if there is none to replay
+     */
+    QByteArray revalidated(const QString& key, QNetworkReply* reply);
+    
     QString m_lastError;
+    
+private:
+    QHash<QString, QNetworkReply*> m_inFlight;
+    QHash<QNetworkReply*, QString> m_inFlightKeys;
+    int m_coalescedRequests = 0;
+    int m_notModified = 0;
+    HttpClient* m_httpClient;
+    QHash<QString, DatabaseManager::HttpValidator> m_validators;
 };
 
 #endif // WEATHERSERVICE_H
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "services/WeatherService.h"
+#include "services/HttpClient.h"
+#include "database/DatabaseManager.h"
+#include <QNetworkReply>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace {
+// Serves one versioned document: 200 with an ETag, or 304 when the request
+// already holds the current ETag
+class ValidatingServer : public QTcpServer
+{
+public:
+    ValidatingServer() {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    QByteArray pending = socket->property("pending").toByteArray() + socket->readAll();
+                    while (pending.contains("\r\n\r\n")) {
+                        const QByteArray head = pending.left(pending.indexOf("\r\n\r\n"));
+                        pending.remove(0, head.size() + 4);
+                        socket->write(respond(head));
+                    }
+                    socket->setProperty("pending", pending);
+                });
+            }
+        });
+    }
+
+    QByteArray respond(const QByteArray& head) {
+        ++requests;
+        const QByteArray etag = "\"v" + QByteArray::number(version) + "\"";
+        if (head.contains("If-None-Match: " + etag)) {
+            ++notModified;
+            return "HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\nContent-Length: 0\r\n\r\n";
+        }
+        const QByteArray body = "{\"version\":" + QByteArray::number(version) + "}";
+        return "HTTP/1.1 200 OK\r\nETag: " + etag + "\r\nContent-Type: application/json\r\n"
+               "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+    }
+
+    int version = 1;
+    int requests = 0;
+    int notModified = 0;
+};
+
+// Exposes the revalidation helpers of the base class
+class RevalidatingService : public WeatherService
+{
+public:
+    using WeatherService::WeatherService;
+    using WeatherService::applyValidators;
+    using WeatherService::validatedPayload;
+    using WeatherService::storeValidators;
+    using WeatherService::revalidated;
+
+    void fetchForecast(double, double) override {}
+    void fetchCurrent(double, double) override {}
+    QString serviceName() const override { return "Revalidating"; }
+};
+
+QNetworkReply* fetch(HttpClient& client, QNetworkRequest request) {
+    QNetworkReply* reply = client.get(request);
+    QEventLoop loop;
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    return reply;
+}
+
+int statusOf(QNetworkReply* reply) {
+    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+}
+} // namespace
+
+TEST(ConditionalGetTest, NotModifiedReplaysStoredPayload) {
+    ASSERT_TRUE(DatabaseManager::instance()->initialize());
+    ValidatingServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    HttpClient client;
+    const QUrl url(QString("http://127.0.0.1:%1/forecast").arg(server.serverPort()));
+    const QString key = "conditional_get_test/forecast";
+
+    RevalidatingService service;
+    service.setHttpClient(&client);
+
+    // First fetch is unconditional and stores the validators with the parsed result
+    QNetworkRequest request = client.request(url);
+    QNetworkReply* reply = fetch(client, request);
+    ASSERT_EQ(statusOf(reply), 200);
+    EXPECT_EQ(reply->readAll(), QByteArray("{\"version\":1}"));
+    service.storeValidators(key, reply, "parsed v1");
+    reply->deleteLater();
+
+    // Second fetch is conditional and comes back as a 304
+    request = client.request(url);
+    ASSERT_TRUE(service.applyValidators(request, key));
+    EXPECT_EQ(request.rawHeader("If-None-Match"), QByteArray("\"v1\""));
+    reply = fetch(client, request);
+    ASSERT_EQ(statusOf(reply), 304);
+    EXPECT_EQ(service.revalidated(key, reply), QByteArray("parsed v1"));
+    EXPECT_EQ(service.notModifiedCount(), 1);
+    reply->deleteLater();
+    EXPECT_EQ(server.notModified, 1);
+
+    // Validators survive a restart of the service
+    RevalidatingService restarted;
+    EXPECT_EQ(restarted.validatedPayload(key), QByteArray("parsed v1"));
+
+    // A changed document is fetched in full again
+    server.version = 2;
+    request = client.request(url);
+    ASSERT_TRUE(restarted.applyValidators(request, key));
+    reply = fetch(client, request);
+    ASSERT_EQ(statusOf(reply), 200);
+    restarted.storeValidators(key, reply, "parsed v2");
+    reply->deleteLater();
+    EXPECT_EQ(RevalidatingService().validatedPayload(key), QByteArray("parsed v2"));
+}
+
+TEST(ConditionalGetTest, RepliesWithoutValidatorsAreNotStored) {
+    ValidatingServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    HttpClient client;
+    RevalidatingService service;
+
+    QNetworkRequest request = client.request(QUrl(QString("http://127.0.0.1:%1/").arg(server.serverPort())));
+    EXPECT_FALSE(service.applyValidators(request, "conditional_get_test/unknown"));
+    EXPECT_FALSE(request.hasRawHeader("If-None-Match"));
+    EXPECT_FALSE(request.hasRawHeader("If-Modified-Since"));
+
+    QNetworkReply* reply = fetch(client, request);
+    service.storeValidators("conditional_get_test/empty_payload", reply, QByteArray());
+    EXPECT_TRUE(service.validatedPayload("conditional_get_test/empty_payload").isEmpty());
+    reply->deleteLater();
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include "database/ConnectionPool.h"
+#include "database/DatabaseManager.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSemaphore>
+#include <atomic>
+#include <vector>
+#include <memory>
+
+namespace {
+// Runs body on count threads at once and waits for all of them
+template <typename Body>
+void runOnThreads(int count, Body body) {
+    std::vector<QThread*> threads;
+    for (int i = 0; i < count; ++i) {
+        threads.push_back(QThread::create([body, i]() { body(i); }));
+    }
+    for (QThread* thread : threads) {
+        thread->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+} // namespace
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "pool_setup");
+        db.setDatabaseName(path());
+        ASSERT_TRUE(db.open());
+        DatabaseManager::applyTuning(db, DatabaseManager::TuningProfile::performance());
+        QSqlQuery query(db);
+        ASSERT_TRUE(query.exec("CREATE TABLE samples (id INTEGER PRIMARY KEY, value INTEGER)"));
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(query.exec(QString("INSERT INTO samples (value) VALUES (%1)").arg(i)));
+        }
+        db.close();
+    }
+
+    void TearDown() override {
+        QSqlDatabase::removeDatabase("pool_setup");
+    }
+
+    QString path() const { return dir.filePath("pool.db"); }
+
+    QTemporaryDir dir;
+};
+
+TEST_F(ConnectionPoolTest, EachThreadGetsItsOwnConnection) {
+    ConnectionPool pool(path());
+    QMutex mutex;
+    QSet<QString> names;
+    std::atomic<int> sums{0};
+
+    runOnThreads(4, [&](int) {
+        QSqlDatabase first = pool.connection();
+        QSqlDatabase second = pool.connection();
+        EXPECT_TRUE(first.isOpen());
+        EXPECT_EQ(first.connectionName(), second.connectionName());
+
+        QSqlQuery query(first);
+        if (query.exec("SELECT SUM(value) FROM samples") && query.next()) {
+            sums += query.value(0).toInt();
+        }
+        QMutexLocker locker(&mutex);
+        names.insert(first.connectionName());
+    });
+
+    EXPECT_EQ(names.size(), 4);
+    EXPECT_EQ(sums.load(), 4 * 4950);
+
+    // Connections close when their threads finish
+    EXPECT_EQ(pool.openConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, ConcurrentWritersWaitForTheLock) {
+    ConnectionPool pool(path());
+    std::atomic<int> failures{0};
+
+    runOnThreads(4, [&](int thread) {
+        QSqlDatabase db = pool.connection();
+        for (int i = 0; i < 25; ++i) {
+            QSqlQuery query(db);
+            query.prepare("INSERT INTO samples (value) VALUES (?)");
+            query.addBindValue(thread * 1000 + i);
+            if (!query.exec()) {
+                ++failures;
+            }
+        }
+    });
+
+    EXPECT_EQ(failures.load(), 0);
+    QSqlDatabase db = pool.connection();
+    QSqlQuery query(db);
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM samples") && query.next());
+    EXPECT_EQ(query.value(0).toInt(), 200);
+    query.finish();
+    db = QSqlDatabase();
+
+    EXPECT_EQ(pool.openConnections(), 1);
+    pool.release();
+    EXPECT_EQ(pool.openConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, RunningThreadsCloseTheirConnectionsAfterThePoolIsGone) {
+    auto pool = std::make_unique<ConnectionPool>(path());
+    const QString ownName = pool->connection().connectionName();
+    QSemaphore opened;
+    QSemaphore poolGone;
+    QString name;
+    bool usable = false;
+
+    QThread* worker = QThread::create([&]() {
+        name = pool->connection().connectionName();
+        opened.release();
+        poolGone.acquire();     // Still running when the pool is destroyed
+
+        // The connection still belongs to this thread and still works
+        QSqlQuery query(QSqlDatabase::database(name, false));
+        usable = query.exec("SELECT COUNT(*) FROM samples") && query.next() && query.value(0).toInt() == 100;
+    });
+    worker->start();
+    opened.acquire();
+    ASSERT_TRUE(QSqlDatabase::contains(name));
+    EXPECT_EQ(pool->openConnections(), 2);
+
+    // Only the destroying thread's own connection is closed here
+    pool.reset();
+    EXPECT_FALSE(QSqlDatabase::contains(ownName));
+    EXPECT_TRUE(QSqlDatabase::contains(name));
+
+    // The worker closes its connection when it finishes
+    poolGone.release();
+    worker->wait();
+    delete worker;
+    EXPECT_TRUE(usable);
+    EXPECT_FALSE(QSqlDatabase::contains(name));
+}
+
+TEST_F(ConnectionPoolTest, RejectsInMemoryDatabase) {
+    ConnectionPool pool(":memory:");
+    EXPECT_FALSE(pool.connection().isOpen());
+    EXPECT_EQ(pool.openConnections(), 0);
+}
+
+TEST(DatabaseManagerThreadingTest, WorkerThreadsUsePooledConnections) {
+    DatabaseManager* manager = DatabaseManager::instance();
+    ASSERT_TRUE(manager->initialize());
+    ASSERT_NE(manager->connectionPool(), nullptr);
+    ASSERT_TRUE(manager->setPreference("pool_test", "main"));
+
+    std::atomic<int> matches{0};
+    QMutex mutex;
+    QSet<QString> names;
+    runOnThreads(3, [&](int) {
+        QSqlDatabase db = manager->database();
+        {
+            QMutexLocker locker(&mutex);
+            names.insert(db.connectionName());
+        }
+        db = QSqlDatabase();
+
+        QList<QVariantList> rows;
+        QString errorText;
+        if (manager->execute("SELECT value FROM user_preferences WHERE key = ?", {"pool_test"}, &rows, &errorText)
+            && rows.size() == 1 && rows.first().value(0).toString() == "main") {
+            ++matches;
+        }
+        if (manager->getPreference("pool_test") == "main") {
+            ++matches;
+        }
+    });
+
+    EXPECT_EQ(matches.load(), 6);
+    EXPECT_EQ(names.size(), 3);
+    EXPECT_FALSE(names.contains(manager->database().connectionName()));
+    EXPECT_EQ(manager->connectionPool()->openConnections(), 0);
+
+    QString errorText;
+    EXPECT_FALSE(manager->execute("SELECT * FROM no_such_table", {}, nullptr, &errorText));
+    EXPECT_FALSE(errorText.isEmpty());
+}
@@ -3,7 +3,9 @@
 #include "database/DatabaseManager.h"
 #include "services/WeatherAggregator.h"
 #include "services/HistoricalDataManager.h"
+#include "services/HistoricalWriter.h"
 #include "services/MovingAverageFilter.h"
+#include "services/CacheManager.h"
 #include "models/WeatherData.h"
 #include <QCoreApplication>
 #include <QEventLoop>
@@ -11,6 +13,10 @@
 #include <QString>
 #include <QObject>
 #include <QDateTime>
+#include <QTimeZone>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QSqlQuery>
 
 class EndToEndTest : public ::testing::Test {
 protected:
@@ -35,6 +41,356 @@ TEST_F(EndToEndTest, WeatherControllerCreation) {
     EXPECT_FALSE(controller.loading());
 }
 
+// Integration test for the SQLite-backed second cache tier
+TEST_F(EndToEndTest, PersistentCacheSurvivesRestart) {
+    DatabaseManager* db = DatabaseManager::instance();
+    ASSERT_TRUE(db->isInitialized());
+    
+    const QString key = CacheManager::generateKey("forecast_test", 30.6272, -96.3344);
+    const QByteArray payload("persisted-forecast");
+    
+    {
+        CacheManager writer(16);
+        writer.setPersistentStore(db);
+        writer.put(key, payload, 600);
+        EXPECT_EQ(writer.pendingWriteCount(), 1);
+        // Destruction flushes queued writes
+    }
+    
+    {
+        CacheManager reader(16);
+        reader.setPersistentStore(db);
+        EXPECT_EQ(reader.size(), 0);
+        QVariant value = reader.get(key);
+        ASSERT_TRUE(value.isValid());
+        EXPECT_EQ(value.toByteArray(), payload);
+        EXPECT_EQ(reader.size(), 1);
+        
+        reader.remove(key);
+        reader.flush();
+    }
+    
+    CacheManager afterRemove(16);
+    afterRemove.setPersistentStore(db);
+    EXPECT_FALSE(afterRemove.get(key).isValid());
+}
+
+TEST_F(EndToEndTest, FailedCacheFlushKeepsEntriesQueued) {
+    DatabaseManager* db = DatabaseManager::instance();
+    ASSERT_TRUE(db->isInitialized());
+    
+    const QString key = CacheManager::generateKey("forecast_retry", 30.6272, -96.3344);
+    QSqlQuery query(db->database());
+    ASSERT_TRUE(query.exec(QString("CREATE TEMP TRIGGER fail_cache_write BEFORE INSERT ON forecast_cache "
+                                   "WHEN NEW.cache_key = '%1' BEGIN SELECT RAISE(ABORT, 'busy'); END").arg(key)));
+    
+    CacheManager cache(16);
+    cache.setPersistentStore(db);
+    cache.put(key, QByteArray("first"), 600);
+    cache.flush();
+    EXPECT_EQ(cache.pendingWriteCount(), 1);
+    
+    // A newer write replaces the one that failed; the retry persists it
+    cache.put(key, QByteArray("second"), 600);
+    EXPECT_EQ(cache.pendingWriteCount(), 1);
+    ASSERT_TRUE(query.exec("DROP TRIGGER temp.fail_cache_write"));
+    cache.flush();
+    EXPECT_EQ(cache.pendingWriteCount(), 0);
+    
+    CacheManager reader(16);
+    reader.setPersistentStore(db);
+    EXPECT_EQ(reader.get(key).toByteArray(), QByteArray("second"));
+    reader.remove(key);
+    reader.flush();
+}
+
+// Integration test for the batched historical write path
+TEST_F(EndToEndTest, HistoricalBatchStoreRoundTrip) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    
+    const double lat = 31.1234;
+    const double lon = -97.5678;
+    const QDateTime start = QDateTime::currentDateTime().addDays(-1);
+    
+    QList<WeatherData*> forecasts;
+    for (int i = 0; i < 48; ++i) {
+        WeatherData* data = new WeatherData();
+        data->setTimestamp(start.addSecs(i * 3600));
+        data->setTemperature(60.0 + i);
+        data->setFeelsLike(58.0 + i);
+        data->setWeatherCondition("Clear");
+        forecasts.append(data);
+    }
+    
+    EXPECT_TRUE(manager.storeForecasts(lat, lon, forecasts, "batch_test"));
+    qDeleteAll(forecasts);
+    
+    QList<WeatherData*> stored = manager.getHistoricalData(lat, lon, start, start.addDays(2), "batch_test");
+    ASSERT_EQ(stored.size(), 48);
+    EXPECT_DOUBLE_EQ(stored.first()->temperature(), 60.0);
+    EXPECT_DOUBLE_EQ(stored.last()->feelsLike(), 58.0 + 47);
+    EXPECT_EQ(stored.first()->weatherCondition(), QString("Clear"));
+    qDeleteAll(stored);
+}
+
+TEST_F(EndToEndTest, HistoricalScanStreamsBoundedBatches) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    
+    const double lat = 31.2345;
+    const double lon = -97.6789;
+    const QDateTime start(QDate(2024, 3, 1), QTime(0, 0), QTimeZone::utc());
+    
+    QList<WeatherData*> forecasts;
+    for (int i = 0; i < 72; ++i) {
+        WeatherData* data = new WeatherData();
+        data->setTimestamp(start.addSecs(i * 3600));
+        data->setTemperature(50.0 + i);
+        data->setWeatherCondition(i % 2 == 0 ? "Clear" : "Cloudy");
+        forecasts.append(data);
+    }
+    ASSERT_TRUE(manager.storeForecasts(lat, lon, forecasts, "scan_test"));
+    qDeleteAll(forecasts);
+    
+    // Batches span daily partitions and arrive oldest first
+    QList<int> batchSizes;
+    qint64 lastTimestamp = 0;
+    int samples = 0;
+    bool ordered = true;
+    ASSERT_TRUE(manager.scanHistoricalData(lat, lon, start, start.addDays(4),
+        [&](const ForecastSeries& batch) {
+            batchSizes.append(batch.size());
+            for (int i = 0; i < batch.size(); ++i) {
+                ordered = ordered && batch.timestampAt(i) > lastTimestamp;
+                lastTimestamp = batch.timestampAt(i);
+            }
+            EXPECT_EQ(batch.conditionAt(0), QString((samples % 2 == 0) ? "Clear" : "Cloudy"));
+            samples += batch.size();
+            return true;
+        }, "scan_test", 20));
+    EXPECT_EQ(samples, 72);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(batchSizes, QList<int>({20, 20, 20, 12}));
+    
+    // The visitor can stop the scan early
+    int visited = 0;
+    ASSERT_TRUE(manager.scanHistoricalData(lat, lon, start, start.addDays(4),
+        [&](const ForecastSeries& batch) {
+            visited += batch.size();
+            return false;
+        }, "scan_test", 16));
+    EXPECT_EQ(visited, 16);
+}
+
+// Integration test for the background historical writer
+TEST_F(EndToEndTest, HistoricalWriterGroupCommit) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    HistoricalWriter* writer = manager.writer();
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->isRunning());
+    
+    const double lat = 32.2345;
+    const double lon = -98.6789;
+    const QDateTime start = QDateTime::currentDateTime().addDays(-1);
+    
+    for (int batch = 0; batch < 4; ++batch) {
+        QList<WeatherData*> forecasts;
+        for (int i = 0; i < 12; ++i) {
+            WeatherData* data = new WeatherData();
+            data->setTimestamp(start.addSecs((batch * 12 + i) * 3600));
+            data->setTemperature(50.0 + batch);
+            forecasts.append(data);
+        }
+        EXPECT_TRUE(manager.enqueueForecasts(lat, lon, forecasts, "writer_test"));
+        qDeleteAll(forecasts);
+    }
+    
+    ASSERT_TRUE(writer->waitForIdle());
+    HistoricalWriter::Stats stats = writer->stats();
+    EXPECT_EQ(stats.acceptedBatches, 4);
+    EXPECT_EQ(stats.writtenSamples, 48);
+    EXPECT_GE(stats.commits, 1);
+    EXPECT_LE(stats.commits, 4);
+    EXPECT_EQ(stats.queuedSamples, 0);
+    
+    QList<WeatherData*> stored = manager.getHistoricalData(lat, lon, start, start.addDays(2), "writer_test");
+    EXPECT_EQ(stored.size(), 48);
+    qDeleteAll(stored);
+    
+    // A full queue rejects new work instead of blocking the caller
+    HistoricalWriter small(DatabaseManager::instance()->database().databaseName(), 8);
+    ASSERT_TRUE(small.start());
+    ForecastSeries series;
+    for (int i = 0; i < 12; ++i) {
+        WeatherSample sample;
+        sample.timestampMs = start.toMSecsSinceEpoch() + static_cast<qint64>(i) * 3600 * 1000;
+        series.append(sample);
+    }
+    EXPECT_FALSE(small.enqueue(lat, lon, series, "writer_test"));
+    EXPECT_EQ(small.stats().droppedBatches, 1);
+    EXPECT_EQ(small.stats().droppedSamples, 12);
+}
+
+// Integration test for nearest-neighbor historical lookups
+TEST_F(EndToEndTest, NearbyDataReturnsClosestSeries) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    
+    const double lat = 34.5000;
+    const double lon = -99.5000;
+    // Fixed times keep reruns against the same database idempotent
+    const QDateTime start(QDate(2024, 3, 1), QTime(12, 0), QTimeZone::utc());
+    
+    // About 0 km, 2.2 km, 5.6 km and 111 km from the query point
+    const QList<QPair<double, double>> locations = {
+        {lat, lon}, {lat + 0.02, lon}, {lat, lon + 0.06}, {lat + 1.0, lon}
+    };
+    for (int loc = 0; loc < locations.size(); ++loc) {
+        QList<WeatherData*> forecasts;
+        for (int i = 0; i < 6; ++i) {
+            WeatherData* data = new WeatherData();
+            data->setTimestamp(start.addSecs(i * 3600));
+            data->setTemperature(70.0 + loc);
+            forecasts.append(data);
+        }
+        EXPECT_TRUE(manager.storeForecasts(locations[loc].first, locations[loc].second, forecasts, "nearby_test"));
+        qDeleteAll(forecasts);
+    }
+    
+    QList<HistoricalDataManager::NearbySeries> nearby =
+        manager.getNearbyData(lat, lon, 10.0, start, start.addDays(1), 8, "nearby_test");
+    ASSERT_EQ(nearby.size(), 3);
+    EXPECT_NEAR(nearby[0].distanceKm, 0.0, 0.01);
+    EXPECT_NEAR(nearby[1].distanceKm, 2.2, 0.1);
+    EXPECT_NEAR(nearby[2].distanceKm, 5.5, 0.2);
+    EXPECT_DOUBLE_EQ(nearby[1].latitude, lat + 0.02);
+    EXPECT_EQ(nearby[0].series.size(), 6);
+    EXPECT_DOUBLE_EQ(nearby[2].series.temperatures().first(), 72.0);
+    
+    // k limits the result to the closest locations
+    nearby = manager.getNearbyData(lat, lon, 10.0, start, start.addDays(1), 2, "nearby_test");
+    ASSERT_EQ(nearby.size(), 2);
+    EXPECT_LT(nearby[0].distanceKm, nearby[1].distanceKm);
+    
+    // Locations without samples in the time range are skipped
+    EXPECT_TRUE(manager.getNearbyData(lat, lon, 10.0, start.addYears(-10), start.addYears(-9),
+                                      8, "nearby_test").isEmpty());
+}
+
+// Integration test for ingest-time hourly and daily rollups
+TEST_F(EndToEndTest, AggregatesReadCoarsestRollup) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    
+    const double lat = 33.7500;
+    const double lon = -100.2500;
+    const QDateTime start(QDate(2024, 2, 1), QTime(0, 0), QTimeZone::utc());
+    const int days = 21;
+    
+    // Three weeks of 15-minute samples; each day has its own temperature
+    for (int day = 0; day < days; ++day) {
+        QList<WeatherData*> forecasts;
+        for (int i = 0; i < 96; ++i) {
+            WeatherData* data = new WeatherData();
+            data->setTimestamp(start.addDays(day).addSecs(i * 900));
+            data->setTemperature(50.0 + day + (i % 2));
+            data->setHumidity(60);
+            forecasts.append(data);
+        }
+        EXPECT_TRUE(manager.storeForecasts(lat, lon, forecasts, "rollup_test"));
+        // Re-ingesting the same samples must not count them twice
+        if (day == 0) {
+            EXPECT_TRUE(manager.storeForecasts(lat, lon, forecasts, "rollup_test"));
+        }
+        qDeleteAll(forecasts);
+    }
+    const QDateTime end = start.addDays(days).addSecs(-1);
+    
+    HistoricalDataManager::Resolution resolution = HistoricalDataManager::Resolution::Raw;
+    QList<HistoricalDataManager::AggregateBucket> daily =
+        manager.getAggregates(lat, lon, start, end, 24 * 3600, "rollup_test", &resolution);
+    EXPECT_EQ(resolution, HistoricalDataManager::Resolution::Daily);
+    ASSERT_EQ(daily.size(), days);
+    EXPECT_EQ(daily[0].sampleCount, 96);
+    EXPECT_EQ(daily[3].start, start.addDays(3));
+    EXPECT_DOUBLE_EQ(daily[3].temperature.mean(), 53.5);
+    EXPECT_DOUBLE_EQ(daily[3].temperature.min, 53.0);
+    EXPECT_DOUBLE_EQ(daily[3].temperature.max, 54.0);
+    EXPECT_DOUBLE_EQ(daily[3].humidity.mean(), 60.0);
+    
+    // Weekly buckets merge daily rollups
+    QList<HistoricalDataManager::AggregateBucket> weekly =
+        manager.getAggregates(lat, lon, start, end, 7 * 24 * 3600, "rollup_test", &resolution);
+    EXPECT_EQ(resolution, HistoricalDataManager::Resolution::Daily);
+    int weeklySamples = 0;
+    for (const HistoricalDataManager::AggregateBucket& bucket : weekly) {
+        weeklySamples += bucket.sampleCount;
+    }
+    EXPECT_EQ(weeklySamples, days * 96);
+    
+    QList<HistoricalDataManager::AggregateBucket> sixHourly =
+        manager.getAggregates(lat, lon, start, end, 6 * 3600, "rollup_test", &resolution);
+    EXPECT_EQ(resolution, HistoricalDataManager::Resolution::Hourly);
+    ASSERT_EQ(sixHourly.size(), days * 4);
+    EXPECT_EQ(sixHourly[5].sampleCount, 24);
+    EXPECT_DOUBLE_EQ(sixHourly[5].temperature.mean(), 51.5);
+    
+    // Sub-hour steps fall back to raw rows and agree with the rollups
+    QList<HistoricalDataManager::AggregateBucket> raw =
+        manager.getAggregates(lat, lon, start.addDays(3), start.addDays(4).addSecs(-1), 1800, "rollup_test", &resolution);
+    EXPECT_EQ(resolution, HistoricalDataManager::Resolution::Raw);
+    ASSERT_EQ(raw.size(), 48);
+    EXPECT_EQ(raw[0].sampleCount, 2);
+    EXPECT_DOUBLE_EQ(raw[0].temperature.mean(), 53.5);
+}
+
+// Integration test for archiving expired partitions
+TEST_F(EndToEndTest, ExpiredPartitionsStayReadableFromArchive) {
+    HistoricalDataManager manager;
+    ASSERT_TRUE(manager.initialize());
+    QTemporaryDir archiveDir;
+    ASSERT_TRUE(archiveDir.isValid());
+    manager.setArchiveDirectory(archiveDir.path());
+    manager.setArchiveRetentionDays(60);
+    
+    const double lat = 32.2500;
+    const double lon = -101.7500;
+    const QDateTime today(QDateTime::currentDateTimeUtc().date(), QTime(0, 0), QTimeZone::utc());
+    const QDateTime start = today.addDays(-30);
+    
+    QList<WeatherData*> forecasts;
+    for (int i = 0; i < 24; ++i) {
+        WeatherData* data = new WeatherData();
+        data->setTimestamp(start.addSecs(i * 3600));
+        data->setTemperature(55.5 + i * 0.5);
+        data->setWeatherCondition(i < 12 ? "Clear" : "Rain");
+        forecasts.append(data);
+    }
+    ASSERT_TRUE(manager.storeForecasts(lat, lon, forecasts, "archive_test"));
+    qDeleteAll(forecasts);
+    
+    // The day leaves the database but remains readable from the archive
+    EXPECT_GE(manager.cleanupOldData(7), 1);
+    const QString partition = DatabaseManager::historicalPartition(start.toSecsSinceEpoch());
+    EXPECT_FALSE(DatabaseManager::historicalPartitions(DatabaseManager::instance()->database()).contains(partition));
+    EXPECT_TRUE(QDir(archiveDir.path()).exists(partition + ".hlwa"));
+    
+    QList<WeatherData*> archived = manager.getHistoricalData(lat, lon, start, start.addDays(1), "archive_test");
+    ASSERT_EQ(archived.size(), 24);
+    EXPECT_EQ(archived[0]->timestamp(), start);
+    EXPECT_DOUBLE_EQ(archived[3]->temperature(), 57.0);
+    EXPECT_EQ(archived[20]->weatherCondition(), QString("Rain"));
+    qDeleteAll(archived);
+    
+    // Archives expire on their own, longer schedule
+    manager.setArchiveRetentionDays(20);
+    manager.cleanupOldData(7);
+    EXPECT_FALSE(QDir(archiveDir.path()).exists(partition + ".hlwa"));
+    EXPECT_TRUE(manager.getHistoricalData(lat, lon, start, start.addDays(1), "archive_test").isEmpty());
+}
+
 // Integration test - requires network
 TEST_F(EndToEndTest, FetchForecast) {
     WeatherController controller;
@@ -66,6 +422,29 @@ TEST_F(EndToEndTest, FetchForecast) {
     }
 }
 
+TEST_F(EndToEndTest, RepeatedFetchJoinsInFlightRequest) {
+    WeatherController controller;
+    controller.setPirateWeatherApiKey("test_key");
+    controller.setUseAggregation(false);
+    controller.setServiceProvider(WeatherController::PirateWeather);
+    PirateWeatherService* service = controller.findChild<PirateWeatherService*>();
+    ASSERT_NE(service, nullptr);
+    
+    // Two taps on the same (uncached) location before the reply arrives
+    controller.fetchForecast(-45.8712, 170.5036);
+    ASSERT_TRUE(service->isForecastInFlight(-45.8712, 170.5036));
+    controller.fetchForecast(-45.87121, 170.50361);
+    
+    EXPECT_EQ(service->coalescedRequestCount(), 1);
+    EXPECT_TRUE(service->isForecastInFlight(-45.8712, 170.5036));
+    
+    // A different location still replaces the outstanding request
+    controller.fetchForecast(29.7604, -95.3698);
+    EXPECT_FALSE(service->isForecastInFlight(-45.8712, 170.5036));
+    EXPECT_EQ(service->coalescedRequestCount(), 1);
+    service->cancelActiveRequests();
+}
+
 // Integration test for weighted average + moving average flow
 TEST_F(EndToEndTest, WeightedAverageWithMovingAverage) {
     // Create aggregator with multiple services
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include "database/DatabaseManager.h"
+#include "services/HistoricalDataManager.h"
+#include "models/ForecastSeries.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QDebug>
+
+class HistoricalSchemaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+        db = QSqlDatabase::addDatabase("QSQLITE", "historical_schema_test");
+        db.setDatabaseName(dir.filePath("schema.db"));
+        ASSERT_TRUE(db.open());
+    }
+
+    void TearDown() override {
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase("historical_schema_test");
+    }
+
+    QTemporaryDir dir;
+    QSqlDatabase db;
+};
+
+TEST_F(HistoricalSchemaTest, MigratesLegacyLayout) {
+    // Layout before integer keys: REAL coordinates, ISO text timestamps, JSON copy
+    QSqlQuery query(db);
+    ASSERT_TRUE(query.exec(R"(
+        CREATE TABLE historical_weather (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            latitude REAL NOT NULL, longitude REAL NOT NULL,
+            timestamp DATETIME NOT NULL, source TEXT NOT NULL,
+            temperature REAL, precip_probability REAL, precip_intensity REAL,
+            wind_speed REAL, wind_direction INTEGER, humidity INTEGER, pressure REAL,
+            cloud_cover INTEGER, visibility INTEGER, uv_index INTEGER,
+            weather_condition TEXT, weather_description TEXT, data_json TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            UNIQUE(latitude, longitude, timestamp, source)
+        )
+    )"));
+    ASSERT_TRUE(query.exec("CREATE INDEX idx_historical_timestamp ON historical_weather(timestamp)"));
+
+    const QDateTime when = QDateTime::currentDateTime().addDays(-2);
+    query.prepare(R"(
+        INSERT INTO historical_weather (latitude, longitude, timestamp, source, temperature,
+                                        humidity, weather_condition, data_json)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    query.addBindValue(30.6272);
+    query.addBindValue(-96.3344);
+    query.addBindValue(when.toString(Qt::ISODate));
+    query.addBindValue(QString("pirateweather"));
+    query.addBindValue(71.5);
+    query.addBindValue(64);
+    query.addBindValue(QString("Cloudy"));
+    query.addBindValue(QString(R"({"feelsLike": 73.0})"));
+    ASSERT_TRUE(query.exec());
+
+    ASSERT_TRUE(DatabaseManager::createTables(db));
+
+    const QSqlRecord record = db.record("historical_weather");
+    EXPECT_TRUE(record.contains("lat_udeg"));
+    EXPECT_TRUE(record.contains("ts"));
+    EXPECT_FALSE(record.contains("timestamp"));
+    EXPECT_FALSE(db.tables().contains("historical_weather_legacy"));
+    EXPECT_EQ(DatabaseManager::historicalPartitions(db),
+              QStringList{DatabaseManager::historicalPartition(when.toSecsSinceEpoch())});
+
+    ASSERT_TRUE(query.exec("SELECT lat_udeg, lon_udeg, ts, temperature, feels_like, humidity, weather_condition FROM historical_weather"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(query.value(0).toLongLong(), 30627200);
+    EXPECT_EQ(query.value(1).toLongLong(), -96334400);
+    EXPECT_EQ(query.value(2).toLongLong(), when.toSecsSinceEpoch());
+    EXPECT_DOUBLE_EQ(query.value(3).toDouble(), 71.5);
+    EXPECT_DOUBLE_EQ(query.value(4).toDouble(), 73.0);
+    EXPECT_EQ(query.value(5).toInt(), 64);
+    EXPECT_EQ(query.value(6).toString(), QString("Cloudy"));
+    EXPECT_FALSE(query.next());
+
+    // Running again on the migrated layout is a no-op
+    EXPECT_TRUE(DatabaseManager::createTables(db));
+}
+
+TEST_F(HistoricalSchemaTest, RangeQueryUsesPrimaryKey) {
+    ASSERT_TRUE(DatabaseManager::applyTuning(db, DatabaseManager::TuningProfile::performance()));
+    ASSERT_TRUE(DatabaseManager::createTables(db));
+
+    // A few hundred locations with three weeks of hourly data each
+    const int locations = 300;
+    const int hours = 21 * 24;
+    const qint64 baseMs = QDateTime::currentDateTime().addDays(-21).toMSecsSinceEpoch();
+    ASSERT_TRUE(db.transaction());
+    for (int loc = 0; loc < locations; ++loc) {
+        ForecastSeries series;
+        series.reserve(hours);
+        for (int h = 0; h < hours; ++h) {
+            WeatherSample sample;
+            sample.timestampMs = baseMs + static_cast<qint64>(h) * 3600 * 1000;
+            sample.temperature = 50.0 + h % 30;
+            series.append(sample);
+        }
+        QString errorText;
+        ASSERT_TRUE(HistoricalDataManager::insertSeries(db, 30.0 + loc * 0.01, -96.0, series, "pirateweather", errorText))
+            << errorText.toStdString();
+    }
+    ASSERT_TRUE(db.commit());
+
+    // The view's WHERE clause reaches every daily partition's primary key
+    QSqlQuery query(db);
+    ASSERT_TRUE(query.exec(R"(
+        EXPLAIN QUERY PLAN SELECT ts, temperature FROM historical_weather
+        WHERE lat_udeg = 30500000 AND lon_udeg = -96000000 AND ts >= 0 AND ts <= 1
+    )"));
+    QString plan;
+    while (query.next()) {
+        plan += query.value(3).toString() + "\n";
+    }
+    EXPECT_GE(DatabaseManager::historicalPartitions(db).size(), 21);
+    EXPECT_FALSE(plan.contains("SCAN historical_weather_")) << plan.toStdString();
+
+    query.prepare(R"(
+        SELECT ts, temperature FROM historical_weather
+        WHERE lat_udeg = ? AND lon_udeg = ? AND ts >= ? AND ts <= ? AND source = ?
+        ORDER BY ts ASC
+    )");
+    const int iterations = 200;
+    int rows = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        const int loc = i % locations;
+        const qint64 start = baseMs / 1000 + (i % 14) * 24 * 3600;
+        query.bindValue(0, DatabaseManager::toMicroDegrees(30.0 + loc * 0.01));
+        query.bindValue(1, DatabaseManager::toMicroDegrees(-96.0));
+        query.bindValue(2, start);
+        query.bindValue(3, start + 24 * 3600 - 1);
+        query.bindValue(4, QString("pirateweather"));
+        ASSERT_TRUE(query.exec());
+        rows = 0;
+        while (query.next()) {
+            ++rows;
+        }
+    }
+    const double averageMs = static_cast<double>(timer.nsecsElapsed()) / 1e6 / iterations;
+    qInfo() << "Historical day range query over" << locations * hours << "rows:" << averageMs << "ms";
+
+    EXPECT_EQ(rows, 24);
+}
+
+TEST_F(HistoricalSchemaTest, RetentionDropsWholePartitions) {
+    ASSERT_TRUE(DatabaseManager::createTables(db));
+
+    // Five UTC days of hourly samples
+    const qint64 dayStart = QDateTime(QDate(2024, 3, 1), QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+    ForecastSeries series;
+    for (int h = 0; h < 5 * 24; ++h) {
+        WeatherSample sample;
+        sample.timestampMs = (dayStart + h * 3600) * 1000;
+        sample.temperature = 40.0 + h % 24;
+        series.append(sample);
+    }
+    QString errorText;
+    ASSERT_TRUE(db.transaction());
+    ASSERT_TRUE(HistoricalDataManager::insertSeries(db, 30.6272, -96.3344, series, "nws", errorText))
+        << errorText.toStdString();
+    ASSERT_TRUE(db.commit());
+    ASSERT_EQ(DatabaseManager::historicalPartitions(db).size(), 5);
+    EXPECT_EQ(DatabaseManager::historicalPartitions(db, dayStart + 24 * 3600, dayStart + 2 * 24 * 3600).size(), 2);
+
+    // The cutoff falls inside the third day, which is kept whole
+    const qint64 cutoff = dayStart + 2 * 24 * 3600 + 6 * 3600;
+    EXPECT_EQ(DatabaseManager::dropHistoricalPartitionsBefore(db, cutoff), 2);
+    EXPECT_EQ(DatabaseManager::dropHistoricalPartitionsBefore(db, cutoff), 0);
+
+    const QStringList remaining = DatabaseManager::historicalPartitions(db);
+    ASSERT_EQ(remaining.size(), 3);
+    EXPECT_EQ(remaining.first(), DatabaseManager::historicalPartition(cutoff));
+
+    QSqlQuery query(db);
+    ASSERT_TRUE(query.exec("SELECT COUNT(*), MIN(ts) FROM historical_weather"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(query.value(0).toInt(), 3 * 24);
+    EXPECT_EQ(query.value(1).toLongLong(), dayStart + 2 * 24 * 3600);
+}
+
+TEST_F(HistoricalSchemaTest, RevisionsStoreOnlyChangedSamples) {
+    ASSERT_TRUE(DatabaseManager::createTables(db));
+
+    // A 48-hour horizon, fetched three times an hour apart
+    const qint64 dayStart = QDateTime(QDate(2024, 4, 1), QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+    auto horizon = [dayStart](double offset, bool revised) {
+        ForecastSeries series;
+        for (int h = 0; h < 48; ++h) {
+            WeatherSample sample;
+            sample.timestampMs = (dayStart + h * 3600) * 1000;
+            sample.temperature = 60.0 + h % 24 + offset + (revised && h >= 10 && h < 15 ? 3.0 : 0.0);
+            sample.windDirection = 359;
+            sample.conditionId = series.internString(revised && h == 20 ? "Rain" : "Clear");
+            series.append(sample);
+        }
+        return series;
+    };
+    const qint64 firstIssue = dayStart - 3 * 3600;
+    const qint64 secondIssue = firstIssue + 3600;
+    const qint64 thirdIssue = secondIssue + 3600;
+
+    QString errorText;
+    int changed = -1;
+    ASSERT_TRUE(db.transaction());
+    ASSERT_TRUE(HistoricalDataManager::insertSeries(db, 30.6272, -96.3344, horizon(0.0, false), "pirateweather",
+                                                    errorText, firstIssue, &changed)) << errorText.toStdString();
+    EXPECT_EQ(changed, 48);
+
+    // Jitter within tolerance writes nothing
+    ASSERT_TRUE(HistoricalDataManager::insertSeries(db, 30.6272, -96.3344, horizon(0.05, false), "pirateweather",
+                                                    errorText, secondIssue, &changed)) << errorText.toStdString();
+    EXPECT_EQ(changed, 0);
+
+    ASSERT_TRUE(HistoricalDataManager::insertSeries(db, 30.6272, -96.3344, horizon(0.0, true), "pirateweather",
+                                                    errorText, thirdIssue, &changed)) << errorText.toStdString();
+    EXPECT_EQ(changed, 6);
+    ASSERT_TRUE(db.commit());
+
+    QSqlQuery query(db);
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM forecast_revisions"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(query.value(0).toInt(), 48 + 6);
+
+    // The partitions hold the latest values
+    const qint64 latKey = DatabaseManager::toMicroDegrees(30.6272);
+    const qint64 lonKey = DatabaseManager::toMicroDegrees(-96.3344);
+    ForecastSeries latest;
+    ASSERT_TRUE(HistoricalDataManager::readSeries(db, latKey, lonKey, dayStart, dayStart + 47 * 3600,
+                                                  "pirateweather", latest, errorText));
+    ASSERT_EQ(latest.size(), 48);
+    EXPECT_DOUBLE_EQ(latest.temperatures().at(10), 73.0);
+
+    // Any issuance can be reconstructed
+    ForecastSeries asIssued;
+    qint64 resolved = 0;
+    ASSERT_TRUE(HistoricalDataManager::readIssuance(db, latKey, lonKey, "pirateweather", secondIssue + 1800,
+                                                    asIssued, errorText, &resolved));
+    EXPECT_EQ(resolved, secondIssue);
+    ASSERT_EQ(asIssued.size(), 48);
+    EXPECT_DOUBLE_EQ(asIssued.temperatures().at(10), 70.0);
+    EXPECT_EQ(asIssued.conditionAt(20), QString("Clear"));
+
+    asIssued = ForecastSeries();
+    ASSERT_TRUE(HistoricalDataManager::readIssuance(db, latKey, lonKey, "pirateweather", thirdIssue,
+                                                    asIssued, errorText, &resolved));
+    EXPECT_EQ(resolved, thirdIssue);
+    ASSERT_EQ(asIssued.size(), 48);
+    EXPECT_DOUBLE_EQ(asIssued.temperatures().at(10), 73.0);
+    EXPECT_DOUBLE_EQ(asIssued.temperatures().at(15), 75.0);
+    EXPECT_EQ(asIssued.conditionAt(20), QString("Rain"));
+
+    asIssued = ForecastSeries();
+    ASSERT_TRUE(HistoricalDataManager::readIssuance(db, latKey, lonKey, "pirateweather", firstIssue - 1,
+                                                    asIssued, errorText, &resolved));
+    EXPECT_TRUE(asIssued.isEmpty());
+    EXPECT_EQ(resolved, 0);
+
+    // Dropping a day forgets its revisions, so it can be ingested again
+    ASSERT_EQ(DatabaseManager::dropHistoricalPartitionsBefore(db, dayStart + 24 * 3600), 1);
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM forecast_revisions"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(query.value(0).toInt(), 24);
+}
+
+TEST(RevisionToleranceTest, WindDirectionWrapsAround) {
+    ForecastSeries strings;
+    WeatherSample previous;
+    previous.windDirection = 359;
+    WeatherSample current = previous;
+    current.windDirection = 0;
+
+    HistoricalDataManager::RevisionTolerance tolerance;
+    EXPECT_FALSE(tolerance.exceeded(previous, strings, current, strings));
+    current.windDirection = 5;
+    EXPECT_TRUE(tolerance.exceeded(previous, strings, current, strings));
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "database/DatabaseManager.h"
+#include "services/HistoricalDataManager.h"
+#include "models/ForecastSeries.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+struct BenchmarkResult {
+    double insertsPerSecond = 0.0;
+    double rangeQueryMs = 0.0;
+    int rowsRead = 0;
+};
+
+// Inserts forecast-sized batches (one transaction each, like live ingest) into
+// a fresh database, then times the historical range query
+BenchmarkResult runProfile(const QString& name, const DatabaseManager::TuningProfile& profile) {
+    BenchmarkResult result;
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return result;
+    }
+
+    const QString connectionName = QString("tuning_benchmark_%1").arg(name);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(dir.filePath("benchmark.db"));
+        if (!db.open()) {
+            return result;
+        }
+        DatabaseManager::applyTuning(db, profile);
+        if (!DatabaseManager::createTables(db)) {
+            return result;
+        }
+
+        const int batches = 200;
+        const int batchSize = 48;
+        const qint64 baseMs = QDateTime::currentDateTime().addDays(-30).toMSecsSinceEpoch();
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int b = 0; b < batches; ++b) {
+            ForecastSeries series;
+            for (int i = 0; i < batchSize; ++i) {
+                WeatherSample sample;
+                sample.timestampMs = baseMs + static_cast<qint64>(b * batchSize + i) * 60 * 1000;
+                sample.temperature = 60.0 + (i % 20);
+                series.append(sample);
+            }
+            QString errorText;
+            db.transaction();
+            HistoricalDataManager::insertSeries(db, 30.6272, -96.3344, series, "benchmark", errorText);
+            db.commit();
+        }
+        const qint64 insertMs = qMax<qint64>(1, timer.elapsed());
+        result.insertsPerSecond = batches * batchSize * 1000.0 / insertMs;
+
+        // Same shape as HistoricalDataManager::getHistoricalData
+        QSqlQuery query(db);
+        query.prepare(R"(
+            SELECT ts, temperature FROM historical_weather
+            WHERE lat_udeg = ? AND lon_udeg = ?
+              AND ts >= ? AND ts <= ? AND source = ?
+            ORDER BY ts ASC
+        )");
+        const qint64 start = (baseMs + 24LL * 3600 * 1000) / 1000;
+        const qint64 end = (baseMs + 48LL * 3600 * 1000) / 1000;
+        const int iterations = 50;
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            query.bindValue(0, DatabaseManager::toMicroDegrees(30.6272));
+            query.bindValue(1, DatabaseManager::toMicroDegrees(-96.3344));
+            query.bindValue(2, start);
+            query.bindValue(3, end);
+            query.bindValue(4, QString("benchmark"));
+            query.exec();
+            result.rowsRead = 0;
+            while (query.next()) {
+                ++result.rowsRead;
+            }
+        }
+        result.rangeQueryMs = static_cast<double>(timer.nsecsElapsed()) / 1e6 / iterations;
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    qInfo() << "SQLite profile" << name << ":" << qRound(result.insertsPerSecond) << "inserts/sec,"
+            << result.rangeQueryMs << "ms per range query";
+    return result;
+}
+} // namespace
+
+TEST(SqliteTuningTest, InsertAndRangeQueryBenchmark) {
+    BenchmarkResult defaults = runProfile("defaults", DatabaseManager::TuningProfile::sqliteDefaults());
+    BenchmarkResult tuned = runProfile("performance", DatabaseManager::TuningProfile::performance());
+
+    // One day of minute samples falls inside the queried window
+    EXPECT_EQ(defaults.rowsRead, 24 * 60 + 1);
+    EXPECT_EQ(tuned.rowsRead, defaults.rowsRead);
+    EXPECT_GT(defaults.insertsPerSecond, 0.0);
+    EXPECT_GT(tuned.insertsPerSecond, 0.0);
+}
+
+TEST(SqliteTuningTest, PerformanceProfileEnablesWal) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tuning_wal_check");
+        db.setDatabaseName(dir.filePath("wal.db"));
+        ASSERT_TRUE(db.open());
+        EXPECT_TRUE(DatabaseManager::applyTuning(db, DatabaseManager::TuningProfile::performance()));
+
+        QSqlQuery query(db);
+        ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ(query.value(0).toString().toLower(), QString("wal"));
+
+        ASSERT_TRUE(query.exec("PRAGMA synchronous"));
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ(query.value(0).toInt(), 1); // NORMAL
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("tuning_wal_check");
+}
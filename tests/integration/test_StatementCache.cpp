@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "database/StatementCache.h"
+#include "database/DatabaseManager.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <memory>
+
+class StatementCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+        db = QSqlDatabase::addDatabase("QSQLITE", "statement_cache_test");
+        db.setDatabaseName(dir.filePath("statements.db"));
+        ASSERT_TRUE(db.open());
+        QSqlQuery query(db);
+        ASSERT_TRUE(query.exec("CREATE TABLE samples (id INTEGER PRIMARY KEY, value INTEGER)"));
+        cache.reset(new StatementCache(db, 4));
+    }
+
+    void TearDown() override {
+        cache.reset();
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase("statement_cache_test");
+    }
+
+    bool insert(int value) {
+        PreparedQuery query(db, "INSERT INTO samples (value) VALUES (?)");
+        query->addBindValue(value);
+        return query->exec();
+    }
+
+    QTemporaryDir dir;
+    QSqlDatabase db;
+    std::unique_ptr<StatementCache> cache;
+};
+
+TEST_F(StatementCacheTest, ReusesStatementsBySqlText) {
+    EXPECT_EQ(StatementCache::forConnection(db), cache.get());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(insert(i));
+    }
+
+    PreparedQuery sum(db, "SELECT SUM(value) FROM samples");
+    ASSERT_TRUE(sum->exec() && sum->next());
+    EXPECT_EQ(sum->value(0).toInt(), 45);
+
+    const StatementCache::Stats stats = cache->stats();
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.hits, 9);
+    EXPECT_EQ(stats.cached, 2);
+}
+
+TEST_F(StatementCacheTest, NestedUseOfSameSqlGetsItsOwnStatement) {
+    ASSERT_TRUE(insert(1));
+    ASSERT_TRUE(insert(2));
+
+    const QString sql = "SELECT value FROM samples WHERE value >= ? ORDER BY value";
+    PreparedQuery outer(db, sql);
+    outer->addBindValue(1);
+    ASSERT_TRUE(outer->exec() && outer->next());
+    {
+        PreparedQuery inner(db, sql);
+        inner->addBindValue(2);
+        ASSERT_TRUE(inner->exec() && inner->next());
+        EXPECT_EQ(inner->value(0).toInt(), 2);
+    }
+    EXPECT_EQ(outer->value(0).toInt(), 1);
+    ASSERT_TRUE(outer->next());
+    EXPECT_EQ(outer->value(0).toInt(), 2);
+    EXPECT_EQ(cache->stats().cached, 2);
+}
+
+TEST_F(StatementCacheTest, EvictsLeastRecentlyUsed) {
+    for (int i = 0; i < 6; ++i) {
+        PreparedQuery query(db, QString("SELECT %1").arg(i));
+        ASSERT_TRUE(query->exec());
+    }
+    StatementCache::Stats stats = cache->stats();
+    EXPECT_EQ(stats.cached, 4);
+    EXPECT_EQ(stats.evictions, 2);
+
+    // "SELECT 0" was evicted, "SELECT 5" was not
+    { PreparedQuery query(db, "SELECT 5"); }
+    { PreparedQuery query(db, "SELECT 0"); }
+    stats = cache->stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 7);
+}
+
+TEST_F(StatementCacheTest, FailedPrepareIsNotCached) {
+    PreparedQuery query(db, "SELECT * FROM no_such_table");
+    EXPECT_FALSE(query->exec());
+    EXPECT_TRUE(query->lastError().isValid());
+    EXPECT_EQ(cache->stats().cached, 0);
+}
+
+TEST_F(StatementCacheTest, ConnectionsWithoutCacheStillWork) {
+    cache.reset();
+    EXPECT_EQ(StatementCache::forConnection(db), nullptr);
+    ASSERT_TRUE(insert(3));
+
+    PreparedQuery query(db, "SELECT COUNT(*) FROM samples");
+    ASSERT_TRUE(query->exec() && query->next());
+    EXPECT_EQ(query->value(0).toInt(), 1);
+}
+
+TEST(DatabaseManagerStatementsTest, PreferenceReadsHitTheCache) {
+    DatabaseManager* manager = DatabaseManager::instance();
+    ASSERT_TRUE(manager->initialize());
+    ASSERT_TRUE(manager->setPreference("statement_test", "1"));
+    manager->getPreference("statement_test");
+
+    const StatementCache::Stats before = manager->statementCacheStats();
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(manager->getPreference("statement_test"), QString("1"));
+    }
+    const StatementCache::Stats after = manager->statementCacheStats();
+    EXPECT_EQ(after.hits - before.hits, 20);
+    EXPECT_EQ(after.misses, before.misses);
+}
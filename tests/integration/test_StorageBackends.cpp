@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include "database/DatabaseManager.h"
+#include "services/SqliteHistoricalStore.h"
+#include "services/MappedHistoricalStore.h"
+#include "models/ForecastSeries.h"
+#include <QSqlDatabase>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QDebug>
+#include <memory>
+
+class StorageBackendsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", ConnectionName);
+            db.setDatabaseName(dir.filePath("history.db"));
+            ASSERT_TRUE(db.open());
+            ASSERT_TRUE(DatabaseManager::createTables(db));
+            sqlite = std::make_unique<SqliteHistoricalStore>(db);
+        }
+
+        mapped = std::make_unique<MappedHistoricalStore>(dir.filePath("segments"));
+        QString errorText;
+        ASSERT_TRUE(mapped->open(errorText)) << errorText.toStdString();
+    }
+
+    void TearDown() override {
+        sqlite.reset();
+        QSqlDatabase::database(ConnectionName, false).close();
+        QSqlDatabase::removeDatabase(ConnectionName);
+    }
+
+    // Samples every stepMinutes from dayStart + firstMinute; every field varies
+    ForecastSeries samples(int firstMinute, int stepMinutes, int count, double temperature) const {
+        static const QStringList conditions = {"Clear", "Clouds", "Rain"};
+        ForecastSeries series;
+        for (int i = 0; i < count; ++i) {
+            WeatherSample sample;
+            sample.timestampMs = (dayStart + static_cast<qint64>(firstMinute + i * stepMinutes) * 60) * 1000;
+            sample.temperature = temperature + i * 0.25;
+            sample.feelsLike = temperature - 2.5 + i * 0.25;
+            sample.humidity = 30 + i % 60;
+            sample.pressure = 1013.25 - i * 0.1;
+            sample.windSpeed = 3.5 + i % 7;
+            sample.windDirection = (i * 15) % 360;
+            sample.precipProbability = (i % 10) / 10.0;
+            sample.precipIntensity = (i % 4) * 0.05;
+            sample.cloudCover = (i * 7) % 101;
+            sample.visibility = 10000 - i;
+            sample.uvIndex = i % 11;
+            sample.conditionId = series.internString(conditions.at(i % conditions.size()));
+            sample.descriptionId = series.internString(QString("Sample %1").arg(i % 5));
+            series.append(sample);
+        }
+        return series;
+    }
+
+    // Same batches, in the same order, into both backends; time spent in each is summed
+    void insertBoth(qint64 lat, qint64 lon, const ForecastSeries& series, const QString& source) {
+        QString errorText;
+        QElapsedTimer timer;
+        timer.start();
+        ASSERT_TRUE(sqlite->insertSeries(lat, lon, series, source, errorText)) << errorText.toStdString();
+        sqliteInsertNs += timer.nsecsElapsed();
+        timer.restart();
+        ASSERT_TRUE(mapped->insertSeries(lat, lon, series, source, errorText)) << errorText.toStdString();
+        mappedInsertNs += timer.nsecsElapsed();
+    }
+
+    static ForecastSeries read(HistoricalStore& store, qint64 lat, qint64 lon,
+                               qint64 fromSecs, qint64 toSecs, const QString& source) {
+        ForecastSeries series;
+        QString errorText;
+        EXPECT_TRUE(store.readSeries(lat, lon, fromSecs, toSecs, source, series, errorText))
+            << store.storeName().toStdString() << ": " << errorText.toStdString();
+        return series;
+    }
+
+    // Small batches so the scan crosses batch and day boundaries many times
+    static ForecastSeries scan(HistoricalStore& store, qint64 lat, qint64 lon,
+                               qint64 fromSecs, qint64 toSecs, const QString& source) {
+        ForecastSeries series;
+        SeriesBatcher batcher(7, [&series](const ForecastSeries& batch) {
+            for (int i = 0; i < batch.size(); ++i) {
+                series.append(batch.at(i), batch);
+            }
+            return true;
+        });
+        QString errorText;
+        EXPECT_TRUE(store.scanSeries(lat, lon, fromSecs, toSecs, source, batcher, errorText))
+            << store.storeName().toStdString() << ": " << errorText.toStdString();
+        batcher.flush();
+        return series;
+    }
+
+    static void expectSameSamples(const ForecastSeries& actual, const ForecastSeries& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (int i = 0; i < actual.size(); ++i) {
+            SCOPED_TRACE(i);
+            const WeatherSample a = actual.at(i);
+            const WeatherSample e = expected.at(i);
+            EXPECT_EQ(a.timestampMs, e.timestampMs);
+            EXPECT_DOUBLE_EQ(a.latitude, e.latitude);
+            EXPECT_DOUBLE_EQ(a.longitude, e.longitude);
+            EXPECT_DOUBLE_EQ(a.temperature, e.temperature);
+            EXPECT_DOUBLE_EQ(a.feelsLike, e.feelsLike);
+            EXPECT_EQ(a.humidity, e.humidity);
+            EXPECT_DOUBLE_EQ(a.pressure, e.pressure);
+            EXPECT_DOUBLE_EQ(a.windSpeed, e.windSpeed);
+            EXPECT_EQ(a.windDirection, e.windDirection);
+            EXPECT_DOUBLE_EQ(a.precipProbability, e.precipProbability);
+            EXPECT_DOUBLE_EQ(a.precipIntensity, e.precipIntensity);
+            EXPECT_EQ(a.cloudCover, e.cloudCover);
+            EXPECT_EQ(a.visibility, e.visibility);
+            EXPECT_EQ(a.uvIndex, e.uvIndex);
+            EXPECT_EQ(actual.conditionAt(i), expected.conditionAt(i));
+            EXPECT_EQ(actual.descriptionAt(i), expected.descriptionAt(i));
+        }
+    }
+
+    static constexpr const char* ConnectionName = "storage_backends";
+
+    QTemporaryDir dir;
+    std::unique_ptr<SqliteHistoricalStore> sqlite;
+    std::unique_ptr<MappedHistoricalStore> mapped;
+    qint64 sqliteInsertNs = 0;
+    qint64 mappedInsertNs = 0;
+    const qint64 lat = DatabaseManager::toMicroDegrees(30.6272);
+    const qint64 lon = DatabaseManager::toMicroDegrees(-96.3344);
+    const qint64 dayStart = QDateTime(QDate(2024, 6, 1), QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+};
+
+TEST_F(StorageBackendsTest, BackendsReturnIdenticalSamples) {
+    // Hourly NWS samples over three days, rewritten in part by later batches
+    insertBoth(lat, lon, samples(0, 60, 72, 60.0), "nws");
+    insertBoth(lat, lon, samples(20 * 60, 60, 10, 85.0), "nws");
+    insertBoth(lat, lon, samples(47 * 60, 60, 3, 40.0), "nws");
+
+    // Quarter-hourly Pirate samples from mid-morning of the first day, sharing
+    // the NWS hours and overlapping each other across midnight
+    insertBoth(lat, lon, samples(10 * 60, 15, 96, 70.0), "pirate");
+    insertBoth(lat, lon, samples(22 * 60, 15, 16, 50.0), "pirate");
+
+    // A neighbouring location must not leak into either backend's reads
+    insertBoth(lat, lon + 100, samples(0, 60, 48, 99.0), "nws");
+
+    struct Range {
+        qint64 fromSecs;
+        qint64 toSecs;
+    };
+    const Range ranges[] = {
+        {dayStart, dayStart + 3 * 24 * 3600},                   // Everything
+        {dayStart + 19 * 3600, dayStart + 26 * 3600 + 1800},    // Across midnight, mid-hour end
+        {dayStart + 47 * 3600, dayStart + 47 * 3600},           // One instant
+        {dayStart - 24 * 3600, dayStart - 1},                   // Before any data
+    };
+    const QString sources[] = {"nws", "pirate", QString()};
+
+    for (const Range& range : ranges) {
+        for (const QString& source : sources) {
+            SCOPED_TRACE(QString("%1..%2 source '%3'").arg(range.fromSecs).arg(range.toSecs).arg(source).toStdString());
+
+            const ForecastSeries sqliteRead = read(*sqlite, lat, lon, range.fromSecs, range.toSecs, source);
+            const ForecastSeries mappedRead = read(*mapped, lat, lon, range.fromSecs, range.toSecs, source);
+            EXPECT_TRUE(sqliteRead.isSortedByTime());
+            expectSameSamples(mappedRead, sqliteRead);
+
+            // Streaming returns exactly what a read returns
+            expectSameSamples(scan(*sqlite, lat, lon, range.fromSecs, range.toSecs, source), sqliteRead);
+            expectSameSamples(scan(*mapped, lat, lon, range.fromSecs, range.toSecs, source), sqliteRead);
+        }
+    }
+
+    // Sanity-check the shared result so two equally wrong backends still fail
+    const ForecastSeries nws = read(*sqlite, lat, lon, dayStart, dayStart + 3 * 24 * 3600, "nws");
+    ASSERT_EQ(nws.size(), 72);
+    EXPECT_DOUBLE_EQ(nws.temperatures().at(19), 64.75);
+    EXPECT_DOUBLE_EQ(nws.temperatures().at(20), 85.0);
+    EXPECT_DOUBLE_EQ(nws.temperatures().at(48), 40.25);
+
+    const ForecastSeries pirate = read(*sqlite, lat, lon, dayStart, dayStart + 3 * 24 * 3600, "pirate");
+    ASSERT_EQ(pirate.size(), 96);
+    EXPECT_DOUBLE_EQ(pirate.temperatures().at(48), 50.0);
+
+    const ForecastSeries all = read(*sqlite, lat, lon, dayStart, dayStart + 3 * 24 * 3600, QString());
+    EXPECT_EQ(all.size(), 72 + 96);
+}
+
+TEST_F(StorageBackendsTest, IngestAndRangeScanBenchmark) {
+    // Forecast-sized batches of minute samples, two days per source
+    const int batches = 60;
+    const int batchSize = 48;
+    for (int b = 0; b < batches; ++b) {
+        insertBoth(lat, lon, samples(b * batchSize, 1, batchSize, 60.0), "nws");
+        insertBoth(lat, lon, samples(b * batchSize, 1, batchSize, 70.0), "pirate");
+    }
+    const double insertedSamples = 2.0 * batches * batchSize;
+
+    // One day from the middle of the data: a single-source read, an all-source scan
+    const qint64 fromSecs = dayStart + 12 * 3600;
+    const qint64 toSecs = dayStart + 36 * 3600;
+    const int iterations = 20;
+    auto measure = [&](HistoricalStore& store, qint64 insertNs, int& readRows, int& scanRows) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            readRows = read(store, lat, lon, fromSecs, toSecs, "nws").size();
+        }
+        const double readMs = static_cast<double>(timer.nsecsElapsed()) / 1e6 / iterations;
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            scanRows = scan(store, lat, lon, fromSecs, toSecs, QString()).size();
+        }
+        const double scanMs = static_cast<double>(timer.nsecsElapsed()) / 1e6 / iterations;
+
+        qInfo() << "Historical backend" << store.storeName() << ":"
+                << qRound(insertedSamples * 1e9 / qMax<qint64>(1, insertNs)) << "inserts/sec,"
+                << readMs << "ms per range read," << scanMs << "ms per all-source scan";
+    };
+
+    int sqliteReadRows = 0;
+    int sqliteScanRows = 0;
+    int mappedReadRows = 0;
+    int mappedScanRows = 0;
+    measure(*sqlite, sqliteInsertNs, sqliteReadRows, sqliteScanRows);
+    measure(*mapped, mappedInsertNs, mappedReadRows, mappedScanRows);
+
+    EXPECT_EQ(mappedReadRows, sqliteReadRows);
+    EXPECT_EQ(mappedScanRows, sqliteScanRows);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "models/ArchiveCodec.h"
+#include "models/ForecastCodec.h"
+#include "models/ForecastSeries.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+} // namespace
+
+class ArchiveCodecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const char* sources[] = {"nws", "pirate", "merged", "nws"};
+        const char* conditions[] = {"Clear", "Cloudy", "Rain"};
+        const char* descriptions[] = {"Clear skies", "Overcast", "Light rain"};
+
+        // A week of hourly samples at four location/source pairs, with the
+        // precision real providers report
+        for (int s = 0; s < 4; ++s) {
+            ArchiveCodec::Series entry;
+            entry.latMicroDegrees = 30627200 + s * 10000;
+            entry.lonMicroDegrees = -96334400 - s * 10000;
+            entry.source = sources[s];
+            for (int i = 0; i < 168; ++i) {
+                WeatherSample sample;
+                sample.timestampMs = 1700000000000 + static_cast<qint64>(i) * 3600 * 1000;
+                sample.latitude = entry.latMicroDegrees / 1000000.0;
+                sample.longitude = entry.lonMicroDegrees / 1000000.0;
+                sample.temperature = std::round((60.0 + 12.0 * std::sin(i / 4.0) + s) * 10.0) / 10.0;
+                sample.feelsLike = std::round((sample.temperature - 2.0) * 10.0) / 10.0;
+                sample.humidity = 50 + (i / 6) % 20;
+                sample.pressure = 1013.0 + ((i / 12) % 5) * 0.25;
+                sample.windSpeed = ((i / 3) % 8) * 0.5;
+                sample.windDirection = (i / 8 * 10) % 360;
+                sample.precipProbability = ((i / 6) % 5) / 10.0;
+                sample.precipIntensity = i % 24 < 3 ? 0.02 : 0.0;
+                sample.cloudCover = 25 * ((i / 24) % 4);
+                sample.visibility = 10;
+                sample.uvIndex = i % 24 >= 10 && i % 24 < 16 ? 5 : 0;
+                sample.conditionId = entry.samples.internString(conditions[(i / 6) % 3]);
+                sample.descriptionId = entry.samples.internString(descriptions[(i / 6) % 3]);
+                entry.samples.append(sample);
+            }
+            series.append(entry);
+        }
+    }
+
+    QList<ArchiveCodec::Series> series;
+};
+
+TEST_F(ArchiveCodecTest, RoundTrip) {
+    QList<ArchiveCodec::Series> decoded;
+    ASSERT_TRUE(ArchiveCodec::decode(ArchiveCodec::encode(series), decoded));
+    ASSERT_EQ(decoded.size(), series.size());
+
+    for (int s = 0; s < series.size(); ++s) {
+        const ArchiveCodec::Series& expected = series[s];
+        const ArchiveCodec::Series& actual = decoded[s];
+        EXPECT_EQ(actual.latMicroDegrees, expected.latMicroDegrees);
+        EXPECT_EQ(actual.lonMicroDegrees, expected.lonMicroDegrees);
+        EXPECT_EQ(actual.source, expected.source);
+        ASSERT_EQ(actual.samples.size(), expected.samples.size());
+
+        for (int i = 0; i < expected.samples.size(); ++i) {
+            WeatherSample e = expected.samples.at(i);
+            WeatherSample a = actual.samples.at(i);
+            EXPECT_EQ(a.timestampMs, e.timestampMs);
+            EXPECT_DOUBLE_EQ(a.latitude, e.latitude);
+            EXPECT_DOUBLE_EQ(a.longitude, e.longitude);
+            EXPECT_TRUE(sameBits(a.temperature, e.temperature));
+            EXPECT_TRUE(sameBits(a.feelsLike, e.feelsLike));
+            EXPECT_TRUE(sameBits(a.pressure, e.pressure));
+            EXPECT_TRUE(sameBits(a.windSpeed, e.windSpeed));
+            EXPECT_TRUE(sameBits(a.precipProbability, e.precipProbability));
+            EXPECT_TRUE(sameBits(a.precipIntensity, e.precipIntensity));
+            EXPECT_EQ(a.humidity, e.humidity);
+            EXPECT_EQ(a.windDirection, e.windDirection);
+            EXPECT_EQ(a.cloudCover, e.cloudCover);
+            EXPECT_EQ(a.visibility, e.visibility);
+            EXPECT_EQ(a.uvIndex, e.uvIndex);
+            EXPECT_EQ(actual.samples.conditionAt(i), expected.samples.conditionAt(i));
+            EXPECT_EQ(actual.samples.descriptionAt(i), expected.samples.descriptionAt(i));
+        }
+    }
+}
+
+TEST_F(ArchiveCodecTest, ArbitraryDoublesAndMissingStrings) {
+    const double values[] = {
+        0.1 + 0.2, -0.0, 1e300, -1e-300, std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity(), 72.123456789, 72.123456789, 72.12345679
+    };
+
+    ArchiveCodec::Series entry;
+    entry.source = "xor_test";
+    for (int i = 0; i < 9; ++i) {
+        WeatherSample sample;
+        sample.timestampMs = 1700000000000 + i * 1000 + (i % 3) * 7;   // Irregular spacing
+        sample.temperature = values[i];
+        sample.pressure = values[8 - i];
+        sample.humidity = i % 2 == 0 ? -5 : 2000000000;
+        entry.samples.append(sample);  // No condition or description
+    }
+
+    QList<ArchiveCodec::Series> decoded;
+    ASSERT_TRUE(ArchiveCodec::decode(ArchiveCodec::encode({entry}), decoded));
+    ASSERT_EQ(decoded.size(), 1);
+    ASSERT_EQ(decoded[0].samples.size(), 9);
+    for (int i = 0; i < 9; ++i) {
+        WeatherSample sample = decoded[0].samples.at(i);
+        EXPECT_EQ(sample.timestampMs, entry.samples.timestampAt(i));
+        EXPECT_TRUE(sameBits(sample.temperature, values[i]));
+        EXPECT_TRUE(sameBits(sample.pressure, values[8 - i]));
+        EXPECT_EQ(sample.humidity, entry.samples.humidities().at(i));
+        EXPECT_EQ(sample.conditionId, WeatherSample::NoString);
+        EXPECT_EQ(sample.descriptionId, WeatherSample::NoString);
+    }
+}
+
+TEST_F(ArchiveCodecTest, ReaderWalksBlocks) {
+    ArchiveReader reader;
+    ASSERT_TRUE(reader.open(ArchiveCodec::encode(series)));
+    EXPECT_EQ(reader.seriesCount(), 4);
+    EXPECT_EQ(reader.sampleCount(), 4 * 168);
+
+    // Skip to the third series without decoding the first two
+    ASSERT_TRUE(reader.next());
+    ASSERT_TRUE(reader.next());
+    ASSERT_TRUE(reader.next());
+    EXPECT_EQ(reader.source(), QString("merged"));
+    EXPECT_EQ(reader.latMicroDegrees(), series[2].latMicroDegrees);
+    EXPECT_EQ(reader.size(), 168);
+
+    ForecastSeries samples;
+    ASSERT_TRUE(reader.samples(samples));
+    EXPECT_DOUBLE_EQ(samples.temperatures().at(40), series[2].samples.temperatures().at(40));
+    EXPECT_EQ(samples.conditionAt(40), series[2].samples.conditionAt(40));
+
+    ASSERT_TRUE(reader.next());
+    EXPECT_FALSE(reader.next());
+}
+
+TEST_F(ArchiveCodecTest, EmptyArchive) {
+    QList<ArchiveCodec::Series> decoded;
+    ASSERT_TRUE(ArchiveCodec::decode(ArchiveCodec::encode({}), decoded));
+    EXPECT_TRUE(decoded.isEmpty());
+}
+
+TEST_F(ArchiveCodecTest, RejectsMalformedBuffers) {
+    QByteArray encoded = ArchiveCodec::encode(series);
+    ArchiveReader reader;
+
+    EXPECT_FALSE(reader.open(QByteArray()));
+    EXPECT_FALSE(reader.open(QByteArray("{\"forecasts\": []}")));
+    EXPECT_FALSE(reader.open(encoded.left(encoded.size() / 2)));
+    EXPECT_FALSE(reader.isValid());
+
+    QByteArray wrongVersion = encoded;
+    wrongVersion[4] = static_cast<char>(ArchiveCodec::FormatVersion + 1);
+    EXPECT_FALSE(reader.open(wrongVersion));
+
+    QList<ArchiveCodec::Series> decoded;
+    EXPECT_FALSE(ArchiveCodec::decode(encoded.left(20), decoded));
+    EXPECT_TRUE(decoded.isEmpty());
+}
+
+TEST_F(ArchiveCodecTest, MuchSmallerThanRowFormat) {
+    qint64 rowBytes = 0;
+    for (const ArchiveCodec::Series& entry : series) {
+        rowBytes += ForecastCodec::encode(entry.samples).size();
+    }
+    const qint64 archiveBytes = ArchiveCodec::encode(series).size();
+    EXPECT_GE(rowBytes, archiveBytes * 10);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "models/ForecastCodec.h"
+#include "models/ForecastSeries.h"
+
+class ForecastCodecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 48; ++i) {
+            WeatherSample sample;
+            sample.timestampMs = 1700000000000 + static_cast<qint64>(i) * 3600 * 1000;
+            sample.latitude = 30.6272;
+            sample.longitude = -96.3344;
+            sample.temperature = 60.0 + i * 0.5;
+            sample.feelsLike = 59.0 + i * 0.5;
+            sample.humidity = 40 + i % 50;
+            sample.pressure = 1013.25;
+            sample.windSpeed = 5.5;
+            sample.windDirection = (i * 15) % 360;
+            sample.precipProbability = (i % 10) / 10.0;
+            sample.precipIntensity = 0.02 * (i % 4);
+            sample.cloudCover = i % 100;
+            sample.visibility = 10;
+            sample.uvIndex = i % 11;
+            sample.conditionId = series.internString(i % 2 == 0 ? "Clear" : "Rain");
+            sample.descriptionId = series.internString(i % 2 == 0 ? "Clear skies" : "Light rain");
+            series.append(sample);
+        }
+    }
+
+    ForecastSeries series;
+};
+
+TEST_F(ForecastCodecTest, RoundTrip) {
+    QByteArray encoded = ForecastCodec::encode(series);
+
+    ForecastSeries decoded;
+    ASSERT_TRUE(ForecastCodec::decode(encoded, decoded));
+    ASSERT_EQ(decoded.size(), series.size());
+    EXPECT_EQ(decoded.strings().size(), 4);
+
+    for (int i = 0; i < series.size(); ++i) {
+        WeatherSample expected = series.at(i);
+        WeatherSample actual = decoded.at(i);
+        EXPECT_EQ(actual.timestampMs, expected.timestampMs);
+        EXPECT_DOUBLE_EQ(actual.latitude, expected.latitude);
+        EXPECT_DOUBLE_EQ(actual.temperature, expected.temperature);
+        EXPECT_DOUBLE_EQ(actual.precipProbability, expected.precipProbability);
+        EXPECT_EQ(actual.humidity, expected.humidity);
+        EXPECT_EQ(actual.windDirection, expected.windDirection);
+        EXPECT_EQ(actual.uvIndex, expected.uvIndex);
+        EXPECT_EQ(decoded.conditionAt(i), series.conditionAt(i));
+        EXPECT_EQ(decoded.descriptionAt(i), series.descriptionAt(i));
+    }
+}
+
+TEST_F(ForecastCodecTest, ViewReadsFieldsInPlace) {
+    QByteArray encoded = ForecastCodec::encode(series);
+
+    ForecastView view;
+    ASSERT_TRUE(view.open(encoded));
+    ASSERT_EQ(view.size(), series.size());
+    EXPECT_EQ(view.stringCount(), 4);
+    EXPECT_EQ(view.timestampAt(10), series.timestampAt(10));
+    EXPECT_DOUBLE_EQ(view.temperatureAt(10), series.temperatures().at(10));
+    EXPECT_DOUBLE_EQ(view.precipProbabilityAt(7), series.precipProbabilities().at(7));
+    EXPECT_EQ(view.conditionAt(3), QString("Rain"));
+    EXPECT_EQ(view.descriptionAt(4), QString("Clear skies"));
+}
+
+TEST_F(ForecastCodecTest, EmptySeries) {
+    ForecastSeries empty;
+    ForecastView view;
+    ASSERT_TRUE(view.open(ForecastCodec::encode(empty)));
+    EXPECT_EQ(view.size(), 0);
+    EXPECT_TRUE(view.toSeries().isEmpty());
+}
+
+TEST_F(ForecastCodecTest, RejectsMalformedBuffers) {
+    QByteArray encoded = ForecastCodec::encode(series);
+    ForecastView view;
+
+    EXPECT_FALSE(view.open(QByteArray()));
+    EXPECT_FALSE(view.open(QByteArray("{\"forecasts\": []}")));
+    EXPECT_FALSE(view.open(encoded.left(encoded.size() / 2)));
+
+    QByteArray wrongVersion = encoded;
+    wrongVersion[4] = static_cast<char>(ForecastCodec::FormatVersion + 1);
+    EXPECT_FALSE(view.open(wrongVersion));
+    EXPECT_FALSE(view.isValid());
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "models/ForecastSeries.h"
+#include "models/WeatherData.h"
+#include <QDateTime>
+#include <type_traits>
+
+class ForecastSeriesTest : public ::testing::Test {
+protected:
+    WeatherSample makeSample(qint64 timestampMs, double temperature) {
+        WeatherSample sample;
+        sample.timestampMs = timestampMs;
+        sample.latitude = 30.6272;
+        sample.longitude = -96.3344;
+        sample.temperature = temperature;
+        sample.humidity = 60;
+        return sample;
+    }
+};
+
+TEST_F(ForecastSeriesTest, SampleIsTriviallyCopyable) {
+    EXPECT_TRUE(std::is_trivially_copyable<WeatherSample>::value);
+    WeatherSample sample;
+    EXPECT_FALSE(sample.hasValidTime());
+    EXPECT_EQ(sample.conditionId, WeatherSample::NoString);
+}
+
+TEST_F(ForecastSeriesTest, WeatherDataRoundTrip) {
+    WeatherData source;
+    source.setLatitude(30.6272);
+    source.setLongitude(-96.3344);
+    source.setTimestamp(QDateTime::fromMSecsSinceEpoch(1700000000000));
+    source.setTemperature(75.5);
+    source.setFeelsLike(77.0);
+    source.setHumidity(60);
+    source.setPressure(1013.2);
+    source.setWindSpeed(8.5);
+    source.setWindDirection(270);
+    source.setPrecipProbability(0.3);
+    source.setPrecipIntensity(0.1);
+    source.setCloudCover(40);
+    source.setVisibility(10);
+    source.setUvIndex(5);
+    source.setWeatherCondition("Cloudy");
+    source.setWeatherDescription("Partly cloudy");
+
+    ForecastSeries series = ForecastSeries::fromWeatherData({&source, nullptr});
+    ASSERT_EQ(series.size(), 1);
+
+    WeatherData* copy = series.toWeatherData(0);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->timestamp(), source.timestamp());
+    EXPECT_DOUBLE_EQ(copy->latitude(), source.latitude());
+    EXPECT_DOUBLE_EQ(copy->longitude(), source.longitude());
+    EXPECT_DOUBLE_EQ(copy->temperature(), source.temperature());
+    EXPECT_DOUBLE_EQ(copy->feelsLike(), source.feelsLike());
+    EXPECT_EQ(copy->humidity(), source.humidity());
+    EXPECT_DOUBLE_EQ(copy->pressure(), source.pressure());
+    EXPECT_DOUBLE_EQ(copy->windSpeed(), source.windSpeed());
+    EXPECT_EQ(copy->windDirection(), source.windDirection());
+    EXPECT_DOUBLE_EQ(copy->precipProbability(), source.precipProbability());
+    EXPECT_DOUBLE_EQ(copy->precipIntensity(), source.precipIntensity());
+    EXPECT_EQ(copy->cloudCover(), source.cloudCover());
+    EXPECT_EQ(copy->visibility(), source.visibility());
+    EXPECT_EQ(copy->uvIndex(), source.uvIndex());
+    EXPECT_EQ(copy->weatherCondition(), QString("Cloudy"));
+    EXPECT_EQ(copy->weatherDescription(), QString("Partly cloudy"));
+    delete copy;
+}
+
+TEST_F(ForecastSeriesTest, InvalidTimestampRoundTrip) {
+    EXPECT_EQ(ForecastSeries::toEpochMs(QDateTime()), WeatherSample::InvalidTime);
+    EXPECT_FALSE(ForecastSeries::toDateTime(WeatherSample::InvalidTime).isValid());
+}
+
+TEST_F(ForecastSeriesTest, SortByTimeIsStableAndSearchable) {
+    ForecastSeries series;
+    series.append(makeSample(3000, 3.0));
+    series.append(makeSample(1000, 1.0));
+    series.append(makeSample(2000, 2.0));
+    series.append(makeSample(1000, 1.5));
+
+    EXPECT_FALSE(series.isSortedByTime());
+    series.sortByTime();
+    ASSERT_TRUE(series.isSortedByTime());
+
+    EXPECT_DOUBLE_EQ(series.temperatures().at(0), 1.0);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(1), 1.5);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(2), 2.0);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(3), 3.0);
+
+    EXPECT_EQ(series.lowerBound(1500), 2);
+    EXPECT_EQ(series.lowerBound(5000), 4);
+    EXPECT_EQ(series.indexOfTime(1000), 0);
+    EXPECT_EQ(series.indexOfTime(2500), -1);
+}
+
+TEST_F(ForecastSeriesTest, StringTableIsDeduplicatedAndRemapped) {
+    ForecastSeries first;
+    WeatherSample sample = makeSample(1000, 70.0);
+    sample.conditionId = first.internString("Rain");
+    first.append(sample);
+    sample.conditionId = first.internString("Rain");
+    first.append(sample);
+    EXPECT_EQ(first.strings().size(), 1);
+
+    ForecastSeries second;
+    second.internString("Clear");
+    second.append(first.at(0), first);
+    EXPECT_EQ(second.conditionAt(0), QString("Rain"));
+    EXPECT_EQ(second.strings().size(), 2);
+
+    ForecastSeries shared = first.emptyCopy();
+    shared.append(first.at(1));
+    EXPECT_EQ(shared.conditionAt(0), QString("Rain"));
+    EXPECT_EQ(shared.descriptionAt(0), QString());
+}
@@ -4,6 +4,10 @@
 #include <QTimer>
 #include <QThread>
 #include <QVariant>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <memory>
+#include <vector>
 
 class CacheManagerTest : public ::testing::Test {
 protected:
@@ -85,6 +89,53 @@ TEST_F(CacheManagerTest, LRUEviction) {
     EXPECT_LE(cache->size(), 10);
 }
 
+TEST_F(CacheManagerTest, LRUEvictsLeastRecentlyAccessed) {
+    for (int i = 0; i < 10; ++i) {
+        cache->put(QString("key_%1").arg(i), QVariant(i), 3600);
+    }
+    
+    // Touch key_0 so key_1 becomes the least recently used entry
+    EXPECT_TRUE(cache->get("key_0").isValid());
+    
+    cache->put("key_10", QVariant(10), 3600);
+    
+    EXPECT_EQ(cache->size(), 10);
+    EXPECT_TRUE(cache->contains("key_0"));
+    EXPECT_FALSE(cache->contains("key_1"));
+    EXPECT_TRUE(cache->contains("key_10"));
+}
+
+TEST_F(CacheManagerTest, PutExistingKeyRefreshesValue) {
+    cache->put("key", QVariant(1), 3600);
+    cache->put("key", QVariant(2), 3600);
+    
+    EXPECT_EQ(cache->size(), 1);
+    EXPECT_EQ(cache->get("key").toInt(), 2);
+}
+
+TEST_F(CacheManagerTest, StaleEntryServedUntilHardExpiry) {
+    cache->put("stale", QString("old"), 0, 3600); // Stale at once, kept for an hour
+    cache->put("fresh", QString("new"), 3600, 7200);
+    
+    // Plain lookups treat stale entries as misses without dropping them
+    EXPECT_FALSE(cache->get("stale").isValid());
+    EXPECT_FALSE(cache->contains("stale"));
+    EXPECT_EQ(cache->size(), 2);
+    
+    bool isStale = false;
+    QVariant value = cache->getAllowStale("stale", isStale);
+    EXPECT_TRUE(isStale);
+    EXPECT_EQ(value.toString(), "old");
+    
+    value = cache->getAllowStale("fresh", isStale);
+    EXPECT_FALSE(isStale);
+    EXPECT_EQ(value.toString(), "new");
+    
+    // Past the hard TTL the entry is gone even for stale reads
+    cache->put("gone", QString("x"), 0, 0);
+    EXPECT_FALSE(cache->getAllowStale("gone", isStale).isValid());
+}
+
 TEST_F(CacheManagerTest, GenerateKey) {
     QString key = CacheManager::generateKey("forecast", 30.6272, -96.3344);
     
@@ -104,3 +155,86 @@ TEST_F(CacheManagerTest, Clear) {
     EXPECT_EQ(cache->size(), 0);
 }
 
+TEST_F(CacheManagerTest, ShardedModeDistributesKeys) {
+    CacheManager sharded(64, 8);
+    EXPECT_EQ(sharded.shardCount(), 8);
+    EXPECT_EQ(sharded.maxSize(), 64);
+    
+    for (int i = 0; i < 32; ++i) {
+        sharded.put(CacheManager::generateKey("forecast", 30.0 + i * 0.01, -96.0), QVariant(i), 3600);
+    }
+    
+    EXPECT_EQ(sharded.size(), 32);
+    for (int i = 0; i < 32; ++i) {
+        QVariant value = sharded.get(CacheManager::generateKey("forecast", 30.0 + i * 0.01, -96.0));
+        ASSERT_TRUE(value.isValid());
+        EXPECT_EQ(value.toInt(), i);
+    }
+    
+    sharded.clear();
+    EXPECT_EQ(sharded.size(), 0);
+}
+
+TEST_F(CacheManagerTest, ShardedConcurrentThroughput) {
+    const int keyCount = 4096;
+    const int opsPerThread = 50000;
+    const QList<int> threadCounts = {1, 2, 4, 8, 16};
+    
+    QStringList keys;
+    keys.reserve(keyCount);
+    for (int i = 0; i < keyCount; ++i) {
+        keys.append(CacheManager::generateKey("forecast", 25.0 + (i / 64) * 0.01, -100.0 + (i % 64) * 0.01));
+    }
+    
+    qInfo() << "\n=========================================";
+    qInfo() << "CACHE MANAGER THROUGHPUT (90% get / 10% put)";
+    qInfo() << "=========================================";
+    
+    for (int shards : {1, 16}) {
+        for (int threads : threadCounts) {
+            CacheManager sharded(keyCount * 2, shards);
+            for (int i = 0; i < keyCount; ++i) {
+                sharded.put(keys.at(i), QVariant(i), 3600);
+            }
+            
+            QAtomicInteger<int> hits(0);
+            std::vector<std::unique_ptr<QThread>> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back(QThread::create([&sharded, &keys, &hits, t, opsPerThread]() {
+                    int localHits = 0;
+                    quint32 state = 2654435761u * static_cast<quint32>(t + 1);
+                    for (int op = 0; op < opsPerThread; ++op) {
+                        state = state * 1664525u + 1013904223u;
+                        const QString& key = keys.at(static_cast<int>(state % static_cast<quint32>(keys.size())));
+                        if (op % 10 == 0) {
+                            sharded.put(key, QVariant(op), 3600);
+                        } else if (sharded.get(key).isValid()) {
+                            localHits++;
+                        }
+                    }
+                    hits.fetchAndAddRelaxed(localHits);
+                }));
+            }
+            
+            QElapsedTimer timer;
+            timer.start();
+            for (auto& worker : workers) {
+                worker->start();
+            }
+            for (auto& worker : workers) {
+                worker->wait();
+            }
+            const qint64 elapsedMs = qMax<qint64>(1, timer.elapsed());
+            
+            const double totalOps = static_cast<double>(threads) * opsPerThread;
+            qInfo() << "shards:" << shards << "threads:" << threads
+                    << "ops/sec:" << QString::number(totalOps * 1000.0 / elapsedMs, 'f', 0);
+            
+            // Capacity exceeds the key set, so every get must hit
+            EXPECT_EQ(hits.loadRelaxed(), threads * (opsPerThread - opsPerThread / 10));
+            EXPECT_EQ(sharded.size(), keyCount);
+        }
+    }
+    
+    qInfo() << "=========================================\n";
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "services/GridpointIndex.h"
+#include "database/DatabaseManager.h"
+
+TEST(GridpointIndexTest, NearbyPointsShareACell) {
+    const GridpointIndex::Cell cell = GridpointIndex::cellOf(30.6272, -96.3344);
+
+    // Cells are about 0.0225 degrees of latitude tall
+    EXPECT_EQ(GridpointIndex::cellOf(30.6273, -96.3343), cell);
+    EXPECT_NE(GridpointIndex::cellOf(30.6272 + 0.03, -96.3344), cell);
+    EXPECT_NE(GridpointIndex::cellOf(30.6272, -96.3344 + 0.03), cell);
+
+    // Columns are narrowed by latitude, so a 1 km step east never skips a cell
+    const GridpointIndex::Cell east = GridpointIndex::cellOf(30.6272, -96.3344 + 1.0 / (111.32 * 0.86));
+    EXPECT_EQ(east.row, cell.row);
+    EXPECT_LE(east.col - cell.col, 1);
+}
+
+TEST(GridpointIndexTest, LookupAnswersForTheWholeCell) {
+    GridpointIndex index(false);
+    GridpointIndex::Gridpoint gridpoint;
+    gridpoint.office = "HGX";
+    gridpoint.x = 28;
+    gridpoint.y = 134;
+
+    GridpointIndex::Gridpoint found;
+    const GridpointIndex::Cell cell = GridpointIndex::cellOf(-45.51, 120.5);
+    EXPECT_FALSE(index.lookup(-45.51, 120.5, found));
+    index.insert(-45.51, 120.5, gridpoint);
+
+    // Any other point of the same cell resolves without a request
+    const double lat = -45.51 + 0.001;
+    ASSERT_EQ(GridpointIndex::cellOf(lat, 120.5), cell);
+    ASSERT_TRUE(index.lookup(lat, 120.5, found));
+    EXPECT_EQ(found.office, QString("HGX"));
+    EXPECT_EQ(found.x, 28);
+    EXPECT_EQ(found.y, 134);
+    EXPECT_EQ(index.hits(), 1);
+    EXPECT_EQ(index.misses(), 1);
+
+    // Invalid resolutions are not recorded
+    index.insert(10.0, 10.0, GridpointIndex::Gridpoint());
+    EXPECT_EQ(index.size(), 1);
+}
+
+TEST(GridpointIndexTest, ResolutionsPersistAcrossInstances) {
+    ASSERT_TRUE(DatabaseManager::instance()->initialize());
+
+    GridpointIndex::Gridpoint gridpoint;
+    gridpoint.office = "FWD";
+    gridpoint.x = 80;
+    gridpoint.y = 103;
+    {
+        GridpointIndex index;
+        index.insert(32.7767, -96.7970, gridpoint);
+    }
+
+    GridpointIndex restarted;
+    GridpointIndex::Gridpoint found;
+    ASSERT_TRUE(restarted.lookup(32.7768, -96.7971, found));
+    EXPECT_EQ(found.office, QString("FWD"));
+    EXPECT_EQ(found.x, 80);
+    EXPECT_EQ(found.y, 103);
+    EXPECT_EQ(restarted.size(), 1);
+}
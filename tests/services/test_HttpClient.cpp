@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "services/HttpClient.h"
+#include "services/NWSService.h"
+#include "services/PirateWeatherService.h"
+#include <QNetworkReply>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace {
+// Minimal HTTP/1.1 server that answers every request with "{}" and keeps
+// the connection open
+class KeepAliveServer : public QTcpServer
+{
+public:
+    KeepAliveServer() {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = nextPendingConnection()) {
+                ++connections;
+                connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+                    QByteArray pending = socket->property("pending").toByteArray() + socket->readAll();
+                    while (pending.contains("\r\n\r\n")) {
+                        pending.remove(0, pending.indexOf("\r\n\r\n") + 4);
+                        socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                                      "Content-Length: 2\r\nConnection: keep-alive\r\n\r\n{}");
+                    }
+                    socket->setProperty("pending", pending);
+                });
+            }
+        });
+    }
+
+    int connections = 0;
+};
+
+bool waitForReply(QNetworkReply* reply) {
+    QEventLoop loop;
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    return reply->isFinished();
+}
+} // namespace
+
+TEST(HttpClientTest, RequestCarriesOptions) {
+    HttpClient::Options options;
+    options.http2 = false;
+    options.compression = false;
+    options.transferTimeoutMs = 1234;
+    options.userAgent = "Test/1.0";
+    HttpClient client(options);
+
+    const QNetworkRequest request = client.request(QUrl("https://api.weather.gov/points/30,-96"));
+    EXPECT_FALSE(request.attribute(QNetworkRequest::Http2AllowedAttribute).toBool());
+    EXPECT_EQ(request.rawHeader("Accept-Encoding"), QByteArray("identity"));
+    EXPECT_EQ(request.transferTimeout(), 1234);
+    EXPECT_EQ(request.header(QNetworkRequest::UserAgentHeader).toString(), QString("Test/1.0"));
+    EXPECT_EQ(request.attribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute).toInt(), 300);
+
+    // By default Qt negotiates the encoding and decodes the body itself
+    client.setOptions(HttpClient::Options());
+    const QNetworkRequest defaults = client.request(QUrl("https://api.weather.gov/points/30,-96"));
+    EXPECT_TRUE(defaults.attribute(QNetworkRequest::Http2AllowedAttribute).toBool());
+    EXPECT_FALSE(defaults.hasRawHeader("Accept-Encoding"));
+}
+
+TEST(HttpClientTest, SequentialRequestsReuseOneConnection) {
+    KeepAliveServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    HttpClient client;
+    const QUrl url(QString("http://127.0.0.1:%1/forecast").arg(server.serverPort()));
+
+    for (int i = 0; i < 3; ++i) {
+        QNetworkReply* reply = client.get(client.request(url));
+        ASSERT_TRUE(waitForReply(reply));
+        EXPECT_EQ(reply->error(), QNetworkReply::NoError);
+        EXPECT_EQ(reply->readAll(), QByteArray("{}"));
+        reply->deleteLater();
+    }
+
+    const HttpClient::HostStats stats = client.hostStats("127.0.0.1");
+    EXPECT_EQ(server.connections, 1);
+    EXPECT_EQ(stats.requests, 3);
+    EXPECT_EQ(stats.finished, 3);
+    EXPECT_EQ(stats.failures, 0);
+    EXPECT_EQ(stats.newConnections, 1);
+    EXPECT_EQ(stats.reusedConnections(), 2);
+    EXPECT_EQ(stats.bytesReceived, 6);
+    EXPECT_EQ(stats.active, 0);
+}
+
+TEST(HttpClientTest, ServicesShareTheDefaultClient) {
+    NWSService nws;
+    PirateWeatherService pirate;
+    EXPECT_EQ(nws.httpClient(), HttpClient::instance());
+    EXPECT_EQ(pirate.httpClient(), nws.httpClient());
+
+    HttpClient own;
+    pirate.setHttpClient(&own);
+    EXPECT_EQ(pirate.httpClient(), &own);
+    pirate.setHttpClient(nullptr);
+    EXPECT_EQ(pirate.httpClient(), HttpClient::instance());
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "services/MappedHistoricalStore.h"
+#include "models/ForecastSeries.h"
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QDir>
+#include <QFile>
+
+class MappedHistoricalStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+        QString errorText;
+        ASSERT_TRUE(store.open(errorText)) << errorText.toStdString();
+    }
+
+    // Hourly samples from dayStart + firstHour
+    ForecastSeries hourly(int firstHour, int count, double temperature) const {
+        ForecastSeries series;
+        for (int i = 0; i < count; ++i) {
+            WeatherSample sample;
+            sample.timestampMs = (dayStart + static_cast<qint64>(firstHour + i) * 3600) * 1000;
+            sample.temperature = temperature + i;
+            sample.humidity = 40 + i;
+            sample.conditionId = series.internString(i % 2 == 0 ? "Clear" : "Rain");
+            series.append(sample);
+        }
+        return series;
+    }
+
+    QTemporaryDir dir;
+    MappedHistoricalStore store{dir.filePath("segments")};
+    const qint64 lat = 30627200;
+    const qint64 lon = -96334400;
+    const qint64 dayStart = QDateTime(QDate(2024, 5, 1), QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+};
+
+TEST_F(MappedHistoricalStoreTest, RangeReadAcrossDays) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 48, 60.0), "nws", errorText));
+
+    ForecastSeries series;
+    ASSERT_TRUE(store.readSeries(lat, lon, dayStart + 20 * 3600, dayStart + 30 * 3600, "nws", series, errorText));
+    ASSERT_EQ(series.size(), 11);
+    EXPECT_EQ(series.timestampAt(0), (dayStart + 20 * 3600) * 1000);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(0), 80.0);
+    EXPECT_EQ(series.humidities().at(10), 70);
+    EXPECT_EQ(series.conditionAt(1), QString("Rain"));
+    EXPECT_DOUBLE_EQ(series.at(0).latitude, 30.6272);
+
+    // Other locations and sources are separate series
+    ForecastSeries other;
+    ASSERT_TRUE(store.readSeries(lat, lon + 100, dayStart, dayStart + 48 * 3600, "nws", other, errorText));
+    ASSERT_TRUE(store.readSeries(lat, lon, dayStart, dayStart + 48 * 3600, "pirate", other, errorText));
+    EXPECT_TRUE(other.isEmpty());
+}
+
+TEST_F(MappedHistoricalStoreTest, OverlappingBatchesReplaceSamples) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 12, 60.0), "nws", errorText));
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(12, 6, 72.0), "nws", errorText));   // Append
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(6, 4, 90.0), "nws", errorText));    // Rewrite
+
+    ForecastSeries series;
+    ASSERT_TRUE(store.readSeries(lat, lon, dayStart, dayStart + 24 * 3600, "nws", series, errorText));
+    ASSERT_EQ(series.size(), 18);
+    EXPECT_TRUE(series.isSortedByTime());
+    EXPECT_DOUBLE_EQ(series.temperatures().at(5), 65.0);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(6), 90.0);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(10), 70.0);
+    EXPECT_DOUBLE_EQ(series.temperatures().at(17), 77.0);
+}
+
+TEST_F(MappedHistoricalStoreTest, AllSourcesInTimeOrder) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 6, 60.0), "nws", errorText));
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 6, 70.0), "pirate", errorText));
+
+    ForecastSeries series;
+    ASSERT_TRUE(store.readSeries(lat, lon, dayStart, dayStart + 24 * 3600, QString(), series, errorText));
+    ASSERT_EQ(series.size(), 12);
+    EXPECT_TRUE(series.isSortedByTime());
+    EXPECT_EQ(series.conditionAt(11), QString("Rain"));
+}
+
+TEST_F(MappedHistoricalStoreTest, DropBeforeRemovesWholeDays) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 72, 60.0), "nws", errorText));
+
+    // The day holding the cutoff is kept
+    EXPECT_EQ(store.dropBefore(dayStart + 36 * 3600, errorText), 1);
+    EXPECT_EQ(store.dropBefore(dayStart + 36 * 3600, errorText), 0);
+
+    ForecastSeries series;
+    ASSERT_TRUE(store.readSeries(lat, lon, dayStart, dayStart + 72 * 3600, "nws", series, errorText));
+    ASSERT_EQ(series.size(), 48);
+    EXPECT_EQ(series.timestampAt(0), (dayStart + 24 * 3600) * 1000);
+}
+
+TEST_F(MappedHistoricalStoreTest, ReopenKeepsSamplesAndStrings) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 4, 60.0), "nws", errorText));
+
+    MappedHistoricalStore reopened(store.directory());
+    ASSERT_TRUE(reopened.open(errorText));
+    ForecastSeries series;
+    ASSERT_TRUE(reopened.readSeries(lat, lon, dayStart, dayStart + 24 * 3600, "nws", series, errorText));
+    ASSERT_EQ(series.size(), 4);
+    EXPECT_EQ(series.conditionAt(0), QString("Clear"));
+    EXPECT_EQ(series.conditionAt(3), QString("Rain"));
+}
+
+TEST_F(MappedHistoricalStoreTest, RejectsDamagedSegment) {
+    QString errorText;
+    ASSERT_TRUE(store.insertSeries(lat, lon, hourly(0, 4, 60.0), "nws", errorText));
+
+    MappedHistoricalStore reopened(store.directory());
+    ASSERT_TRUE(reopened.open(errorText));
+    QDir location(QDir(store.directory()).filePath(QString("%1_%2").arg(lat).arg(lon)));
+    const QStringList segments = location.entryList({"*.seg"}, QDir::Files);
+    ASSERT_EQ(segments.size(), 1);
+    QFile file(location.filePath(segments.first()));
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.write("XXXX");
+    file.close();
+
+    ForecastSeries series;
+    EXPECT_FALSE(reopened.readSeries(lat, lon, dayStart, dayStart + 24 * 3600, "nws", series, errorText));
+    EXPECT_FALSE(errorText.isEmpty());
+}
+
+TEST_F(MappedHistoricalStoreTest, NewSegmentsVisibleWithRelativeDirectory) {
+    const QString previous = QDir::currentPath();
+    ASSERT_TRUE(QDir::setCurrent(dir.path()));
+    MappedHistoricalStore relative("relative");
+    QString errorText;
+    ASSERT_TRUE(relative.open(errorText)) << errorText.toStdString();
+
+    // The first read caches the location's (empty) segment list
+    ForecastSeries series;
+    ASSERT_TRUE(relative.readSeries(lat, lon, dayStart, dayStart + 48 * 3600, "nws", series, errorText));
+    EXPECT_TRUE(series.isEmpty());
+
+    ASSERT_TRUE(relative.insertSeries(lat, lon, hourly(0, 4, 60.0), "nws", errorText));
+    ASSERT_TRUE(relative.insertSeries(lat, lon, hourly(24, 4, 60.0), "nws", errorText));
+    ASSERT_TRUE(relative.readSeries(lat, lon, dayStart, dayStart + 48 * 3600, "nws", series, errorText));
+    EXPECT_EQ(series.size(), 8);
+
+    QDir::setCurrent(previous);
+}
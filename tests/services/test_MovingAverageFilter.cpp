@@ -4,6 +4,7 @@
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QtMath>
+#include <QTimeZone>
 
 class MovingAverageFilterTest : public ::testing::Test {
 protected:
@@ -179,3 +180,51 @@ TEST_F(MovingAverageFilterTest, WindowSizePerParameter) {
     SUCCEED();
 }
 
+
+TEST_F(MovingAverageFilterTest, StreamMatchesWholeSeries) {
+    ForecastSeries series;
+    const qint64 baseMs = QDateTime(QDate(2024, 6, 1), QTime(0, 0), QTimeZone::utc()).toMSecsSinceEpoch();
+    for (int i = 0; i < 103; ++i) {
+        WeatherSample sample;
+        sample.timestampMs = baseMs + static_cast<qint64>(i) * 3600 * 1000;
+        sample.temperature = 60.0 + (i * 7) % 13;
+        sample.humidity = 40 + i % 9;
+        sample.windSpeed = 5.0 + i % 4;
+        sample.windDirection = (i * 30) % 360;
+        sample.conditionId = series.internString(i % 3 == 0 ? "Rain" : "Clear");
+        series.append(sample);
+    }
+    
+    for (MovingAverageFilter::MovingAverageType type : {MovingAverageFilter::Simple, MovingAverageFilter::Exponential}) {
+        filter->setType(type);
+        const ForecastSeries whole = filter->smoothForecast(series);
+        
+        // Uneven batches, including ones smaller than half a window
+        ForecastSeries streamed;
+        int offset = 0;
+        for (int batchSize : {1, 2, 17, 40, 43}) {
+            ForecastSeries batch;
+            for (int i = offset; i < offset + batchSize; ++i) {
+                batch.append(series.at(i), series);
+            }
+            offset += batchSize;
+            const ForecastSeries part = filter->smoothStream(batch);
+            for (int i = 0; i < part.size(); ++i) {
+                streamed.append(part.at(i), part);
+            }
+        }
+        const ForecastSeries rest = filter->finishStream();
+        for (int i = 0; i < rest.size(); ++i) {
+            streamed.append(rest.at(i), rest);
+        }
+        
+        ASSERT_EQ(streamed.size(), whole.size());
+        for (int i = 0; i < whole.size(); ++i) {
+            EXPECT_EQ(streamed.timestampAt(i), whole.timestampAt(i));
+            EXPECT_DOUBLE_EQ(streamed.temperatures().at(i), whole.temperatures().at(i));
+            EXPECT_EQ(streamed.humidities().at(i), whole.humidities().at(i));
+            EXPECT_EQ(streamed.windDirections().at(i), whole.windDirections().at(i));
+            EXPECT_EQ(streamed.conditionAt(i), whole.conditionAt(i));
+        }
+    }
+}
@@ -24,6 +24,10 @@ protected:
     void testParseForecastResponse(const QByteArray& data, double lat, double lon, bool hasMinuteReceivers = false) {
         service->parseForecastResponse(data, lat, lon, hasMinuteReceivers);
     }
+    
+    int activeReplyCount() const {
+        return service->m_activeReplies.size();
+    }
 };
 
 TEST_F(PirateWeatherServiceTest, Initialization) {
@@ -114,3 +118,21 @@ TEST_F(PirateWeatherServiceTest, ParseMissingFields) {
     EXPECT_NE(data, nullptr);
     EXPECT_EQ(data->temperature(), 0.0); // Default
 }
+
+TEST_F(PirateWeatherServiceTest, DuplicateFetchJoinsInFlightRequest) {
+    service->fetchForecast(30.62721, -96.33441);
+    service->fetchForecast(30.62719, -96.33439); // Same rounded coordinate
+    
+    EXPECT_EQ(activeReplyCount(), 1);
+    EXPECT_EQ(service->coalescedRequestCount(), 1);
+    
+    // A different coordinate still gets its own request
+    service->fetchForecast(29.7604, -95.3698);
+    EXPECT_EQ(activeReplyCount(), 2);
+    
+    // Once cancelled, the next fetch starts a fresh request
+    service->cancelActiveRequests();
+    service->fetchForecast(30.62721, -96.33441);
+    EXPECT_EQ(activeReplyCount(), 1);
+    EXPECT_EQ(service->coalescedRequestCount(), 1);
+}
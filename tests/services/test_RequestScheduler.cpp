@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "services/RequestScheduler.h"
+#include "services/WeatherService.h"
+#include <QEventLoop>
+#include <QTimer>
+#include <QStringList>
+
+namespace {
+class CountingService : public WeatherService
+{
+public:
+    void fetchForecast(double, double) override { ++fetches; }
+    void fetchCurrent(double, double) override {}
+    QString serviceName() const override { return "Counting"; }
+
+    int fetches = 0;
+};
+
+class OtherService : public CountingService
+{
+public:
+    QString serviceName() const override { return "Other"; }
+};
+
+void waitMs(int ms) {
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+RequestScheduler::RateLimit limit(double perSecond, int burst, int reserve) {
+    RequestScheduler::RateLimit result;
+    result.requestsPerSecond = perSecond;
+    result.burst = burst;
+    result.interactiveReserve = reserve;
+    return result;
+}
+} // namespace
+
+TEST(RequestSchedulerTest, UnlimitedProvidersDispatchImmediately) {
+    RequestScheduler scheduler;
+    CountingService service;
+
+    for (int i = 0; i < 14; ++i) {
+        scheduler.fetchForecast(&service, 30.0, -97.0, RequestScheduler::Prefetch);
+    }
+    EXPECT_EQ(service.fetches, 14);
+    EXPECT_EQ(scheduler.queuedCount("Counting"), 0);
+}
+
+TEST(RequestSchedulerTest, BurstIsLimitedAndRefills) {
+    RequestScheduler scheduler;
+    scheduler.setRateLimit("Counting", limit(20.0, 4, 0));
+    CountingService service;
+
+    for (int i = 0; i < 6; ++i) {
+        scheduler.fetchForecast(&service, 30.0, -97.0);
+    }
+    EXPECT_EQ(service.fetches, 4);
+    EXPECT_EQ(scheduler.queuedCount("Counting"), 2);
+
+    // 20 per second refills the remaining two within ~100 ms
+    waitMs(300);
+    EXPECT_EQ(service.fetches, 6);
+    EXPECT_EQ(scheduler.stats("Counting").dispatched[RequestScheduler::Interactive], 6);
+}
+
+TEST(RequestSchedulerTest, HigherClassesGoFirst) {
+    RequestScheduler scheduler;
+    scheduler.setRateLimit("Counting", limit(20.0, 1, 0));
+    CountingService service;
+    QStringList order;
+
+    // Empty the bucket, then queue one of each class in reverse order
+    scheduler.submit(&service, RequestScheduler::Prefetch, [&]() { order << "first"; });
+    scheduler.submit(&service, RequestScheduler::Prefetch, [&]() { order << "prefetch"; });
+    scheduler.submit(&service, RequestScheduler::Alerts, [&]() { order << "alerts"; });
+    scheduler.submit(&service, RequestScheduler::Interactive, [&]() { order << "interactive"; });
+    ASSERT_EQ(order, QStringList({"first"}));
+
+    waitMs(400);
+    EXPECT_EQ(order, QStringList({"first", "interactive", "alerts", "prefetch"}));
+}
+
+TEST(RequestSchedulerTest, ReserveKeepsInteractiveLatencyFlat) {
+    RequestScheduler scheduler;
+    scheduler.setRateLimit("Counting", limit(0.1, 5, 2));
+    CountingService service;
+
+    // Background work takes everything but the reserve
+    for (int i = 0; i < 10; ++i) {
+        scheduler.fetchForecast(&service, 30.0, -97.0, RequestScheduler::Prefetch);
+    }
+    EXPECT_EQ(service.fetches, 3);
+
+    // A user fetch does not wait behind it
+    scheduler.fetchForecast(&service, 30.0, -97.0, RequestScheduler::Interactive);
+    EXPECT_EQ(service.fetches, 4);
+    EXPECT_EQ(scheduler.stats("Counting").maxWaitMs[RequestScheduler::Interactive], 0);
+}
+
+TEST(RequestSchedulerTest, ExpiredWorkIsDropped) {
+    RequestScheduler scheduler;
+    scheduler.setRateLimit("Counting", limit(0.1, 1, 0));
+    CountingService service;
+    int errors = 0;
+    QObject::connect(&service, &WeatherService::error, [&errors]() { ++errors; });
+
+    scheduler.fetchForecast(&service, 30.0, -97.0);
+    scheduler.fetchForecast(&service, 30.0, -97.0, RequestScheduler::Interactive, 20);
+    EXPECT_EQ(service.fetches, 1);
+
+    waitMs(200);
+    EXPECT_EQ(service.fetches, 1);
+    EXPECT_EQ(errors, 1);
+    EXPECT_EQ(scheduler.stats("Counting").expired[RequestScheduler::Interactive], 1);
+    EXPECT_EQ(scheduler.queuedCount("Counting"), 0);
+}
+
+TEST(RequestSchedulerTest, CancelDropsQueuedWork) {
+    RequestScheduler scheduler;
+    scheduler.setRateLimit("Counting", limit(0.1, 1, 0));
+    CountingService service;
+    bool expired = false;
+
+    scheduler.fetchForecast(&service, 30.0, -97.0);
+    scheduler.submit(&service, RequestScheduler::Prefetch, [&service]() { service.fetchForecast(0, 0); },
+                     [&expired]() { expired = true; });
+    scheduler.cancel(&service);
+
+    EXPECT_EQ(scheduler.queuedCount("Counting"), 0);
+    EXPECT_EQ(scheduler.stats("Counting").cancelled, 1);
+    EXPECT_EQ(service.fetches, 1);
+    EXPECT_FALSE(expired);
+}
+
+TEST(RequestSchedulerTest, WorkForAnotherProviderRunsAfterThePass) {
+    RequestScheduler scheduler;
+    CountingService service;
+    OtherService other;
+    QStringList order;
+
+    // A fetch finishing synchronously starts a fetch against another provider
+    scheduler.submit(&service, RequestScheduler::Interactive, [&]() {
+        order << "counting";
+        scheduler.submit(&other, RequestScheduler::Interactive, [&]() { order << "other"; });
+        order << "counting done";
+    });
+    EXPECT_EQ(order, QStringList({"counting", "counting done", "other"}));
+    EXPECT_EQ(scheduler.queuedCount("Other"), 0);
+}
@@ -117,3 +117,22 @@ TEST(SpatioTemporalEngineTest, CombineApisFallsBackWhenMissing) {
     qDeleteAll(apiB);
 }
 
+
+TEST(SpatioTemporalEngineTest, CombiningSeriesEmitsForecastReady) {
+    SpatioTemporalEngine engine;
+    QList<WeatherData*> emitted;
+    QObject::connect(&engine, &SpatioTemporalEngine::forecastReady,
+                     [&emitted](QList<WeatherData*> forecast) { emitted += forecast; });
+
+    QList<WeatherData*> api;
+    api.append(makeWeatherData(30.0, -90.0, 70.0, nowUtc()));
+    QMap<QString, ForecastSeries> apiForecasts;
+    apiForecasts["API_A"] = ForecastSeries::fromWeatherData(api);
+    qDeleteAll(api);
+
+    const ForecastSeries combined = engine.combineAPIForecasts(apiForecasts);
+    ASSERT_EQ(combined.size(), 1);
+    ASSERT_EQ(emitted.size(), 1);
+    EXPECT_NEAR(emitted[0]->temperature(), 70.0, 0.1);
+    qDeleteAll(emitted);
+}
@@ -7,6 +7,52 @@
 #include <QSignalSpy>
 #include <QTimer>
 
+namespace {
+// Answers synchronously; every point north of the request shares one cell
+class CellService : public WeatherService
+{
+public:
+    explicit CellService(double centerLatitude) : m_centerLatitude(centerLatitude) {}
+    
+    void fetchForecast(double latitude, double longitude) override {
+        fetched.append(QPointF(latitude, longitude));
+        QList<WeatherData*> data;
+        const QDateTime start = QDateTime::currentDateTimeUtc();
+        for (int i = 0; i < 3; ++i) {
+            WeatherData* sample = new WeatherData();
+            sample->setLatitude(latitude);
+            sample->setLongitude(longitude);
+            sample->setTimestamp(start.addSecs(i * 3600));
+            sample->setTemperature(latitude >= m_centerLatitude ? 70.0 : 80.0);
+            data.append(sample);
+        }
+        emit forecastReady(data);
+    }
+    void fetchCurrent(double latitude, double longitude) override { fetchForecast(latitude, longitude); }
+    QString serviceName() const override { return "NWS"; }
+    QString upstreamCell(double latitude, double longitude) override {
+        Q_UNUSED(longitude);
+        return latitude >= m_centerLatitude ? "north" : "south";
+    }
+    
+    QList<QPointF> fetched;
+    
+private:
+    double m_centerLatitude;
+};
+
+// Records fetches without answering them
+class SilentService : public WeatherService
+{
+public:
+    void fetchForecast(double latitude, double longitude) override { fetched.append(QPointF(latitude, longitude)); }
+    void fetchCurrent(double latitude, double longitude) override { fetchForecast(latitude, longitude); }
+    QString serviceName() const override { return "Silent"; }
+    
+    QList<QPointF> fetched;
+};
+} // namespace
+
 class WeatherAggregatorTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -127,3 +173,43 @@ TEST_F(WeatherAggregatorTest, MovingAverageConfiguration) {
     SUCCEED();
 }
 
+TEST_F(WeatherAggregatorTest, SpatioTemporalFetchesEachUpstreamCellOnce) {
+    CellService service(30.2672);
+    aggregator->addService(&service, 10);
+    aggregator->setStrategy(WeatherAggregator::WeightedAverage);
+    QSignalSpy spy(aggregator, &WeatherAggregator::forecastReady);
+    
+    aggregator->fetchForecast(30.2672, -97.7431);
+    
+    // Seven grid points fall in two cells; every point still gets a forecast
+    EXPECT_EQ(service.fetched.size(), 2);
+    ASSERT_EQ(spy.count(), 1);
+    QList<WeatherData*> merged = spy.takeFirst().at(0).value<QList<WeatherData*>>();
+    EXPECT_FALSE(merged.isEmpty());
+    EXPECT_FALSE(aggregator->isSpatioTemporalActive());
+    qDeleteAll(merged);
+}
+
+TEST_F(WeatherAggregatorTest, NewRequestDropsFetchesQueuedForThePreviousOne) {
+    SilentService service;
+    aggregator->addService(&service, 10);
+    aggregator->setStrategy(WeatherAggregator::PrimaryOnly);
+    
+    RequestScheduler::RateLimit limit;
+    limit.requestsPerSecond = 0.001;
+    limit.burst = 1;
+    limit.interactiveReserve = 0;
+    RequestScheduler* scheduler = RequestScheduler::instance();
+    scheduler->setRateLimit("Silent", limit);
+    
+    aggregator->fetchForecast(30.0, -97.0);
+    aggregator->fetchForecast(31.0, -97.0);
+    aggregator->fetchForecast(32.0, -97.0);
+    EXPECT_EQ(service.fetched.size(), 1);
+    EXPECT_EQ(scheduler->queuedCount("Silent"), 1);
+    
+    // Only the latest request is still waiting for a token
+    scheduler->clearRateLimit("Silent");
+    ASSERT_EQ(service.fetched.size(), 2);
+    EXPECT_DOUBLE_EQ(service.fetched.last().x(), 32.0);
+}